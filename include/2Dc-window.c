@@ -1,5 +1,12 @@
 #include "2Dc-window.h"
 
+/*functions, descriptor_t and the handle are defined within the data structure header file*/
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention);
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention);
+uint64_t random_index(uint16_t width);
+void initialize_window(DS_TYPE* set, uint16_t depth);
+void initialize_thread_window(thread_window_t* window);
+
 
 static inline uint64_t hop(DS_TYPE* set, uint64_t index, uint16_t* random, uint16_t* hops)
 {
@@ -27,45 +34,47 @@ static inline uint64_t hop(DS_TYPE* set, uint64_t index, uint16_t* random, uint1
 }
 
 // Reads the global window into the thread local one, can think of it as atomic
-static void read_window()
+static void read_window(DS_TYPE* set, thread_window_t* window)
 {
 	// Opt: Can we read it in two consecutive parts? First in that case the version, and then the rest
-	// __atomic_load(&global_Window.content, &thread_Window, __ATOMIC_SEQ_CST);
-	thread_Window.max = global_Window.content.max;
-	thread_Window.version = global_Window.content.version;
+	// __atomic_load(&set->Window.content, &window->Window, __ATOMIC_SEQ_CST);
+	window->Window.max = set->Window.content.max;
+	window->Window.version = set->Window.content.version;
 }
 
-descriptor_t put_window(DS_TYPE* set, uint8_t contention)
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	window_t read_global_Window, new_window;
 	uint16_t hops, random;
 	descriptor_t descriptor;
 	hops = random = 0;
 
-	if(thread_Window.version != global_Window.content.version)
+	if(window->Window.version != set->Window.content.version)
 	{
-		read_window();
+		read_window(set, window);
 	}
 
 	if(contention == 1)
 	{
-		thread_index = random_index(set->width);
+		window->index = random_index(set->width);
 	}
 
 	while(1)
 	{
 		/* read descriptor */
-		descriptor =  set->set_array[thread_index].descriptor;
+		descriptor =  set->set_array[window->index].descriptor;
 
 		/* Read the global window and possibly sync */
-		if (global_Window.content.version != thread_Window.version)
+		if (set->Window.content.version != window->Window.version)
 		{
 			hops = 0;
-			read_window();
+			read_window(set, window);
 		}
 
 		/* Try to work on the descriptor */
-		else if(descriptor.count < thread_Window.max)
+		else if(descriptor.count < window->Window.max)
 		{
 			return descriptor;
 		}
@@ -73,27 +82,27 @@ descriptor_t put_window(DS_TYPE* set, uint8_t contention)
 		/* hop */
 		else if(hops != set->width)
 		{
-			thread_index = hop(set, thread_index, &random, &hops);
+			window->index = hop(set, window->index, &random, &hops);
 		}
 
 		/* shift window */
 		else
 		{
 
-			new_window.max = thread_Window.max + set->shift;
-			new_window.version = thread_Window.version + 1;
+			new_window.max = window->Window.max + set->shift;
+			new_window.version = window->Window.version + 1;
 
-			if(thread_Window.version == global_Window.content.version)
+			if(window->Window.version == set->Window.content.version)
 			{
 
-				if(CAE(&global_Window.content, &thread_Window, &new_window))
+				if(CAE(&set->Window.content, &window->Window, &new_window))
 				{
-					thread_Window = new_window;
+					window->Window = new_window;
 					my_slide_count+=1;
 				}
 				else
 				{
-					read_window();
+					read_window(set, window);
 					my_slide_fail_count+=1;
 				}
 			}
@@ -103,39 +112,41 @@ descriptor_t put_window(DS_TYPE* set, uint8_t contention)
 }
 
 
-descriptor_t get_window(DS_TYPE* set, uint8_t contention)
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	window_t read_global_Window, new_window;
 	uint16_t hops, random, shift;
 	hops = random = 0;
 	descriptor_t descriptor;
 	uint8_t empty = 1;
 
-	if(thread_Window.version != global_Window.content.version)
+	if(window->Window.version != set->Window.content.version)
 	{
-		read_window();
+		read_window(set, window);
 	}
 
 	if(contention == 1)
 	{
-		thread_index = random_index(set->width);
+		window->index = random_index(set->width);
 	}
 
 	while(1)
 	{
 
 		/* read descriptor */
-		descriptor =  set->set_array[thread_index].descriptor;
+		descriptor =  set->set_array[window->index].descriptor;
 
 		/* Read the global window and possibly sync */
-		if (global_Window.content.version != thread_Window.version)
+		if (set->Window.content.version != window->Window.version)
 		{
 			hops = 0; empty = 1;
-			read_window();
+			read_window(set, window);
 		}
 
-		/* empty sub-structures will be skipped at this point because (global_Window.content.max - set->depth) cannot go bellow zero */
-		else if(descriptor.count + set->depth > thread_Window.max)
+		/* empty sub-structures will be skipped at this point because (set->Window.content.max - set->depth) cannot go bellow zero */
+		else if(descriptor.count + set->depth > window->Window.max)
 		{
 			return descriptor;
 		}
@@ -148,7 +159,7 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 			{
 				empty = 0;
 			}
-			thread_index = hop(set, thread_index, &random, &hops);
+			window->index = hop(set, window->index, &random, &hops);
 		}
 
 		/* Return empty descriptor */
@@ -162,21 +173,21 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 		{
 
 
-			new_window.version = thread_Window.version + 1;
-			new_window.max = thread_Window.max - set->shift;
+			new_window.version = window->Window.version + 1;
+			new_window.max = window->Window.max - set->shift;
 
-			/* maintains (global_Window.content.max >= global_Window.content.depth) */
-			if(thread_Window.version == global_Window.content.version && new_window.max >= set->depth)
+			/* maintains (set->Window.content.max >= set->Window.content.depth) */
+			if(window->Window.version == set->Window.content.version && new_window.max >= set->depth)
 			{
 
-				if(CAE(&global_Window.content, &thread_Window, &new_window))
+				if(CAE(&set->Window.content, &window->Window, &new_window))
 				{
-					thread_Window = new_window;
+					window->Window = new_window;
 					my_slide_count+=1;
 				}
 				else
 				{
-					read_window();
+					read_window(set, window);
 					my_slide_fail_count+=1;
 				}
 			}
@@ -193,9 +204,16 @@ uint64_t random_index(uint16_t width)
 }
 
 
-void initialize_global_window(uint16_t depth)
+void initialize_window(DS_TYPE* set, uint16_t depth)
 {
-	global_Window.content.max = depth;
-	global_Window.content.version = 1;
+	set->Window.content.max = depth;
+	set->Window.content.version = 1;
+
+}
 
+void initialize_thread_window(thread_window_t* window)
+{
+	window->Window.max = 0;
+	window->Window.version = 0;
+	window->index = 0;
 }
@@ -1,3 +1,6 @@
+#ifndef TWODc_window
+#define TWODc_window
+
 typedef ALIGNED(CACHE_LINE_SIZE) struct window_descriptor
 {
 	uint64_t max;
@@ -10,14 +13,15 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct window_struct
 	uint8_t padding[CACHE_LINE_SIZE - sizeof(window_t)]; 
 } padded_window_t;
 
-/*window variables*/
-volatile padded_window_t global_Window;
-
-__thread window_t thread_Window;
-__thread uint64_t thread_index;
+/*
+ * The global window is kept in the data structure (Window), and every thread keeps its view of it
+ * in the handle returned by DS_REGISTER. This header only holds the types, so that it can be
+ * included before the data structure is defined. The functions are declared in 2Dc-window.c.
+ */
+typedef struct thread_window_struct
+{
+	window_t Window;
+	uint64_t index;
+} thread_window_t;
 
-/*functions, descriptor_t defined within the data structure header file*/
-descriptor_t put_window(DS_TYPE* set, uint8_t contention);
-descriptor_t get_window(DS_TYPE* set, uint8_t contention);
-uint64_t random_index(uint16_t width);
-void initialize_global_window(uint16_t depth);
\ No newline at end of file
+#endif
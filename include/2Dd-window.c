@@ -1,6 +1,13 @@
 
 #include "2Dd-window.h"
 
+/* functions */
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention);
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention);
+uint64_t random_index(uint32_t width);
+void initialize_window(DS_TYPE* set, uint64_t depth);
+void initialize_thread_window(thread_window_t* window);
+
 
 static inline uint64_t hop(DS_TYPE* set, uint64_t index, uint64_t* random, uint64_t* hops)
 {
@@ -27,8 +34,10 @@ static inline uint64_t hop(DS_TYPE* set, uint64_t index, uint64_t* random, uint6
 }
 
 
-descriptor_t put_window(DS_TYPE* set, uint8_t contention)
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	uint64_t hops, random;
 	descriptor_t descriptor;
 	put_window_t new_window, read_global_PWindow;
@@ -37,28 +46,28 @@ descriptor_t put_window(DS_TYPE* set, uint8_t contention)
 
 	if(contention == 1)
 	{
-		thread_index = random_index(set->width);
+		window->index = random_index(set->width);
 		contention = 0;
 	}
 
-	if(thread_PWindow.max != global_PWindow.content.max)
+	if(window->PWindow.max != set->PWindow.content.max)
 	{
-		thread_PWindow = global_PWindow.content;
+		window->PWindow = set->PWindow.content;
 	}
 
 	while(1)
 	{
 
 		//read descriptor
-		assert(thread_index < set->width);
+		assert(window->index < set->width);
 		// Not an atomic read, but it is ok since both parts are monotonically increasing and we only act on it with CAS
-		descriptor =  set->put_array[thread_index].descriptor;
+		descriptor =  set->put_array[window->index].descriptor;
 		
 		// Read the global get window and possibly sync
-		read_global_PWindow = global_PWindow.content;
-		if (read_global_PWindow.max != thread_PWindow.max)
+		read_global_PWindow = set->PWindow.content;
+		if (read_global_PWindow.max != window->PWindow.max)
 		{
-			thread_PWindow = read_global_PWindow;
+			window->PWindow = read_global_PWindow;
 			hops = 0;
 		}
 
@@ -71,47 +80,49 @@ descriptor_t put_window(DS_TYPE* set, uint8_t contention)
 		//hop
 		else if(hops != set->width)
 		{
-			thread_index = hop(set, thread_index, &random, &hops);
+			window->index = hop(set, window->index, &random, &hops);
 		}
 
 		//shift window
 		else
 		{
-			if(thread_PWindow.max == global_PWindow.content.max)
+			if(window->PWindow.max == set->PWindow.content.max)
 			{
-				new_window.max = thread_PWindow.max + set->depth;
+				new_window.max = window->PWindow.max + set->depth;
 
-				if(CAE(&global_PWindow.content, &thread_PWindow, &new_window))
+				if(CAE(&set->PWindow.content, &window->PWindow, &new_window))
 				{
 					my_slide_count+=1;
 				}
 			}
 
-			thread_PWindow = global_PWindow.content;
+			window->PWindow = set->PWindow.content;
 			hops = 0;
 		}
 	}
 }
 
-descriptor_t get_window(DS_TYPE* set, uint8_t contention)
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	descriptor_t descriptor;
 	get_window_t new_window, read_global_GWindow;
 	uint64_t hops, random, put_count;
 	uint8_t notempty;
 
 	notempty = hops = random = 0;
-	thread_GWindow = global_GWindow.content;
+	window->GWindow = set->GWindow.content;
 
 	if(contention == 1)
 	{
-		thread_index = random_index(set->width);
+		window->index = random_index(set->width);
 		contention = 0;
 	}
 
-	if(thread_GWindow.max != global_GWindow.content.max)
+	if(window->GWindow.max != set->GWindow.content.max)
 	{
-		thread_GWindow = global_GWindow.content;
+		window->GWindow = set->GWindow.content;
 		notempty=0;
 	}
 
@@ -120,14 +131,14 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 	{
 
 		//read descriptor
-		descriptor =  set->get_array[thread_index].descriptor;
-		put_count = set->put_array[thread_index].descriptor.put_count;
+		descriptor =  set->get_array[window->index].descriptor;
+		put_count = set->put_array[window->index].descriptor.put_count;
 
 		// Read the global get window and possibly sync
-		read_global_GWindow = global_GWindow.content;
-		if (read_global_GWindow.max != thread_GWindow.max)
+		read_global_GWindow = set->GWindow.content;
+		if (read_global_GWindow.max != window->GWindow.max)
 		{
-			thread_GWindow = read_global_GWindow;
+			window->GWindow = read_global_GWindow;
 			hops = notempty = 0;
 		}
 
@@ -145,23 +156,23 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 				notempty = 1;
 			}
 
-			thread_index = hop(set, thread_index, &random, &hops);
+			window->index = hop(set, window->index, &random, &hops);
 		}
 
 		// Shift window
 		else if (notempty)
 		{
-			if(thread_GWindow.max == global_GWindow.content.max)
+			if(window->GWindow.max == set->GWindow.content.max)
 			{
-				new_window.max = thread_GWindow.max + set->depth;
+				new_window.max = window->GWindow.max + set->depth;
 
-				if(CAE(&global_GWindow.content, &thread_GWindow, &new_window))
+				if(CAE(&set->GWindow.content, &window->GWindow, &new_window))
 				{
 					my_slide_count+=1;
 				}
 			}
 
-			thread_GWindow = global_GWindow.content;
+			window->GWindow = set->GWindow.content;
 			hops = notempty = 0;
 		}
 
@@ -180,12 +191,23 @@ uint64_t random_index(uint32_t width)
 	return (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % width);
 }
 
-void initialize_global_window(uint64_t depth)
+void initialize_window(DS_TYPE* set, uint64_t depth)
+{
+	/**
+	 * Initializes the global windows of a data structure
+	 */
+
+	set->PWindow.content.max = depth;
+	set->GWindow.content.max = depth;
+}
+
+void initialize_thread_window(thread_window_t* window)
 {
 	/**
-	 * Initializes the required global window variables
+	 * Initializes the view of the windows of a thread, which is synchronized at its first operation
 	 */
 
-	global_PWindow.content.max = depth;
-	global_GWindow.content.max = depth;
+	window->PWindow.max = 0;
+	window->GWindow.max = 0;
+	window->index = 0;
 }
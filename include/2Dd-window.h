@@ -23,18 +23,16 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct padded_get_window_struct
 	uint8_t padding[CACHE_LINE_SIZE - sizeof(get_window_t)];
 } padded_get_window_t;
 
-/*window variables*/
-volatile padded_put_window_t global_PWindow;
-volatile padded_get_window_t global_GWindow;
-
-__thread put_window_t thread_PWindow;
-__thread get_window_t thread_GWindow;
-__thread uint64_t thread_index;
-
-/* functions */
-descriptor_t put_window(DS_TYPE* set, uint8_t contention);
-descriptor_t get_window(DS_TYPE* set, uint8_t contention);
-uint64_t random_index(uint32_t width);
-void initialize_global_window(uint64_t depth);
+/*
+ * The global windows are kept in the data structure (PWindow and GWindow), and every thread keeps
+ * its view of them in the handle returned by DS_REGISTER. This header only holds the types, so that it
+ * can be included before the data structure is defined. The functions are declared in 2Dd-window.c.
+ */
+typedef struct thread_window_struct
+{
+	put_window_t PWindow;
+	get_window_t GWindow;
+	uint64_t index;
+} thread_window_t;
 
 #endif
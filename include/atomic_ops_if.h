@@ -236,6 +236,7 @@
 	// https://gcc.gnu.org/onlinedocs/gcc/_005f_005fatomic-Builtins.html
 
 	#  define CAE_N(a,b,c,d,e,f) 	__atomic_compare_exchange_n (a,b,c,d,e,f)
+	#  define FAA_U64(a,b) 			__sync_fetch_and_add(a,b)
 	/********************************************************/
 
 	//Swap
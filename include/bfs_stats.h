@@ -0,0 +1,134 @@
+#ifndef BFS_STATS_H
+#define BFS_STATS_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graph.h"
+#include "utils.h"
+
+/* ################################################################### *
+ * TERMINATION DETECTION AND WORK STATISTICS OF THE BFS BENCHMARKS
+ * ################################################################### */
+
+// Items each thread has added to the queue and fully processed, where an item only counts as
+// processed once all the neighbors it found have been added. Only written by their own thread.
+typedef ALIGNED(CACHE_LINE_SIZE) struct bfs_counters {
+    volatile uint64_t added;
+    volatile uint64_t processed;
+} bfs_counters_t;
+
+// Expansions of a thread at every distance, grown as deeper vertices are expanded
+typedef ALIGNED(CACHE_LINE_SIZE) struct bfs_levels {
+    uint64_t *expansions;
+    uint64_t n_levels;
+    uint64_t idle_time;
+} bfs_levels_t;
+
+static bfs_counters_t *bfs_counters;
+static bfs_levels_t *bfs_levels;
+static size_t bfs_threads;
+
+static void bfs_stats_init(size_t n_threads) {
+    bfs_threads = n_threads;
+    bfs_counters = (bfs_counters_t*) aligned_alloc(CACHE_LINE_SIZE, n_threads * sizeof(bfs_counters_t));
+    bfs_levels = (bfs_levels_t*) aligned_alloc(CACHE_LINE_SIZE, n_threads * sizeof(bfs_levels_t));
+    if (!bfs_counters || !bfs_levels) {
+        perror("malloc");
+        exit(1);
+    }
+    memset(bfs_counters, 0, n_threads * sizeof(bfs_counters_t));
+    memset(bfs_levels, 0, n_threads * sizeof(bfs_levels_t));
+}
+
+// Called before the item is added, so that it is never processed before it is counted
+static inline void bfs_added(int thread) {
+    __atomic_store_n(&bfs_counters[thread].added, bfs_counters[thread].added + 1, __ATOMIC_RELEASE);
+}
+
+static inline void bfs_processed(int thread) {
+    __atomic_store_n(&bfs_counters[thread].processed, bfs_counters[thread].processed + 1, __ATOMIC_RELEASE);
+}
+
+// Sums the processed counters before the added ones. Both only grow and processed never exceeds
+// added, so equal sums mean every added item had been processed when the last processed counter
+// was read, and then no thread can add anything more.
+static bool bfs_terminated() {
+    uint64_t processed = 0, added = 0;
+    for (size_t t = 0; t < bfs_threads; t++) {
+        processed += __atomic_load_n(&bfs_counters[t].processed, __ATOMIC_ACQUIRE);
+    }
+    for (size_t t = 0; t < bfs_threads; t++) {
+        added += __atomic_load_n(&bfs_counters[t].added, __ATOMIC_ACQUIRE);
+    }
+    return processed == added;
+}
+
+static inline void bfs_expanded(int thread, uint64_t distance) {
+    bfs_levels_t *levels = &bfs_levels[thread];
+    if (unlikely(distance >= levels->n_levels)) {
+        uint64_t n_levels = levels->n_levels ? levels->n_levels : 64;
+        while (n_levels <= distance) n_levels *= 2;
+        if ((levels->expansions = (uint64_t*) realloc(levels->expansions, n_levels * sizeof(uint64_t))) == NULL) {
+            perror("realloc");
+            exit(1);
+        }
+        memset(&levels->expansions[levels->n_levels], 0, (n_levels - levels->n_levels) * sizeof(uint64_t));
+        levels->n_levels = n_levels;
+    }
+    levels->expansions[distance]++;
+}
+
+static inline void bfs_idle(int thread, uint64_t ns) {
+    bfs_levels[thread].idle_time += ns;
+}
+
+// Prints the expansions beyond one per reached vertex and the idle time of every thread. With
+// print_levels also the cost of every level, as the expansions at a distance per vertex whose
+// final distance it is, where expansions with a distance that was later improved are wasted.
+static void bfs_stats_print(graph_t *g, bool print_levels) {
+    uint64_t n_levels = 0, expansions = 0, visited = 0, idle_time = 0;
+    for (size_t t = 0; t < bfs_threads; t++) {
+        if (bfs_levels[t].n_levels > n_levels) n_levels = bfs_levels[t].n_levels;
+    }
+    uint64_t *level_expansions = (uint64_t*) calloc(n_levels + 1, sizeof(uint64_t));
+    uint64_t *level_verticies = (uint64_t*) calloc(n_levels + 1, sizeof(uint64_t));
+    if (!level_expansions || !level_verticies) {
+        perror("malloc");
+        exit(1);
+    }
+    for (size_t t = 0; t < bfs_threads; t++) {
+        for (uint64_t l = 0; l < bfs_levels[t].n_levels; l++) {
+            level_expansions[l] += bfs_levels[t].expansions[l];
+            expansions += bfs_levels[t].expansions[l];
+        }
+    }
+    for (uint64_t v = 1; v <= g->n_verticies; v++) {
+        uint64_t distance = get_distance(g, v);
+        if (distance == UINT64_MAX) continue;
+        visited++;
+        level_verticies[distance < n_levels ? distance : n_levels]++;
+    }
+
+    printf("expanded_vertices , %lu \n", expansions);
+    printf("re_expanded_vertices , %lu \n", expansions - visited);
+    for (size_t t = 0; t < bfs_threads; t++) {
+        printf("idle_time_thread_%zu , %.3f \n", t, (double) bfs_levels[t].idle_time / 1000000);
+        idle_time += bfs_levels[t].idle_time;
+    }
+    printf("idle_time_avg , %.3f \n", (double) idle_time / bfs_threads / 1000000);
+
+    if (print_levels) {
+        printf("#level vertices expansions relaxation_cost\n");
+        for (uint64_t l = 0; l < n_levels; l++) {
+            if (level_verticies[l] == 0 && level_expansions[l] == 0) continue;
+            printf("level_cost , %lu , %lu , %lu , %.3f \n", l, level_verticies[l], level_expansions[l],
+                   level_verticies[l] ? (double) level_expansions[l] / level_verticies[l] : 0.0);
+        }
+    }
+    free(level_expansions);
+    free(level_verticies);
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef CHOICE_CONTROLLER_H
+#define CHOICE_CONTROLLER_H
+
+// Per thread and queue controller of the number of choices d in the d-CBO queues (ADAPTIVE=1 builds), in the
+// spirit of the elastic controller in src/2Dd-queue_elastic-lpw/controller.h. Every operation moves
+// a balance up when more choices are wanted and down when fewer are, and d is stepped by one when
+// the balance passes a threshold. The controllers are kept in the handles of the d-CBO queues.
+#include "utils.h"
+#include <stdint.h>
+
+// Balance decrement for an operation with CAS failures, as fewer samples mean fewer contended cache lines
+#define CHOICE_CONTENTION 50
+// Balance increment for a dequeue whose best sample was empty while the queue was not
+#define CHOICE_EMPTY 10
+// Balance change towards the configured d for an uncontended operation when there is no rank error budget
+#define CHOICE_UNCONTENDED 1
+// Balance increment while the estimated rank error is above the budget
+#define CHOICE_OVER_BUDGET 20
+// Balance decrement while it is below half the budget, to save the cache misses of the extra samples
+#define CHOICE_UNDER_BUDGET 1
+// At what absolute balance to change d
+#define CHOICE_THRESHOLD 2000
+// How often to halve the balance, preventing drift
+#define CHOICE_HALVE_OPS 100000
+// One in this many operations draws an extra sample to estimate the rank error
+#define CHOICE_PROBE_OPS 16
+#define CHOICE_MIN_D 1
+#define CHOICE_MAX_D 16
+
+typedef struct {
+  /// Incremented when more choices are wanted, decremented when fewer are.
+  int32_t balance;
+
+  /// The number of operations since the balance was last halved.
+  uint32_t ops;
+
+  uint32_t d;
+
+  /// Moving average of the rank error estimates of the probes.
+  int64_t error;
+
+  /// For the mean d of the thread.
+  uint64_t d_sum;
+  uint64_t total_ops;
+} choice_controller_t;
+
+static inline void init_choice_controller(choice_controller_t *cont, uint32_t d) {
+  cont->balance = 0;
+  cont->ops = 0;
+  cont->d = d < CHOICE_MIN_D ? CHOICE_MIN_D : (d > CHOICE_MAX_D ? CHOICE_MAX_D : d);
+  cont->error = 0;
+  cont->d_sum = 0;
+  cont->total_ops = 0;
+}
+
+static inline int choice_probe(choice_controller_t *cont) {
+  return cont->total_ops % CHOICE_PROBE_OPS == 0;
+}
+
+// Adds the rank error estimate of a probe, which compares the chosen sub-queue with an independent
+// random one. An operation at count c_i is out of order with every sub-queue j with c_j < c_i, so
+// width * (c_i - c_j) for a uniform j estimates the rank error of the operation.
+static inline void choice_probe_error(choice_controller_t *cont, uint32_t width, int64_t chosen, int64_t other) {
+  int64_t error = chosen > other ? (int64_t) width * (chosen - other) : 0;
+  cont->error += (error - cont->error) / 8;
+}
+
+// Feeds one operation to the controller, with its CAS failures, whether its best sample was empty
+// although the queue was not, and the rank error budget (0 if none). Without a budget, d returns to
+// the configured d once the contention is gone.
+static inline void update_choice_controller(choice_controller_t *cont, unsigned long cas_failures,
+                                            int empty, uint64_t budget, uint32_t configured_d) {
+  if (cas_failures) {
+    cont->balance -= CHOICE_CONTENTION;
+  } else if (budget == 0 && cont->d != configured_d) {
+    cont->balance += cont->d < configured_d ? CHOICE_UNCONTENDED : -CHOICE_UNCONTENDED;
+  }
+  if (budget != 0) {
+    if (cont->error > (int64_t) budget) {
+      cont->balance += CHOICE_OVER_BUDGET;
+    } else if (2 * cont->error < (int64_t) budget) {
+      cont->balance -= CHOICE_UNDER_BUDGET;
+    }
+  }
+  if (empty) {
+    cont->balance += CHOICE_EMPTY;
+  }
+
+  cont->d_sum += cont->d;
+  cont->total_ops += 1;
+  cont->ops += 1;
+  if (unlikely(cont->ops == CHOICE_HALVE_OPS)) {
+    cont->balance = cont->balance / 2;
+    cont->ops = 0;
+  }
+  if (unlikely(cont->balance > CHOICE_THRESHOLD)) {
+    if (cont->d < CHOICE_MAX_D) cont->d += 1;
+    cont->balance = 0;
+  } else if (unlikely(cont->balance < -CHOICE_THRESHOLD)) {
+    if (cont->d > CHOICE_MIN_D) cont->d -= 1;
+    cont->balance = 0;
+  }
+}
+
+static inline double choice_mean(choice_controller_t *cont) {
+  return cont->total_ops ? (double) cont->d_sum / cont->total_ops : cont->d;
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _FUTEX_H_
+	#define _FUTEX_H_
+
+	#include <errno.h>
+	#include <limits.h>
+	#include <stdint.h>
+	#include <time.h>
+	#include <unistd.h>
+	#include <linux/futex.h>
+	#include <sys/syscall.h>
+
+	/* ################################################################### *
+	 * FUTEX
+	 * ################################################################### */
+
+	// Sleeps while *addr == expected, for at most timeout (NULL to wait forever). Returns 0 when woken,
+	// and -1 with errno EAGAIN if *addr had already changed, ETIMEDOUT on timeout or EINTR on a signal.
+	static inline int futex_wait(volatile uint32_t* addr, uint32_t expected, const struct timespec* timeout)
+	{
+		return syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, timeout, NULL, 0);
+	}
+
+	// Wakes at most count threads sleeping on addr, returns how many were woken
+	static inline int futex_wake(volatile uint32_t* addr, int count)
+	{
+		return syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+	}
+
+	static inline uint64_t monotonic_ns()
+	{
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	}
+#endif	/* _FUTEX_H_ */
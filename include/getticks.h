@@ -47,6 +47,15 @@ static inline ticks
   __asm__ __volatile__ ("rdtsc" : "=a"(lo), "=d"(hi));
   return ( (unsigned long long)lo)|( ((unsigned long long)hi)<<32 );
 }
+
+/* rdtscp also returns the TSC_AUX register, which Linux sets to the cpu in its low 12 bits */
+static inline ticks
+getticks_aux(uint32_t* aux)
+{
+  unsigned hi, lo;
+  __asm__ __volatile__ ("rdtscp" : "=a"(lo), "=d"(hi), "=c"(*aux));
+  return ( (unsigned long long)lo)|( ((unsigned long long)hi)<<32 );
+}
 #elif defined(__sparc__)
 static inline ticks
 getticks()
@@ -10,28 +10,65 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <pthread.h>
 #include <fcntl.h>      // For open(), O_RDONLY, etc.
 #include <sys/mman.h>   // For mmap(), PROT_READ, MAP_SHARED, MAP_FAILED, etc.
 
+// Order the vertices are numbered in, where BFS and RCM put vertices close in the graph close in memory
+typedef enum graph_order {
+  GRAPH_ORDER_NONE,   // As in the .mtx file
+  GRAPH_ORDER_BFS,    // Breadth first from the smallest vertex of every component
+  GRAPH_ORDER_RCM     // Reverse Cuthill-McKee, breadth first in increasing degree
+} graph_order_t;
+
 typedef struct graph {
   // TODO: Fix spelling
   uint64_t n_verticies;
   uint64_t n_edges;
+  uint32_t id_bits;          // 32 if the ids and offsets fit in 32 bits, only the arrays of this width are set
+  graph_order_t order;
   uint64_t *verticies;
   uint64_t *neighbors;
   uint64_t *distances;
+  uint32_t *verticies32;
+  uint32_t *neighbors32;
+  uint32_t *distances32;
+  uint64_t *weights;     // Weight of each edge in neighbors, 1 if the file has no weights
+  uint64_t *original;    // Id in the .mtx file of every reordered vertex, NULL for GRAPH_ORDER_NONE
 } graph_t;
 
+// Header of the binary cache, which is parsed again if it was written with other options or on
+// a machine of another byte order. Followed by the weights, original ids, offsets and neighbors.
+typedef struct graph_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t endianness;
+  uint32_t id_bits;
+  uint32_t directed;
+  uint32_t order;
+  uint32_t padding;
+  uint64_t n_verticies;
+  uint64_t n_edges;
+} graph_header_t;
+
+#define GRAPH_MAGIC "DCBOCSR"
+#define GRAPH_VERSION 2
+#define GRAPH_ENDIANNESS 0x01020304
+
 // Interface
 static uint64_t get_neighbors(graph_t *g, uint64_t index, uint64_t **neighbors);
-static graph_t *parse_mtx_file(char *fp, bool directed);
+static uint64_t get_neighbors32(graph_t *g, uint64_t index, uint32_t **neighbors);
+static uint64_t *get_weights(graph_t *g, uint64_t index);
+static graph_t *parse_mtx_file(char *fp, bool directed, uint32_t id_bits, graph_order_t order);
 
-static char* create_binary_filename(char *filename) {
-    const char *suffix = ".bin";
+// The cache of every variant of a graph gets its own file, e.g. graph.mtx.rcm.b32.d.bin, so that
+// benchmarks using other id widths or orders don't overwrite each other's caches
+static char* create_binary_filename(char *filename, bool directed, uint32_t id_bits, graph_order_t order) {
+    static const char *order_names[] = { "none", "bfs", "rcm" };
+    const char *suffix_format = ".%s.b%u%s.bin";
 
-    // Allocate memory for the new string
     // Length of original filename + length of suffix + 1 for null terminator
-    size_t len = strlen(filename) + strlen(suffix) + 1;
+    size_t len = strlen(filename) + snprintf(NULL, 0, suffix_format, order_names[order], id_bits, directed ? ".d" : "") + 1;
     char *binary_filename = malloc(len);
 
     if (binary_filename == NULL) {
@@ -39,11 +76,8 @@ static char* create_binary_filename(char *filename) {
         exit(EXIT_FAILURE);
     }
 
-    // Copy the original filename into the new string
     strcpy(binary_filename, filename);
-
-    // Append the suffix
-    strcat(binary_filename, suffix);
+    sprintf(binary_filename + strlen(filename), suffix_format, order_names[order], id_bits, directed ? ".d" : "");
 
     return binary_filename;
 }
@@ -54,8 +88,55 @@ static bool file_exists(char *filename) {
     return (stat(filename, &buffer) == 0);
 }
 
-// Load the binary graph from memory
-static graph_t* mmap_graph(char *filename) {
+// The id width used for a graph, where 0 asks for 32 bits whenever the vertex ids and edge offsets fit
+static uint32_t graph_id_bits(uint32_t id_bits, uint64_t n_verticies, uint64_t n_edges) {
+    bool fits = n_verticies < UINT32_MAX && n_edges < UINT32_MAX;
+    if (id_bits == 0) return fits ? 32 : 64;
+    if (id_bits == 32 && !fits) {
+        fprintf(stderr, "The graph has too many vertices or edges for 32-bit ids\n");
+        exit(EXIT_FAILURE);
+    }
+    if (id_bits != 32 && id_bits != 64) {
+        fprintf(stderr, "Vertex ids have to be 32 or 64 bits, not %u\n", id_bits);
+        exit(EXIT_FAILURE);
+    }
+    return id_bits;
+}
+
+static graph_order_t parse_graph_order(const char *name) {
+    if (strcmp(name, "none") == 0) return GRAPH_ORDER_NONE;
+    if (strcmp(name, "bfs") == 0) return GRAPH_ORDER_BFS;
+    if (strcmp(name, "rcm") == 0) return GRAPH_ORDER_RCM;
+    fprintf(stderr, "Unknown vertex order %s, use none, bfs or rcm\n", name);
+    exit(EXIT_FAILURE);
+}
+
+// Allocate the distances in the width of the ids, all unreached
+static void init_distances(graph_t *g) {
+    if (g->id_bits == 32) {
+        g->distances32 = (uint32_t*) malloc(sizeof(uint32_t) * (g->n_verticies + 1));
+        if (!g->distances32) {
+            printf("Error in allocating graph\n");
+            exit(EXIT_FAILURE);
+        }
+        for (uint64_t i=1; i<=g->n_verticies; i++) {
+            g->distances32[i] = UINT32_MAX;
+        }
+    }
+    else {
+        g->distances = (uint64_t*) malloc(sizeof(uint64_t) * (g->n_verticies + 1));
+        if (!g->distances) {
+            printf("Error in allocating graph\n");
+            exit(EXIT_FAILURE);
+        }
+        for (uint64_t i=1; i<=g->n_verticies; i++) {
+            g->distances[i] = UINT64_MAX;
+        }
+    }
+}
+
+// Load the binary graph from memory, returns NULL if it is from an older version or other options
+static graph_t* mmap_graph(char *filename, bool directed, uint32_t id_bits, graph_order_t order) {
     int fd = open(filename, O_RDONLY);
     if (fd == -1) {
         perror("Failed to open file for reading");
@@ -67,185 +148,546 @@ static graph_t* mmap_graph(char *filename) {
         perror("Failed to stat file");
         exit(EXIT_FAILURE);
     }
+    if ((uint64_t) sb.st_size < sizeof(graph_header_t)) {
+        close(fd);
+        return NULL;
+    }
 
     void *file_memory = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
     if (file_memory == MAP_FAILED) {
         perror("Failed to mmap file");
         exit(EXIT_FAILURE);
     }
+    close(fd);
 
-    graph_t *g = malloc(sizeof(graph_t));
-    char *ptr = (char *)file_memory;
-
-    // Pointer arithmetic to read out the different fields
-    g->n_verticies = *(uint64_t *)ptr;
-    ptr += sizeof(uint64_t);
-    g->n_edges = *(uint64_t *)ptr;
-    ptr += sizeof(uint64_t);
-
-    g->verticies = (uint64_t *)ptr;
-    ptr += (g->n_verticies+1) * sizeof(uint64_t);
-
-    g->neighbors = (uint64_t *)ptr;
+    graph_header_t *header = (graph_header_t *)file_memory;
+    uint64_t id_size = header->id_bits / 8;
+    uint64_t size = sizeof(graph_header_t) + header->n_edges * sizeof(uint64_t)
+        + (header->order != GRAPH_ORDER_NONE ? (header->n_verticies + 1) * sizeof(uint64_t) : 0)
+        + (header->n_verticies + 1 + header->n_edges) * id_size;
+    if (memcmp(header->magic, GRAPH_MAGIC, sizeof(header->magic)) != 0 || header->version != GRAPH_VERSION
+        || header->endianness != GRAPH_ENDIANNESS || header->directed != directed || header->order != order
+        || header->id_bits != graph_id_bits(id_bits, header->n_verticies, header->n_edges)
+        || (uint64_t) sb.st_size != size) {
+        munmap(file_memory, sb.st_size);
+        return NULL;
+    }
 
-    g->distances = (uint64_t*) malloc(sizeof(uint64_t) * (g->n_verticies + 1));
-    for (uint64_t i=1; i<=g->n_verticies; i++) {
-        g->distances[i] = UINT64_MAX;
+    graph_t *g = calloc(1, sizeof(graph_t));
+    g->n_verticies = header->n_verticies;
+    g->n_edges = header->n_edges;
+    g->id_bits = header->id_bits;
+    g->order = order;
+    char *ptr = (char *)file_memory + sizeof(graph_header_t);
+
+    // Pointer arithmetic to read out the different fields, the 64-bit ones first to keep them aligned
+    g->weights = (uint64_t *)ptr;
+    ptr += g->n_edges * sizeof(uint64_t);
+    if (order != GRAPH_ORDER_NONE) {
+        g->original = (uint64_t *)ptr;
+        ptr += (g->n_verticies + 1) * sizeof(uint64_t);
+    }
+    if (g->id_bits == 32) {
+        g->verticies32 = (uint32_t *)ptr;
+        g->neighbors32 = (uint32_t *)(ptr + (g->n_verticies + 1) * id_size);
+    }
+    else {
+        g->verticies = (uint64_t *)ptr;
+        g->neighbors = (uint64_t *)(ptr + (g->n_verticies + 1) * id_size);
     }
 
-    close(fd);
+    init_distances(g);
     return g;
 }
 
-// Serialize the parsed graph to memory
-static void serialize_graph(const char *filename, graph_t *g) {
-    FILE *file = fopen(filename, "wb");
+// Serialize the parsed graph to memory, through a temporary file so that runs mapping the old one keep it
+static void serialize_graph(const char *filename, graph_t *g, bool directed) {
+    char tmp_filename[strlen(filename) + 32];
+    snprintf(tmp_filename, sizeof(tmp_filename), "%s.%d.tmp", filename, (int) getpid());
+    FILE *file = fopen(tmp_filename, "wb");
     if (!file) {
         perror("Failed to open file for writing");
         exit(EXIT_FAILURE);
     }
 
-    fwrite(&g->n_verticies, sizeof(uint64_t), 1, file);
-    fwrite(&g->n_edges, sizeof(uint64_t), 1, file);
-    fwrite(g->verticies, sizeof(uint64_t), g->n_verticies + 1, file);
-    fwrite(g->neighbors, sizeof(uint64_t), g->n_edges, file);
-
-    fclose(file);
-}
+    graph_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GRAPH_MAGIC, sizeof(header.magic));
+    header.version = GRAPH_VERSION;
+    header.endianness = GRAPH_ENDIANNESS;
+    header.id_bits = g->id_bits;
+    header.directed = directed;
+    header.order = g->order;
+    header.n_verticies = g->n_verticies;
+    header.n_edges = g->n_edges;
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(g->weights, sizeof(uint64_t), g->n_edges, file);
+    if (g->order != GRAPH_ORDER_NONE) {
+        fwrite(g->original, sizeof(uint64_t), g->n_verticies + 1, file);
+    }
+    if (g->id_bits == 32) {
+        fwrite(g->verticies32, sizeof(uint32_t), g->n_verticies + 1, file);
+        fwrite(g->neighbors32, sizeof(uint32_t), g->n_edges, file);
+    }
+    else {
+        fwrite(g->verticies, sizeof(uint64_t), g->n_verticies + 1, file);
+        fwrite(g->neighbors, sizeof(uint64_t), g->n_edges, file);
+    }
 
-/*Idea based on https://www.usenix.org/system/files/login/articles/login_winter20_16_kelly.pdf*/
-static graph_t* parse_mtx_file(char* fp, bool directed) {
-    // First try to see if it has already been parsed
-    char *bin_fp = create_binary_filename(fp);
-    if (file_exists(bin_fp)) {
-        graph_t* g = mmap_graph(bin_fp);
-        free(bin_fp);
-        return g;
+    if (fclose(file) != 0 || rename(tmp_filename, filename) != 0) {
+        perror("Failed to write binary graph");
+        exit(EXIT_FAILURE);
     }
+}
 
-    // Just parse it as normally
-    FILE *mtx_file = fopen(fp, "r");
+/* ################################################################### *
+ * PARALLEL MTX PARSING
+ * ################################################################### */
 
-    if (mtx_file == NULL){
-        fprintf(stderr, "Could not find mtx file: %s \n", fp);
-    }
-    char *line = NULL;
-    size_t len = 0;
-    uint8_t first = true;
+// Smallest part of the file given to a parsing thread
+#define MTX_MIN_CHUNK (1 << 20)
+// Adjacency lists up to this length are sorted with insertion sort
+#define MTX_INSERTION_SORT 16
 
+typedef struct mtx_chunk {
+    const char *begin;
+    const char *end;
+    uint64_t n_verticies;
+    bool directed;
+    bool scatter;           // Second pass, placing the edges instead of counting them
+    uint64_t n_edges;       // Edges found in the chunk
+    uint64_t first_vertex;  // Vertices whose lists are sorted by the chunk
+    uint64_t last_vertex;
     uint64_t *verticies;
-    uint64_t *offsets;
     uint64_t *neighbors;
-    uint64_t n_verticies;
-    uint64_t n_edges;
-
-    while (getline(&line, &len, mtx_file) != -1) {
-        if (line[0] == '%') continue;
-        if (first) {
-            sscanf(line, "%lu %lu %lu", &n_verticies, &n_verticies, &n_edges);
-            first = false;
-            assert(n_verticies > 0);
-            if (!directed) n_edges *= 2;
-            verticies = (uint64_t*) calloc(n_verticies + 1, sizeof(uint64_t));
-            neighbors = (uint64_t*) malloc(sizeof(uint64_t) * n_edges);
-
-            if (!verticies || !neighbors) {
-                printf("Error in allocating graph\n");
-                exit(EXIT_FAILURE);
-            }
+    uint64_t *weights;
+    pthread_t thread;
+} mtx_chunk_t;
+
+static inline const char *mtx_skip_blanks(const char *pos, const char *end) {
+    while (pos < end && (*pos == ' ' || *pos == '\t')) pos++;
+    return pos;
+}
+
+static inline const char *mtx_next_line(const char *pos, const char *end) {
+    const char *newline = memchr(pos, '\n', end - pos);
+    return newline == NULL ? end : newline + 1;
+}
+
+static inline uint64_t mtx_read_uint(const char **pos, const char *end) {
+    const char *p = mtx_skip_blanks(*pos, end);
+    uint64_t val = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        val = val * 10 + (*p - '0');
+        p++;
+    }
+    *pos = p;
+    return val;
+}
+
+// Reads the optional weight column, 1 if it is missing (pattern matrices) and rounded if it is real
+static inline uint64_t mtx_read_weight(const char **pos, const char *end, uint64_t vertex, uint64_t neighbor) {
+    const char *p = mtx_skip_blanks(*pos, end);
+    const char *token = p;
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+    *pos = p;
+    if (p == token) return 1;
+
+    char buffer[64];
+    size_t len = p - token < (long) sizeof(buffer) - 1 ? p - token : sizeof(buffer) - 1;
+    memcpy(buffer, token, len);
+    buffer[len] = '\0';
+    double weight = strtod(buffer, NULL);
+    if (weight < 0) {
+        fprintf(stderr, "Negative edge weight %f from %lu to %lu\n", weight, vertex, neighbor);
+        exit(EXIT_FAILURE);
+    }
+    return (uint64_t) (weight + 0.5);
+}
+
+// Counts the degrees of the vertices in a chunk in the first pass, and places its edges in the second.
+// Each vertex's edges are placed from the end of its list, so verticies ends up with the list starts.
+static void *mtx_parse_chunk(void *arg) {
+    mtx_chunk_t *chunk = (mtx_chunk_t *) arg;
+    const char *pos = chunk->begin;
+    const char *end = chunk->end;
+    uint64_t n_edges = 0;
+
+    while (pos < end) {
+        const char *line = mtx_skip_blanks(pos, end);
+        const char *next = mtx_next_line(line, end);
+        if (line == next || *line == '%' || *line == '\n' || *line == '\r') {
+            pos = next;
+            continue;
         }
-        else {
-            uint64_t vertex;
-            uint64_t neighbor;
-            //unused
-            uint64_t weight;
 
-            sscanf(line, "%lu %lu", &vertex, &neighbor);
-            //Starts with 1
-            verticies[vertex]++;
+        uint64_t vertex = mtx_read_uint(&line, next);
+        uint64_t neighbor = mtx_read_uint(&line, next);
+        if (vertex == 0 || neighbor == 0 || vertex > chunk->n_verticies || neighbor > chunk->n_verticies) {
+            fprintf(stderr, "Edge from %lu to %lu is outside the %lu vertices\n", vertex, neighbor, chunk->n_verticies);
+            exit(EXIT_FAILURE);
+        }
 
-            if (!directed) {
-                verticies[neighbor]++;
+        if (!chunk->scatter) {
+            __sync_fetch_and_add(&chunk->verticies[vertex], 1);
+            if (!chunk->directed) __sync_fetch_and_add(&chunk->verticies[neighbor], 1);
+        }
+        else {
+            uint64_t weight = mtx_read_weight(&line, next, vertex, neighbor);
+            uint64_t slot = __sync_sub_and_fetch(&chunk->verticies[vertex], 1);
+            chunk->neighbors[slot] = neighbor;
+            chunk->weights[slot] = weight;
+            if (!chunk->directed) {
+                slot = __sync_sub_and_fetch(&chunk->verticies[neighbor], 1);
+                chunk->neighbors[slot] = vertex;
+                chunk->weights[slot] = weight;
             }
         }
+        n_edges += chunk->directed ? 1 : 2;
+        pos = next;
     }
-    //Set the indexes
-    uint64_t sum = 0;
 
-    for (uint64_t i = 1; i <= n_verticies; i++){
-        uint64_t count = verticies[i];
-        if (count > 0) {
-            verticies[i] += sum;
-            sum += count;
-        }
-        else {verticies[i] = sum;}
-        if (i > 1) {
-        assert(verticies[i - 1] <= verticies[i]);
+    chunk->n_edges = n_edges;
+    return NULL;
+}
 
+static inline void mtx_swap_edges(uint64_t *neighbors, uint64_t *weights, uint64_t a, uint64_t b) {
+    uint64_t n = neighbors[a], w = weights[a];
+    neighbors[a] = neighbors[b];
+    weights[a] = weights[b];
+    neighbors[b] = n;
+    weights[b] = w;
+}
+
+static inline bool mtx_edge_less(uint64_t *neighbors, uint64_t *weights, uint64_t a, uint64_t b) {
+    return neighbors[a] < neighbors[b] || (neighbors[a] == neighbors[b] && weights[a] < weights[b]);
+}
+
+static void mtx_sift_down(uint64_t *neighbors, uint64_t *weights, uint64_t pos, uint64_t size) {
+    while (2 * pos + 1 < size) {
+        uint64_t child = 2 * pos + 1;
+        if (child + 1 < size && mtx_edge_less(neighbors, weights, child, child + 1)) child++;
+        if (!mtx_edge_less(neighbors, weights, pos, child)) break;
+        mtx_swap_edges(neighbors, weights, pos, child);
+        pos = child;
+    }
+}
+
+// Sorts one adjacency list by neighbor and weight, with a heap sort for the long lists
+static void mtx_sort_edges(uint64_t *neighbors, uint64_t *weights, uint64_t size) {
+    if (size <= MTX_INSERTION_SORT) {
+        for (uint64_t i = 1; i < size; i++) {
+            for (uint64_t j = i; j > 0 && mtx_edge_less(neighbors, weights, j, j - 1); j--) {
+                mtx_swap_edges(neighbors, weights, j, j - 1);
+            }
         }
+        return;
     }
-    rewind(mtx_file);
-    first = true;
-    while (getline(&line, &len, mtx_file) != -1) {
-        if (line[0] == '%') continue;
-        if (first) {
-            first = false;
-            continue;
+
+    for (uint64_t i = size / 2; i-- > 0;) {
+        mtx_sift_down(neighbors, weights, i, size);
+    }
+    for (uint64_t last = size - 1; last > 0; last--) {
+        mtx_swap_edges(neighbors, weights, 0, last);
+        mtx_sift_down(neighbors, weights, 0, last);
+    }
+}
+
+// The threads place edges in a racy order, so the lists are sorted to get the same graph on every parse
+static void *mtx_sort_chunk(void *arg) {
+    mtx_chunk_t *chunk = (mtx_chunk_t *) arg;
+    for (uint64_t v = chunk->first_vertex; v < chunk->last_vertex; v++) {
+        uint64_t loc = chunk->verticies[v];
+        uint64_t size = (v == chunk->n_verticies ? chunk->n_edges : chunk->verticies[v + 1]) - loc;
+        mtx_sort_edges(&chunk->neighbors[loc], &chunk->weights[loc], size);
+    }
+    return NULL;
+}
+
+static void mtx_run_chunks(mtx_chunk_t *chunks, int n_chunks, void *(*run)(void *)) {
+    for (int t = 0; t < n_chunks; t++) {
+        if (pthread_create(&chunks[t].thread, NULL, run, &chunks[t]) != 0) {
+            perror("Failed to create graph parsing thread");
+            exit(EXIT_FAILURE);
         }
-        else {
-            uint64_t vertex;
-            uint64_t neighbor;
-            //unused
-            uint64_t weight;
-            sscanf(line, "%lu %lu", &vertex, &neighbor);
+    }
+    for (int t = 0; t < n_chunks; t++) {
+        pthread_join(chunks[t].thread, NULL);
+    }
+}
 
-            assert(neighbor <= n_verticies);
-            assert(vertex <= n_verticies);
+static inline uint64_t mtx_degree(uint64_t *verticies, uint64_t n_verticies, uint64_t n_edges, uint64_t v) {
+    return (v == n_verticies ? n_edges : verticies[v + 1]) - verticies[v];
+}
 
-            verticies[vertex]--;
-            neighbors[verticies[vertex]] = neighbor;
+// Renumber the vertices in the order a BFS reaches them, with every component started from its
+// smallest vertex. RCM starts from a vertex of smallest degree, adds the neighbors in increasing
+// degree, and reverses the order at the end.
+static void reorder_graph(graph_t *g, graph_order_t order) {
+    uint64_t n = g->n_verticies, m = g->n_edges;
+    uint64_t *original = (uint64_t*) malloc(sizeof(uint64_t) * (n + 1));
+    uint64_t *renumbered = (uint64_t*) calloc(n + 1, sizeof(uint64_t));
+    uint64_t *starts = (uint64_t*) malloc(sizeof(uint64_t) * n);
+    uint64_t *degrees = (uint64_t*) malloc(sizeof(uint64_t) * n);
+    uint64_t *verticies = (uint64_t*) malloc(sizeof(uint64_t) * (n + 1));
+    uint64_t *neighbors = (uint64_t*) malloc(sizeof(uint64_t) * m);
+    uint64_t *weights = (uint64_t*) malloc(sizeof(uint64_t) * m);
+    if (!original || !renumbered || !starts || !degrees || !verticies || !neighbors || !weights) {
+        printf("Error in allocating graph\n");
+        exit(EXIT_FAILURE);
+    }
 
-            if (!directed) {
-                verticies[neighbor]--;
-                neighbors[verticies[neighbor]] = vertex;
+    for (uint64_t i = 0; i < n; i++) {
+        starts[i] = i + 1;
+        degrees[i] = mtx_degree(g->verticies, n, m, i + 1);
+    }
+    if (order == GRAPH_ORDER_RCM) mtx_sort_edges(degrees, starts, n);
+
+    // The queue of the BFS is the new order itself, original[head..tail)
+    uint64_t head = 1, tail = 1;
+    for (uint64_t s = 0; s < n; s++) {
+        if (renumbered[starts[s]]) continue;
+        renumbered[starts[s]] = tail;
+        original[tail++] = starts[s];
+        while (head < tail) {
+            uint64_t v = original[head++];
+            uint64_t loc = g->verticies[v];
+            uint64_t size = mtx_degree(g->verticies, n, m, v);
+            uint64_t first = tail;
+            for (uint64_t i = loc; i < loc + size; i++) {
+                if (renumbered[g->neighbors[i]]) continue;
+                renumbered[g->neighbors[i]] = tail;
+                original[tail++] = g->neighbors[i];
             }
-
+            if (order == GRAPH_ORDER_RCM && tail - first > 1) {
+                for (uint64_t i = first; i < tail; i++) {
+                    degrees[i - first] = mtx_degree(g->verticies, n, m, original[i]);
+                }
+                mtx_sort_edges(degrees, &original[first], tail - first);
+                for (uint64_t i = first; i < tail; i++) renumbered[original[i]] = i;
+            }
+        }
+    }
+    if (order == GRAPH_ORDER_RCM) {
+        for (uint64_t i = 1, j = n; i < j; i++, j--) {
+            uint64_t v = original[i];
+            original[i] = original[j];
+            original[j] = v;
         }
+        for (uint64_t i = 1; i <= n; i++) renumbered[original[i]] = i;
     }
-    fclose(mtx_file);
 
-    for (uint64_t i = 2; i <= n_verticies; i++){
-        assert(verticies[i - 1] <= verticies[i]);
+    // Copy the lists in the new order, sorted again as the neighbors got new ids
+    uint64_t loc = 0;
+    verticies[0] = 0;
+    for (uint64_t v = 1; v <= n; v++) {
+        uint64_t old_loc = g->verticies[original[v]];
+        uint64_t size = mtx_degree(g->verticies, n, m, original[v]);
+        verticies[v] = loc;
+        for (uint64_t i = 0; i < size; i++) {
+            neighbors[loc + i] = renumbered[g->neighbors[old_loc + i]];
+            weights[loc + i] = g->weights[old_loc + i];
         }
+        mtx_sort_edges(&neighbors[loc], &weights[loc], size);
+        loc += size;
+    }
+
+    original[0] = 0;
+    free(g->verticies);
+    free(g->neighbors);
+    free(g->weights);
+    free(renumbered);
+    free(starts);
+    free(degrees);
+    g->verticies = verticies;
+    g->neighbors = neighbors;
+    g->weights = weights;
+    g->original = original;
+    g->order = order;
+}
+
+// Move the offsets and neighbors to 32-bit arrays, halving the memory the traversals read
+static void narrow_graph(graph_t *g) {
+    g->verticies32 = (uint32_t*) malloc(sizeof(uint32_t) * (g->n_verticies + 1));
+    g->neighbors32 = (uint32_t*) malloc(sizeof(uint32_t) * g->n_edges);
+    if (!g->verticies32 || !g->neighbors32) {
+        printf("Error in allocating graph\n");
+        exit(EXIT_FAILURE);
+    }
+    for (uint64_t i = 0; i <= g->n_verticies; i++) g->verticies32[i] = g->verticies[i];
+    for (uint64_t i = 0; i < g->n_edges; i++) g->neighbors32[i] = g->neighbors[i];
+    free(g->verticies);
+    free(g->neighbors);
+    g->verticies = NULL;
+    g->neighbors = NULL;
+    g->id_bits = 32;
+}
+
+/*Idea based on https://www.usenix.org/system/files/login/articles/login_winter20_16_kelly.pdf*/
+// The file is mapped and split at line boundaries over one thread per cpu. The threads count the
+// degrees in a first pass and place the edges in a second, after the degrees are summed to offsets.
+// The graph is then reordered and moved to 32-bit ids if asked for, where an id_bits of 0 uses 32
+// bits whenever the graph fits.
+static graph_t* parse_mtx_file(char* fp, bool directed, uint32_t id_bits, graph_order_t order) {
+    // First try to see if it has already been parsed, in either width if it is chosen by the size
+    for (uint32_t bits = 32; bits <= 64; bits += 32) {
+        if (id_bits != 0 && id_bits != bits) continue;
+        char *bin_fp = create_binary_filename(fp, directed, bits, order);
+        graph_t* g = file_exists(bin_fp) ? mmap_graph(bin_fp, directed, id_bits, order) : NULL;
+        free(bin_fp);
+        if (g != NULL) return g;
+    }
+
+    int fd = open(fp, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, "Could not find mtx file: %s \n", fp);
+        exit(EXIT_FAILURE);
+    }
+    struct stat sb;
+    if (fstat(fd, &sb) == -1) {
+        perror("Failed to stat file");
+        exit(EXIT_FAILURE);
+    }
+    const char *file = (const char *) mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (file == MAP_FAILED) {
+        perror("Failed to mmap file");
+        exit(EXIT_FAILURE);
+    }
+    madvise((void *) file, sb.st_size, MADV_SEQUENTIAL);
+    const char *end = file + sb.st_size;
+
+    // Skip the comments, and read the size line
+    const char *pos = file;
+    while (pos < end && *mtx_skip_blanks(pos, end) == '%') pos = mtx_next_line(pos, end);
+    const char *size_line = pos;
+    mtx_read_uint(&size_line, end);
+    uint64_t n_verticies = mtx_read_uint(&size_line, end);
+    assert(n_verticies > 0);
+    pos = mtx_next_line(pos, end);
+
+    long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int n_chunks = (end - pos) / MTX_MIN_CHUNK + 1;
+    if (n_cpus > 0 && n_chunks > n_cpus) n_chunks = n_cpus;
+    mtx_chunk_t *chunks = (mtx_chunk_t*) calloc(n_chunks, sizeof(mtx_chunk_t));
+    uint64_t *verticies = (uint64_t*) calloc(n_verticies + 1, sizeof(uint64_t));
+    if (!chunks || !verticies) {
+        printf("Error in allocating graph\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int t = 0; t < n_chunks; t++) {
+        const char *split = pos + (end - pos) * t / n_chunks;
+        chunks[t].begin = t == 0 ? pos : mtx_next_line(split - 1, end);
+        chunks[t].n_verticies = n_verticies;
+        chunks[t].directed = directed;
+        chunks[t].verticies = verticies;
+        if (t > 0) chunks[t - 1].end = chunks[t].begin;
+    }
+    chunks[n_chunks - 1].end = end;
+    mtx_run_chunks(chunks, n_chunks, mtx_parse_chunk);
 
-    graph_t* g = (graph_t*) malloc(sizeof(graph_t));
-    uint64_t *distances = (uint64_t*) malloc(sizeof(uint64_t) * (n_verticies + 1));
+    //Set the indexes, to the end of every list as the edges are placed backwards
+    uint64_t n_edges = 0;
+    for (int t = 0; t < n_chunks; t++) n_edges += chunks[t].n_edges;
+    uint64_t sum = 0;
+    for (uint64_t i = 1; i <= n_verticies; i++){
+        sum += verticies[i];
+        verticies[i] = sum;
+    }
+
+    uint64_t *neighbors = (uint64_t*) malloc(sizeof(uint64_t) * n_edges);
+    uint64_t *weights = (uint64_t*) malloc(sizeof(uint64_t) * n_edges);
+    if (!neighbors || !weights) {
+        printf("Error in allocating graph\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int t = 0; t < n_chunks; t++) {
+        chunks[t].scatter = true;
+        chunks[t].neighbors = neighbors;
+        chunks[t].weights = weights;
+    }
+    mtx_run_chunks(chunks, n_chunks, mtx_parse_chunk);
+    munmap((void *) file, sb.st_size);
+    close(fd);
 
-    //fill distances
-    for (uint64_t i=1; i<=n_verticies; i++) {
-        distances[i] = UINT64_MAX;
+    // Sort the lists of an even share of the vertices in each thread
+    for (int t = 0; t < n_chunks; t++) {
+        chunks[t].first_vertex = 1 + n_verticies * t / n_chunks;
+        chunks[t].last_vertex = 1 + n_verticies * (t + 1) / n_chunks;
+        chunks[t].n_edges = n_edges;
     }
+    mtx_run_chunks(chunks, n_chunks, mtx_sort_chunk);
+    free(chunks);
+
+    for (uint64_t i = 2; i <= n_verticies; i++){
+        assert(verticies[i - 1] <= verticies[i]);
+        }
 
+    graph_t* g = (graph_t*) calloc(1, sizeof(graph_t));
     g->n_verticies = n_verticies;
     g->n_edges = n_edges;
+    g->id_bits = 64;
+    g->order = GRAPH_ORDER_NONE;
     g->verticies = verticies;
     g->neighbors = neighbors;
-    g->distances = distances;
+    g->weights = weights;
+
+    if (order != GRAPH_ORDER_NONE) reorder_graph(g, order);
+    if (graph_id_bits(id_bits, n_verticies, n_edges) == 32) narrow_graph(g);
+    init_distances(g);
 
-    serialize_graph(bin_fp, g);
+    char *bin_fp = create_binary_filename(fp, directed, g->id_bits, order);
+    serialize_graph(bin_fp, g, directed);
     free(bin_fp);
 
     return g;
 }
 
 //Maybe optimize by sending n_verticies as an argument
-static uint64_t get_neighbors(graph_t *g, uint64_t index, uint64_t **neighbors) {
-    uint64_t loc = g->verticies[index];
-    *neighbors = &g->neighbors[loc];
-    if (index == g->n_verticies){
-        return g->n_edges - loc;
+// Defines get_neighbors and get_neighbors32 over the arrays of each id width
+#define GRAPH_GET_NEIGHBORS(SUFFIX, ID_T)                                                   \
+static uint64_t get_neighbors##SUFFIX(graph_t *g, uint64_t index, ID_T **neighbors) {   \
+    uint64_t loc = g->verticies##SUFFIX[index];                                           \
+    *neighbors = &g->neighbors##SUFFIX[loc];                                              \
+    if (index == g->n_verticies){                                                         \
+        return g->n_edges - loc;                                                          \
+    }                                                                                     \
+    else return g->verticies##SUFFIX[index + 1] - loc;                                    \
+}
+
+GRAPH_GET_NEIGHBORS(, uint64_t)
+GRAPH_GET_NEIGHBORS(32, uint32_t)
+
+// The weights of the edges returned by get_neighbors, in the same order
+static uint64_t *get_weights(graph_t *g, uint64_t index) {
+    return &g->weights[g->id_bits == 32 ? g->verticies32[index] : g->verticies[index]];
+}
+
+// The distance of a vertex in either width, UINT64_MAX if it was not reached
+static inline uint64_t get_distance(graph_t *g, uint64_t index) {
+    if (g->id_bits == 32) {
+        return g->distances32[index] == UINT32_MAX ? UINT64_MAX : g->distances32[index];
+    }
+    return g->distances[index];
+}
+
+static inline void set_distance(graph_t *g, uint64_t index, uint64_t distance) {
+    if (g->id_bits == 32) g->distances32[index] = distance;
+    else g->distances[index] = distance;
+}
+
+// The id of a vertex of the .mtx file in the reordered graph
+static uint64_t graph_vertex(graph_t *g, uint64_t vertex) {
+    if (vertex == 0 || vertex > g->n_verticies) {
+        fprintf(stderr, "Vertex %lu is outside the %lu vertices\n", vertex, g->n_verticies);
+        exit(EXIT_FAILURE);
+    }
+    if (g->original == NULL) return vertex;
+    for (uint64_t v = 1; v <= g->n_verticies; v++) {
+        if (g->original[v] == vertex) return v;
     }
-    else return g->verticies[index + 1] - loc;
+    return vertex;
 }
 
 #endif
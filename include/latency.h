@@ -305,6 +305,82 @@
         free(__lats[l]);							\
         }
 
+        #elif PFD_TYPE == 3
+        #  undef PFD_TYPE
+        #  define PFD_TYPE  0
+        #  include "latency_histogram.h"
+
+        #  define LATENCY_TYPE_NUM 6
+        #  define LATENCY_MAX_THREADS 1024
+        static __thread __attribute__ ((unused)) lat_hist_t* __lat_hist;
+        static __attribute__ ((unused)) lat_hist_t* __lat_hist_all[LATENCY_MAX_THREADS];
+        // A queue dequeue only fails when it finds the queue empty
+        static __attribute__ ((unused)) const char* __lat_titles[LATENCY_TYPE_NUM] =
+        {
+            "srch-succ",
+            "insr-succ",
+            "remv-succ",
+            "srch-fail",
+            "insr-fail",
+            "remv-empty",
+        };
+
+        #  define PARSE_START_TS(s)
+        #  define PARSE_END_TS(s, i)
+        #  define PARSE_END_INC(i)
+        #  define START_TS(s)				\
+        COMPILER_BARRIER();				\
+        start_acq = getticks();			\
+        COMPILER_BARRIER();				\
+        LFENCE;
+        #  define END_TS(s, i)							\
+        COMPILER_BARRIER();							\
+        LFENCE;								\
+        end_acq = getticks();							\
+        lat_hist_record(&__lat_hist[s], (int64_t) (end_acq - start_acq - correction)); \
+        asm volatile ("");
+        #  define END_TS_ELSE(s, i, inc)		\
+        else						\
+        {						\
+        END_TS(s, i);				\
+        ADD_DUR(inc);				\
+        }
+        #  define ADD_DUR(tar) tar += (end_acq - start_acq - correction)
+        #  define ADD_DUR_FAIL(tar)					\
+        else								\
+        {								\
+        ADD_DUR(tar);						\
+        }
+        #  define PF_INIT(s, e, id)					\
+        if ((id) < 0 || (id) >= LATENCY_MAX_THREADS)			\
+        {								\
+        fprintf(stderr, "Thread %d has no latency histograms, at most %d threads are measured\n", (int) (id), LATENCY_MAX_THREADS); \
+        exit(1);							\
+        }								\
+        __lat_hist = lat_hist_new(LATENCY_TYPE_NUM);			\
+        __lat_hist_all[id] = __lat_hist;
+
+        // Merges the histograms of all threads and prints the percentiles of every operation type
+        #  define LATENCY_DISTRIBUTION_PRINT()					\
+        {									\
+        printf("#op        count        p50      p90      p99      p99.9    max      ## latency (in cycles) \n"); \
+        int l;								\
+        for (l = 0; l < LATENCY_TYPE_NUM; l++)				\
+        {									\
+        lat_hist_t* __merged = lat_hist_new(1);				\
+        int h;								\
+        for (h = 0; h < num_threads; h++)					\
+        {								\
+        if (__lat_hist_all[h] != NULL)				\
+	    {								\
+        lat_hist_merge(__merged, &__lat_hist_all[h][l]);		\
+	    }								\
+        }								\
+        lat_hist_print(__merged, __lat_titles[l], 1);			\
+        free(__merged);							\
+        }									\
+        }
+
     #endif
 
     static inline void
@@ -26,6 +26,8 @@
 
 	#define _MAIN_TEST_LOOP_H_
 
+	#include "perf_counters.h"
+
 	#if OPS_PER_THREAD == 1
 		#define PRINT_OPS_PER_THREAD() \
 			printf("%-3lu  %-8zu %-8zu %-8zu\n",t, getting_count[t], putting_count[t], removing_count[t]);
@@ -95,6 +97,7 @@
 		__thread volatile ticks phase_start, phase_stop;					\
 		ZIPF_RAND_DECLARATIONS();											\
 		__thread char* precomputed_bytes;									\
+		OPEN_LOOP_VARS_GLOBAL												\
 		__thread uint32_t nbr_precomputed_bytes, byte_at, bit_at;
 	#ifndef WORKLOAD
 		#define WORKLOAD 0		/*normal workload*/
@@ -334,6 +337,43 @@
 			if(side_work>0)																		\
 				cpause(my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (side_work));			\
 
+		/* Same as TEST_LOOP_ONLY_UPDATES, but every operation moves batch_size items */
+		/* through DS_ADD_BATCH / DS_REMOVE_BATCH, so the counts are in items. */
+		#define TEST_LOOP_BATCH_UPDATES()														\
+			c = (uint32_t)(my_random(&(seeds[0]),&(seeds[1]),&(seeds[2])));						\
+			if (unlikely(c < scale_put))														\
+			{																					\
+				for (size_t b = 0; b < batch_size; b++)											\
+					batch_keys[b] = (num_elems_thread + my_putting_count + b) << 8 | thread_id;	\
+				int res;																		\
+				START_TS(1);																	\
+				res = DS_ADD_BATCH(handle, batch_keys, batch_keys, batch_size);					\
+				if(res)																			\
+				{																				\
+					END_TS(1, my_putting_count_succ);											\
+					ADD_DUR(my_putting_succ);													\
+					my_putting_count_succ += batch_size;										\
+				}																				\
+			  END_TS_ELSE(4, my_putting_count - my_putting_count_succ, my_putting_fail);		\
+			  my_putting_count += batch_size;													\
+			}																					\
+			else if(unlikely(c <= scale_rem))													\
+			{																					\
+				uint32_t removed;																\
+				START_TS(2);																	\
+				removed = DS_REMOVE_BATCH(handle, batch_vals, batch_size);						\
+				if(removed != 0)																\
+				{																				\
+					END_TS(2, my_removing_count_succ);											\
+					ADD_DUR(my_removing_succ);													\
+					my_removing_count_succ += removed;											\
+				}																				\
+				END_TS_ELSE(5, my_removing_count - my_removing_count_succ, my_removing_fail);	\
+				my_removing_count += batch_size;												\
+			} 																					\
+			if(side_work>0)																		\
+				cpause(my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (side_work));			\
+
 		#define COUNTER_LOOP_ONLY_UPDATES()														\
 			c = (uint32_t)(my_random(&(seeds[0]),&(seeds[1]),&(seeds[2])));						\
 			if (unlikely(c < scale_put))														\
@@ -486,8 +526,86 @@
 				END_TS_ELSE(3, my_getting_count - my_getting_count_succ,my_getting_fail); 	\
 				my_getting_count++;															\
 			}
+
+	#elif WORKLOAD == 5	/* open-loop workload */
+		#include "open_loop.h"
+
+		/* Checks the rate and calibrates the ticks before the threads start */
+		#define OPEN_LOOP_INIT()																\
+			if (open_loop_rate <= 0)															\
+			{																					\
+				fprintf(stderr, "The open-loop workload needs a rate (-R)\n");					\
+				exit(1);																		\
+			}																					\
+			if (num_threads > OPEN_LOOP_MAX_THREADS)											\
+			{																					\
+				fprintf(stderr, "The open-loop workload measures at most %d threads\n", OPEN_LOOP_MAX_THREADS);	\
+				exit(1);																		\
+			}																					\
+			open_loop_ticks_per_ns = lat_hist_ticks_per_ns();
+
+		#define OPEN_LOOP_PRINT()	open_loop_print(num_threads);
+
+		/* Same operations as TEST_LOOP_ONLY_UPDATES, started at the intended times of open_loop_next */
+		#define TEST_LOOP_ONLY_UPDATES()														\
+			ticks intended = open_loop_next(ID);												\
+			while (getticks() < intended && !stop)												\
+				PAUSE;																			\
+			c = (uint32_t)(my_random(&(seeds[0]),&(seeds[1]),&(seeds[2])));						\
+			if (unlikely(c < scale_put) && !stop)												\
+			{																					\
+				key = (num_elems_thread + my_putting_count) << 8 | thread_id;					\
+				int res;																		\
+				START_TS(1);																	\
+				res = DS_ADD(handle, key, key);													\
+				open_loop_record(res ? 1 : 4, intended);										\
+				if(res)																			\
+				{																				\
+					END_TS(1, my_putting_count_succ);											\
+					ADD_DUR(my_putting_succ);													\
+					my_putting_count_succ++;													\
+				}																				\
+			  END_TS_ELSE(4, my_putting_count - my_putting_count_succ, my_putting_fail);		\
+			  my_putting_count++;																\
+			}																					\
+			else if(unlikely(c <= scale_rem) && !stop)											\
+			{																					\
+				int removed;																	\
+				START_TS(2);																	\
+				removed = DS_REMOVE(handle);														\
+				open_loop_record(removed != 0 ? 2 : 5, intended);								\
+				if(removed != 0)																\
+				{																				\
+					END_TS(2, my_removing_count_succ);											\
+					ADD_DUR(my_removing_succ);													\
+					my_removing_count_succ++;													\
+				}																				\
+				END_TS_ELSE(5, my_removing_count - my_removing_count_succ, my_removing_fail);	\
+				my_removing_count++;															\
+			}
 	#endif	/* WORKLOAD */
 
+	#if !defined(OPEN_LOOP_INIT)
+		#define OPEN_LOOP_VARS_GLOBAL
+		#define OPEN_LOOP_INIT()																\
+			if (open_loop_rate > 0)																\
+			{																					\
+				fprintf(stderr, "The rate (-R) is only used by the open-loop workload, WORKLOAD=5\n");	\
+				exit(1);																		\
+			}
+		#define OPEN_LOOP_PRINT()
+	#endif
+
+	#if !defined(TEST_LOOP_BATCH_UPDATES)
+		/* Batches are only implemented for the uniform workload */
+		#define TEST_LOOP_BATCH_UPDATES()														\
+			do																					\
+			{																					\
+				fprintf(stderr, "Batches are only implemented for WORKLOAD=0\n");				\
+				exit(1);																		\
+			} while (0)
+	#endif
+
 	#define POW_CORRECTED 0
 	// double pow_tot_correction = (throughput * eng_per_test_iter_nj[num_threads-1][0]) / 1e9;
 	//  printf("#Duration: %f, %f, %f\n", s.duration[0], s.duration[1], s.duration[2]);
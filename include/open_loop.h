@@ -0,0 +1,115 @@
+/*
+ * Open-loop workload (WORKLOAD=5). Every thread starts its operations at a configured rate, either
+ * evenly spaced or as a Poisson process, instead of right after the previous one completed. The
+ * latency of an operation is measured from its intended start, so the time an operation spent
+ * waiting behind a slow one is counted (no coordinated omission), and a rate above what the data
+ * structure sustains shows up as ever growing latencies.
+ */
+
+#ifndef _OPEN_LOOP_H_
+#define _OPEN_LOOP_H_
+
+#include <math.h>
+#include "random.h"
+#include "latency_histogram.h"
+
+// Checked against the thread count by OPEN_LOOP_INIT, as the histograms are indexed by thread id
+#define OPEN_LOOP_MAX_THREADS 1024
+#define OPEN_LOOP_TYPES       6
+
+typedef struct open_loop
+{
+  double interval;  // Mean ticks between the intended starts of two operations
+  double next;      // Intended start of the next operation, kept fractional for high rates
+  uint64_t seed;
+  lat_hist_t* hist; // One histogram per operation type, as the types of latency.h
+} open_loop_t;
+
+// Set by the options of the test
+extern double open_loop_rate;      // Operations per second of each thread
+extern int open_loop_poisson;
+
+extern double open_loop_ticks_per_ns;
+extern lat_hist_t* open_loop_hist[OPEN_LOOP_MAX_THREADS];
+extern __thread open_loop_t open_loop;
+
+#define OPEN_LOOP_VARS_GLOBAL                                 \
+  double open_loop_ticks_per_ns;                              \
+  lat_hist_t* open_loop_hist[OPEN_LOOP_MAX_THREADS];          \
+  __thread open_loop_t open_loop;
+
+static __attribute__ ((unused)) const char* open_loop_titles[OPEN_LOOP_TYPES] =
+{
+  "srch-succ",
+  "insr-succ",
+  "remv-succ",
+  "srch-fail",
+  "insr-fail",
+  "remv-empty",
+};
+
+// Returns the intended start of the thread's next operation and schedules the one after it. The
+// schedule only depends on the rate, so a thread that fell behind issues its operations back to
+// back until it has caught up.
+static inline ticks
+open_loop_next(int id)
+{
+  open_loop_t* ol = &open_loop;
+  if (unlikely(ol->hist == NULL))
+    {
+      ol->hist = lat_hist_new(OPEN_LOOP_TYPES);
+      open_loop_hist[id] = ol->hist;
+      ol->seed = wyrand_seed(id);
+      ol->interval = open_loop_ticks_per_ns * 1e9 / open_loop_rate;
+      ol->next = getticks();
+    }
+
+  ticks intended = (ticks) ol->next;
+  if (open_loop_poisson)
+    {
+      // Exponential inter-arrival times from 53 uniform bits in [0, 1)
+      double u = (wyrand(&ol->seed) >> 11) * 0x1p-53;
+      ol->next += -log(1 - u) * ol->interval;
+    }
+  else
+    {
+      ol->next += ol->interval;
+    }
+  return intended;
+}
+
+static inline void
+open_loop_record(int type, ticks intended)
+{
+  lat_hist_record(&open_loop.hist[type], (int64_t) (getticks() - intended));
+}
+
+static inline void
+open_loop_print(size_t num_threads)
+{
+  printf("Offered_rate , %.0f\n", open_loop_rate * num_threads);
+  printf("Arrivals , %s\n", open_loop_poisson ? "poisson" : "constant");
+  printf("#op        count        p50      p90      p99      p99.9    max      ## open-loop latency (in ns) \n");
+
+  lat_hist_t* all = lat_hist_new(1);
+  int l;
+  for (l = 0; l < OPEN_LOOP_TYPES; l++)
+    {
+      lat_hist_t* merged = lat_hist_new(1);
+      size_t h;
+      for (h = 0; h < num_threads; h++)
+        {
+          if (open_loop_hist[h] != NULL)
+            {
+              lat_hist_merge(merged, &open_loop_hist[h][l]);
+            }
+        }
+      lat_hist_print(merged, open_loop_titles[l], open_loop_ticks_per_ns);
+      lat_hist_merge(all, merged);
+      free(merged);
+    }
+  lat_hist_print(all, "all", open_loop_ticks_per_ns);
+  free(all);
+}
+
+#endif /* _OPEN_LOOP_H_ */
@@ -0,0 +1,185 @@
+/*
+ * Per-thread hardware counters (PERF=1), read with perf_event_open between the start and the end
+ * of the measured part of a test. Every counter is opened on its own, so a counter the CPU, the
+ * kernel or perf_event_paranoid does not allow is printed as n/a while the others are still read.
+ */
+
+#ifndef _PERF_COUNTERS_H_
+#define _PERF_COUNTERS_H_
+
+#if defined(PERF_COUNTERS)
+#  include <errno.h>
+#  include <stdint.h>
+#  include <stdio.h>
+#  include <stdlib.h>
+#  include <string.h>
+#  include <unistd.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <linux/perf_event.h>
+
+#  define PERF_MAX_THREADS 1024
+#  define PERF_NUM_EVENTS  5
+
+// Loads that hit a modified line in another core's cache, which is a model specific event given
+// by PERF_HITM, e.g. PERF_HITM=0x04d2 for MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM on Skylake
+#  if defined(PERF_HITM_EVENT)
+#    define PERF_HITM_TYPE PERF_TYPE_RAW
+#  else
+#    define PERF_HITM_TYPE PERF_TYPE_MAX
+#    define PERF_HITM_EVENT 0
+#  endif
+
+typedef struct perf_event_desc
+{
+  const char* name;
+  uint32_t type;
+  uint64_t config;
+} perf_event_desc_t;
+
+static __attribute__ ((unused)) const perf_event_desc_t perf_events[PERF_NUM_EVENTS] =
+{
+  { "Cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+  { "Instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+  { "LLC_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+  { "Remote_node_misses", PERF_TYPE_HW_CACHE,
+    PERF_COUNT_HW_CACHE_NODE | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+  { "HITM", PERF_HITM_TYPE, PERF_HITM_EVENT },
+};
+
+static __thread __attribute__ ((unused)) int perf_fds[PERF_NUM_EVENTS];
+// The counts of every thread, where -1 marks a counter the thread could not open
+static __attribute__ ((unused)) int64_t perf_values[PERF_MAX_THREADS][PERF_NUM_EVENTS];
+static __attribute__ ((unused)) int perf_errno[PERF_NUM_EVENTS];
+
+static inline void
+perf_counters_start(int id)
+{
+  int e;
+  if (id < 0 || id >= PERF_MAX_THREADS)
+    {
+      fprintf(stderr, "Thread %d has no hardware counters, at most %d threads are measured\n", id, PERF_MAX_THREADS);
+      exit(1);
+    }
+  for (e = 0; e < PERF_NUM_EVENTS; e++)
+    {
+      perf_fds[e] = -1;
+      if (perf_events[e].type == PERF_TYPE_MAX)
+        {
+          perf_errno[e] = ENOENT;
+          continue;
+        }
+
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = perf_events[e].type;
+      attr.config = perf_events[e].config;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      // The calling thread on any cpu
+      perf_fds[e] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+      if (perf_fds[e] < 0)
+        {
+          perf_errno[e] = errno;
+        }
+    }
+  for (e = 0; e < PERF_NUM_EVENTS; e++)
+    {
+      if (perf_fds[e] >= 0)
+        {
+          ioctl(perf_fds[e], PERF_EVENT_IOC_RESET, 0);
+          ioctl(perf_fds[e], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+static inline void
+perf_counters_stop(int id)
+{
+  int e;
+  for (e = 0; e < PERF_NUM_EVENTS; e++)
+    {
+      if (perf_fds[e] >= 0)
+        {
+          ioctl(perf_fds[e], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+  for (e = 0; e < PERF_NUM_EVENTS; e++)
+    {
+      perf_values[id][e] = -1;
+      if (perf_fds[e] < 0)
+        {
+          continue;
+        }
+
+      // Scale up the counts of a counter that was multiplexed with others
+      uint64_t v[3];
+      if (read(perf_fds[e], v, sizeof(v)) == sizeof(v) && v[2] > 0)
+        {
+          perf_values[id][e] = (int64_t) ((double) v[0] * v[1] / v[2]);
+        }
+      close(perf_fds[e]);
+    }
+}
+
+// Sums every counter over the threads, or -1 if a thread could not read it
+static inline void
+perf_counters_sum(size_t num_threads, int64_t sums[PERF_NUM_EVENTS])
+{
+  int e;
+  for (e = 0; e < PERF_NUM_EVENTS; e++)
+    {
+      sums[e] = 0;
+      size_t t;
+      for (t = 0; t < num_threads; t++)
+        {
+          if (perf_values[t][e] < 0)
+            {
+              sums[e] = -1;
+              break;
+            }
+          sums[e] += perf_values[t][e];
+        }
+    }
+}
+
+// Prints the sum over the threads of every counter, and its mean per operation
+static inline void
+perf_counters_print(size_t num_threads, uint64_t ops)
+{
+  int64_t sums[PERF_NUM_EVENTS];
+  int e;
+  perf_counters_sum(num_threads, sums);
+  for (e = 0; e < PERF_NUM_EVENTS; e++)
+    {
+      if (sums[e] < 0)
+        {
+          printf("%s , n/a (%s)\n", perf_events[e].name, strerror(perf_errno[e] ? perf_errno[e] : EIO));
+          continue;
+        }
+      printf("%s , %lld\n", perf_events[e].name, (long long) sums[e]);
+      if (ops > 0)
+        {
+          printf("%s_per_op , %.3f\n", perf_events[e].name, (double) sums[e] / ops);
+        }
+    }
+  if (sums[0] > 0 && sums[1] >= 0)
+    {
+      printf("IPC , %.3f\n", (double) sums[1] / sums[0]);
+    }
+}
+
+#  define PERF_COUNTERS_START()      perf_counters_start(ID)
+#  define PERF_COUNTERS_STOP()       perf_counters_stop(ID)
+#  define PERF_COUNTERS_PRINT(ops)   perf_counters_print(num_threads, ops)
+#else
+#  define PERF_COUNTERS_START()
+#  define PERF_COUNTERS_STOP()
+#  define PERF_COUNTERS_PRINT(ops)
+#endif /* PERF_COUNTERS */
+
+#endif /* _PERF_COUNTERS_H_ */
@@ -74,6 +74,27 @@ static inline unsigned long xorshf96(unsigned long* x, unsigned long* y, unsigne
   return *z;
 }
 
+// wyrand, a 64 bit generator whose state is only a counter, so threads seeded far apart in the
+// period get independent streams. Used to sample sub-queue indices.
+static inline uint64_t wyrand(uint64_t* state)
+{
+  *state += 0xa0761d6478bd642fULL;
+  __uint128_t t = (__uint128_t) *state * (*state ^ 0xe7037ed1a0b428dbULL);
+  return (uint64_t) (t >> 64) ^ (uint64_t) t;
+}
+
+// Starts the stream of a thread, spreading the thread ids over the period
+static inline uint64_t wyrand_seed(int thread_id)
+{
+  return getticks() ^ ((uint64_t) thread_id * 0x9e3779b97f4a7c15ULL);
+}
+
+// Lemire's multiply-shift reduction of 32 random bits to [0, range), without the division of a modulo
+static inline uint32_t reduce_range(uint32_t r, uint32_t range)
+{
+  return (uint32_t) (((uint64_t) r * range) >> 32);
+}
+
 static inline long rand_range(long r)
 {
   /* PF_START(0); */
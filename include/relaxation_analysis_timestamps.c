@@ -1,4 +1,11 @@
 #include "relaxation_analysis_timestamps.h"
+#include "getticks.h"
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // Thread local arrays for storing records
 __thread relax_stamp_t* thread_put_stamps;
@@ -14,13 +21,199 @@ size_t** shared_put_stamps_ind; // Array of pointers, to make it more thread loc
 size_t** shared_get_stamps_ind; // Array of pointers, to make it more thread local without dropping too early
 
 
-// Get a timestamp from the realtime clock, shared accross processors
+#ifdef RELAXATION_TIMESTAMP_TSC
+// Set at startup if the TSC is invariant, otherwise CLOCK_MONOTONIC_RAW is used
+int timestamp_use_tsc = 0;
+// Offset to subtract from the TSC of each cpu, the same for all cpus in a socket
+int64_t tsc_cpu_offset[TSC_MAX_CPUS];
+
+// The TSC and the cpu it was read on, from the same instruction so a migration can't mix them up
+static inline uint64_t get_tsc(uint32_t* cpu)
+{
+    uint32_t aux;
+    ticks tsc = getticks_aux(&aux);
+    *cpu = aux & (TSC_MAX_CPUS - 1);
+    return tsc;
+}
+#endif
+
+// Get a timestamp, comparable accross processors
 uint64_t get_timestamp() {
+#ifdef RELAXATION_TIMESTAMP_TSC
+    if (likely(timestamp_use_tsc)) {
+        uint32_t cpu;
+        uint64_t tsc = get_tsc(&cpu);
+        return tsc - tsc_cpu_offset[cpu];
+    }
+#endif
     struct timespec ts;
+#if defined(RELAXATION_TIMESTAMP_MONOTONIC) || defined(RELAXATION_TIMESTAMP_TSC)
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else
     clock_gettime(CLOCK_REALTIME, &ts);  // Get the current time
+#endif
     return (uint64_t)ts.tv_sec * 1e9 + ts.tv_nsec;  // Convert seconds and nanoseconds to a single 64-bit number
 }
 
+#ifdef RELAXATION_TIMESTAMP_TSC
+// Ping-pong rounds used to estimate the TSC offset between two sockets
+#define TSC_CALIBRATION_ROUNDS 1000
+
+typedef struct tsc_calibration {
+    int ref_cpu;
+    int cpu;
+    volatile uint64_t ping;
+    volatile uint64_t pong;
+    int64_t offset;
+    int pin_failed;     // Set if a side could not be pinned, so the offset is not of the two cpus
+} tsc_calibration_t;
+
+static int pin_calibration_thread(int cpu)
+{
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    return sched_setaffinity(0, sizeof(mask), &mask);
+}
+
+// Reference side, sends its TSC and waits for the other side to answer with its own
+static void* tsc_calibration_ref(void* arg)
+{
+    tsc_calibration_t* cal = (tsc_calibration_t*) arg;
+    uint32_t cpu;
+    uint64_t best_rtt = UINT64_MAX;
+    // Still answer the other side if pinning fails, so both sides finish their rounds
+    if (pin_calibration_thread(cal->ref_cpu) != 0) cal->pin_failed = 1;
+    for (int round = 0; round < TSC_CALIBRATION_ROUNDS; round++)
+    {
+        while (cal->ping != 0) ;
+        uint64_t sent = get_tsc(&cpu);
+        cal->ping = sent;
+        while (cal->pong == 0) ;
+        uint64_t received = get_tsc(&cpu);
+        uint64_t remote = cal->pong;
+        cal->pong = 0;
+        // The round trip with the smallest delay gives the tightest offset estimate
+        if (received - sent < best_rtt)
+        {
+            best_rtt = received - sent;
+            cal->offset = (int64_t) (remote - (sent + (received - sent) / 2));
+        }
+    }
+    return NULL;
+}
+
+static void* tsc_calibration_remote(void* arg)
+{
+    tsc_calibration_t* cal = (tsc_calibration_t*) arg;
+    uint32_t cpu;
+    if (pin_calibration_thread(cal->cpu) != 0) cal->pin_failed = 1;
+    for (int round = 0; round < TSC_CALIBRATION_ROUNDS; round++)
+    {
+        while (cal->ping == 0) ;
+        cal->ping = 0;
+        cal->pong = get_tsc(&cpu);
+    }
+    return NULL;
+}
+
+static int tsc_is_invariant()
+{
+#if defined(__x86_64__)
+    uint32_t eax, ebx, ecx, edx;
+    __asm__ __volatile__ ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(0x80000000));
+    if (eax < 0x80000007) return 0;
+    __asm__ __volatile__ ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(0x80000007));
+    return (edx >> 8) & 1;
+#else
+    return 0;
+#endif
+}
+
+static int cpu_socket(int cpu)
+{
+    char path[128];
+    int socket = -1;
+    sprintf(path, "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return -1;
+    if (fscanf(file, "%d", &socket) != 1) socket = -1;
+    fclose(file);
+    return socket;
+}
+
+// Use the TSC if it is invariant, and measure the offset of every socket to the socket of the first cpu
+static void init_timestamp_source()
+{
+    timestamp_use_tsc = tsc_is_invariant();
+    if (!timestamp_use_tsc)
+    {
+        fprintf(stderr, "Warning: the TSC is not invariant, using CLOCK_MONOTONIC_RAW\n");
+        return;
+    }
+
+    long nbr_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    if (nbr_cpus > TSC_MAX_CPUS) nbr_cpus = TSC_MAX_CPUS;
+    int ref_cpu = 0;
+    int ref_socket = cpu_socket(ref_cpu);
+
+    for (int cpu = 0; cpu < nbr_cpus; cpu++)
+    {
+        int socket = cpu_socket(cpu);
+        if (socket == ref_socket) continue;
+
+        // Calibrate against the first cpu of the socket and reuse its offset for the rest
+        int first = 0;
+        while (first < cpu && cpu_socket(first) != socket) first++;
+        if (first < cpu)
+        {
+            tsc_cpu_offset[cpu] = tsc_cpu_offset[first];
+            continue;
+        }
+
+        tsc_calibration_t cal = { .ref_cpu = ref_cpu, .cpu = cpu, .ping = 0, .pong = 0, .offset = 0, .pin_failed = 0 };
+        pthread_t ref_thread, remote_thread;
+        pthread_create(&ref_thread, NULL, tsc_calibration_ref, &cal);
+        pthread_create(&remote_thread, NULL, tsc_calibration_remote, &cal);
+        pthread_join(ref_thread, NULL);
+        pthread_join(remote_thread, NULL);
+        if (cal.pin_failed)
+        {
+            fprintf(stderr, "Warning: could not pin the TSC calibration to cpus %d and %d, using CLOCK_MONOTONIC_RAW\n", ref_cpu, cpu);
+            timestamp_use_tsc = 0;
+            return;
+        }
+        tsc_cpu_offset[cpu] = cal.offset;
+    }
+}
+#else
+static void init_timestamp_source() {}
+#endif
+
+// Measure and print how long taking a timestamp takes
+static void print_timestamp_overhead()
+{
+    const int rounds = 1000000;
+    struct timespec start, end;
+    volatile uint64_t sink = 0;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    for (int i = 0; i < rounds; i++)
+    {
+        sink += get_timestamp();
+    }
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+    double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+
+#ifdef RELAXATION_TIMESTAMP_TSC
+    printf("Timestamp source , %s\n", timestamp_use_tsc ? "tsc" : "monotonic_raw");
+#elif defined(RELAXATION_TIMESTAMP_MONOTONIC)
+    printf("Timestamp source , monotonic_raw\n");
+#else
+    printf("Timestamp source , realtime\n");
+#endif
+    printf("Timestamp overhead (ns/op) , %.1f\n", ns / rounds);
+}
+
 // Add a put operation of a value with its timestamp
 void add_relaxed_put(sval_t val, uint64_t timestamp)
 {
@@ -60,6 +253,9 @@ void init_relaxation_analysis_shared(int nbr_threads)
     shared_get_stamps = (relax_stamp_t**) calloc(nbr_threads, sizeof(relax_stamp_t**));
     shared_put_stamps_ind = (size_t**) calloc(nbr_threads, sizeof(size_t**));
     shared_get_stamps_ind = (size_t**) calloc(nbr_threads, sizeof(size_t**));
+
+    init_timestamp_source();
+    print_timestamp_overhead();
 }
 
 // Init the relaxation analysis, thread local variables
@@ -99,14 +295,154 @@ void destoy_relaxation_analysis_all(int nbr_threads)
     free(shared_get_stamps_ind);
 }
 
-int compare_timestamps(const void *a, const void *b) {
-    const relax_stamp_t *stamp1 = (const relax_stamp_t *)a;
-    const relax_stamp_t *stamp2 = (const relax_stamp_t *)b;
-    if (stamp1->timestamp < stamp2->timestamp) return -1;
-    if (stamp1->timestamp > stamp2->timestamp) return 1;
-    return 0;
+// Below this many stamps in total, the merge is done by the calling thread alone
+#define PARALLEL_MERGE_MIN_STAMPS (1 << 20)
+
+// Entry in the merge heap, ordered by timestamp and then by thread so equal timestamps are merged in thread order
+typedef struct merge_head {
+    uint64_t timestamp;
+    int thread;
+} merge_head_t;
+
+static inline int merge_head_less(merge_head_t a, merge_head_t b)
+{
+    return a.timestamp < b.timestamp || (a.timestamp == b.timestamp && a.thread < b.thread);
 }
 
+static void merge_heap_sift_down(merge_head_t* heap, int size, int pos)
+{
+    merge_head_t top = heap[pos];
+    while (2 * pos + 1 < size)
+    {
+        int child = 2 * pos + 1;
+        if (child + 1 < size && merge_head_less(heap[child + 1], heap[child])) child += 1;
+        if (!merge_head_less(heap[child], top)) break;
+        heap[pos] = heap[child];
+        pos = child;
+    }
+    heap[pos] = top;
+}
+
+// Heap based k-way merge of the already sorted per-thread ranges [from[t], to[t]) into out
+static void merge_relaxed_stamps(int nbr_threads, relax_stamp_t** stamps, size_t* from, size_t* to, relax_stamp_t* out)
+{
+    merge_head_t* heap = (merge_head_t*) malloc(nbr_threads * sizeof(merge_head_t));
+    size_t* next = (size_t*) malloc(nbr_threads * sizeof(size_t));
+    if (heap == NULL || next == NULL) {
+        fprintf(stderr, "Memory allocation failed for merging relaxation stamps\n");
+        exit(1);
+    }
+
+    int size = 0;
+    for (int thread = 0; thread < nbr_threads; thread += 1)
+    {
+        next[thread] = from[thread];
+        if (from[thread] < to[thread])
+        {
+            heap[size].timestamp = stamps[thread][from[thread]].timestamp;
+            heap[size].thread = thread;
+            size += 1;
+        }
+    }
+    for (int pos = size / 2 - 1; pos >= 0; pos -= 1)
+    {
+        merge_heap_sift_down(heap, size, pos);
+    }
+
+    size_t out_ind = 0;
+    while (size > 0)
+    {
+        int thread = heap[0].thread;
+        out[out_ind++] = stamps[thread][next[thread]++];
+        if (next[thread] < to[thread])
+        {
+            heap[0].timestamp = stamps[thread][next[thread]].timestamp;
+        }
+        else
+        {
+            heap[0] = heap[--size];
+        }
+        merge_heap_sift_down(heap, size, 0);
+    }
+
+    free(next);
+    free(heap);
+}
+
+// First index in a sorted stamp array with a timestamp not less than (or, if upper, greater than) the given one
+static size_t search_relaxed_stamps(relax_stamp_t* stamps, size_t count, uint64_t timestamp, int upper)
+{
+    size_t low = 0, high = count;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (stamps[mid].timestamp < timestamp || (upper && stamps[mid].timestamp == timestamp)) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+// Merge path for k sorted arrays: split every thread's array so that exactly `pos` stamps come before the splits.
+// Searches for the timestamp of the pos:th output stamp, and hands out stamps equal to it in thread order.
+static void split_relaxed_stamps(int nbr_threads, relax_stamp_t** stamps, size_t** counts, size_t pos, size_t* splits)
+{
+    uint64_t low = 0, high = UINT64_MAX;
+    while (low < high)
+    {
+        uint64_t mid = low + (high - low) / 2;
+        size_t below = 0;
+        for (int thread = 0; thread < nbr_threads; thread += 1)
+        {
+            below += search_relaxed_stamps(stamps[thread], *counts[thread], mid, 1);
+        }
+        if (below >= pos) high = mid;
+        else low = mid + 1;
+    }
+
+    size_t remaining = pos;
+    for (int thread = 0; thread < nbr_threads; thread += 1)
+    {
+        splits[thread] = search_relaxed_stamps(stamps[thread], *counts[thread], low, 0);
+        remaining -= splits[thread];
+    }
+    for (int thread = 0; thread < nbr_threads && remaining > 0; thread += 1)
+    {
+        size_t equal = search_relaxed_stamps(stamps[thread], *counts[thread], low, 1) - splits[thread];
+        size_t take = equal < remaining ? equal : remaining;
+        splits[thread] += take;
+        remaining -= take;
+    }
+}
+
+typedef struct merge_worker {
+    pthread_t thread;
+    int nbr_threads;
+    relax_stamp_t** stamps;
+    size_t** counts;
+    size_t out_from;
+    size_t out_to;
+    relax_stamp_t* out;
+} merge_worker_t;
+
+static void* merge_worker_run(void* arg)
+{
+    merge_worker_t* w = (merge_worker_t*) arg;
+    size_t* from = (size_t*) malloc(w->nbr_threads * sizeof(size_t));
+    size_t* to = (size_t*) malloc(w->nbr_threads * sizeof(size_t));
+    if (from == NULL || to == NULL) {
+        fprintf(stderr, "Memory allocation failed for merging relaxation stamps\n");
+        exit(1);
+    }
+    split_relaxed_stamps(w->nbr_threads, w->stamps, w->counts, w->out_from, from);
+    split_relaxed_stamps(w->nbr_threads, w->stamps, w->counts, w->out_to, to);
+    merge_relaxed_stamps(w->nbr_threads, w->stamps, from, to, w->out + w->out_from);
+    free(from);
+    free(to);
+    return NULL;
+}
+
+// Combine the per-thread stamp arrays, each already sorted by time, into one array sorted by time.
+// Large inputs are split with merge path so that every worker merges an equally large part of the output.
 relax_stamp_t* combine_sort_relaxed_stamps(int nbr_threads, relax_stamp_t** stamps, size_t** counts, size_t* tot_counts_out)
 {
     *tot_counts_out = 0;
@@ -121,25 +457,56 @@ relax_stamp_t* combine_sort_relaxed_stamps(int nbr_threads, relax_stamp_t** stam
         exit(1);
     }
 
-    // Combine all lists into one
-    size_t offset = 0;
-    for (int thread = 0; thread < nbr_threads; thread++) {
-        memcpy(combined_stamps + offset, stamps[thread], *counts[thread] * sizeof(relax_stamp_t));
-        offset += *counts[thread];
+    int nbr_workers = nbr_threads;
+    long nbr_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nbr_cpus > 0 && nbr_workers > nbr_cpus) nbr_workers = (int) nbr_cpus;
+
+    if (nbr_workers <= 1 || *tot_counts_out < PARALLEL_MERGE_MIN_STAMPS)
+    {
+        size_t* from = (size_t*) calloc(nbr_threads, sizeof(size_t));
+        size_t* to = (size_t*) malloc(nbr_threads * sizeof(size_t));
+        if (from == NULL || to == NULL) {
+            fprintf(stderr, "Memory allocation failed for merging relaxation stamps\n");
+            exit(1);
+        }
+        for (int thread = 0; thread < nbr_threads; thread += 1)
+        {
+            to[thread] = *counts[thread];
+        }
+        merge_relaxed_stamps(nbr_threads, stamps, from, to, combined_stamps);
+        free(from);
+        free(to);
+        return combined_stamps;
     }
 
-    // Sort the combined list using the comparator
-    // TODO: In case this is too slow, we can get complecity to O(stamps*log(threads)) instead of O(stamps*log(stamps)) with some extra code
-    qsort(combined_stamps, *tot_counts_out, sizeof(relax_stamp_t), compare_timestamps);
+    merge_worker_t* workers = (merge_worker_t*) calloc(nbr_workers, sizeof(merge_worker_t));
+    if (workers == NULL) {
+        fprintf(stderr, "Memory allocation failed for merging relaxation stamps\n");
+        exit(1);
+    }
+    for (int id = 0; id < nbr_workers; id += 1)
+    {
+        merge_worker_t* w = &workers[id];
+        w->nbr_threads = nbr_threads;
+        w->stamps = stamps;
+        w->counts = counts;
+        w->out_from = *tot_counts_out * id / nbr_workers;
+        w->out_to = *tot_counts_out * (id + 1) / nbr_workers;
+        w->out = combined_stamps;
+        if (pthread_create(&w->thread, NULL, merge_worker_run, w) != 0) {
+            perror("Could not create relaxation merge thread");
+            exit(1);
+        }
+    }
+    for (int id = 0; id < nbr_workers; id += 1)
+    {
+        pthread_join(workers[id].thread, NULL);
+    }
+    free(workers);
 
     return combined_stamps;
 }
 
-struct item_list {
-    struct item_list *next;
-    sval_t value;
-};
-
 void remove_duplicate_timestamps(relax_stamp_t* put_stamps, size_t tot_put, relax_stamp_t* get_stamps, size_t tot_get)
 {
     int keep_going = 1;
@@ -169,112 +536,498 @@ void remove_duplicate_timestamps(relax_stamp_t* put_stamps, size_t tot_put, rela
     }
 }
 
+// Worst case size of one encoded stamp, two 64 bit varints
+#define RELAX_STAMP_MAX_ENCODED 20
+
+static inline uint64_t zigzag_encode(int64_t val)
+{
+    return ((uint64_t) val << 1) ^ (uint64_t) (val >> 63);
+}
+
+static inline int64_t zigzag_decode(uint64_t val)
+{
+    return (int64_t) (val >> 1) ^ -(int64_t) (val & 1);
+}
+
+static inline uint8_t* varint_encode(uint8_t* out, uint64_t val)
+{
+    while (val >= 0x80)
+    {
+        *out++ = (uint8_t) (val | 0x80);
+        val >>= 7;
+    }
+    *out++ = (uint8_t) val;
+    return out;
+}
+
+static inline const uint8_t* varint_decode(const uint8_t* in, const uint8_t* end, uint64_t* val)
+{
+    uint64_t res = 0;
+    int shift = 0;
+    while (in < end && shift < 64)
+    {
+        uint8_t byte = *in++;
+        res |= (uint64_t) (byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            *val = res;
+            return in;
+        }
+        shift += 7;
+    }
+    return NULL;
+}
+
+// Open a stamp file for at most max_count stamps. The binary file is preallocated for the worst case and mapped.
+void open_stamp_writer(relax_stamp_writer_t* writer, const char* path, size_t max_count)
+{
+    memset(writer, 0, sizeof(*writer));
+#ifdef SAVE_TIMESTAMPS_TEXT
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL) {
+        perror("Error opening file");
+        exit(1);
+    }
+#else
+    writer->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (writer->fd < 0) {
+        perror("Error opening file");
+        exit(1);
+    }
+    writer->capacity = sizeof(relax_stamp_file_header_t) + max_count * RELAX_STAMP_MAX_ENCODED;
+    if (ftruncate(writer->fd, writer->capacity) != 0) {
+        perror("Could not allocate timestamp file");
+        exit(1);
+    }
+    writer->map = (uint8_t*) mmap(NULL, writer->capacity, PROT_READ | PROT_WRITE, MAP_SHARED, writer->fd, 0);
+    if (writer->map == MAP_FAILED) {
+        perror("Could not map timestamp file");
+        exit(1);
+    }
+    writer->offset = sizeof(relax_stamp_file_header_t);
+#endif
+}
+
+// Append one stamp, as a delta encoded timestamp followed by a delta encoded value
+void write_stamp(relax_stamp_writer_t* writer, uint64_t timestamp, sval_t value)
+{
+#ifdef SAVE_TIMESTAMPS_TEXT
+    if (writer->count > 0) fputc('\n', writer->file);
+    fprintf(writer->file, "%ld %ld", timestamp, value);
+#else
+    uint8_t* out = writer->map + writer->offset;
+    out = varint_encode(out, zigzag_encode((int64_t) (timestamp - writer->prev_timestamp)));
+    out = varint_encode(out, zigzag_encode((int64_t) ((uint64_t) value - (uint64_t) writer->prev_value)));
+    writer->offset = out - writer->map;
+    writer->prev_timestamp = timestamp;
+    writer->prev_value = value;
+#endif
+    writer->count += 1;
+}
+
+// Write the header, and shrink the file to the encoded size
+void close_stamp_writer(relax_stamp_writer_t* writer)
+{
+#ifdef SAVE_TIMESTAMPS_TEXT
+    fclose(writer->file);
+#else
+    relax_stamp_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RELAX_STAMP_FILE_MAGIC, sizeof(header.magic));
+    header.version = RELAX_STAMP_FILE_VERSION;
+    header.header_size = sizeof(relax_stamp_file_header_t);
+    header.count = writer->count;
+    header.payload_size = writer->offset - sizeof(relax_stamp_file_header_t);
+    memcpy(writer->map, &header, sizeof(header));
+
+    munmap(writer->map, writer->capacity);
+    if (ftruncate(writer->fd, writer->offset) != 0) {
+        perror("Could not shrink timestamp file");
+        exit(1);
+    }
+    close(writer->fd);
+#endif
+}
+
+// Read a binary stamp file written by close_stamp_writer. Returns NULL if it can not be read.
+relax_stamp_t* load_relaxed_stamps(const char* path, size_t* count_out)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(relax_stamp_file_header_t)) {
+        close(fd);
+        return NULL;
+    }
+    uint8_t* map = (uint8_t*) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    relax_stamp_file_header_t header;
+    memcpy(&header, map, sizeof(header));
+    if (memcmp(header.magic, RELAX_STAMP_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != RELAX_STAMP_FILE_VERSION ||
+        header.header_size + header.payload_size > (uint64_t) st.st_size)
+    {
+        fprintf(stderr, "Not a version %d timestamp file: %s\n", RELAX_STAMP_FILE_VERSION, path);
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    relax_stamp_t* stamps = (relax_stamp_t*) malloc((header.count + 1) * sizeof(relax_stamp_t));
+    if (stamps == NULL) {
+        fprintf(stderr, "Memory allocation failed for loading timestamps\n");
+        exit(1);
+    }
+
+    const uint8_t* in = map + header.header_size;
+    const uint8_t* end = in + header.payload_size;
+    uint64_t timestamp = 0, value = 0, delta;
+    for (size_t idx = 0; idx < header.count; idx++)
+    {
+        if ((in = varint_decode(in, end, &delta)) == NULL) break;
+        timestamp += (uint64_t) zigzag_decode(delta);
+        if ((in = varint_decode(in, end, &delta)) == NULL) break;
+        value += (uint64_t) zigzag_decode(delta);
+        stamps[idx].timestamp = timestamp;
+        stamps[idx].value = (sval_t) value;
+    }
+    munmap(map, st.st_size);
+
+    if (in == NULL) {
+        fprintf(stderr, "Truncated timestamp file: %s\n", path);
+        free(stamps);
+        return NULL;
+    }
+    *count_out = header.count;
+    return stamps;
+}
+
 void save_timestamps(relax_stamp_t* combined_put_stamps, size_t tot_put, relax_stamp_t* combined_get_stamps, size_t tot_get)
 {
     //create dir if not exists
     system("mkdir -p results/timestamps");
-    FILE* fptr;
-    fptr = fopen("results/timestamps/combined_put_stamps.txt", "wb");
-   
+    relax_stamp_writer_t writer;
+
     remove_duplicate_timestamps(combined_put_stamps, tot_put, combined_get_stamps, tot_get);
 
-    
     printf("Saving timestamps...\n");
+    open_stamp_writer(&writer, "results/timestamps/combined_put_stamps" RELAX_STAMP_FILE_EXT, tot_put);
     for(size_t idx = 0; idx < tot_put; idx++)
     {
-        relax_stamp_t curr = combined_put_stamps[idx];
-        if (unlikely(idx == tot_put - 1)) {
-            fprintf(fptr,"%ld %ld", curr.timestamp, curr.value); 
-        } else{
-            fprintf(fptr,"%ld %ld\n", curr.timestamp, curr.value); 
-        }
+        write_stamp(&writer, combined_put_stamps[idx].timestamp, combined_put_stamps[idx].value);
     }
-    fclose(fptr); 
-    fptr = fopen("results/timestamps/combined_get_stamps.txt", "wb");
+    close_stamp_writer(&writer);
+
+    open_stamp_writer(&writer, "results/timestamps/combined_get_stamps" RELAX_STAMP_FILE_EXT, tot_get);
     for(size_t idx = 0; idx < tot_get; idx++)
     {
         relax_stamp_t curr = combined_get_stamps[idx];
 #ifdef SAVE_THREAD_STAMPS
         curr.value = curr.value >> 8;
 #endif
-        if (unlikely(idx == tot_get - 1)) {
-            fprintf(fptr,"%ld %ld", curr.timestamp, curr.value); 
-        } else {
-            fprintf(fptr,"%ld %ld\n", curr.timestamp, curr.value); 
-        }
+        write_stamp(&writer, curr.timestamp, curr.value);
     }
-    fclose(fptr); 
+    close_stamp_writer(&writer);
     printf("Timestamps saved.\n");
 }
 
+// Save the stamps of every thread in its own file, thread_<id>_<suffix>
+static void save_stamps_per_thread(int nbr_threads, relax_stamp_t* stamps, size_t tot, const char* suffix, int strip_thread)
+{
+    char filename[64];
+    relax_stamp_writer_t* writers = (relax_stamp_writer_t*) malloc(nbr_threads * sizeof(relax_stamp_writer_t));
+    size_t* thread_counts = (size_t*) calloc(nbr_threads, sizeof(size_t));
+    if (writers == NULL || thread_counts == NULL) {
+        fprintf(stderr, "Memory allocation failed for saving thread timestamps\n");
+        exit(1);
+    }
+
+    // Values not tagged with a benchmark thread (e.g. random initial keys) are not saved
+    for (size_t i = 0; i < tot; ++i) {
+        int thread = stamps[i].value & 0xFF;
+        if (thread < nbr_threads) thread_counts[thread] += 1;
+    }
+    for (int i = 0; i < nbr_threads; ++i) {
+        sprintf(filename, "results/threads/thread_%d_%s" RELAX_STAMP_FILE_EXT, i, suffix);
+        open_stamp_writer(&writers[i], filename, thread_counts[i]);
+    }
+
+    for (size_t i = 0; i < tot; ++i) {
+        relax_stamp_t curr = stamps[i];
+        int thread = curr.value & 0xFF;
+        if (thread >= nbr_threads) continue;
+        if (strip_thread) curr.value = curr.value >> 8;
+        write_stamp(&writers[thread], curr.timestamp, curr.value);
+    }
+
+    for (int i = 0; i < nbr_threads; ++i) {
+        close_stamp_writer(&writers[i]);
+    }
+    free(thread_counts);
+    free(writers);
+}
+
 void save_thread_stamps(int nbr_threads, relax_stamp_t* combined_put_stamps, size_t tot_put, relax_stamp_t* combined_get_stamps, size_t tot_get)
 {
     //create dir if not exists
     system("rm -rf results/threads && mkdir -p results/threads");
 
-    char* filename = (char*)malloc(50u * sizeof(char));
-    FILE *file_ptrs[nbr_threads];
-    FILE *fptr;
+    save_stamps_per_thread(nbr_threads, combined_put_stamps, tot_put, "puts", 0);
+    save_stamps_per_thread(nbr_threads, combined_get_stamps, tot_get, "gets", 1);
+}
+
+// Hash table with one slot per distinct value, shared by the rank workers.
+// Slots store the index + 1 of some enqueue of the value, so 0 marks an empty slot.
+typedef struct rank_worker {
+    pthread_t thread;
+    int id;
+    int nbr_workers;
+    relax_stamp_t* put_stamps;
+    size_t tot_put;
+    relax_stamp_t* get_stamps;
+    size_t tot_get;
+    size_t* put_slots;
+    size_t* get_slots;
+    size_t* table;
+    size_t table_mask;
+    pthread_barrier_t* barrier;
+} rank_worker_t;
 
-    // Save puts stamps
+static inline size_t hash_relaxed_value(sval_t val)
+{
+    uint64_t h = (uint64_t) val * 0x9E3779B97F4A7C15ull;
+    return (size_t) (h ^ (h >> 32));
+}
+
+static inline sval_t get_stamp_key(sval_t val)
+{
+#ifdef SAVE_THREAD_STAMPS
+    return val >> 8;
+#else
+    return val;
+#endif
+}
+
+// Find the slot of a value, or an empty slot if it was never enqueued
+static inline size_t find_value_slot(rank_worker_t* w, sval_t key)
+{
+    size_t slot = hash_relaxed_value(key) & w->table_mask;
+    while (w->table[slot] != 0 && w->put_stamps[w->table[slot] - 1].value != key)
     {
-        for (int i = 0; i < nbr_threads; ++i) {
-            // remove_duplicate_timestamps(put_stamps[i], *put_counts[i], get_stamps[i], *get_counts[i]);
-            sprintf(filename, "results/threads/thread_%d_puts.txt", i);
-            fptr = fopen(filename, "wb");
-            if (fptr == NULL) {
-                perror("Error opening file");
-                exit(1);
-            }
-            file_ptrs[i] = fptr;
+        slot = (slot + 1) & w->table_mask;
+    }
+    return slot;
+}
+
+static void* rank_worker_run(void* arg)
+{
+    rank_worker_t* w = (rank_worker_t*) arg;
+
+    // Insert this worker's share of the enqueued values. Equal values race for the same slots, so they end up in one.
+    size_t put_from = w->tot_put * w->id / w->nbr_workers;
+    size_t put_to = w->tot_put * (w->id + 1) / w->nbr_workers;
+    for (size_t put_ind = put_from; put_ind < put_to; put_ind += 1)
+    {
+        sval_t key = w->put_stamps[put_ind].value;
+        size_t slot = hash_relaxed_value(key) & w->table_mask;
+        while (1)
+        {
+            size_t entry = w->table[slot];
+            if (entry == 0 && __sync_bool_compare_and_swap(&w->table[slot], 0, put_ind + 1)) break;
+            entry = w->table[slot];
+            if (w->put_stamps[entry - 1].value == key) break;
+            slot = (slot + 1) & w->table_mask;
         }
-        
-        for (size_t i = 0; i < tot_put; ++i) {
-            relax_stamp_t curr = combined_put_stamps[i];
-            int enq_thread = curr.value & 0xFF; 
-            if (likely(i < tot_put - 1)) {
-                fprintf(file_ptrs[enq_thread],"%ld %ld\n", curr.timestamp, curr.value); 
-            } else {
-                fprintf(file_ptrs[enq_thread],"%ld %ld", curr.timestamp, curr.value); 
-            }
+    }
+
+    pthread_barrier_wait(w->barrier);
+
+    // Look up the slot of every enqueue and dequeue in this worker's share
+    for (size_t put_ind = put_from; put_ind < put_to; put_ind += 1)
+    {
+        w->put_slots[put_ind] = find_value_slot(w, w->put_stamps[put_ind].value);
+    }
+    size_t get_from = w->tot_get * w->id / w->nbr_workers;
+    size_t get_to = w->tot_get * (w->id + 1) / w->nbr_workers;
+    for (size_t deq_ind = get_from; deq_ind < get_to; deq_ind += 1)
+    {
+        size_t slot = find_value_slot(w, get_stamp_key(w->get_stamps[deq_ind].value));
+        if (w->table[slot] == 0)
+        {
+            perror("Out of bounds on finding matching relaxation enqueue\n");
+            printf("%zu\n", deq_ind);
+            exit(-1);
         }
-        
-        for (int i = 0; i < nbr_threads; ++i) {
-            fclose(file_ptrs[i]);
+        w->get_slots[deq_ind] = slot;
+    }
+    return NULL;
+}
+
+// Find the enqueue rank (index in the sorted put stamps) of every dequeue.
+// If a value is enqueued several times, the k:th dequeue of it matches the k:th enqueue of it.
+void find_enqueue_ranks(int nbr_threads, relax_stamp_t* put_stamps, size_t tot_put, relax_stamp_t* get_stamps, size_t tot_get, size_t* get_ranks)
+{
+    int nbr_workers = nbr_threads;
+    long nbr_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nbr_cpus > 0 && nbr_workers > nbr_cpus) nbr_workers = (int) nbr_cpus;
+    if (nbr_workers < 1) nbr_workers = 1;
+
+    size_t table_size = 1;
+    while (table_size < 2 * tot_put + 1) table_size <<= 1;
+    size_t* table = (size_t*) calloc(table_size, sizeof(size_t));
+    size_t* put_slots = (size_t*) malloc((tot_put + 1) * sizeof(size_t));
+    rank_worker_t* workers = (rank_worker_t*) calloc(nbr_workers, sizeof(rank_worker_t));
+    if (table == NULL || put_slots == NULL || workers == NULL) {
+        fprintf(stderr, "Memory allocation failed for relaxation rank table\n");
+        exit(1);
+    }
+
+    // The slots of the dequeues are kept in get_ranks until they are resolved to ranks below
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, nbr_workers);
+    for (int id = 0; id < nbr_workers; id += 1)
+    {
+        rank_worker_t* w = &workers[id];
+        w->id = id;
+        w->nbr_workers = nbr_workers;
+        w->put_stamps = put_stamps;
+        w->tot_put = tot_put;
+        w->get_stamps = get_stamps;
+        w->tot_get = tot_get;
+        w->put_slots = put_slots;
+        w->get_slots = get_ranks;
+        w->table = table;
+        w->table_mask = table_size - 1;
+        w->barrier = &barrier;
+        if (pthread_create(&w->thread, NULL, rank_worker_run, w) != 0) {
+            perror("Could not create relaxation rank thread");
+            exit(1);
         }
     }
+    for (int id = 0; id < nbr_workers; id += 1)
+    {
+        pthread_join(workers[id].thread, NULL);
+    }
+    pthread_barrier_destroy(&barrier);
+    free(workers);
 
-    // Save gets stamps
+    // Chain the enqueues of each value in rank order, reusing put_slots for the links and the table for the chain heads
+    memset(table, 0, table_size * sizeof(size_t));
+    for (size_t put_ind = tot_put; put_ind > 0; put_ind -= 1)
     {
-        for (int i = 0; i < nbr_threads; ++i) {
-            // remove_duplicate_timestamps(put_stamps[i], *put_counts[i], get_stamps[i], *get_counts[i]);
-            sprintf(filename, "results/threads/thread_%d_gets.txt", i);
-            fptr = fopen(filename, "wb");
-            if (fptr == NULL) {
-                perror("Error opening file");
-                exit(1);
-            }
-            file_ptrs[i] = fptr;
+        size_t slot = put_slots[put_ind - 1];
+        put_slots[put_ind - 1] = table[slot];
+        table[slot] = put_ind;
+    }
+
+    // Every dequeue takes the first remaining enqueue of its value
+    for (size_t deq_ind = 0; deq_ind < tot_get; deq_ind += 1)
+    {
+        size_t slot = get_ranks[deq_ind];
+        if (table[slot] == 0)
+        {
+            perror("Out of bounds on finding matching relaxation enqueue\n");
+            printf("%zu\n", deq_ind);
+            exit(-1);
         }
-        
-        for (size_t i = 0; i < tot_get; ++i) {
-            relax_stamp_t curr = combined_get_stamps[i];
-            int deq_thread = curr.value & 0xFF;
-            curr.value = curr.value >> 8;
-            if (likely(i < tot_get - 1)) {
-                fprintf(file_ptrs[deq_thread],"%ld %ld\n", curr.timestamp, curr.value); 
-            } else {
-                fprintf(file_ptrs[deq_thread],"%ld %ld", curr.timestamp, curr.value); 
+        get_ranks[deq_ind] = table[slot] - 1;
+        table[slot] = put_slots[get_ranks[deq_ind]];
+    }
+
+    free(put_slots);
+    free(table);
+}
+
+#ifdef RELAXATION_KEY_ORDER
+static int compare_relaxed_keys(const void* a, const void* b)
+{
+    sval_t x = *(const sval_t*) a;
+    sval_t y = *(const sval_t*) b;
+    return (x > y) - (x < y);
+}
+
+// Find the rank error in key order of every dequeue (delete-min), which is the number of items with a
+// smaller key in the queue when it was removed. The operations are replayed in timestamp order over a
+// Fenwick tree of the distinct keys, counting the items of each key in the queue. The errors replace the dequeued values.
+void find_key_rank_errors(relax_stamp_t* put_stamps, size_t tot_put, relax_stamp_t* get_stamps, size_t tot_get)
+{
+    sval_t* keys = (sval_t*) malloc((tot_put + 1) * sizeof(sval_t));
+    if (keys == NULL) {
+        fprintf(stderr, "Memory allocation failed for relaxation keys\n");
+        exit(1);
+    }
+    for (size_t put_ind = 0; put_ind < tot_put; put_ind += 1)
+    {
+        keys[put_ind] = put_stamps[put_ind].value;
+    }
+    qsort(keys, tot_put, sizeof(sval_t), compare_relaxed_keys);
+    size_t nbr_keys = 0;
+    for (size_t i = 0; i < tot_put; i += 1)
+    {
+        if (nbr_keys == 0 || keys[nbr_keys - 1] != keys[i]) keys[nbr_keys++] = keys[i];
+    }
+
+    int64_t* fenwick = (int64_t*) calloc(nbr_keys + 1, sizeof(int64_t));
+    if (fenwick == NULL) {
+        fprintf(stderr, "Memory allocation failed for relaxation fenwick tree\n");
+        exit(1);
+    }
+
+    size_t put_ind = 0;
+    for (size_t deq_ind = 0; deq_ind < tot_get; deq_ind += 1)
+    {
+        // An insert with the same timestamp as the removal is taken to come first, as it might be the removed item
+        while (put_ind < tot_put && put_stamps[put_ind].timestamp <= get_stamps[deq_ind].timestamp)
+        {
+            sval_t* pos = bsearch(&put_stamps[put_ind].value, keys, nbr_keys, sizeof(sval_t), compare_relaxed_keys);
+            for (size_t i = pos - keys + 1; i <= nbr_keys; i += i & -i)
+            {
+                fenwick[i] += 1;
             }
+            put_ind += 1;
+        }
+
+        sval_t key = get_stamp_key(get_stamps[deq_ind].value);
+        sval_t* pos = bsearch(&key, keys, nbr_keys, sizeof(sval_t), compare_relaxed_keys);
+        if (pos == NULL)
+        {
+            perror("Out of bounds on finding matching relaxation enqueue\n");
+            printf("%zu\n", deq_ind);
+            exit(-1);
         }
-        
-        for (int i = 0; i < nbr_threads; ++i) {
-            fclose(file_ptrs[i]);
+
+        // Counts can briefly go negative when timestamps of different threads are slightly off
+        int64_t smaller = 0;
+        for (size_t i = pos - keys; i > 0; i -= i & -i)
+        {
+            smaller += fenwick[i];
         }
+        for (size_t i = pos - keys + 1; i <= nbr_keys; i += i & -i)
+        {
+            fenwick[i] -= 1;
+        }
+        get_stamps[deq_ind].value = smaller > 0 ? smaller : 0;
     }
 
-    free(filename);
+    free(fenwick);
+    free(keys);
 }
+#endif
+
+#ifdef LOAD_TIMESTAMPS
+// Load a combined stamp file saved by SAVE_TIMESTAMPS, in the layout of the stamps of a run
+static relax_stamp_t* load_saved_stamps(const char* path, size_t* count_out)
+{
+    relax_stamp_t* stamps = load_relaxed_stamps(path, count_out);
+    if (stamps == NULL) {
+        fprintf(stderr, "Could not load the saved timestamps %s\n", path);
+        exit(1);
+    }
+    return stamps;
+}
+#endif
 
 // Print the stats from the relaxation measurement. Also destroys all memory
 void print_relaxation_measurements(int nbr_threads)
@@ -282,6 +1035,16 @@ void print_relaxation_measurements(int nbr_threads)
     // Sort all enqueue and dequeue operations in ascending order by time
     size_t tot_put, tot_get;
 
+#ifdef LOAD_TIMESTAMPS
+    // Analyse the stamps saved by an earlier run instead of the ones of this run
+    printf("Loading saved timestamps...\n");
+    relax_stamp_t* combined_put_stamps = load_saved_stamps("results/timestamps/combined_put_stamps.bin", &tot_put);
+    relax_stamp_t* combined_get_stamps = load_saved_stamps("results/timestamps/combined_get_stamps.bin", &tot_get);
+#ifdef SAVE_THREAD_STAMPS
+    // The dequeuing thread is not saved, but get_stamp_key expects one below the value
+    for (size_t idx = 0; idx < tot_get; idx++) combined_get_stamps[idx].value <<= 8;
+#endif
+#else
     relax_stamp_t* combined_put_stamps = combine_sort_relaxed_stamps(nbr_threads, shared_put_stamps, shared_put_stamps_ind, &tot_put);
     relax_stamp_t* combined_get_stamps = combine_sort_relaxed_stamps(nbr_threads, shared_get_stamps, shared_get_stamps_ind, &tot_get);
 
@@ -294,6 +1057,7 @@ void print_relaxation_measurements(int nbr_threads)
     printf("Saving timestamps for each threads...\n");
     save_thread_stamps(nbr_threads, combined_put_stamps, tot_put, combined_get_stamps, tot_get);
 #endif
+#endif
 
 #ifdef SKIP_CALCULATIONS
     printf("Skipping calculations\n");
@@ -308,48 +1072,50 @@ void print_relaxation_measurements(int nbr_threads)
     uint64_t rank_error_sum = 0;
     uint64_t rank_error_max = 0;
 
-    // Create a list of all items in the queue (in the beginning all of them)
-    // TODO: For stacks we can't do this offline like this, but rather add and remove things online
-    struct item_list* item_list = malloc(tot_put*sizeof(*item_list));
-    for (size_t enq_ind = 0; enq_ind < tot_put; enq_ind += 1)
+#ifdef RELAXATION_KEY_ORDER
+    // Priority queues, where the rank error is counted in key order rather than insertion order
+    find_key_rank_errors(combined_put_stamps, tot_put, combined_get_stamps, tot_get);
+    for (size_t deq_ind = 0; deq_ind < tot_get; deq_ind += 1)
     {
-        item_list[enq_ind].value = combined_put_stamps[enq_ind].value;
-        item_list[enq_ind].next = &item_list[enq_ind+1];
+        uint64_t rank_error = combined_get_stamps[deq_ind].value;
+        rank_error_sum += rank_error;
+        if (rank_error > rank_error_max) rank_error_max = rank_error;
     }
-    item_list[tot_put-1].next = NULL;
+#else
+    // Map every dequeued item to the rank of its enqueue, in parallel
+    size_t* get_ranks = (size_t*) malloc(tot_get * sizeof(size_t));
+    if (get_ranks == NULL) {
+        fprintf(stderr, "Memory allocation failed for relaxation ranks\n");
+        exit(1);
+    }
+    find_enqueue_ranks(nbr_threads, combined_put_stamps, tot_put, combined_get_stamps, tot_get, get_ranks);
 
-    // The head is initially the item enqueued first
-    struct item_list* head = &item_list[0];
+    // Fenwick tree over enqueue ranks, where a one marks an item still in the queue.
+    // In the beginning all items are in the queue, and a tree of only ones has lowbit(i) in every node.
+    // TODO: For stacks we can't do this offline like this, but rather add and remove things online
+    size_t* fenwick = (size_t*) malloc((tot_put + 1) * sizeof(size_t));
+    if (fenwick == NULL) {
+        fprintf(stderr, "Memory allocation failed for relaxation fenwick tree\n");
+        exit(1);
+    }
+    for (size_t i = 1; i <= tot_put; i += 1)
+    {
+        fenwick[i] = i & -i;
+    }
 
-    // For every dequeue, search the queue from the head for the dequeued item. Follow pointers to only search items not already dequeued
+    // For every dequeue, the rank error is the number of items enqueued before it which are still in the queue
     for (size_t deq_ind = 0; deq_ind < tot_get; deq_ind += 1)
     {
-        sval_t key = combined_get_stamps[deq_ind].value;
+        size_t rank = get_ranks[deq_ind];
 
-        uint64_t rank_error;
-        if (head->value == key)
+        uint64_t rank_error = 0;
+        for (size_t i = rank; i > 0; i -= i & -i)
         {
-            head = head->next;
-            rank_error = 0;
+            rank_error += fenwick[i];
         }
-        else
+        for (size_t i = rank + 1; i <= tot_put; i += i & -i)
         {
-            rank_error = 1;
-            struct item_list *current = head;
-            while (current->next->value != key)
-            {
-                current = current->next;
-                rank_error += 1;
-                if (current->next == NULL)
-                {
-                    perror("Out of bounds on finding matching relaxation enqueue\n");
-                    printf("%zu\n", deq_ind);
-                    exit(-1);
-                }
-            }
-
-            // current->next has the removed item, so just unlink it from the data structure
-            current->next = current->next->next;
+            fenwick[i] -= 1;
         }
 
         // Store rank error in get_stamps for variance calculation
@@ -358,6 +1124,9 @@ void print_relaxation_measurements(int nbr_threads)
         rank_error_sum += rank_error;
         if (rank_error > rank_error_max) rank_error_max = rank_error;
     }
+    free(fenwick);
+    free(get_ranks);
+#endif
 
     long double rank_error_mean = (long double) rank_error_sum / (long double) tot_get;
     if (tot_get == 0) rank_error_mean = 0.0;
@@ -366,17 +1135,16 @@ void print_relaxation_measurements(int nbr_threads)
 
     // Find variance
     long double rank_error_variance = 0;
-    for (size_t deq_ind; deq_ind < tot_get; deq_ind += 1)
+    for (size_t deq_ind = 0; deq_ind < tot_get; deq_ind += 1)
     {
         long double off = (long double) combined_get_stamps[deq_ind].value - rank_error_mean;
         rank_error_variance += off*off;
     }
-    rank_error_variance /= tot_get - 1;
+    if (tot_get > 1) rank_error_variance /= tot_get - 1;
 
     printf("variance_relaxation , %.4Lf\n", rank_error_variance);
 
     // Free everything used, as well as all earlier used relaxation analysis things
-    free(item_list);
     free(combined_get_stamps);
     free(combined_put_stamps);
     destoy_relaxation_analysis_all(nbr_threads);
@@ -3,6 +3,7 @@
 
 #include "common.h"
 #include <stdint.h>
+#include <stdio.h>
 #include <time.h>
 #include <sys/time.h>
 
@@ -10,16 +11,57 @@
 // This should be set experimentally, but we probably can't handle too large values
 #define MAX_RELAX_COUNTS 1e8
 
+// Largest cpu id with its own TSC offset
+#define TSC_MAX_CPUS 4096
+
+// The TSC source is only available on x86-64
+#if defined(RELAXATION_TIMESTAMP_TSC) && !defined(__x86_64__)
+#undef RELAXATION_TIMESTAMP_TSC
+#endif
+
 // The record for a single operation
 typedef struct relax_stamp {
     uint64_t timestamp;
     sval_t value;
 } relax_stamp_t;
 
+// Saved timestamp files (SAVE_TIMESTAMPS / SAVE_THREAD_STAMPS) are binary unless SAVE_TIMESTAMPS_TEXT is set.
+// A binary file is a header followed by one record per stamp, holding the zigzag varint encoded differences
+// to the timestamp and value of the previous stamp (starting from 0). scripts/relaxation_stamps.py reads them.
+#define RELAX_STAMP_FILE_MAGIC "RLXSTAMP"
+#define RELAX_STAMP_FILE_VERSION 1
+#ifdef SAVE_TIMESTAMPS_TEXT
+#define RELAX_STAMP_FILE_EXT ".txt"
+#else
+#define RELAX_STAMP_FILE_EXT ".bin"
+#endif
+
+typedef struct relax_stamp_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t count;
+    uint64_t payload_size;
+} relax_stamp_file_header_t;
+
+typedef struct relax_stamp_writer {
+    FILE* file;
+    int fd;
+    uint8_t* map;
+    size_t capacity;
+    size_t offset;
+    uint64_t count;
+    uint64_t prev_timestamp;
+    sval_t prev_value;
+} relax_stamp_writer_t;
+
 
 // Shared functions
 
-// Get a timestamp from the realtime clock, shared accross processors
+// Get a timestamp, comparable accross processors. The source is chosen at compile time:
+// RELAXATION_TIMESTAMP_TSC reads the TSC (in ticks, with per-socket offsets measured at startup)
+// and falls back to CLOCK_MONOTONIC_RAW if it is not invariant, RELAXATION_TIMESTAMP_MONOTONIC
+// reads CLOCK_MONOTONIC_RAW, and otherwise CLOCK_REALTIME is read.
 uint64_t get_timestamp();
 
 // Add a put operation of a value with its timestamp
@@ -37,6 +79,18 @@ void init_relaxation_analysis_local(int thread_id);
 // de-init all memory for all threads
 void destoy_relaxation_analysis_all(int nbr_threads);
 
+// Open a timestamp file for writing at most max_count stamps
+void open_stamp_writer(relax_stamp_writer_t* writer, const char* path, size_t max_count);
+
+// Append a stamp to a timestamp file
+void write_stamp(relax_stamp_writer_t* writer, uint64_t timestamp, sval_t value);
+
+// Finish and close a timestamp file
+void close_stamp_writer(relax_stamp_writer_t* writer);
+
+// Read a binary timestamp file, returns NULL if it can't be read
+relax_stamp_t* load_relaxed_stamps(const char* path, size_t* count_out);
+
 // Print the stats from the relaxation measurement
 void print_relaxation_measurements(int nbr_threads);
 
@@ -0,0 +1,315 @@
+#ifndef _TOPOLOGY_H_
+	#define _TOPOLOGY_H_
+
+	#include <dirent.h>
+	#include <pthread.h>
+	#include <sched.h>
+	#include <stdio.h>
+	#include <stdlib.h>
+	#include <string.h>
+
+	/* ################################################################### *
+	 * THREAD PINNING FROM THE SYSFS TOPOLOGY
+	 * ################################################################### */
+
+	/*
+	 * By default set_cpu() pins thread i to the_cores[i], from the machine tables in utils.h.
+	 * After set_pin_policy() with one of the policies below, it instead pins thread i to the i:th
+	 * hardware thread in an order built from /sys/devices/system/cpu/cpu<N>/topology, using only
+	 * the cpus the process was allowed to run on at startup:
+	 *   compact-cores-first: fill one socket at a time, using every core before any SMT sibling
+	 *   scatter-sockets:     round robin over the sockets, using every core before any SMT sibling
+	 *   smt-last:            fill every core on all sockets, one socket at a time, before any SMT sibling
+	 * The policy is kept per translation unit, so it should be set where the benchmark parses its flags.
+	 */
+
+	typedef enum pin_policy
+	{
+		PIN_TABLE,
+		PIN_COMPACT_CORES_FIRST,
+		PIN_SCATTER_SOCKETS,
+		PIN_SMT_LAST,
+	} pin_policy_t;
+
+	typedef struct hw_thread
+	{
+		int cpu;
+		int socket;
+		int node;
+		int core;
+		int smt;	// Index among the SMT siblings of the core
+		int rank;	// Index within the socket, when using every core before any SMT sibling
+	} hw_thread_t;
+
+	static pin_policy_t __attribute__ ((unused)) pin_policy = PIN_TABLE;
+	static hw_thread_t* __attribute__ ((unused)) pin_order = NULL;
+	static int __attribute__ ((unused)) pin_order_len = 0;
+	static cpu_set_t __attribute__ ((unused)) pin_allowed;
+
+	// The benchmarks pin the main thread before parsing their flags, so remember the original mask
+	static void __attribute__ ((constructor, unused)) save_allowed_cpus(void)
+	{
+		if (sched_getaffinity(0, sizeof(cpu_set_t), &pin_allowed) != 0)
+		{
+			CPU_ZERO(&pin_allowed);
+		}
+	}
+
+	// Reads an integer from a sysfs file, path is a format string for the cpu number. -1 on failure.
+	static inline int topology_read_int(const char* format, int cpu)
+	{
+		char path[128];
+		int val = -1;
+		snprintf(path, sizeof(path), format, cpu);
+		FILE* file = fopen(path, "r");
+		if (file == NULL)
+		{
+			return -1;
+		}
+		if (fscanf(file, "%d", &val) != 1)
+		{
+			val = -1;
+		}
+		fclose(file);
+		return val;
+	}
+
+	// Position of cpu in a sysfs cpu list such as "0-3,8-11", or -1 if it isn't there
+	static inline int topology_list_index(const char* format, int cpu)
+	{
+		char path[128], list[1024];
+		char* pos = list;
+		int index = 0;
+		snprintf(path, sizeof(path), format, cpu);
+		FILE* file = fopen(path, "r");
+		if (file == NULL)
+		{
+			return -1;
+		}
+		if (fgets(list, sizeof(list), file) == NULL)
+		{
+			fclose(file);
+			return -1;
+		}
+		fclose(file);
+
+		while (*pos != '\0' && *pos != '\n')
+		{
+			char* end;
+			int first = strtol(pos, &end, 10);
+			int last = first;
+			if (*end == '-')
+			{
+				last = strtol(end + 1, &end, 10);
+			}
+			if (cpu >= first && cpu <= last)
+			{
+				return index + cpu - first;
+			}
+			index += last - first + 1;
+			pos = *end == ',' ? end + 1 : end;
+			if (pos == end && *end != '\0' && *end != '\n')
+			{
+				break;
+			}
+		}
+		return -1;
+	}
+
+	// The NUMA node of a cpu, from its /sys/devices/system/cpu/cpu<N>/node<M> link
+	static inline int topology_node(int cpu)
+	{
+		char path[128];
+		struct dirent* entry;
+		int node = 0;
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+		DIR* dir = opendir(path);
+		if (dir == NULL)
+		{
+			return 0;
+		}
+		while ((entry = readdir(dir)) != NULL)
+		{
+			if (strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9')
+			{
+				node = atoi(entry->d_name + 4);
+				break;
+			}
+		}
+		closedir(dir);
+		return node;
+	}
+
+	// Number of NUMA nodes, from /sys/devices/system/node/online, or 1 if it can't be read
+	static inline int topology_node_count()
+	{
+		char list[256];
+		char* last;
+		FILE* file = fopen("/sys/devices/system/node/online", "r");
+		if (file == NULL)
+		{
+			return 1;
+		}
+		if (fgets(list, sizeof(list), file) == NULL)
+		{
+			fclose(file);
+			return 1;
+		}
+		fclose(file);
+
+		// The list is sorted, so the highest node is the last number
+		last = list + strlen(list);
+		while (last > list && (last[-1] < '0' || last[-1] > '9'))
+		{
+			last--;
+		}
+		while (last > list && last[-1] >= '0' && last[-1] <= '9')
+		{
+			last--;
+		}
+		return atoi(last) + 1;
+	}
+
+	static int compare_compact(const void* a, const void* b)
+	{
+		const hw_thread_t* x = (const hw_thread_t*) a;
+		const hw_thread_t* y = (const hw_thread_t*) b;
+		if (x->socket != y->socket) return x->socket - y->socket;
+		if (x->smt != y->smt) return x->smt - y->smt;
+		if (x->core != y->core) return x->core - y->core;
+		return x->cpu - y->cpu;
+	}
+
+	static int compare_scatter(const void* a, const void* b)
+	{
+		const hw_thread_t* x = (const hw_thread_t*) a;
+		const hw_thread_t* y = (const hw_thread_t*) b;
+		if (x->rank != y->rank) return x->rank - y->rank;
+		return x->socket - y->socket;
+	}
+
+	static int compare_smt_last(const void* a, const void* b)
+	{
+		const hw_thread_t* x = (const hw_thread_t*) a;
+		const hw_thread_t* y = (const hw_thread_t*) b;
+		if (x->smt != y->smt) return x->smt - y->smt;
+		return compare_compact(a, b);
+	}
+
+	// Builds pin_order for pin_policy, returns the number of hardware threads found
+	static inline int init_pin_order()
+	{
+		int cpu, i;
+
+		free(pin_order);
+		pin_order = (hw_thread_t*) malloc(CPU_COUNT(&pin_allowed) * sizeof(hw_thread_t));
+		pin_order_len = 0;
+		if (pin_order == NULL)
+		{
+			return 0;
+		}
+
+		for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+		{
+			if (!CPU_ISSET(cpu, &pin_allowed))
+			{
+				continue;
+			}
+			hw_thread_t* thread = &pin_order[pin_order_len];
+			thread->cpu = cpu;
+			thread->socket = topology_read_int("/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+			thread->core = topology_read_int("/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+			thread->smt = topology_list_index("/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", cpu);
+			thread->node = topology_node(cpu);
+			if (thread->socket < 0 || thread->core < 0 || thread->smt < 0)
+			{
+				// No usable topology, so treat every cpu as its own core
+				thread->socket = 0;
+				thread->core = cpu;
+				thread->smt = 0;
+			}
+			pin_order_len++;
+		}
+
+		// Rank the hardware threads within each socket, every core before any SMT sibling
+		qsort(pin_order, pin_order_len, sizeof(hw_thread_t), compare_compact);
+		for (i = 0; i < pin_order_len; i++)
+		{
+			pin_order[i].rank = (i > 0 && pin_order[i - 1].socket == pin_order[i].socket) ? pin_order[i - 1].rank + 1 : 0;
+		}
+
+		if (pin_policy == PIN_SCATTER_SOCKETS)
+		{
+			qsort(pin_order, pin_order_len, sizeof(hw_thread_t), compare_scatter);
+		}
+		else if (pin_policy == PIN_SMT_LAST)
+		{
+			qsort(pin_order, pin_order_len, sizeof(hw_thread_t), compare_smt_last);
+		}
+
+		return pin_order_len;
+	}
+
+	static inline void set_pin_policy(const char* name)
+	{
+		if (strcmp(name, "table") == 0)
+		{
+			pin_policy = PIN_TABLE;
+			return;
+		}
+		else if (strcmp(name, "compact-cores-first") == 0)
+		{
+			pin_policy = PIN_COMPACT_CORES_FIRST;
+		}
+		else if (strcmp(name, "scatter-sockets") == 0)
+		{
+			pin_policy = PIN_SCATTER_SOCKETS;
+		}
+		else if (strcmp(name, "smt-last") == 0)
+		{
+			pin_policy = PIN_SMT_LAST;
+		}
+		else
+		{
+			fprintf(stderr, "Unknown pinning policy %s, use compact-cores-first, scatter-sockets, smt-last or table\n", name);
+			exit(1);
+		}
+
+		if (init_pin_order() == 0)
+		{
+			fprintf(stderr, "Could not read the cpu topology, pinning with the machine table\n");
+			pin_policy = PIN_TABLE;
+		}
+	}
+
+	// Pins the calling thread with pin_order, threads beyond the hardware threads are not pinned
+	static inline void set_cpu_topology(int thread)
+	{
+		if (thread >= pin_order_len)
+		{
+			return;
+		}
+
+		cpu_set_t mask;
+		CPU_ZERO(&mask);
+		CPU_SET(pin_order[thread].cpu, &mask);
+		#if defined(PLATFORM_NUMA)
+			numa_set_preferred(pin_order[thread].node);
+		#endif
+		if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &mask) != 0)
+		{
+			fprintf(stderr, "Error setting thread affinity\n");
+		}
+	}
+
+	// Writes the hardware thread order as "cpu socket/core/smt" pairs, to check a policy on a new machine
+	static inline void print_pin_order(FILE* out)
+	{
+		int i;
+		for (i = 0; i < pin_order_len; i++)
+		{
+			fprintf(out, "%s%d (%d/%d/%d)", i ? ", " : "", pin_order[i].cpu, pin_order[i].socket, pin_order[i].core, pin_order[i].smt);
+		}
+		fprintf(out, "\n");
+	}
+#endif	/* _TOPOLOGY_H_ */
@@ -44,6 +44,7 @@
 	#include "measurements.h"
 	#include "ssalloc.h"
 	#include "atomic_ops_if.h"
+	#include "topology.h"
 
 
 	#ifdef __cplusplus
@@ -915,6 +916,12 @@
 						tmc_task_die("tmc_cpus_set_my_cpu() failed.");
 					}
 				#else
+					// Pinning policy from the sysfs topology, see topology.h
+					if (pin_policy != PIN_TABLE)
+					{
+						set_cpu_topology(cpu);
+						return;
+					}
 					int n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
 					//    cpu %= (NUMBER_OF_SOCKETS * CORES_PER_SOCKET);
 					if (cpu < n_cpus)
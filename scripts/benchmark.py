@@ -56,6 +56,10 @@ RENAME_MAP = {
     'dcbl-lcrq': 'LCRQ d-CBL',
     'dcbl-wfqueue': 'WFQ d-CBL',
     'dcbl-ms': 'MS d-CBL',
+    'numa-dcbo-faaaq': 'FAAArrayQueue NUMA d-CBO',
+    'numa-dcbo-lcrq': 'LCRQ NUMA d-CBO',
+    'numa-dcbo-wfqueue': 'WFQ NUMA d-CBO',
+    'numa-dcbo-ms': 'MS NUMA d-CBO',
     'simple-dcbo-faaaq': 'FAAArrayQueue Simple d-CBO',
     'simple-dcbo-lcrq': 'LCRQ Simple d-CBO',
     'simple-dcbo-wfqueue': 'WFQ Simple d-CBO',
@@ -595,6 +599,8 @@ def new_bench(args):
         '-s': args.side_work,
         '-m': args.mode,
         '-c': args.choice,
+        '-N': args.numa_nodes,
+        '-L': args.remote_percent,
     }
 
     for (key, value) in static_args.copy().items():
@@ -682,6 +688,10 @@ def parse_args():
                         help='How much side work to do between accesses')
     parser.add_argument('--choice', '-c', type=int,
                         help='How many partial queues to sample in c-choice load balancers')
+    parser.add_argument('--numa_nodes', '-N', type=int,
+                        help='How many NUMA partitions to split the sub-queues into in numa-dcbo-* queues')
+    parser.add_argument('--remote_percent', '-L', type=int,
+                        help='Percentage of samples drawn from all sub-queues instead of the local partition in numa-dcbo-* queues')
     # TODO Add some extra arguments maybe? Some testr might want extra ones.
 
     parser.add_argument('--errors',
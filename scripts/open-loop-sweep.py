@@ -0,0 +1,144 @@
+import argparse
+import subprocess
+import re
+import json
+
+from os import environ
+from pathlib import Path
+from datetime import datetime
+
+# Finds the highest rate every data structure sustains in the open-loop workload (WORKLOAD=5), where
+# a rate is sustained if the operations keep up with it and their p99 latency, measured from the
+# intended start of the operations, stays below the target.
+
+
+def get_root_path():
+    return Path(__file__).parent.parent
+
+
+def compile(structs, args):
+    my_env = environ.copy()
+    my_env["WORKLOAD"] = "5"
+    if args.ndebug:
+        my_env["VERSION"] = 'O4'
+
+    for struct in structs:
+        try:
+            subprocess.check_output(['make', f'{struct}'], env=my_env)
+        except Exception as e:
+            exit(e)
+
+
+def run_rate(struct, rate, args):
+    # Runs the test at a total rate, returning the p99 latency in ns and the achieved rate
+    arg_list = [get_root_path() / 'bin' / struct,
+                '-n', str(args.threads),
+                '-d', str(args.duration),
+                '-i', str(args.initial),
+                '-R', str(rate / args.threads)]
+    if args.poisson:
+        arg_list.append('-O')
+    for extra in args.extra:
+        arg_list += extra.split()
+
+    test_out = subprocess.check_output(
+        arg_list, timeout=args.test_timeout).decode('utf8')
+    all_row = re.search(r"^all\s+(\d+)\s+(\d+)\s+(\d+)\s+(\d+)", test_out, re.MULTILINE)
+    if not all_row:
+        exit(f"could not parse the open-loop latencies in \n{test_out} when running {arg_list}")
+
+    achieved = int(all_row.group(1)) * 1000.0 / args.duration
+    p99 = float(all_row.group(4))
+    return p99, achieved
+
+
+def sustained(struct, rate, args):
+    # The median run decides, as a single preempted run can spoil the p99
+    runs = sorted((run_rate(struct, rate, args) for _ in range(args.runs)), key=lambda r: r[0])
+    p99, achieved = runs[len(runs) // 2]
+    ok = p99 <= args.p99 and achieved >= args.keep_up * rate
+    print(f"{struct:24} rate {rate:14.0f}  achieved {achieved:14.0f}  p99 {p99:10.0f} ns  {'ok' if ok else 'over'}")
+    return ok
+
+
+def max_rate(struct, args):
+    # Doubles the rate until it is not sustained, and then bisects down to the precision
+    low = 0
+    high = args.start
+    while sustained(struct, high, args):
+        low = high
+        high *= 2
+        if high > args.max:
+            return low
+
+    while low == 0 or high / low > 1 + args.precision:
+        mid = (low + high) / 2 if low else high / 2
+        if mid < 1:
+            return 0
+        if sustained(struct, mid, args):
+            low = mid
+        else:
+            high = mid
+    return low
+
+
+def main(args):
+    if not args.no_compile:
+        compile(args.structs, args)
+
+    results = {}
+    for struct in args.structs:
+        results[struct] = max_rate(struct, args)
+
+    print("\nMax sustainable rate (ops/s) at a p99 of", args.p99, "ns")
+    for struct, rate in results.items():
+        print(f"{struct:24} {rate:14.0f}")
+
+    if not args.nosave:
+        path = get_root_path() / 'results' / 'open-loop' / datetime.now().strftime("%Y-%m-%d_%H-%M-%S")
+        path.mkdir(parents=True, exist_ok=True)
+        with open(path / 'sweep.json', 'w') as f:
+            json.dump({'args': vars(args), 'max_rate': results}, f, indent=2)
+        print("Saved in", path)
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description='Find the highest rate the data structures sustain at a p99 latency target in the open-loop workload')
+    parser.add_argument('structs', nargs='+',
+                        help='The data structures to test, such as dcbo-ms ms')
+    parser.add_argument('--threads', '-n', default=1, type=int,
+                        help='Number of threads, which share the rate evenly')
+    parser.add_argument('--p99', default=10000, type=float,
+                        help='The p99 latency target in ns')
+    parser.add_argument('--keep-up', default=0.95, type=float,
+                        help='The fraction of the rate the operations have to achieve')
+    parser.add_argument('--start', default=100000, type=float,
+                        help='The first total rate in operations per second')
+    parser.add_argument('--max', default=1e9, type=float,
+                        help='The highest total rate to test')
+    parser.add_argument('--precision', default=0.05, type=float,
+                        help='The relative precision of the found rate')
+    parser.add_argument('--duration', '-d', default=1000, type=int,
+                        help='Duration of every run in ms')
+    parser.add_argument('--initial', default=2**17, type=int,
+                        help='Initial number of items')
+    parser.add_argument('--runs', default=3, type=int,
+                        help='Runs at every rate, of which the median p99 decides')
+    parser.add_argument('--poisson', action='store_true',
+                        help='Start the operations as a Poisson process instead of evenly spaced')
+    parser.add_argument('--extra', action='append', default=[],
+                        help='Extra arguments to the tests, such as --extra="-w 16 -c 2"')
+    parser.add_argument('--test_timeout', type=int, default=60,
+                        help='Timeout of every run in seconds')
+    parser.add_argument('--ndebug', action='store_true',
+                        help='Compile with VERSION=O4')
+    parser.add_argument('--no_compile', action='store_true',
+                        help='Use the already compiled WORKLOAD=5 binaries')
+    parser.add_argument('--nosave', action='store_true',
+                        help='Do not save the results in results/open-loop')
+    return parser.parse_args()
+
+
+if __name__ == '__main__':
+    main(parse_args())
@@ -3,7 +3,7 @@
 # Variables and tests for running shorter than the real paper
 nbr_threads=256             # Set to the number of threads you want to use
 duration=500                # Reducing more will not have that big an effect, as the setup time is not included here
-relaxation_duration=100     # Computing relaxation after a run is slow, so to speed up experiments, we can reduce the time these tests run
+relaxation_duration=$duration # Relaxation runs can be shortened to speed up experiments, but are measured at full length by default
 runs=1                      # When set to 1, only runs one run for each data point in scalability experiments
 step=$((nbr_threads / 4))   # Decrease this to get a more detailed plot
 
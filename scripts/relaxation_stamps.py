@@ -0,0 +1,127 @@
+import argparse
+import struct
+import sys
+
+from pathlib import Path
+
+# Must match relax_stamp_file_header_t in include/relaxation_analysis_timestamps.h
+MAGIC = b"RLXSTAMP"
+VERSION = 1
+HEADER = struct.Struct("<8sIIQQ")
+
+
+def zigzag_decode(val):
+    return (val >> 1) ^ -(val & 1)
+
+
+def load_stamps(path):
+    """
+    Reads a timestamp file saved with SAVE_TIMESTAMPS or SAVE_THREAD_STAMPS.
+
+    Binary files (.bin) are a header followed by zigzag varint encoded deltas of the
+    timestamps and values, while text files (.txt) have one "timestamp value" pair per line.
+    Returns a list of timestamps and a list of values.
+    """
+    path = Path(path)
+    timestamps = []
+    values = []
+
+    if path.suffix == ".txt":
+        with open(path) as f:
+            for line in f:
+                if line.strip():
+                    stamp, value = line.split()
+                    timestamps.append(int(stamp))
+                    values.append(int(value))
+        return timestamps, values
+
+    data = path.read_bytes()
+    magic, version, header_size, count, payload_size = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError(f"{path} is not a version {VERSION} timestamp file")
+    if header_size + payload_size > len(data):
+        raise ValueError(f"{path} is truncated")
+
+    pos = header_size
+    deltas = [0, 0]
+    timestamp = 0
+    value = 0
+    for _ in range(count):
+        for i in range(2):
+            res = 0
+            shift = 0
+            while True:
+                byte = data[pos]
+                pos += 1
+                res |= (byte & 0x7F) << shift
+                if byte < 0x80:
+                    break
+                shift += 7
+            deltas[i] = zigzag_decode(res)
+        timestamp = (timestamp + deltas[0]) & 0xFFFFFFFFFFFFFFFF
+        value = (value + deltas[1] + 2**63) % 2**64 - 2**63
+        timestamps.append(timestamp)
+        values.append(value)
+
+    return timestamps, values
+
+
+def rank_errors(put_values, get_values):
+    """
+    The rank error of every dequeue, as the number of earlier enqueued items still in the queue.
+    Same as print_relaxation_measurements, if a value is enqueued several times
+    the k:th dequeue of it matches the k:th enqueue of it.
+    """
+    ranks = {}
+    for rank, value in enumerate(put_values):
+        ranks.setdefault(value, []).append(rank)
+    for value in ranks:
+        ranks[value].reverse()
+
+    n = len(put_values)
+    fenwick = [0] + [i & -i for i in range(1, n + 1)]
+    errors = []
+    for value in get_values:
+        rank = ranks[value].pop()
+        error = 0
+        i = rank
+        while i > 0:
+            error += fenwick[i]
+            i -= i & -i
+        i = rank + 1
+        while i <= n:
+            fenwick[i] -= 1
+            i += i & -i
+        errors.append(error)
+    return errors
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Read timestamp files saved by RELAXATION_ANALYSIS=TIMER runs")
+    parser.add_argument('files', type=Path, nargs='+',
+                        help='Timestamp files to read')
+    parser.add_argument('--text', action='store_true',
+                        help='Print the stamps as "timestamp value" lines')
+    parser.add_argument('--rank-error', action='store_true',
+                        help='Given a put and a get file, print the rank error statistics')
+    args = parser.parse_args()
+
+    if args.rank_error:
+        if len(args.files) != 2:
+            sys.exit("--rank-error needs a put file and a get file")
+        _, put_values = load_stamps(args.files[0])
+        _, get_values = load_stamps(args.files[1])
+        errors = rank_errors(put_values, get_values)
+        mean = sum(errors) / len(errors) if errors else 0.0
+        variance = sum((e - mean)**2 for e in errors) / (len(errors) - 1) if len(errors) > 1 else 0.0
+        print(f"mean_relaxation , {mean:.4f}")
+        print(f"max_relaxation , {max(errors, default=0)}")
+        print(f"variance_relaxation , {variance:.4f}")
+    else:
+        for path in args.files:
+            timestamps, values = load_stamps(path)
+            if args.text:
+                for stamp, value in zip(timestamps, values):
+                    print(f"{stamp} {value}")
+            else:
+                print(f"{path}: {len(timestamps)} stamps")
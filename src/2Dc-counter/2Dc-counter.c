@@ -95,11 +95,6 @@ counter_t* create_counter(size_t num_threads, uint64_t width, uint64_t depth, ui
 	}
 	/*************************************************************/
 
-	/*initialise window*/
-	global_Window.content.max = depth;
-	global_Window.content.version = 0;
-	/*******************/
-
 #ifdef RELAXATION_ANALYSIS
 	init_relaxation_analysis();
 #endif
@@ -109,6 +104,11 @@ counter_t* create_counter(size_t num_threads, uint64_t width, uint64_t depth, ui
 		perror("malloc");
 		exit(1);
     }
+
+	/*initialise window*/
+	set->Window.content.max = depth;
+	set->Window.content.version = 0;
+	/*******************/
 	set->set_array = (index_t*)calloc(width, sizeof(index_t)); //ssalloc(width);
 	set->width = width;
 	set->depth = depth;
@@ -156,15 +156,16 @@ static inline char counter_cae(volatile descriptor_t* desc_loc, descriptor_t* de
 #endif
 }
 
-uint64_t increment(counter_t *set)
+uint64_t increment(counter_handle_t* handle)
 {
+	counter_t* set = handle->set;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
 	while(1)
 	{
-		descriptor = put_window(set,contention);
+		descriptor = put_window(handle, contention);
 		new_descriptor.count = descriptor.count + 1;
-		if(counter_cae(&set->set_array[thread_index].descriptor,&descriptor,&new_descriptor, set))
+		if(counter_cae(&set->set_array[handle->window.index].descriptor,&descriptor,&new_descriptor, set))
 		{
 			#if VALIDATESIZE==1
 				return 1;
@@ -181,17 +182,18 @@ uint64_t increment(counter_t *set)
 	}
 }
 
-uint64_t decrement(counter_t *set)
+uint64_t decrement(counter_handle_t* handle)
 {
+	counter_t* set = handle->set;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
 	while (1)
     {
-		descriptor = get_window(set, contention);
+		descriptor = get_window(handle, contention);
 		if(descriptor.count > 0)
 		{
 			new_descriptor.count = descriptor.count - 1;
-			if(counter_cae(&set->set_array[thread_index].descriptor,&descriptor,&new_descriptor, set))
+			if(counter_cae(&set->set_array[handle->window.index].descriptor,&descriptor,&new_descriptor, set))
 			{
 				#if VALIDATESIZE==1
 					return 1;
@@ -227,7 +229,7 @@ size_t counter_size(counter_t *set)
 	return size;
 }
 
-counter_t* counter_register(counter_t *set, int thread_id)
+counter_handle_t* counter_register(counter_t *set, int thread_id)
 {
     ssalloc_init();
 	#if GC == 1
@@ -239,5 +241,14 @@ counter_t* counter_register(counter_t *set, int thread_id)
     }
 	#endif
 
-    return set;
+	counter_handle_t* handle;
+	if ((handle = (counter_handle_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(counter_handle_t))) == NULL)
+	{
+		perror("malloc");
+		exit(1);
+	}
+	handle->set = set;
+	initialize_thread_window(&handle->window);
+
+    return handle;
 }
\ No newline at end of file
@@ -13,6 +13,7 @@
 #include "lock_if.h"
 #include "ssmem.h"
 #include "utils.h"
+#include "2Dc-window.h"
 
  /* ################################################################### *
 	* Definition of macros: per data structure
@@ -26,7 +27,7 @@
 #define DS_REGISTER(s,i)    counter_register(s,i)
 
 #define DS_TYPE             counter_t
-#define DS_HANDLE           counter_t*
+#define DS_HANDLE           counter_handle_t*
 #define DS_NODE             index_t
 
 /* Type definitions */
@@ -50,8 +51,18 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct counter
 	uint64_t relaxation_bound;
 	uint8_t k_mode;
 	uint8_t padding[CACHE_LINE_SIZE - sizeof(uint8_t) -  sizeof(index_t*) - (sizeof(int64_t)*5)];
+
+	// The global window, in its own cache line
+	volatile padded_window_t Window;
 } counter_t;
 
+// Per-thread handle, returned by DS_REGISTER
+typedef struct counter_handle
+{
+	counter_t* set;
+	thread_window_t window;
+} counter_handle_t;
+
 /*Global variables*/
 
 
@@ -80,10 +91,10 @@ extern __thread unsigned long my_hop_count;
 extern __thread unsigned long my_slide_count;
 
 /* Interfaces */
-uint64_t increment(counter_t *set);
-uint64_t decrement(counter_t *set);
+uint64_t increment(counter_handle_t* handle);
+uint64_t decrement(counter_handle_t* handle);
 counter_t* create_counter(size_t num_threads, uint64_t width, uint64_t depth, uint8_t k_mode, uint64_t relaxation_bound);
-counter_t* counter_register(counter_t *set, int thread_id);
+counter_handle_t* counter_register(counter_t *set, int thread_id);
 size_t counter_size(counter_t *set);
 int floor_log_2(unsigned int n);
 
@@ -188,10 +188,12 @@ void* test(void* thread)
 	RETRY_STATS_ZERO();
 	barrier_cross(&barrier_global);
 	RR_START_SIMPLE();
+	PERF_COUNTERS_START();
 	while (stop == 0)
     {
 		COUNTER_LOOP_ONLY_UPDATES();
 	}
+	PERF_COUNTERS_STOP();
 	barrier_cross(&barrier);
 	RR_STOP_SIMPLE();
 	if (!thread_id)
@@ -253,6 +255,7 @@ int main(int argc, char **argv)
 		{"num-buckets",               required_argument, NULL, 'b'},
 		{"print-vals",                required_argument, NULL, 'v'},
 		{"vals-pf",                   required_argument, NULL, 'f'},
+		{"pin",                       required_argument, NULL, 'P'},
 		{NULL, 0, NULL, 0}
 	};
 
@@ -260,7 +263,7 @@ int main(int argc, char **argv)
 	while(1)
     {
 		i = 0;
-		c = getopt_long(argc, argv, "hAf:d:i:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:", long_options, &i);
+		c = getopt_long(argc, argv, "hAf:d:i:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:P:", long_options, &i);
 		if(c == -1)
 		break;
 		if(c == 0 && long_options[i].flag == 0)
@@ -308,6 +311,8 @@ int main(int argc, char **argv)
 			"        Fixed Width or Width to thread ratio depending on the k-mode.\n"
 			"  -m, --K Mode <int>\n"
 			"        0 for Fixed Width and Depth, 1 for Fixed Width, 2 for fixed Depth, 3 for fixed Width to thread ratio.\n"
+			"  -P, --pin <policy>\n"
+			"        Pin threads from the sysfs topology: compact-cores-first, scatter-sockets, smt-last or table [DEFAULT=table].\n"
 			, argv[0]);
 			exit(0);
 			case 'd':
@@ -351,6 +356,9 @@ int main(int argc, char **argv)
 			if(atoi(optarg)<=3) k_mode = atoi(optarg);
 			break;
 			break;
+			case 'P':
+			set_pin_policy(optarg);
+			break;
 			case '?':
 			default:
 			printf("Use -h or --help for help\n");
@@ -524,7 +532,7 @@ int main(int argc, char **argv)
 		long unsigned put_fal = (putting_count_total - putting_count_total_succ) ? putting_fal_total / (putting_count_total - putting_count_total_succ) : 0;
 		long unsigned rem_suc = removing_count_total_succ ? removing_suc_total / removing_count_total_succ : 0;
 		long unsigned rem_fal = (removing_count_total - removing_count_total_succ) ? removing_fal_total / (removing_count_total - removing_count_total_succ) : 0;
-		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, get_suc, get_fal, put_suc, put_fal, rem_suc, rem_fal);
+		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, 0LU, 0LU, put_suc, put_fal, rem_suc, rem_fal);
 	#endif
 
 	#define LLU long long unsigned int
@@ -565,6 +573,7 @@ int main(int argc, char **argv)
 	RR_PRINT_CORRECTED();
 	RETRY_STATS_PRINT(total, putting_count_total, removing_count_total, putting_count_total_succ + removing_count_total_succ);
 	LATENCY_DISTRIBUTION_PRINT();
+	PERF_COUNTERS_PRINT(putting_count_total + removing_count_total);
 
 	printf("Push_CAS_fails , %zu\n", put_cas_fail_count_total);
 	printf("Pop_CAS_fails , %zu\n", get_cas_fail_count_total);
@@ -13,6 +13,7 @@
 #include "lock_if.h"
 #include "ssmem.h"
 #include "utils.h"
+#include "2Dc-window.h"
 
  /* ################################################################### *
 	* Definition of macros: per data structure
@@ -25,7 +26,7 @@
 #define DS_REGISTER(s,i)    register_stack(s,i)
 
 #define DS_TYPE             mstack_t
-#define DS_HANDLE           mstack_t*
+#define DS_HANDLE           mstack_handle_t*
 #define DS_NODE             node_t
 
 /* Type definitions */
@@ -59,8 +60,18 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct mstack_file
 	uint64_t relaxation_bound;
 	uint8_t k_mode;
 	uint8_t padding[CACHE_LINE_SIZE - sizeof(uint8_t) -  sizeof(index_t*) - (sizeof(int64_t)*5)];
+
+	// The global window, in its own cache line
+	volatile padded_window_t Window;
 } mstack_t;
 
+// Per-thread handle, returned by DS_REGISTER
+typedef struct mstack_handle
+{
+	mstack_t* set;
+	thread_window_t window;
+} mstack_handle_t;
+
 /*Global variables*/
 
 
@@ -76,10 +87,10 @@ extern __thread unsigned long my_slide_count;
 extern __thread unsigned long my_slide_fail_count;
 
 /* Interfaces */
-int push(mstack_t *set, skey_t key, sval_t val);
-sval_t pop(mstack_t *set);
+int push(mstack_handle_t* handle, skey_t key, sval_t val);
+sval_t pop(mstack_handle_t* handle);
 node_t* create_node(skey_t key, sval_t val, node_t* next);
 mstack_t* create_stack(size_t num_threads, uint64_t width, uint64_t depth, uint8_t k_mode, uint64_t relaxation_bound);
-mstack_t* register_stack(mstack_t *set, int thread_id);
+mstack_handle_t* register_stack(mstack_t *set, int thread_id);
 size_t stack_size(mstack_t *set);
 int floor_log_2(unsigned int n);
\ No newline at end of file
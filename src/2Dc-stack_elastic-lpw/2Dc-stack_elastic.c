@@ -112,8 +112,6 @@ mstack_t* create_stack(size_t num_threads, width_t width, depth_t depth, width_t
 	}
 	/*************************************************************/
 
-	initialize_global_window(depth, width);
-
 	if (max_width < width)
 	{
 		max_width = width;
@@ -124,6 +122,7 @@ mstack_t* create_stack(size_t num_threads, width_t width, depth_t depth, width_t
 		perror("malloc");
 		exit(1);
     }
+	initialize_window(set, depth, width);
 	set->set_array = (index_t*) ssalloc_aligned(CACHE_LINE_SIZE, max_width*sizeof(index_t));
 	set->lateral = create_lateral_stack(max_width);
 	set->width = width;
@@ -169,15 +168,16 @@ int stack_cae(volatile descriptor_t* des_loc, descriptor_t* read_des_loc, descri
 #endif
 }
 
-int push(mstack_t *set, skey_t key, sval_t val)
+int push(mstack_handle_t* handle, skey_t key, sval_t val)
 {
+	mstack_t* set = handle->set;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
 
 	node_t* new_node = create_node(key, val, NULL);
 	while(1)
 	{
-		descriptor = put_window(set, contention);
+		descriptor = put_window(handle, contention);
 
 		new_node->next = descriptor.node;
 		new_node->next_count = descriptor.count;
@@ -185,16 +185,16 @@ int push(mstack_t *set, skey_t key, sval_t val)
 		new_descriptor.node = new_node;
 
 		// Don't allow pushes below the window.
-		if (likely(descriptor.count + thread_Window.depth >= thread_Window.max))
+		if (likely(descriptor.count + handle->window.Window.depth >= handle->window.Window.max))
 		{
 			new_descriptor.count = descriptor.count + 1;
 		}
 		else {
-			new_descriptor.count = thread_Window.max - thread_Window.depth;
+			new_descriptor.count = handle->window.Window.max - handle->window.Window.depth;
 		}
 
 
-		if(stack_cae(&set->set_array[thread_put_index].descriptor, &descriptor, &new_descriptor, 1))
+		if(stack_cae(&set->set_array[handle->window.put_index].descriptor, &descriptor, &new_descriptor, 1))
 		{
 			return 1;
 		}
@@ -207,20 +207,21 @@ int push(mstack_t *set, skey_t key, sval_t val)
 	}
 }
 
-sval_t pop(mstack_t *set)
+sval_t pop(mstack_handle_t* handle)
 {
+	mstack_t* set = handle->set;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
 
 	while (1)
     {
-		descriptor = get_window(set, contention);
+		descriptor = get_window(handle, contention);
 		if(descriptor.node != NULL)
 		{
 			new_descriptor.node = descriptor.node->next;
 			new_descriptor.count = descriptor.node->next_count;
 
-			if(stack_cae(&set->set_array[thread_get_index].descriptor, &descriptor, &new_descriptor, 0))
+			if(stack_cae(&set->set_array[handle->window.get_index].descriptor, &descriptor, &new_descriptor, 0))
 			{
 				sval_t node_val = descriptor.node->val;
 				//garbage collector
@@ -261,7 +262,7 @@ size_t stack_size(mstack_t *set)
 	return size;
 }
 
-mstack_t* register_stack(mstack_t *set, int thread_id)
+mstack_handle_t* register_stack(mstack_t *set, int thread_id)
 {
     ssalloc_init();
 	#if GC == 1
@@ -273,7 +274,16 @@ mstack_t* register_stack(mstack_t *set, int thread_id)
     }
 	#endif
 
-    return set;
+	mstack_handle_t* handle;
+	if ((handle = (mstack_handle_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mstack_handle_t))) == NULL)
+	{
+		perror("malloc");
+		exit(1);
+	}
+	handle->set = set;
+	initialize_thread_window(&handle->window);
+
+    return handle;
 }
 
 depth_t update_depth(mstack_t *set, depth_t depth)
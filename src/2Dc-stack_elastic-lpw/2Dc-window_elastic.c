@@ -3,6 +3,13 @@
 
 #include "lateral_stack.c"
 
+/*functions, descriptor_t and the handle are defined within the data structure header file*/
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention);
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention);
+uint64_t random_index(width_t width);
+void initialize_window(DS_TYPE* set, depth_t depth, width_t width);
+void initialize_thread_window(thread_window_t* window);
+
 
 static width_t shift_width(lateral_stack_t* lateral, row_t bottom, width_t old_put_width, width_t new_put_width)
 {
@@ -118,104 +125,108 @@ static width_t sync_index(width_t width, width_t index)
 
 
 // Reads the global window into the thread local one, can think of it as atomic
-static void read_window()
+static void read_window(DS_TYPE* set, thread_window_t* window)
 {
 	// Opt: Can we read it in two consecutive parts? First in that case the version, and then the rest
-	__atomic_load(&global_Window.content, &thread_Window, __ATOMIC_SEQ_CST);
+	__atomic_load(&set->Window.content, &window->Window, __ATOMIC_SEQ_CST);
 }
 
 
-descriptor_t put_window(DS_TYPE* set, uint8_t contention)
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	window_t new_window;
 	width_t hops;
 	uint8_t random;
 	descriptor_t descriptor;
 	hops = random = 0;
 
-	if(thread_Window.version != global_Window.content.version)
+	if(window->Window.version != set->Window.content.version)
 	{
-		read_window();
-		thread_put_index = sync_index(thread_Window.put_width, thread_put_index);
+		read_window(set, window);
+		window->put_index = sync_index(window->Window.put_width, window->put_index);
 	}
 
-	if(contention || thread_put_index >= thread_Window.put_width)
+	if(contention || window->put_index >= window->Window.put_width)
 	{
-		thread_put_index = random_index(thread_Window.put_width);
+		window->put_index = random_index(window->Window.put_width);
 	}
 
 	while(1)
 	{
 		/* read descriptor */
-		descriptor =  set->set_array[thread_put_index].descriptor;
+		descriptor =  set->set_array[window->put_index].descriptor;
 
-		if (global_Window.content.version != thread_Window.version)
+		if (set->Window.content.version != window->Window.version)
 		{
 			hops = 0;
-			read_window();
-			thread_put_index = sync_index(thread_Window.put_width, thread_put_index);
+			read_window(set, window);
+			window->put_index = sync_index(window->Window.put_width, window->put_index);
 		}
 
 		/* Try to work on the descriptor */
-		else if(descriptor.count < thread_Window.max)
+		else if(descriptor.count < window->Window.max)
 		{
 			// Only sync if the get index is not outside the put width
-			if (likely(thread_Window.put_width > thread_get_index))
+			if (likely(window->Window.put_width > window->get_index))
 			{
-				thread_get_index = thread_put_index;
+				window->get_index = window->put_index;
 			}
 			return descriptor;
 		}
 
 		/* hop */
-		else if(hops != thread_Window.put_width)
+		else if(hops != window->Window.put_width)
 		{
-			thread_put_index = hop(set, thread_put_index, &random, &hops, thread_Window.put_width);
+			window->put_index = hop(set, window->put_index, &random, &hops, window->Window.put_width);
 		}
 
 		/* shift window */
 		else
 		{
 
-			synchronize_lateral(set->lateral, set->set_array);
+			synchronize_lateral(set->lateral, set->set_array, &set->Window.content, &window->Window);
 
-			new_window.old_put_width = thread_Window.put_width;
+			new_window.old_put_width = window->Window.put_width;
 
 			new_window.put_width = set->width;
-			new_window.version = thread_Window.version + 1;
+			new_window.version = window->Window.version + 1;
 
 			new_window.depth = set->depth;
-			new_window.max = put_shift_max(thread_Window.max, new_window.depth);
+			new_window.max = put_shift_max(window->Window.max, new_window.depth);
 
 			new_window.get_width = shift_width(set->lateral, new_window.max - new_window.depth,
-											thread_Window.put_width, new_window.put_width);
+											window->Window.put_width, new_window.put_width);
 
 
 			assert(new_window.max >= new_window.depth);
 
-			if(thread_Window.version == global_Window.content.version)
+			if(window->Window.version == set->Window.content.version)
 			{
 
-				if(CAE(&global_Window.content, &thread_Window, &new_window))
+				if(CAE(&set->Window.content, &window->Window, &new_window))
 				{
-					thread_Window = new_window;
+					window->Window = new_window;
 					my_slide_count+=1;
 				}
 				else
 				{
-					read_window();
+					read_window(set, window);
 					my_slide_fail_count+=1;
 				}
 			}
-			thread_put_index = sync_index(thread_Window.put_width, thread_put_index);
+			window->put_index = sync_index(window->Window.put_width, window->put_index);
 			hops = 0;
 		}
 	}
 }
 
 
-descriptor_t get_window(DS_TYPE* set, uint8_t contention)
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	window_t new_window;
 	width_t hops;
 	uint8_t random; // shift
@@ -223,46 +234,46 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 	descriptor_t descriptor;
 	uint8_t empty = 1;
 
-	if(thread_Window.version != global_Window.content.version)
+	if(window->Window.version != set->Window.content.version)
 	{
-		read_window();
-		thread_get_index = sync_index(thread_Window.get_width, thread_get_index);
+		read_window(set, window);
+		window->get_index = sync_index(window->Window.get_width, window->get_index);
 	}
 
-	if(contention || thread_get_index >= thread_Window.get_width)
+	if(contention || window->get_index >= window->Window.get_width)
 	{
-		thread_get_index = random_index(thread_Window.get_width);
+		window->get_index = random_index(window->Window.get_width);
 	}
 
 	while(1)
 	{
 
 		/* read descriptor */
-		descriptor =  set->set_array[thread_get_index].descriptor;
+		descriptor =  set->set_array[window->get_index].descriptor;
 
 		/* Read the global window and possibly sync */
-		if (global_Window.content.version != thread_Window.version)
+		if (set->Window.content.version != window->Window.version)
 		{
 			hops = 0; empty = 1;
-			read_window();
-			thread_get_index = sync_index(thread_Window.get_width, thread_get_index);
+			read_window(set, window);
+			window->get_index = sync_index(window->Window.get_width, window->get_index);
 		}
 
-		/* empty sub-structures will be skipped at this point because (global_Window.content.max - set->depth) cannot go bellow zero */
-		else if(descriptor.count > thread_Window.max - thread_Window.depth)
+		/* empty sub-structures will be skipped at this point because (set->Window.content.max - set->depth) cannot go bellow zero */
+		else if(descriptor.count > window->Window.max - window->Window.depth)
 		{
 			break;
 		}
 
 		/* change index (hop) */
-		else if(hops != thread_Window.get_width)
+		else if(hops != window->Window.get_width)
 		{
 			/* emptiness check */
 			if(descriptor.count > 0)
 			{
 				empty = 0;
 			}
-			thread_get_index = hop(set, thread_get_index, &random, &hops, thread_Window.get_width);
+			window->get_index = hop(set, window->get_index, &random, &hops, window->Window.get_width);
 		}
 
 		/* Return empty descriptor */
@@ -275,45 +286,45 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 		else
 		{
 
-			synchronize_lateral(set->lateral, set->set_array);
+			synchronize_lateral(set->lateral, set->set_array, &set->Window.content, &window->Window);
 
-			new_window.old_put_width = thread_Window.put_width;
+			new_window.old_put_width = window->Window.put_width;
 
 			new_window.put_width = set->width;
-			new_window.version = thread_Window.version + 1;
+			new_window.version = window->Window.version + 1;
 
 			new_window.depth = set->depth;
-			new_window.max = get_shift_max(thread_Window.max, new_window.depth, thread_Window.depth);
+			new_window.max = get_shift_max(window->Window.max, new_window.depth, window->Window.depth);
 
 			new_window.get_width = shift_width(set->lateral, new_window.max - new_window.depth,
-											thread_Window.put_width, new_window.put_width);
+											window->Window.put_width, new_window.put_width);
 
 			assert(new_window.max >= new_window.depth);
 
-			if(thread_Window.version == global_Window.content.version)
+			if(window->Window.version == set->Window.content.version)
 			{
 
-				if(CAE(&global_Window.content, &thread_Window, &new_window))
+				if(CAE(&set->Window.content, &window->Window, &new_window))
 				{
-					thread_Window = new_window;
+					window->Window = new_window;
 					my_slide_count+=1;
 				}
 				else
 				{
-					read_window();
+					read_window(set, window);
 					my_slide_fail_count+=1;
 				}
 			}
 
-			thread_get_index = sync_index(thread_Window.get_width, thread_get_index);
+			window->get_index = sync_index(window->Window.get_width, window->get_index);
 			hops = 0; empty = 1;
 		}
 	}
 
 	// Only sync if we can bring put index to get index
-	if (likely(thread_Window.put_width > thread_get_index))
+	if (likely(window->Window.put_width > window->get_index))
 	{
-		thread_put_index = thread_get_index;
+		window->put_index = window->get_index;
 	}
 	return descriptor;
 }
@@ -325,17 +336,23 @@ uint64_t random_index(width_t width)
 }
 
 
-void initialize_global_window(depth_t depth, width_t width)
+void initialize_window(DS_TYPE* set, depth_t depth, width_t width)
 {
-	global_Window.content.max = depth;
-	global_Window.content.version = 1;
-
-	global_Window.content.depth = depth;
-
-	global_Window.content.get_width = width;
-	global_Window.content.put_width = width;
-	global_Window.content.old_put_width = width;
+	set->Window.content.max = depth;
+	set->Window.content.version = 1;
 
+	set->Window.content.depth = depth;
 
+	set->Window.content.get_width = width;
+	set->Window.content.put_width = width;
+	set->Window.content.old_put_width = width;
 }
 
+
+void initialize_thread_window(thread_window_t* window)
+{
+	window->Window.max = 0;
+	window->Window.version = 0;
+	window->put_index = 0;
+	window->get_index = 0;
+}
\ No newline at end of file
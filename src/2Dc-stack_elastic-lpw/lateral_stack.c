@@ -37,11 +37,11 @@ static void free_nodes_until(lateral_node_t* node, lateral_node_t* base_node)
 }
 
 /* Counts where to lower or push lateral nodes depending on width as compared to put_width */
-static inline row_t push_wider_count(index_t* substructures)
+static inline row_t push_wider_count(window_t* window, index_t* substructures)
 {
 	// Instead of having this in window we can just loop and get an upper bound
 	row_t max = 0;
-	for (width_t i = thread_Window.put_width; i < thread_Window.old_put_width; i += 1)
+	for (width_t i = window->put_width; i < window->old_put_width; i += 1)
 	{
 		row_t count = substructures[i].descriptor.count;
 		if (unlikely(count > max)) {
@@ -51,30 +51,30 @@ static inline row_t push_wider_count(index_t* substructures)
 	return max;
 }
 
-static inline row_t push_narrower_count()
+static inline row_t push_narrower_count(window_t* window)
 {
-	return thread_Window.max - thread_Window.depth + 1;
+	return window->max - window->depth + 1;
 }
 
-// static inline row_t lower_wider_count()
+// static inline row_t lower_wider_count(window_t* window)
 // {
-// 	return thread_Window.potential_old_bottom;
+// 	return window->potential_old_bottom;
 // }
 
-static inline row_t lower_narrower_count()
+static inline row_t lower_narrower_count(window_t* window)
 {
-	return thread_Window.max - thread_Window.depth + 1;
+	return window->max - window->depth + 1;
 }
 
-static row_t lateral_new_count(row_t lateral_count, row_t lower_limit, width_t lateral_width, width_t put_width)
+static row_t lateral_new_count(window_t* window, row_t lateral_count, row_t lower_limit, width_t lateral_width, width_t put_width)
 {
 	// Get the new count for a lateral node given its width and the active width when lowering
 	row_t new_count;
 
-	if (lateral_width > put_width && thread_Window.last_shift != 0)
+	if (lateral_width > put_width && window->last_shift != 0)
 	{
 		// shifted down last, so what must the last bottom have been?
-		row_t last_bottom = thread_Window.max - (thread_Window.depth >> 1);
+		row_t last_bottom = window->max - (window->depth >> 1);
 		if (last_bottom < lateral_count) {
 			new_count = last_bottom;
 		} else {
@@ -100,20 +100,20 @@ typedef struct update_tuple {
 	lateral_node_t* base; 			// The one in common between read and new stack
 } update_tuple_t;
 
-static update_tuple_t replace_lateral_node(lateral_node_t* node, row_t count)
+static update_tuple_t replace_lateral_node(window_t* window, lateral_node_t* node, row_t count)
 {
 	// Are we below the point any node can be lowered?
-	if (likely(count < lower_narrower_count()))
+	if (likely(count < lower_narrower_count(window)))
 	{
 		// Don't do anything, set as base node in case nothing is changed
 		update_tuple_t base = {count, node, node};
 		return base;
 	}
 
-	update_tuple_t next = replace_lateral_node(node->next, node->next_count);
+	update_tuple_t next = replace_lateral_node(window, node->next, node->next_count);
  	update_tuple_t replacement = next;
 
-	row_t new_count = lateral_new_count(count, lower_narrower_count(), node->width, thread_Window.put_width);
+	row_t new_count = lateral_new_count(window, count, lower_narrower_count(window), node->width, window->put_width);
 
 	if (next.node == node->next && next.count == node->next_count && new_count == count)
 	{
@@ -150,12 +150,12 @@ static update_tuple_t replace_lateral_node(lateral_node_t* node, row_t count)
 	}
 }
 
-static void replace_laterals(lateral_descriptor_t* read_descriptor, lateral_descriptor_t* new_descriptor, lateral_node_t** base_node)
+static void replace_laterals(window_t* window, lateral_descriptor_t* read_descriptor, lateral_descriptor_t* new_descriptor, lateral_node_t** base_node)
 {
 	// Lowers and replaces the nodes until base node, and adds new top to the new descriptor
 
 	// In a way we don't need to calculate the base pointer in advance...
-	update_tuple_t top = replace_lateral_node(read_descriptor->node, read_descriptor->count);
+	update_tuple_t top = replace_lateral_node(window, read_descriptor->node, read_descriptor->count);
 
 	new_descriptor->count = top.count;
 	new_descriptor->node = top.node;
@@ -168,40 +168,40 @@ static void push_lateral(lateral_descriptor_t* descriptor, row_t count, width_t
 	descriptor->count = count;
 }
 
-static void maybe_push_lateral(lateral_descriptor_t *new_descriptor, index_t* substructures)
+static void maybe_push_lateral(window_t* window, lateral_descriptor_t *new_descriptor, index_t* substructures)
 {
 	/* We are in a window with shifting width and want to push the old width */
 
-	if (thread_Window.put_width > thread_Window.old_put_width &&
-		new_descriptor->count < push_narrower_count())
+	if (window->put_width > window->old_put_width &&
+		new_descriptor->count < push_narrower_count(window))
 	{
 		// Increasing width so push lateral at window bottom
-		push_lateral(new_descriptor, push_narrower_count(), thread_Window.old_put_width);
+		push_lateral(new_descriptor, push_narrower_count(window), window->old_put_width);
 	}
-	else if (thread_Window.put_width < thread_Window.old_put_width)
+	else if (window->put_width < window->old_put_width)
 	{
 		// Decreasing width so push lateral at upper bound of where nodes can still be at that width
-		row_t upper_bound = push_wider_count(substructures);
+		row_t upper_bound = push_wider_count(window, substructures);
 		if (new_descriptor->count < upper_bound)
 		{
-			push_lateral(new_descriptor, upper_bound, thread_Window.old_put_width);
+			push_lateral(new_descriptor, upper_bound, window->old_put_width);
 		}
 	}
 }
 
-void synchronize_lateral(lateral_stack_t *lateral, index_t* substructures)
+void synchronize_lateral(lateral_stack_t *lateral, index_t* substructures, volatile window_t* global_window, window_t* window)
 {
 	/* ENsures that the lateral is in a consistently defined state before shifting from a window */
 	lateral_descriptor_t read_descriptor;
 
 	read_descriptor = lateral->descriptor;
 
-	if (global_Window.content.version != thread_Window.version) {
+	if (global_window->version != window->version) {
 		// To make sure this lateral stack was observed during the global window
 		return ;
 	}
 
-	if (unlikely(read_descriptor.version == thread_Window.version))
+	if (unlikely(read_descriptor.version == window->version))
 	{
 		// The descriptor has already been updated during this window, so don't do it twice!
 		return ;
@@ -212,12 +212,12 @@ void synchronize_lateral(lateral_stack_t *lateral, index_t* substructures)
 	lateral_node_t *base_node; // The uppermost node which not to replace (can still be moved by updating counts above it)
 
 	// Replace the required nodes in the new descriptor with new ones
-	replace_laterals(&read_descriptor, &new_descriptor, &base_node);
+	replace_laterals(window, &read_descriptor, &new_descriptor, &base_node);
 
 	// Push a new lateral node if we have changed width
-	if (unlikely(thread_Window.put_width != thread_Window.old_put_width))
+	if (unlikely(window->put_width != window->old_put_width))
 	{
-		maybe_push_lateral(&new_descriptor, substructures);
+		maybe_push_lateral(window, &new_descriptor, substructures);
 	}
 
 	// Only do CAS if there is any change
@@ -226,7 +226,7 @@ void synchronize_lateral(lateral_stack_t *lateral, index_t* substructures)
 			new_descriptor.node != read_descriptor.node
 		))
 	{
-		new_descriptor.version = thread_Window.version;
+		new_descriptor.version = window->version;
 		if (CAE(&lateral->descriptor, &read_descriptor, &new_descriptor))
 		{
 			// Managed to update it, so now the replaced nodes should be freed
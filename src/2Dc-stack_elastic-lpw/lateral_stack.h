@@ -6,6 +6,7 @@
 
 // Forward declaration due to circular dependence (the three files all share logic, but are split up to make it easier to intuitevely separate)
 typedef struct array_index index_t;
+typedef struct window_descriptor window_t;
 
 
 /* Type definitions */
@@ -33,7 +34,7 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct lateral_block
 
 
 /* Interfaces */
-void synchronize_lateral(lateral_stack_t* lateral, index_t* substructures);
+void synchronize_lateral(lateral_stack_t* lateral, index_t* substructures, volatile window_t* global_window, window_t* window);
 lateral_stack_t* create_lateral_stack(width_t width);
 
 #endif
@@ -339,6 +339,7 @@ int main(int argc, char **argv)
 		{"num-buckets",               required_argument, NULL, 'b'},
 		{"print-vals",                required_argument, NULL, 'v'},
 		{"vals-pf",                   required_argument, NULL, 'f'},
+		{"pin",                       required_argument, NULL, 'P'},
 		{NULL, 0, NULL, 0}
 	};
 
@@ -346,7 +347,7 @@ int main(int argc, char **argv)
 	while(1)
     {
 		i = 0;
-		c = getopt_long(argc, argv, "hAf:d:i:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:", long_options, &i);
+		c = getopt_long(argc, argv, "hAf:d:i:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:P:", long_options, &i);
 		if(c == -1)
 		break;
 		if(c == 0 && long_options[i].flag == 0)
@@ -394,6 +395,8 @@ int main(int argc, char **argv)
 			"        Fixed Width or Width to thread ratio depending on the k-mode.\n"
 			"  -m, --K Mode <int>\n"
 			"        0 for Fixed Width and Depth, 1 for Fixed Width, 2 for fixed Depth, 3 for fixed Width to thread ratio.\n"
+			"  -P, --pin <policy>\n"
+			"        Pin threads from the sysfs topology: compact-cores-first, scatter-sockets, smt-last or table [DEFAULT=table].\n"
 			, argv[0]);
 			exit(0);
 			case 'd':
@@ -437,6 +440,9 @@ int main(int argc, char **argv)
 			if(atoi(optarg)<=3) k_mode = atoi(optarg);
 			break;
 			break;
+			case 'P':
+			set_pin_policy(optarg);
+			break;
 			case '?':
 			default:
 			printf("Use -h or --help for help\n");
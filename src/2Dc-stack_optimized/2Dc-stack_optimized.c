@@ -111,8 +111,6 @@ mstack_t* create_stack(size_t num_threads, width_t width, depth_t depth, width_t
 	}
 	/*************************************************************/
 
-	initialize_global_window(depth, width);
-
 	if (max_width < width)
 	{
 		max_width = width;
@@ -123,6 +121,7 @@ mstack_t* create_stack(size_t num_threads, width_t width, depth_t depth, width_t
 		perror("malloc");
 		exit(1);
     }
+	initialize_window(set, depth);
 	set->set_array = (index_t*) ssalloc_aligned(CACHE_LINE_SIZE, max_width*sizeof(index_t));
 	set->width = width;
 	set->depth = depth;
@@ -167,15 +166,16 @@ int stack_cae(volatile descriptor_t* des_loc, descriptor_t* read_des_loc, descri
 #endif
 }
 
-int push(mstack_t *set, skey_t key, sval_t val)
+int push(mstack_handle_t* handle, skey_t key, sval_t val)
 {
+	mstack_t* set = handle->set;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
 
 	node_t* new_node = create_node(key, val, NULL);
 	while(1)
 	{
-		descriptor = put_window(set, contention);
+		descriptor = put_window(handle, contention);
 
 		new_node->next = descriptor.node;
 
@@ -183,7 +183,7 @@ int push(mstack_t *set, skey_t key, sval_t val)
 		new_descriptor.count = descriptor.count + 1;
 
 
-		if(stack_cae(&set->set_array[thread_index].descriptor, &descriptor, &new_descriptor, 1))
+		if(stack_cae(&set->set_array[handle->window.index].descriptor, &descriptor, &new_descriptor, 1))
 		{
 			return 1;
 		}
@@ -196,20 +196,21 @@ int push(mstack_t *set, skey_t key, sval_t val)
 	}
 }
 
-sval_t pop(mstack_t *set)
+sval_t pop(mstack_handle_t* handle)
 {
+	mstack_t* set = handle->set;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
 
 	while (1)
     {
-		descriptor = get_window(set, contention);
+		descriptor = get_window(handle, contention);
 		if(descriptor.node != NULL)
 		{
 			new_descriptor.node = descriptor.node->next;
 			new_descriptor.count = descriptor.count - 1;
 
-			if(stack_cae(&set->set_array[thread_index].descriptor, &descriptor, &new_descriptor, 0))
+			if(stack_cae(&set->set_array[handle->window.index].descriptor, &descriptor, &new_descriptor, 0))
 			{
 				sval_t node_val = descriptor.node->val;
 				//garbage collector
@@ -250,7 +251,7 @@ size_t stack_size(mstack_t *set)
 	return size;
 }
 
-mstack_t* register_stack(mstack_t *set, int thread_id)
+mstack_handle_t* register_stack(mstack_t *set, int thread_id)
 {
     ssalloc_init();
 	#if GC == 1
@@ -262,5 +263,14 @@ mstack_t* register_stack(mstack_t *set, int thread_id)
     }
 	#endif
 
-    return set;
+	mstack_handle_t* handle;
+	if ((handle = (mstack_handle_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mstack_handle_t))) == NULL)
+	{
+		perror("malloc");
+		exit(1);
+	}
+	handle->set = set;
+	initialize_thread_window(&handle->window);
+
+    return handle;
 }
@@ -14,6 +14,7 @@
 #include "ssmem.h"
 #include "utils.h"
 #include "types.h"
+#include "2Dc-window_optimized.h"
 
 #ifdef RELAXATION_ANALYSIS
 #include "relaxation_analysis_queue.h"
@@ -30,7 +31,7 @@
 #define DS_REGISTER(s,i)    register_stack(s,i)
 
 #define DS_TYPE             mstack_t
-#define DS_HANDLE           mstack_t*
+#define DS_HANDLE           mstack_handle_t*
 #define DS_NODE             node_t
 
 /* Type definitions */
@@ -65,8 +66,18 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct mstack_file
 	depth_t shift;
 	uint8_t k_mode;
 	uint8_t padding[CACHE_LINE_SIZE - sizeof(index_t*) - sizeof(uint64_t)*2 - 2*sizeof(depth_t) - sizeof(width_t) - sizeof(uint8_t)];
+
+	// The global window, in its own cache line
+	volatile padded_window_t Window;
 } mstack_t;
 
+// Per-thread handle, returned by DS_REGISTER
+typedef struct mstack_handle
+{
+	mstack_t* set;
+	thread_window_t window;
+} mstack_handle_t;
+
 /*Global variables*/
 
 
@@ -82,10 +93,10 @@ extern __thread unsigned long my_slide_count;
 extern __thread unsigned long my_slide_fail_count;
 
 /* Interfaces */
-int push(mstack_t *set, skey_t key, sval_t val);
-sval_t pop(mstack_t *set);
+int push(mstack_handle_t* handle, skey_t key, sval_t val);
+sval_t pop(mstack_handle_t* handle);
 node_t* create_node(skey_t key, sval_t val, node_t* next);
 mstack_t* create_stack(size_t num_threads, width_t width, depth_t depth, width_t max_width, uint8_t k_mode, uint64_t relaxation_bound);
-mstack_t* register_stack(mstack_t *set, int thread_id);
+mstack_handle_t* register_stack(mstack_t *set, int thread_id);
 size_t stack_size(mstack_t *set);
 int floor_log_2(unsigned int n);
\ No newline at end of file
@@ -1,5 +1,12 @@
 #include "2Dc-window_optimized.h"
 
+/*functions, descriptor_t and the handle are defined within the data structure header file*/
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention);
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention);
+uint64_t random_index(width_t width);
+void initialize_window(DS_TYPE* set, depth_t depth);
+void initialize_thread_window(thread_window_t* window);
+
 
 static inline uint64_t hop(DS_TYPE* set, uint64_t index, uint8_t* random, width_t* hops, width_t width)
 {
@@ -28,44 +35,46 @@ static inline uint64_t hop(DS_TYPE* set, uint64_t index, uint8_t* random, width_
 
 
 // Reads the global window into the thread local one, can think of it as atomic
-static void read_window()
+static void read_window(DS_TYPE* set, thread_window_t* window)
 {
 	// Opt: Can we read it in two consecutive parts? First in that case the version, and then the rest
-	__atomic_load(&global_Window.content, &thread_Window, __ATOMIC_SEQ_CST);
+	__atomic_load(&set->Window.content, &window->Window, __ATOMIC_SEQ_CST);
 }
 
 
-descriptor_t put_window(DS_TYPE* set, uint8_t contention)
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	window_t new_window;
 	width_t hops;
 	uint8_t random;
 	descriptor_t descriptor;
 	hops = random = 0;
 
-	if(thread_Window.version != global_Window.content.version)
+	if(window->Window.version != set->Window.content.version)
 	{
-		read_window();
+		read_window(set, window);
 	}
 
 	if(contention)
 	{
-		thread_index = random_index(set->width);
+		window->index = random_index(set->width);
 	}
 
 	while(1)
 	{
 		/* read descriptor */
-		descriptor =  set->set_array[thread_index].descriptor;
+		descriptor =  set->set_array[window->index].descriptor;
 
-		if (global_Window.content.version != thread_Window.version)
+		if (set->Window.content.version != window->Window.version)
 		{
 			hops = 0;
-			read_window();
+			read_window(set, window);
 		}
 
 		/* Try to work on the descriptor */
-		else if(descriptor.count < thread_Window.max)
+		else if(descriptor.count < window->Window.max)
 		{
 			return descriptor;
 		}
@@ -73,28 +82,28 @@ descriptor_t put_window(DS_TYPE* set, uint8_t contention)
 		/* hop */
 		else if(hops != set->width)
 		{
-			thread_index = hop(set, thread_index, &random, &hops, set->width);
+			window->index = hop(set, window->index, &random, &hops, set->width);
 		}
 
 		/* shift window */
 		else
 		{
 
-			new_window.version = thread_Window.version + 1;
-			new_window.max = thread_Window.max + set->shift;
+			new_window.version = window->Window.version + 1;
+			new_window.max = window->Window.max + set->shift;
 
 			// assert(new_window.max >= new_window.depth);
 
-			if(thread_Window.version == global_Window.content.version)
+			if(window->Window.version == set->Window.content.version)
 			{
-				if(CAE(&global_Window.content, &thread_Window, &new_window))
+				if(CAE(&set->Window.content, &window->Window, &new_window))
 				{
-					thread_Window = new_window;
+					window->Window = new_window;
 					my_slide_count+=1;
 				}
 				else
 				{
-					read_window();
+					read_window(set, window);
 					my_slide_fail_count+=1;
 				}
 			}
@@ -104,8 +113,10 @@ descriptor_t put_window(DS_TYPE* set, uint8_t contention)
 }
 
 
-descriptor_t get_window(DS_TYPE* set, uint8_t contention)
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	window_t new_window;
 	width_t hops;
 	uint8_t random; // shift
@@ -113,31 +124,31 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 	descriptor_t descriptor;
 	uint8_t empty = 1;
 
-	if(thread_Window.version != global_Window.content.version)
+	if(window->Window.version != set->Window.content.version)
 	{
-		read_window();
+		read_window(set, window);
 	}
 
 	if(contention)
 	{
-		thread_index = random_index(set->width);
+		window->index = random_index(set->width);
 	}
 
 	while(1)
 	{
 
 		/* read descriptor */
-		descriptor =  set->set_array[thread_index].descriptor;
+		descriptor =  set->set_array[window->index].descriptor;
 
 		/* Read the global window and possibly sync */
-		if (global_Window.content.version != thread_Window.version)
+		if (set->Window.content.version != window->Window.version)
 		{
 			hops = 0; empty = 1;
-			read_window();
+			read_window(set, window);
 		}
 
-		/* empty sub-structures will be skipped at this point because (global_Window.content.max - set->depth) cannot go bellow zero */
-		else if(descriptor.count > thread_Window.max - set->depth)
+		/* empty sub-structures will be skipped at this point because (set->Window.content.max - set->depth) cannot go bellow zero */
+		else if(descriptor.count > window->Window.max - set->depth)
 		{
 			break;
 		}
@@ -150,7 +161,7 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 			{
 				empty = 0;
 			}
-			thread_index = hop(set, thread_index, &random, &hops, set->width);
+			window->index = hop(set, window->index, &random, &hops, set->width);
 		}
 
 		/* Return empty descriptor */
@@ -163,22 +174,22 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 		else
 		{
 
-			new_window.max = thread_Window.max - set->shift;
-			new_window.version = thread_Window.version + 1;
+			new_window.max = window->Window.max - set->shift;
+			new_window.version = window->Window.version + 1;
 
 			assert(new_window.max >= set->depth);
 
 			// Should never want to shift down below zero right as we then would return empty instead?
-			if(thread_Window.version == global_Window.content.version)
+			if(window->Window.version == set->Window.content.version)
 			{
-				if(CAE(&global_Window.content, &thread_Window, &new_window))
+				if(CAE(&set->Window.content, &window->Window, &new_window))
 				{
-					thread_Window = new_window;
+					window->Window = new_window;
 					my_slide_count+=1;
 				}
 				else
 				{
-					read_window();
+					read_window(set, window);
 					my_slide_fail_count+=1;
 				}
 			}
@@ -197,9 +208,16 @@ uint64_t random_index(width_t width)
 }
 
 
-void initialize_global_window(depth_t depth, width_t width)
+void initialize_window(DS_TYPE* set, depth_t depth)
+{
+	set->Window.content.max = depth;
+	set->Window.content.version = 1;
+}
+
+void initialize_thread_window(thread_window_t* window)
 {
-	global_Window.content.max = depth;
-	global_Window.content.version = 1;
+	window->Window.max = 0;
+	window->Window.version = 0;
+	window->index = 0;
 }
 
@@ -16,18 +16,15 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct window_struct
 	uint8_t padding[CACHE_LINE_SIZE - sizeof(window_t)];
 } padded_window_t;
 
-/*window variables*/
-volatile padded_window_t global_Window;
-
-__thread window_t thread_Window;
-// __thread uint64_t thread_put_index;
-// __thread uint64_t thread_get_index;
-__thread uint64_t thread_index;
-
-/*functions, descriptor_t defined within the data structure header file*/
-descriptor_t put_window(DS_TYPE* set, uint8_t contention);
-descriptor_t get_window(DS_TYPE* set, uint8_t contention);
-uint64_t random_index(width_t width);
-void initialize_global_window(depth_t depth, width_t width);
+/*
+ * The global window is kept in the stack (Window), and every thread keeps its view of it in the
+ * handle returned by DS_REGISTER. This header only holds the types, so that it can be included
+ * before the stack is defined. The functions are declared in 2Dc-window_optimized.c.
+ */
+typedef struct thread_window_struct
+{
+	window_t Window;
+	uint64_t index;
+} thread_window_t;
 
 #endif
@@ -109,6 +109,9 @@ counter_t* create_counter(size_t num_threads, uint64_t width, uint64_t depth, ui
 	set->k_mode = k_mode;
 	set->relaxation_bound = relaxation_bound;
 
+	// Initlialize the window variables
+	initialize_window(set, depth);
+
 	int i;
 	for(i=0; i < set->width; i++)
 	{
@@ -149,16 +152,17 @@ static inline char counter_cae(volatile descriptor_t* desc_loc, descriptor_t* de
 #endif
 }
 
-uint64_t increment(counter_t *set)
+uint64_t increment(counter_handle_t* handle)
 {
+	counter_t* set = handle->set;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
 	while(1)
 	{
-		descriptor = put_window(set,contention);
+		descriptor = put_window(handle, contention);
 		new_descriptor.get_count = descriptor.get_count;
 		new_descriptor.put_count = descriptor.put_count + 1;
-		if(counter_cae(&set->put_array[thread_index].descriptor,&descriptor,&new_descriptor,set))
+		if(counter_cae(&set->put_array[handle->window.index].descriptor,&descriptor,&new_descriptor,set))
 		{
 			#if VALIDATESIZE==1
 				return 1;
@@ -175,18 +179,19 @@ uint64_t increment(counter_t *set)
 	}
 }
 
-uint64_t decrement(counter_t *set)
+uint64_t decrement(counter_handle_t* handle)
 {
+	counter_t* set = handle->set;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
 	while (1)
     {
-		descriptor = get_window(set, contention);
+		descriptor = get_window(handle, contention);
 		if((descriptor.put_count - descriptor.get_count)>0)
 		{
 			new_descriptor.put_count = descriptor.put_count;
 			new_descriptor.get_count = descriptor.get_count + 1;
-			if(counter_cae(&set->get_array[thread_index].descriptor,&descriptor,&new_descriptor, set))
+			if(counter_cae(&set->get_array[handle->window.index].descriptor,&descriptor,&new_descriptor, set))
 			{
 				#if VALIDATESIZE==1
 					return 1;
@@ -222,7 +227,7 @@ size_t counter_size(counter_t *set)
 	return size;
 }
 
-counter_t* counter_register(counter_t *set, int thread_id)
+counter_handle_t* counter_register(counter_t *set, int thread_id)
 {
     ssalloc_init();
 	#if GC == 1
@@ -234,5 +239,14 @@ counter_t* counter_register(counter_t *set, int thread_id)
     }
 	#endif
 
-    return set;
+	counter_handle_t* handle;
+	if ((handle = (counter_handle_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(counter_handle_t))) == NULL)
+	{
+		perror("malloc");
+		exit(1);
+	}
+	handle->set = set;
+	initialize_thread_window(&handle->window);
+
+    return handle;
 }
\ No newline at end of file
@@ -11,10 +11,10 @@
 __thread ssmem_allocator_t* alloc;
 __thread ssmem_allocator_t* alloc2;
 
-deque_t* create_deque()
+mdeque_t* create_deque()
 {
 	anchor_t* anchor;
-	deque_t* deque;
+	mdeque_t* set;
     ssalloc_init();
 	 /******************relaxation_bound k = (3depth)(width - 1)***************/
 	if(width<2) width = 2;
@@ -27,20 +27,18 @@ deque_t* create_deque()
 	width = (relaxation_bound/(3*depth)) + 1;
 	if(width<1)width=1;
 
-	/*create global windows*/
-	global_PLWindow = (window_t *) calloc(1, sizeof(window_t));
-	global_PRWindow = (window_t *) calloc(1, sizeof(window_t));
-	global_GLWindow = (window_t *) calloc(1, sizeof(window_t));
-	global_GRWindow = (window_t *) calloc(1, sizeof(window_t));
+	set = (mdeque_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mdeque_t));
+	set->width = width;
+	set->depth = depth;
 
-	/*initialise window max limit*/
-	global_PLWindow->max = depth;
-	global_PRWindow->max = depth;
-	global_GLWindow->max = depth;
-	global_GRWindow->max = depth;
+	/*initialise global window max limit*/
+	set->PLWindow.max = depth;
+	set->PRWindow.max = depth;
+	set->GLWindow.max = depth;
+	set->GRWindow.max = depth;
 
 	/*create an array of sub_structures (relaxation)*/
-	if ((deque=(deque_t*) calloc(width, sizeof(deque_t)))==NULL)
+	if ((set->deques=(deque_t*) calloc(width, sizeof(deque_t)))==NULL)
     {
 		perror("malloc");
 		exit(1);
@@ -54,13 +52,13 @@ deque_t* create_deque()
 		anchor->left = NULL;
     	anchor->right = NULL;
 		anchor->state = STATE_STABLE;
-		deque[i].anchor=anchor;
+		set->deques[i].anchor=anchor;
 	}
 
 	#if defined(RELAXATION_ANALYSIS)
 		initialise_relaxation_analysis();
 	#endif
-	return deque;
+	return set;
 }
 
 node_t* create_node(skey_t k, sval_t value)
@@ -110,8 +108,10 @@ anchor_t* create_anchor()
     return new_anchor;
 }
 
-int push_left(deque_t* set, skey_t key, sval_t value)
+int push_left(mdeque_handle_t* handle, skey_t key, sval_t value)
 {
+	mdeque_t* set = handle->set;
+	int contention = 0;
 	anchor_t *anchor;
 	anchor_t *nextAnchor=NULL;
 	node_t *node;
@@ -127,16 +127,14 @@ int push_left(deque_t* set, skey_t key, sval_t value)
 		return 0;
 	}
 
-	contention=0;
 	while(1)
 	{
 		if(nextAnchor==NULL)nextAnchor=create_anchor();
 		while(1)
 		{
 			/********relaxation window********/
-			put_left_window(set);
-			anchor=anchor_ptr;
-			deque=&set[thread_index];
+			anchor=put_left_window(handle, contention);
+			deque=&set->deques[handle->window.index];
 			/*********************************/
 			if(anchor==deque->anchor)break;
 		}
@@ -178,7 +176,7 @@ int push_left(deque_t* set, skey_t key, sval_t value)
 			contention+=1;
 			my_put_cas_fail_count+=1;
 		}
-		else stabilize(anchor,deque);
+		else contention+=stabilize(anchor,deque);
 	}
 	#if GC == 1
 		ssmem_free(alloc2, (void*) anchor);
@@ -186,8 +184,10 @@ int push_left(deque_t* set, skey_t key, sval_t value)
 	return 1;
 }
 
-int push_right(deque_t* set, skey_t key, sval_t value)
+int push_right(mdeque_handle_t* handle, skey_t key, sval_t value)
 {
+	mdeque_t* set = handle->set;
+	int contention = 0;
 	anchor_t *anchor;
 	anchor_t *nextAnchor=NULL;
 	node_t *node;
@@ -203,16 +203,14 @@ int push_right(deque_t* set, skey_t key, sval_t value)
 		return 0;
 	}
 
-	contention=0;
 	while(1)
 	{
 		if(nextAnchor==NULL)nextAnchor=create_anchor();
 		while(1)
 		{
 			/********relaxation window********/
-			put_right_window(set);
-			anchor=anchor_ptr;
-			deque=&set[thread_index];
+			anchor=put_right_window(handle, contention);
+			deque=&set->deques[handle->window.index];
 			/*********************************/
 			if(anchor==deque->anchor)break;
 		}
@@ -254,7 +252,7 @@ int push_right(deque_t* set, skey_t key, sval_t value)
 			contention+=1;
 			my_put_cas_fail_count+=1;
 		}
-		else stabilize(anchor,deque);
+		else contention+=stabilize(anchor,deque);
 	}
 	#if GC == 1
 		ssmem_free(alloc2, (void*) anchor);
@@ -262,8 +260,10 @@ int push_right(deque_t* set, skey_t key, sval_t value)
 	return 1;
 }
 
-sval_t pop_right(deque_t* set)
+sval_t pop_right(mdeque_handle_t* handle)
 {
+	mdeque_t* set = handle->set;
+	int contention = 0;
 	sval_t value;
 	anchor_t *anchor;
 	anchor_t *nextAnchor=NULL;
@@ -271,15 +271,14 @@ sval_t pop_right(deque_t* set)
 	node_t *node;
 	deque_t* deque;
 
-	contention=0;
 	while(1)
 	{
 		if(nextAnchor==NULL)nextAnchor=create_anchor();
 		while(1)
 		{
 			/********relaxation window********/
-			get_right_window(set);
-			if(empty_check==1)
+			anchor=get_right_window(handle, contention);
+			if(anchor==NULL)
 			{
 				#if defined(RELAXATION_ANALYSIS)
 					relaxation_null_remove((1));
@@ -287,8 +286,7 @@ sval_t pop_right(deque_t* set)
 				my_null_count+=1;
 				return NULL;
 			}
-			anchor=anchor_ptr;
-			deque=&set[thread_index];
+			deque=&set->deques[handle->window.index];
 			/*********************************/
 			if(anchor==deque->anchor)break;
 		}
@@ -330,7 +328,7 @@ sval_t pop_right(deque_t* set)
 			contention+=1;
 			my_get_cas_fail_count+=1;
 		}
-		else stabilize(anchor,deque);
+		else contention+=stabilize(anchor,deque);
 	}
 	value=node->val;
 	#if GC == 1
@@ -340,8 +338,10 @@ sval_t pop_right(deque_t* set)
 	return value;
 }
 
-sval_t pop_left(deque_t* set)
+sval_t pop_left(mdeque_handle_t* handle)
 {
+	mdeque_t* set = handle->set;
+	int contention = 0;
 	sval_t value;
 	anchor_t *anchor;
 	anchor_t *nextAnchor=NULL;
@@ -349,15 +349,14 @@ sval_t pop_left(deque_t* set)
 	node_t *node;
 	deque_t* deque;
 
-	contention=0;
 	while(1)
 	{
 		if(nextAnchor==NULL)nextAnchor=create_anchor();
 		while(1)
 		{
 			/********relaxation window********/
-			get_left_window(set);
-			if(empty_check==1)
+			anchor=get_left_window(handle, contention);
+			if(anchor==NULL)
 			{
 				#if defined(RELAXATION_ANALYSIS)
 					relaxation_null_remove((1));
@@ -365,8 +364,7 @@ sval_t pop_left(deque_t* set)
 				my_null_count+=1;
 				return NULL;
 			}
-			anchor=anchor_ptr;
-			deque=&set[thread_index];
+			deque=&set->deques[handle->window.index];
 			/*********************************/
 			if(anchor==deque->anchor)break;
 		}
@@ -408,7 +406,7 @@ sval_t pop_left(deque_t* set)
 			contention+=1;
 			my_get_cas_fail_count+=1;
 		}
-		else stabilize(anchor,deque);
+		else contention+=stabilize(anchor,deque);
 	}
 	value=node->val;
 	#if GC == 1
@@ -418,29 +416,29 @@ sval_t pop_left(deque_t* set)
 	return value;
 }
 
-void stabilize(anchor_t *anchor, deque_t *deque)
+/*returns 1 if the stabilization lost a CAS, which counts as contention on the sub-deque*/
+int stabilize(anchor_t *anchor, deque_t *deque)
 {
-	if(anchor->state==STATE_RPUSH)stabilize_right(anchor,deque);
-	else stabilize_left(anchor,deque);
+	if(anchor->state==STATE_RPUSH)return stabilize_right(anchor,deque);
+	else return stabilize_left(anchor,deque);
 }
 
-void stabilize_left(anchor_t *anchor, deque_t *deque)
+int stabilize_left(anchor_t *anchor, deque_t *deque)
 {
 	anchor_t *nextAnchor;
 	node_t *prevnext;
 	node_t *prev;
 
-	if(deque->anchor!=anchor) return;
+	if(deque->anchor!=anchor) return 0;
 	prev=anchor->left->right;
-	if(deque->anchor!=anchor) return;
+	if(deque->anchor!=anchor) return 0;
 	prevnext=prev->left;
 	if(prevnext!=anchor->left)
 	{
-		if(deque->anchor!=anchor) return;
+		if(deque->anchor!=anchor) return 0;
 		if(!CAS_BOOL(&prev->left,prevnext,anchor->left))
 		{
-			contention+=1;
-			return;
+			return 1;
 		}
 	}
 
@@ -449,31 +447,31 @@ void stabilize_left(anchor_t *anchor, deque_t *deque)
 	nextAnchor->state=STATE_STABLE;
 	if(!CAS_BOOL(&deque->anchor,anchor,nextAnchor))
 	{
-		contention+=1;
 		#if GC == 1
 			ssmem_free(alloc2, (void*) nextAnchor);
 		#endif
+		return 1;
 	}
+	return 0;
 }
 
-void stabilize_right(anchor_t *anchor, deque_t *deque)
+int stabilize_right(anchor_t *anchor, deque_t *deque)
 {
 	anchor_t *nextAnchor;
 	node_t *prevnext;
 	node_t *prev;
 
-	if(deque->anchor!=anchor) return;
+	if(deque->anchor!=anchor) return 0;
 	prev=anchor->right->left;
-	if(deque->anchor!=anchor) return;
+	if(deque->anchor!=anchor) return 0;
 
 	prevnext=prev->right;
 	if(prevnext!=anchor->right)
 	{
-		if(deque->anchor!=anchor) return;
+		if(deque->anchor!=anchor) return 0;
 		if(!CAS_BOOL(&prev->right,prevnext,anchor->right))
 		{
-			contention+=1;
-			return;
+			return 1;
 		}
 	}
 
@@ -482,21 +480,22 @@ void stabilize_right(anchor_t *anchor, deque_t *deque)
 	nextAnchor->state=STATE_STABLE;
 	if(!CAS_BOOL(&deque->anchor,anchor,nextAnchor))
 	{
-		contention+=1;
 		#if GC == 1
 			ssmem_free(alloc2, (void*) nextAnchor);
 		#endif
+		return 1;
 	}
+	return 0;
 }
 
-int deque_size_2D(deque_t *deque)
+int deque_size_2D(mdeque_t *set)
 {
 	int i;
 	int size=0;
 	deque_t* sub_deque;
-	for(i=0;i<width;i++)
+	for(i=0;i<set->width;i++)
 	{
-		sub_deque = &deque[i];
+		sub_deque = &set->deques[i];
 		size += deque_size(sub_deque);
 	}
 	return size;
@@ -533,8 +532,9 @@ int deque_size(deque_t *deque)
 	return size;
 }
 
-deque_t* register_deque(deque_t *set, int thread_id)
+mdeque_handle_t* register_deque(mdeque_t *set, int thread_id)
 {
+	mdeque_handle_t* handle;
     ssalloc_init();
 	#if GC == 1
     if (alloc == NULL)
@@ -550,33 +550,29 @@ deque_t* register_deque(deque_t *set, int thread_id)
 	#endif
 
 	/*************relaxation code****************************/
-	/*create thread local windows*/
-	thread_PLWindow = (window_t *) calloc(1, sizeof(window_t));
-	thread_PRWindow = (window_t *) calloc(1, sizeof(window_t));
-	thread_GLWindow = (window_t *) calloc(1, sizeof(window_t));
-	thread_GRWindow = (window_t *) calloc(1, sizeof(window_t));
-
-	new_window = (window_t *) calloc(1, sizeof(window_t));
+	handle = (mdeque_handle_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mdeque_handle_t));
+	handle->set = set;
 
 	/*initialise thread window max limit*/
-	thread_PLWindow->max = depth;
-	thread_PRWindow->max = depth;
-	thread_GLWindow->max = depth;
-	thread_GRWindow->max = depth;
+	handle->window.PLWindow = set->depth;
+	handle->window.PRWindow = set->depth;
+	handle->window.GLWindow = set->depth;
+	handle->window.GRWindow = set->depth;
+	handle->window.notempty = 0;
 
 	/*create thread local index map*/
-	PLMap_array = (uint64_t *) calloc(width, sizeof(uint64_t));
-	GLMap_array = (uint64_t *) calloc(width, sizeof(uint64_t));
-	PRMap_array = (uint64_t *) calloc(width, sizeof(uint64_t));
-	GRMap_array = (uint64_t *) calloc(width, sizeof(uint64_t));
-	PL_full=0;
-	PR_full=0;
-	GL_full=0;
-	GR_full=0;
+	handle->window.PLMap_array = (int *) calloc(set->width, sizeof(int));
+	handle->window.GLMap_array = (int *) calloc(set->width, sizeof(int));
+	handle->window.PRMap_array = (int *) calloc(set->width, sizeof(int));
+	handle->window.GRMap_array = (int *) calloc(set->width, sizeof(int));
+	handle->window.PL_full=0;
+	handle->window.PR_full=0;
+	handle->window.GL_full=0;
+	handle->window.GR_full=0;
 
 	/*initialise thread starting index*/
-	thread_index=thread_id*(width/num_threads);
+	handle->window.index=thread_id*(set->width/num_threads);
 	/*********************************************************/
 
-    return set;
+    return handle;
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "atomic_ops_if.h"
 #include "ssalloc.h"
 #include "ssmem.h"
+#include "2Dd-window_maged.h"
 
 #define STATE_STABLE 0
 #define STATE_RPUSH 1
@@ -19,8 +20,8 @@
 #define DS_REGISTER(s,t)        register_deque(s,t)
 #define DS_NEW()                create_deque()
 
-#define DS_HANDLE           deque_t*
-#define DS_TYPE             deque_t
+#define DS_HANDLE           mdeque_handle_t*
+#define DS_TYPE             mdeque_t
 #define DS_NODE             node_t
 #define DS_KEY              skey_t
 
@@ -56,22 +57,44 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct deque_struct
     uint8_t padding1[CACHE_LINE_SIZE - sizeof(anchor_t*)];
 } deque_t;
 
-deque_t* create_deque();
+typedef ALIGNED(CACHE_LINE_SIZE) struct mdeque_struct
+{
+    deque_t* deques;
+    int width;
+    int depth;
+    uint8_t padding[CACHE_LINE_SIZE - sizeof(deque_t*) - 2*sizeof(int)];
+    /*global windows, each on its own cache line*/
+    window_t PLWindow;
+    window_t PRWindow;
+    window_t GLWindow;
+    window_t GRWindow;
+} mdeque_t;
+
+typedef struct mdeque_handle_struct
+{
+    mdeque_t* set;
+    thread_window_t window;
+} mdeque_handle_t;
+
+mdeque_t* create_deque();
 node_t* create_node(skey_t k, sval_t value);
 anchor_t* create_anchor();
-deque_t* register_deque(deque_t* set, int thread_id);
+mdeque_handle_t* register_deque(mdeque_t* set, int thread_id);
 
-int push_left(deque_t* set, skey_t k, sval_t value);
-int push_right(deque_t* set, skey_t k, sval_t value);
-sval_t pop_left(deque_t* set);
-sval_t pop_right(deque_t* set);
+int push_left(mdeque_handle_t* handle, skey_t k, sval_t value);
+int push_right(mdeque_handle_t* handle, skey_t k, sval_t value);
+sval_t pop_left(mdeque_handle_t* handle);
+sval_t pop_right(mdeque_handle_t* handle);
 int deque_size(deque_t* set);
 
-static void stabilize(anchor_t *anchor, deque_t* deque);
-static void stabilize_left(anchor_t *anchor, deque_t* deque);
-static void stabilize_right(anchor_t *anchor, deque_t* deque);
+static int stabilize(anchor_t *anchor, deque_t* deque);
+static int stabilize_left(anchor_t *anchor, deque_t* deque);
+static int stabilize_right(anchor_t *anchor, deque_t* deque);
 
 extern size_t num_threads;
+extern int width;
+extern int depth;
+extern int relaxation_bound;
 extern __thread unsigned long my_put_cas_fail_count;
 extern __thread unsigned long my_get_cas_fail_count;
 extern __thread unsigned long my_null_count;
@@ -79,5 +102,5 @@ extern __thread unsigned long my_hop_count;
 extern __thread unsigned long my_window_count;
 
 /************relaxation code************************/
-int deque_size_2D(deque_t* set);
+int deque_size_2D(mdeque_t* set);
 /**************************************************/
\ No newline at end of file
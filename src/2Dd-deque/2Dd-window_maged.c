@@ -1,60 +1,70 @@
 
 #include "2Dd-window_maged.h"
 
-void put_left_window(DS_TYPE* set)
+/*functions, the deque and its handle are defined within the data structure header file.
+  The get windows return NULL if the deque was seen empty*/
+anchor_t* put_left_window(DS_HANDLE handle, int contention);
+anchor_t* put_right_window(DS_HANDLE handle, int contention);
+anchor_t* get_left_window(DS_HANDLE handle, int contention);
+anchor_t* get_right_window(DS_HANDLE handle, int contention);
+int random_index(int width);
+
+anchor_t* put_left_window(DS_HANDLE handle, int contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
+	anchor_t* anchor = NULL;
 	int hops = 0;
 	int random = 0;
-	anchor_ptr = NULL;
 
 	if(contention)
 	{
-		thread_index==random_index();
+		window->index==random_index(set->width);
 		//DO_PAUSE_EXP(contention);
 		my_hop_count+=1;
 	}
 
-	if(thread_PLWindow->max != global_PLWindow->max)
+	if(window->PLWindow != set->PLWindow.max)
 	{
-		thread_PLWindow->max = global_PLWindow->max;
-		PL_full=0;
+		window->PLWindow = set->PLWindow.max;
+		window->PL_full=0;
 	}
 	while(1)
 	{
 		//shift window
-		if(hops == width || PL_full == width)
+		if(hops == set->width || window->PL_full == set->width)
 		{
-			if(thread_PLWindow->max == global_PLWindow->max)
+			if(window->PLWindow == set->PLWindow.max)
 			{
-				new_window->max = thread_PLWindow->max + depth;
-				if(CAS_BOOL(&global_PLWindow->max,thread_PLWindow->max,new_window->max))my_window_count+=1;
+				uint64_t new_max = window->PLWindow + set->depth;
+				if(CAS_BOOL(&set->PLWindow.max,window->PLWindow,new_max))my_window_count+=1;
 			}
-			thread_PLWindow->max = global_PLWindow->max;
-			PL_full=0;
+			window->PLWindow = set->PLWindow.max;
+			window->PL_full=0;
 			hops = 0;
 		}
-		if(PLMap_array[thread_index] < thread_PLWindow->max)
+		if(window->PLMap_array[window->index] < window->PLWindow)
 		{
-			anchor_ptr = set[thread_index].anchor;
-			if(anchor_ptr->PL_count < global_PLWindow->max)
+			anchor = set->deques[window->index].anchor;
+			if(anchor->PL_count < set->PLWindow.max)
 			{
-				return;
+				return anchor;
 			}
-			PL_full+=1;
-			PLMap_array[thread_index]=anchor_ptr->PL_count;
+			window->PL_full+=1;
+			window->PLMap_array[window->index]=anchor->PL_count;
 		}
 		//change index (hop)
-		if(thread_PLWindow->max == global_PLWindow->max)
+		if(window->PLWindow == set->PLWindow.max)
 		{
 			if(random < 2)
 			{
-				thread_index=random_index();
+				window->index=random_index(set->width);
 				random+=1;
 			}
 			else
 			{
-				if(thread_index == width - 1)thread_index=0;
-				else thread_index += 1;
+				if(window->index == set->width - 1)window->index=0;
+				else window->index += 1;
 				hops += 1;
 			}
 			my_hop_count+=1;
@@ -62,67 +72,69 @@ void put_left_window(DS_TYPE* set)
 		//switch to current window
 		else
 		{
-			thread_PLWindow->max = global_PLWindow->max;
+			window->PLWindow = set->PLWindow.max;
 			hops = 0;
-			PL_full=0;
+			window->PL_full=0;
 		}
 	}
 }
 
-void put_right_window(DS_TYPE* set)
+anchor_t* put_right_window(DS_HANDLE handle, int contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
+	anchor_t* anchor = NULL;
 	int hops = 0;
 	int random = 0;
-	anchor_ptr = NULL;
 
 	if(contention)
 	{
-		thread_index==random_index();
+		window->index==random_index(set->width);
 		//DO_PAUSE_EXP(contention);
 		my_hop_count+=1;
 	}
 
-	if(thread_PRWindow->max != global_PRWindow->max)
+	if(window->PRWindow != set->PRWindow.max)
 	{
-		thread_PRWindow->max = global_PRWindow->max;
-		PR_full=0;
+		window->PRWindow = set->PRWindow.max;
+		window->PR_full=0;
 	}
 	while(1)
 	{
 		//shift window
-		if(hops == width || PR_full == width)
+		if(hops == set->width || window->PR_full == set->width)
 		{
-			if(thread_PRWindow->max == global_PRWindow->max)
+			if(window->PRWindow == set->PRWindow.max)
 			{
-				new_window->max = thread_PRWindow->max + depth;
-				if(CAS_BOOL(&global_PRWindow->max,thread_PRWindow->max,new_window->max))my_window_count+=1;
+				uint64_t new_max = window->PRWindow + set->depth;
+				if(CAS_BOOL(&set->PRWindow.max,window->PRWindow,new_max))my_window_count+=1;
 			}
-			thread_PRWindow->max = global_PRWindow->max;
-			PR_full=0;
+			window->PRWindow = set->PRWindow.max;
+			window->PR_full=0;
 			hops = 0;
 		}
-		if(PRMap_array[thread_index] < thread_PRWindow->max)
+		if(window->PRMap_array[window->index] < window->PRWindow)
 		{
-			anchor_ptr = set[thread_index].anchor;
-			if(anchor_ptr->PR_count < global_PRWindow->max)
+			anchor = set->deques[window->index].anchor;
+			if(anchor->PR_count < set->PRWindow.max)
 			{
-				return;
+				return anchor;
 			}
-			PR_full+=1;
-			PRMap_array[thread_index]=anchor_ptr->PR_count;
+			window->PR_full+=1;
+			window->PRMap_array[window->index]=anchor->PR_count;
 		}
 		//change index (hop)
-		if(thread_PRWindow->max == global_PRWindow->max)
+		if(window->PRWindow == set->PRWindow.max)
 		{
 			if(random < 2)
 			{
-				thread_index=random_index();
+				window->index=random_index(set->width);
 				random+=1;
 			}
 			else
 			{
-				if(thread_index == width - 1)thread_index=0;
-				else thread_index += 1;
+				if(window->index == set->width - 1)window->index=0;
+				else window->index += 1;
 				hops += 1;
 			}
 			my_hop_count+=1;
@@ -130,181 +142,181 @@ void put_right_window(DS_TYPE* set)
 		//switch to current window
 		else
 		{
-			thread_PRWindow->max = global_PRWindow->max;
+			window->PRWindow = set->PRWindow.max;
 			hops = 0;
-			PR_full=0;
+			window->PR_full=0;
 		}
 	}
 }
 
-void get_left_window(DS_TYPE* set)
+anchor_t* get_left_window(DS_HANDLE handle, int contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
+	anchor_t* anchor = NULL;
 	int hops = 0;
 	int random = 0;
-	empty_check=0;
-	anchor_ptr = NULL;
 
 	if(contention)
 	{
-		thread_index==random_index();
+		window->index==random_index(set->width);
 		//DO_PAUSE_EXP(contention);
 		my_hop_count+=1;
 	}
 
-	if(thread_GLWindow->max != global_GLWindow->max)
+	if(window->GLWindow != set->GLWindow.max)
 	{
-		thread_GLWindow->max = global_GLWindow->max;
-		notempty=0;
-		GL_full=0;
+		window->GLWindow = set->GLWindow.max;
+		window->notempty=0;
+		window->GL_full=0;
 	}
 	while(1)
 	{
 		//shift window
-		if(hops == width || GL_full == width)
+		if(hops == set->width || window->GL_full == set->width)
 		{
-			if(notempty==0)
+			if(window->notempty==0)
 			{
-				empty_check=1;
-				return ;
+				return NULL;
 			}
-			else if(thread_GLWindow->max == global_GLWindow->max)
+			else if(window->GLWindow == set->GLWindow.max)
 			{
-				new_window->max = thread_GLWindow->max + depth;
-				if(CAS_BOOL(&global_GLWindow->max,thread_GLWindow->max,new_window->max))my_window_count+=1;
+				uint64_t new_max = window->GLWindow + set->depth;
+				if(CAS_BOOL(&set->GLWindow.max,window->GLWindow,new_max))my_window_count+=1;
 			}
-			thread_GLWindow->max = global_GLWindow->max;
+			window->GLWindow = set->GLWindow.max;
 			hops = 0;
-			notempty=0;
-			GL_full=0;
+			window->notempty=0;
+			window->GL_full=0;
 		}
-		if(GLMap_array[thread_index] < thread_GLWindow->max)
+		if(window->GLMap_array[window->index] < window->GLWindow)
 		{
-			anchor_ptr = set[thread_index].anchor;
-			if(anchor_ptr->GL_count < global_GLWindow->max)
+			anchor = set->deques[window->index].anchor;
+			if(anchor->GL_count < set->GLWindow.max)
 			{
-				if(anchor_ptr->left!=NULL)
+				if(anchor->left!=NULL)
 				{
-					return;
+					return anchor;
 				}
 			}
 			else
 			{
-				GL_full+=1;
-				GLMap_array[thread_index]=anchor_ptr->GL_count;
+				window->GL_full+=1;
+				window->GLMap_array[window->index]=anchor->GL_count;
 			}
 		}
 		//change index (hop)
-		if(thread_GLWindow->max == global_GLWindow->max)
+		if(window->GLWindow == set->GLWindow.max)
 		{
 			if(random < 2)
 			{
-				thread_index=random_index();
+				window->index=random_index(set->width);
 				random+=1;
 			}
 			else
 			{
-				if(thread_index == width - 1) thread_index=0;
-				else thread_index += 1;
+				if(window->index == set->width - 1) window->index=0;
+				else window->index += 1;
 				hops += 1;
 			}
-			if(anchor_ptr!=NULL&&anchor_ptr->left!=NULL) notempty=1;
+			if(anchor!=NULL&&anchor->left!=NULL) window->notempty=1;
 			my_hop_count+=1;
 		}
 		//switch to current window
 		else
 		{
-			thread_GLWindow->max = global_GLWindow->max;
+			window->GLWindow = set->GLWindow.max;
 			hops = 0;
-			notempty=0;
-			GL_full=0;
+			window->notempty=0;
+			window->GL_full=0;
 		}
 	}
 }
 
-void get_right_window(DS_TYPE* set)
+anchor_t* get_right_window(DS_HANDLE handle, int contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
+	anchor_t* anchor = NULL;
 	int hops = 0;
 	int random = 0;
-	empty_check=0;
-	anchor_ptr = NULL;
 
 	if(contention)
 	{
-		thread_index==random_index();
+		window->index==random_index(set->width);
 		//DO_PAUSE_EXP(contention);
 		my_hop_count+=1;
 	}
 
-	if(thread_GRWindow->max != global_GRWindow->max)
+	if(window->GRWindow != set->GRWindow.max)
 	{
-		thread_GRWindow->max = global_GRWindow->max;
-		notempty=0;
-		GR_full=0;
+		window->GRWindow = set->GRWindow.max;
+		window->notempty=0;
+		window->GR_full=0;
 	}
 	while(1)
 	{
 		//shift window
-		if(hops == width || GR_full == width)
+		if(hops == set->width || window->GR_full == set->width)
 		{
-			if(notempty==0)
+			if(window->notempty==0)
 			{
-				empty_check=1;
-				return ;
+				return NULL;
 			}
-			else if(thread_GRWindow->max == global_GRWindow->max)
+			else if(window->GRWindow == set->GRWindow.max)
 			{
-				new_window->max = thread_GRWindow->max + depth;
-				if(CAS_BOOL(&global_GRWindow->max,thread_GRWindow->max,new_window->max))my_window_count+=1;
+				uint64_t new_max = window->GRWindow + set->depth;
+				if(CAS_BOOL(&set->GRWindow.max,window->GRWindow,new_max))my_window_count+=1;
 			}
-			thread_GRWindow->max = global_GRWindow->max;
+			window->GRWindow = set->GRWindow.max;
 			hops = 0;
-			notempty=0;
-			GR_full=0;
+			window->notempty=0;
+			window->GR_full=0;
 		}
-		if(GRMap_array[thread_index] < thread_GRWindow->max)
+		if(window->GRMap_array[window->index] < window->GRWindow)
 		{
-			anchor_ptr = set[thread_index].anchor;
-			if(anchor_ptr->GR_count < global_GRWindow->max)
+			anchor = set->deques[window->index].anchor;
+			if(anchor->GR_count < set->GRWindow.max)
 			{
-				if(anchor_ptr->right!=NULL)
+				if(anchor->right!=NULL)
 				{
-					return;
+					return anchor;
 				}
 			}
 			else
 			{
-				GR_full+=1;
-				GRMap_array[thread_index]=anchor_ptr->GR_count;
+				window->GR_full+=1;
+				window->GRMap_array[window->index]=anchor->GR_count;
 			}
 		}
 		//change index (hop)
-		if(thread_GRWindow->max == global_GRWindow->max)
+		if(window->GRWindow == set->GRWindow.max)
 		{
 			if(random < 2)
 			{
-				thread_index=random_index();
+				window->index=random_index(set->width);
 				random+=1;
 			}
 			else
 			{
-				if(thread_index == width - 1) thread_index=0;
-				else thread_index += 1;
+				if(window->index == set->width - 1) window->index=0;
+				else window->index += 1;
 				hops += 1;
 			}
-			if(anchor_ptr!=NULL&&anchor_ptr->right!=NULL) notempty=1;
+			if(anchor!=NULL&&anchor->right!=NULL) window->notempty=1;
 			my_hop_count+=1;
 		}
 		//switch to current window
 		else
 		{
-			thread_GRWindow->max = global_GRWindow->max;
+			window->GRWindow = set->GRWindow.max;
 			hops = 0;
-			notempty=0;
-			GR_full=0;
+			window->notempty=0;
+			window->GR_full=0;
 		}
 	}
 }
-int random_index()
+int random_index(int width)
 {
 	return (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (width));
 }
\ No newline at end of file
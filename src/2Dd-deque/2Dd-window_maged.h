@@ -1,3 +1,6 @@
+#ifndef TWODd_window_maged
+#define TWODd_window_maged
+
 #include <stdio.h>
 #include <stdlib.h>
 #include "utils.h"
@@ -13,44 +16,32 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct window_struct
 	uint8_t padding[CACHE_LINE_SIZE - sizeof(uint64_t)];
 }window_t;
 
-extern int width;
-extern int depth;
-extern int relaxation_bound;
-
-__thread anchor_t* anchor_ptr;
-__thread int contention;
-
-__thread int thread_index;
-
-/******emptiness check****/
-__thread int empty_check;
-__thread int notempty;
-
-/*index mapping variables*/
-__thread int* PLMap_array;
-__thread int* GLMap_array;
-__thread int* PRMap_array;
-__thread int* GRMap_array;
-__thread int PL_full;
-__thread int PR_full;
-__thread int GL_full;
-__thread int GR_full;
-
-/*window variables*/
-window_t* global_PLWindow;
-window_t* global_PRWindow;
-window_t* global_GLWindow;
-window_t* global_GRWindow;
-
-__thread window_t* thread_PLWindow;
-__thread window_t* thread_PRWindow;
-__thread window_t* thread_GLWindow;
-__thread window_t* thread_GRWindow;
-__thread window_t* new_window;
-
-/*functions*/
-void put_left_window(DS_TYPE* set);
-void put_right_window(DS_TYPE* set);
-void get_left_window(DS_TYPE* set);
-void get_right_window(DS_TYPE* set);
-int random_index();
\ No newline at end of file
+/*
+ * The global windows are kept in the deque (PLWindow, PRWindow, GLWindow and GRWindow), and every
+ * thread keeps its view of them in the handle returned by DS_REGISTER, along with its index and the
+ * operation counts it last saw on every sub-deque. This header only holds the types, so that it can
+ * be included before the deque is defined. The functions are declared in 2Dd-window_maged.c.
+ */
+typedef struct thread_window_struct
+{
+	uint64_t PLWindow;
+	uint64_t PRWindow;
+	uint64_t GLWindow;
+	uint64_t GRWindow;
+	int index;
+
+	/******emptiness check****/
+	int notempty;
+
+	/*index mapping variables*/
+	int* PLMap_array;
+	int* GLMap_array;
+	int* PRMap_array;
+	int* GRMap_array;
+	int PL_full;
+	int PR_full;
+	int GL_full;
+	int GR_full;
+} thread_window_t;
+
+#endif
@@ -176,7 +176,7 @@ void* test(void* thread)
     {
 		key = (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (rand_max + 1)) + rand_min;
 
-		if(DS_ADD_L(set, key, key) == false)
+		if(DS_ADD_L(handle, key, key) == false)
 		{
 			i--;
 		}
@@ -195,12 +195,14 @@ void* test(void* thread)
 	barrier_cross(&barrier_global);
 
 	RR_START_SIMPLE();
+	PERF_COUNTERS_START();
 
 	while (stop == 0)
     {
 		TEST_LOOP_ONLY_4UPDATES();
 	}
 
+	PERF_COUNTERS_STOP();
 	barrier_cross(&barrier);
 	RR_STOP_SIMPLE();
 
@@ -267,6 +269,7 @@ main(int argc, char **argv)
 		{"num-buckets",               required_argument, NULL, 'b'},
 		{"print-vals",                required_argument, NULL, 'v'},
 		{"vals-pf",                   required_argument, NULL, 'f'},
+		{"pin",                       required_argument, NULL, 'P'},
 		{NULL, 0, NULL, 0}
 	};
 
@@ -274,7 +277,7 @@ main(int argc, char **argv)
 	while(1)
     {
 		i = 0;
-		c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:k:w:", long_options, &i);
+		c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:k:w:P:", long_options, &i);
 
 		if(c == -1)
 		break;
@@ -319,6 +322,8 @@ main(int argc, char **argv)
 				"        Relaxation bound.\n"
 				"  -w, --Width <int>\n"
 				"        Number of sub structures.\n"
+				"  -P, --pin <policy>\n"
+				"        Pin threads from the sysfs topology: compact-cores-first, scatter-sockets, smt-last or table [DEFAULT=table].\n"
 			, argv[0]);
 			exit(0);
 			case 'd':
@@ -355,6 +360,9 @@ main(int argc, char **argv)
 			case 'w':
 			width = atoi(optarg);
 			break;
+			case 'P':
+			set_pin_policy(optarg);
+			break;
 			case '?':
 			default:
 			printf("Use -h or --help for help\n");
@@ -587,6 +595,7 @@ main(int argc, char **argv)
 	RR_PRINT_CORRECTED();
 	RETRY_STATS_PRINT(total, putting_count_total, removing_count_total, putting_count_total_succ + removing_count_total_succ);
 	LATENCY_DISTRIBUTION_PRINT();
+	PERF_COUNTERS_PRINT(putting_count_total + removing_count_total);
 
 	#if defined(RELAXATION_ANALYSIS)
 		print_relaxation_measurements();
@@ -134,7 +134,7 @@ mqueue_t* create_queue(size_t num_threads, uint32_t width, uint64_t depth, uint8
 	set->relaxation_bound = relaxation_bound;
 
 	// Initlialize the window variables
-	initialize_global_window(depth);
+	initialize_window(set, depth);
 
 	uint64_t i;
 	for(i = 0; i < width; i++)
@@ -217,8 +217,9 @@ static int deq_cae(volatile descriptor_t* des_loc, descriptor_t* read_des_loc, d
 }
 
 
-int enqueue(mqueue_t* set, skey_t key, sval_t val)
+int enqueue(mqueue_handle_t* handle, skey_t key, sval_t val)
 {
+	mqueue_t* set = handle->set;
 	node_t* tail;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
@@ -226,7 +227,7 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val)
 	node_t* new_node = create_node(key, val, NULL);
 	while(1)
     {
-		descriptor = put_window(set,contention);
+		descriptor = put_window(handle, contention);
 
 		tail = descriptor.node;
 
@@ -235,7 +236,7 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val)
 
 		if(tail->next == NULL)
 		{
-			if (set->put_array[thread_index].descriptor.put_count >= thread_PWindow.max) {
+			if (set->put_array[handle->window.index].descriptor.put_count >= handle->window.PWindow.max) {
 				// Double check needed as the descriptor is not read atomically, and the node is written without ensuring it is read correctly
 				continue;
 			}
@@ -253,22 +254,23 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val)
 		{
 			//Try helping pending enqueue
 			new_descriptor.node = tail->next;
-			if(!CAE(&set->put_array[thread_index].descriptor,&descriptor,&new_descriptor))
+			if(!CAE(&set->put_array[handle->window.index].descriptor,&descriptor,&new_descriptor))
 			{
 				contention = 1;
 			}
 		}
 		my_put_cas_fail_count+=1;
     }
-	if(!CAE(&set->put_array[thread_index].descriptor,&descriptor,&new_descriptor));
+	if(!CAE(&set->put_array[handle->window.index].descriptor,&descriptor,&new_descriptor));
 	{
 		contention = 1;
 	}
 	return 1;
 }
 
-sval_t dequeue(mqueue_t* set)
+sval_t dequeue(mqueue_handle_t* handle)
 {
+	mqueue_t* set = handle->set;
 	sval_t val;
 	node_t *head, *tail;
 	uint8_t contention = 0;
@@ -276,9 +278,9 @@ sval_t dequeue(mqueue_t* set)
 
 	while (1)
     {
-		deq_descriptor = get_window(set,contention);
+		deq_descriptor = get_window(handle, contention);
 		head = deq_descriptor.node;
-		enq_descriptor = set->put_array[thread_index].descriptor;
+		enq_descriptor = set->put_array[handle->window.index].descriptor;
 		tail = enq_descriptor.node;
 
 		if (unlikely(head == tail))
@@ -293,7 +295,7 @@ sval_t dequeue(mqueue_t* set)
 				//Try helping pending enqueue
 				new_enq_descriptor.node = tail->next;
 				new_enq_descriptor.put_count = enq_descriptor.put_count + 1;
-				if(!CAE(&set->put_array[thread_index].descriptor,&enq_descriptor,&new_enq_descriptor))
+				if(!CAE(&set->put_array[handle->window.index].descriptor,&enq_descriptor,&new_enq_descriptor))
 				{
 					contention = 1;
 				}
@@ -303,7 +305,7 @@ sval_t dequeue(mqueue_t* set)
 		{
 			new_deq_descriptor.node = head->next;
 			new_deq_descriptor.get_count = deq_descriptor.get_count + 1;
-			if(deq_cae(&set->get_array[thread_index].descriptor, &deq_descriptor, &new_deq_descriptor))
+			if(deq_cae(&set->get_array[handle->window.index].descriptor, &deq_descriptor, &new_deq_descriptor))
 			{
 
 				val = head->next->val;
@@ -340,7 +342,7 @@ size_t queue_size(mqueue_t *set)
 	return size;
 }
 
-mqueue_t* queue_register(mqueue_t *set, int thread_id)
+mqueue_handle_t* queue_register(mqueue_t *set, int thread_id)
 {
     ssalloc_init();
 	#if GC == 1
@@ -352,5 +354,29 @@ mqueue_t* queue_register(mqueue_t *set, int thread_id)
     }
 	#endif
 
-    return set;
+	mqueue_handle_t* handle;
+	if ((handle = (mqueue_handle_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mqueue_handle_t))) == NULL)
+	{
+		perror("malloc");
+		exit(1);
+	}
+	handle->set = set;
+	initialize_thread_window(&handle->window);
+
+    return handle;
+}
+
+// Frees the handle of a thread, which can't operate on the queue any more
+void queue_unregister(mqueue_handle_t* handle)
+{
+	ssfree((void*) handle);
+}
+
+// Frees the descriptor arrays of the queue, once no thread uses it any more. The nodes
+// still in the sub-queues are left to the allocators of the threads.
+void destroy_queue(mqueue_t* set)
+{
+	ssfree((void*) set->get_array);
+	ssfree((void*) set->put_array);
+	ssfree((void*) set);
 }
\ No newline at end of file
@@ -16,6 +16,7 @@
 #include "lock_if.h"
 #include "ssmem.h"
 #include "utils.h"
+#include "2Dd-window.h"
 
 #ifdef RELAXATION_TIMER_ANALYSIS
 #include "relaxation_analysis_timestamps.h"
@@ -32,10 +33,12 @@
 #define DS_REMOVE(s)        dequeue(s)
 #define DS_SIZE(s)          queue_size(s)
 #define DS_REGISTER(s,i)    queue_register(s,i)
+#define DS_UNREGISTER(h)    queue_unregister(h)
+#define DS_DESTROY(s)       destroy_queue(s)
 #define DS_NEW(n,w,d,m,k,i) create_queue(n,w,d,m,k,i)
 
 #define DS_TYPE             mqueue_t
-#define DS_HANDLE           mqueue_t*
+#define DS_HANDLE           mqueue_handle_t*
 #define DS_NODE             node_t
 
 /* Type definitions */
@@ -76,8 +79,19 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct mqueue_file
 	uint32_t width;
 	uint8_t k_mode;
 	uint8_t padding[CACHE_LINE_SIZE - sizeof(uint8_t) - (2 * sizeof(index_t*)) - (sizeof(uint64_t)*3) - sizeof(uint32_t)];
+
+	// The global windows, each in its own cache line
+	volatile padded_put_window_t PWindow;
+	volatile padded_get_window_t GWindow;
 } mqueue_t;
 
+// Per-thread handle, returned by DS_REGISTER
+typedef struct mqueue_handle
+{
+	mqueue_t* set;
+	thread_window_t window;
+} mqueue_handle_t;
+
 /*Global variables*/
 
 
@@ -92,12 +106,14 @@ extern __thread unsigned long my_hop_count;
 extern __thread unsigned long my_slide_count;
 
 /* Interfaces */
-int enqueue(mqueue_t *set, skey_t key, sval_t val);
-sval_t dequeue(mqueue_t *set);
+int enqueue(mqueue_handle_t* handle, skey_t key, sval_t val);
+sval_t dequeue(mqueue_handle_t* handle);
 node_t* create_node(skey_t key, sval_t val, node_t* next);
 void free_node(node_t* node);
 mqueue_t* create_queue(size_t num_threads, uint32_t width, uint64_t depth, uint8_t k_mode, uint64_t relaxation_bound, int thread_id);
-mqueue_t* queue_register(mqueue_t* set, int thread_id);
+mqueue_handle_t* queue_register(mqueue_t* set, int thread_id);
+void queue_unregister(mqueue_handle_t* handle);
+void destroy_queue(mqueue_t* set);
 size_t queue_size(mqueue_t *set);
 int floor_log_2(unsigned int n);
 
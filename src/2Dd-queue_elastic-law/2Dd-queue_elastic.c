@@ -248,8 +248,10 @@ static int deq_cae(volatile descriptor_t* des_loc, descriptor_t* read_des_loc, d
 }
 
 
-int enqueue(mqueue_t* set, skey_t key, sval_t val, int no_init)
+int enqueue(mqueue_handle_t* handle, skey_t key, sval_t val, int no_init)
 {
+	mqueue_t* set = handle->set;
+	thread_window_t* window = &handle->window;
 	node_t* tail;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
@@ -259,15 +261,15 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val, int no_init)
 	while(1)
   {
 
-		descriptor = put_window(set,contention);
+		descriptor = put_window(handle, contention);
 		assert(descriptor.node != NULL);
-		// assert(thread_put_window->max >= thread_get_window->max);
-		assert(descriptor.put_count < thread_put_window->max);
+		// assert(window->put_window->max >= window->get_window->max);
+		assert(descriptor.put_count < window->put_window->max);
 
 		tail = descriptor.node; // Use tail->count instead of descriptor->count, as the descriptor can have the wrong count (non-atomic read)
 		// row_t curr_count = tail->count;
 		// ERR: Is this an error in the original algorithm?
-		if (set->put_array[thread_put_index].descriptor.get_count >= thread_put_window->max) {
+		if (set->put_array[window->put_index].descriptor.get_count >= window->put_window->max) {
 			continue;
 		}
 
@@ -275,13 +277,13 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val, int no_init)
 		assert(new_descriptor.node != NULL);
 
 		// Not very nice to bleed window information here either
-		if (likely(descriptor.put_count >= thread_put_window->max - thread_put_window->depth))
+		if (likely(descriptor.put_count >= window->put_window->max - window->put_window->depth))
 		{
 			new_descriptor.put_count = descriptor.put_count + 1;
 		}
 		else
 		{
-			new_descriptor.put_count = thread_put_window->max - thread_put_window->depth + 1;
+			new_descriptor.put_count = window->put_window->max - window->put_window->depth + 1;
 		}
 		// new_node->count = new_descriptor.put_count;
 
@@ -292,15 +294,15 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val, int no_init)
 			{
 				// Linearization of the enqueue, enqueing the node.
 				// assert(new_node->count <= thread_PWindow.max);
-				assert(thread_put_index <= thread_put_window->width);
-				if (likely(no_init)) dec_put_controller(&controller, set, thread_put_window);
+				assert(window->put_index <= window->put_window->width);
+				if (likely(no_init)) dec_put_controller(&controller, set, window->put_window);
 
 				break;
 			}
 			else
 			{
 				contention = 1;
-				if (likely(no_init)) inc_put_controller(&controller, set, thread_put_window);
+				if (likely(no_init)) inc_put_controller(&controller, set, window->put_window);
 			}
 		}
 		else
@@ -309,14 +311,14 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val, int no_init)
 			// From the same descriptor, so it must be the same count
 			new_descriptor.node = tail->next;
 
-			if(!CAE(&set->put_array[thread_put_index].descriptor, &descriptor, &new_descriptor))
+			if(!CAE(&set->put_array[window->put_index].descriptor, &descriptor, &new_descriptor))
 			{
 				contention = 1;
 			}
 			else
 			{
 				// I think this assert has actually failed a couple of times
-				assert(new_descriptor.put_count <= thread_put_window->max);
+				assert(new_descriptor.put_count <= window->put_window->max);
 				// assert(new_descriptor.node->count == new_descriptor.put_count);	// Should come to the same conclusion
 			}
 		}
@@ -324,35 +326,37 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val, int no_init)
   }
 
 	assert(new_descriptor.node != NULL);
-	CAE(&set->put_array[thread_put_index].descriptor, &descriptor, &new_descriptor);
+	CAE(&set->put_array[window->put_index].descriptor, &descriptor, &new_descriptor);
 
 	return 1;
 }
 
 
-sval_t dequeue(mqueue_t* set, int no_init)
+sval_t dequeue(mqueue_handle_t* handle, int no_init)
 {
+	mqueue_t* set = handle->set;
+	thread_window_t* window = &handle->window;
 	sval_t val;
 	node_t *head;
 	uint8_t contention = 0;
 	descriptor_t enq_descriptor, new_enq_descriptor, deq_descriptor, new_deq_descriptor;
 
 
-	thread_put_window = thread_ltail_pointer = set->lateral->tail;
+	window->put_window = window->ltail_pointer = set->lateral->tail;
 
 	while (1)
     {
-		deq_descriptor = get_window(set,contention);
+		deq_descriptor = get_window(handle, contention);
 
 		head = deq_descriptor.node;
 
-		if (thread_put_window->max > thread_get_window->max)
+		if (window->put_window->max > window->get_window->max)
 		{
 			// Heuristic tells us we are not dequeuing the top item in the queue, so don't have to check tail => faster operation
 			goto safe_deq;
 		}
 
-		enq_descriptor = set->put_array[thread_get_index].descriptor;
+		enq_descriptor = set->put_array[window->get_index].descriptor;
 		node_t* tail = enq_descriptor.node;
 
 		if (unlikely(head == tail))	// Empty, or close to it
@@ -378,7 +382,7 @@ sval_t dequeue(mqueue_t* set, int no_init)
 				}
 				// new_enq_descriptor.put_count = new_enq_descriptor.node->count;
 
-				if(!CAE(&set->put_array[thread_get_index].descriptor, &enq_descriptor, &new_enq_descriptor))
+				if(!CAE(&set->put_array[window->get_index].descriptor, &enq_descriptor, &new_enq_descriptor))
 				{
 					contention = 1;
 					// TODO: Which controller should we increment here? This basically just happens when we have too few items.
@@ -395,7 +399,7 @@ sval_t dequeue(mqueue_t* set, int no_init)
 			new_deq_descriptor.node = head->next;
 
 			new_deq_descriptor.get_count = deq_descriptor.get_count + 1;
-			row_t min = thread_get_window->max - thread_get_window->depth + 1; // The node cannot be dequeued to below the window, as it then should have been dequeus last window. And width can only change at boundaries, so the gap must have stopped at min.
+			row_t min = window->get_window->max - window->get_window->depth + 1; // The node cannot be dequeued to below the window, as it then should have been dequeus last window. And width can only change at boundaries, so the gap must have stopped at min.
 			if (unlikely(new_deq_descriptor.get_count < min))
 			{
 				// Gaps must close at the bottom of the window
@@ -403,17 +407,17 @@ sval_t dequeue(mqueue_t* set, int no_init)
 			}
 
 
-			if(deq_cae(&set->get_array[thread_get_index].descriptor, &deq_descriptor, &new_deq_descriptor))
+			if(deq_cae(&set->get_array[window->get_index].descriptor, &deq_descriptor, &new_deq_descriptor))
 			{
 				free_node(head);
-				if (likely(no_init)) dec_get_controller(&controller, set, thread_get_window);
+				if (likely(no_init)) dec_get_controller(&controller, set, window->get_window);
 				return new_deq_descriptor.node->val;
 			}
 			else
 			{
 				contention = 1;
 				my_get_cas_fail_count+=1;
-				if (likely(no_init)) inc_get_controller(&controller, set, thread_get_window);
+				if (likely(no_init)) inc_get_controller(&controller, set, window->get_window);
 			}
 		}
     }
@@ -490,7 +494,7 @@ void validate_structure(mqueue_t *set)
 	}
 }
 
-mqueue_t* queue_register(mqueue_t *set, int thread_id)
+mqueue_handle_t* queue_register(mqueue_t *set, int thread_id)
 {
     ssalloc_init();
 	#if GC == 1
@@ -502,9 +506,16 @@ mqueue_t* queue_register(mqueue_t *set, int thread_id)
     }
 	#endif
 
-	init_thread_windows(set);
+	mqueue_handle_t* handle;
+	if ((handle = (mqueue_handle_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mqueue_handle_t))) == NULL)
+	{
+		perror("malloc");
+		exit(1);
+	}
+	handle->set = set;
+	init_thread_windows(set, &handle->window);
 
-    return set;
+    return handle;
 }
 
 #ifndef DIFF_DEPTHS
@@ -558,14 +569,14 @@ width_t get_width(mqueue_t *set)
 	return set->width;
 }
 
-row_t get_put_width()
+width_t get_put_width(mqueue_handle_t *handle)
 {
-	// return thread_put_window->max;
-	return thread_put_window->width;
+	// return handle->window.put_window->max;
+	return handle->window.put_window->width;
 }
 
-row_t get_get_width()
+width_t get_get_width(mqueue_handle_t *handle)
 {
-	// return thread_get_window->max;
-	return thread_get_window->width;
+	// return handle->window.get_window->max;
+	return handle->window.get_window->width;
 }
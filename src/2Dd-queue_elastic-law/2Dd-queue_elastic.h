@@ -18,6 +18,7 @@
 #include "utils.h"
 #include "types.h"
 #include "lateral_queue.h"
+#include "2Dd-window_elastic.h"
 
 #ifdef RELAXATION_TIMER_ANALYSIS
 #include "relaxation_analysis_timestamps.h"
@@ -37,7 +38,7 @@
 #define DS_NEW(n,w,d,b,m,k,i) create_queue(n,w,d,b,m,k,i)
 
 #define DS_TYPE               mqueue_t
-#define DS_HANDLE             mqueue_t*
+#define DS_HANDLE             mqueue_handle_t*
 #define DS_NODE               node_t
 
 /* Type definitions */
@@ -93,6 +94,13 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct mqueue_file
 	uint8_t padding[CACHE_LINE_SIZE - sizeof(uint8_t) - 3*sizeof(void*) - 2*sizeof(uint64_t) - 2*sizeof(depth_t) - 2*sizeof(width_t)];
 } mqueue_t;
 
+// Per-thread handle, returned by DS_REGISTER
+typedef struct mqueue_handle
+{
+	mqueue_t* set;
+	thread_window_t window;
+} mqueue_handle_t;
+
 /*Global variables*/
 
 
@@ -107,10 +115,10 @@ extern __thread unsigned long my_hop_count;
 extern __thread unsigned long my_slide_count;
 
 /* Interfaces */
-int enqueue(mqueue_t *set, skey_t key, sval_t val, int no_init);
-sval_t dequeue(mqueue_t *set, int no_init);
+int enqueue(mqueue_handle_t *handle, skey_t key, sval_t val, int no_init);
+sval_t dequeue(mqueue_handle_t *handle, int no_init);
 mqueue_t* create_queue(size_t num_threads, width_t width, depth_t depth, width_t max_width, uint8_t k_mode, uint64_t relaxation_bound, int thread_id);
-mqueue_t* queue_register(mqueue_t* set, int thread_id);
+mqueue_handle_t* queue_register(mqueue_t* set, int thread_id);
 size_t queue_size(mqueue_t *set);
 int floor_log_2(unsigned int n);
 
@@ -125,7 +133,7 @@ depth_t update_depth_get(mqueue_t *set, depth_t depth); // For only updating the
 width_t update_width(mqueue_t *set, width_t width);
 depth_t get_depth(mqueue_t *set);
 width_t get_width(mqueue_t *set);
-row_t get_put_width();
-row_t get_get_width();
+width_t get_put_width(mqueue_handle_t *handle);
+width_t get_get_width(mqueue_handle_t *handle);
 
 #endif
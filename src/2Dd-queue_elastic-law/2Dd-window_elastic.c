@@ -5,6 +5,12 @@
 
 #include "lateral_queue.c"
 
+/* functions */
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention);
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention);
+width_t random_index(width_t width);
+void init_thread_windows(DS_TYPE* set, thread_window_t* window);
+
 
 static inline uint64_t min(uint64_t x, uint64_t y)
 {
@@ -55,78 +61,82 @@ static inline width_t hop(DS_TYPE* set, width_t index, width_t* random, width_t*
 
 }
 
-descriptor_t put_window(DS_TYPE* set, uint8_t contention)
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	width_t hops, random;
 	descriptor_t descriptor;
 	lateral_queue_t* lateral = set->lateral;
 
 	hops = random = 0;
 
-	thread_put_window = thread_ltail_pointer = lateral->tail;
-	if(contention == 1 || unlikely(thread_put_index >= thread_put_window->width))
+	window->put_window = window->ltail_pointer = lateral->tail;
+	if(contention == 1 || unlikely(window->put_index >= window->put_window->width))
 	{
-		thread_put_index = random_index(thread_put_window->width);
+		window->put_index = random_index(window->put_window->width);
 		contention = 0;
 	}
 
 	while(1)
 	{
 		//read descriptor
-		descriptor =  set->put_array[thread_put_index].descriptor;
+		descriptor =  set->put_array[window->put_index].descriptor;
 
 		// Read the global put window and possibly sync
 		lateral_node_t* lat_tail = lateral->tail;
-		if(lat_tail != thread_ltail_pointer)
+		if(lat_tail != window->ltail_pointer)
 		{
-			thread_ltail_pointer = lat_tail;
-			thread_put_window = lat_tail;
+			window->ltail_pointer = lat_tail;
+			window->put_window = lat_tail;
 			hops = 0;
-			if (unlikely(thread_put_index >= thread_put_window->width)) {
-				thread_put_index = 0;
+			if (unlikely(window->put_index >= window->put_window->width)) {
+				window->put_index = 0;
 			}
 		}
 
 		// Valid index
-		else if(descriptor.put_count < thread_put_window->max)
+		else if(descriptor.put_count < window->put_window->max)
 		{
-			assert(thread_put_index < thread_put_window->width);
-			if (thread_get_window && likely(thread_get_window->width == thread_put_window->width)) {
+			assert(window->put_index < window->put_window->width);
+			if (window->get_window && likely(window->get_window->width == window->put_window->width)) {
 				// TODO: Not efficient check in producer/consumer workloads
-				thread_get_index = thread_put_index;
+				window->get_index = window->put_index;
 			}
 			return descriptor;
 		}
 
 		//hop
-		else if(hops < thread_put_window->width)
+		else if(hops < window->put_window->width)
 		{
-			thread_put_index = hop(set, thread_put_index, &random, &hops, thread_put_window->width);
+			window->put_index = hop(set, window->put_index, &random, &hops, window->put_window->width);
 		}
 
 		//shift window
 		else
 		{
 			// Could skip this
-			if(thread_ltail_pointer == lateral->tail)
+			if(window->ltail_pointer == lateral->tail)
 			{
 				depth_t depth = set->depth;
-				shift_put(lateral, thread_ltail_pointer, thread_put_window->max + depth, depth, set->width);
+				shift_put(lateral, window->ltail_pointer, window->put_window->max + depth, depth, set->width);
 			}
 
-			thread_ltail_pointer = lateral->tail;
-			thread_put_window = thread_ltail_pointer;
+			window->ltail_pointer = lateral->tail;
+			window->put_window = window->ltail_pointer;
 			hops = 0;
-			if (unlikely(thread_put_index >= thread_put_window->width)) {
-				thread_put_index = 0;
+			if (unlikely(window->put_index >= window->put_window->width)) {
+				window->put_index = 0;
 			}
 		}
 	}
 
 }
 
-descriptor_t get_window(DS_TYPE* set, uint8_t contention)
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	descriptor_t descriptor;
 	row_t put_count;
 	width_t hops, random;
@@ -136,22 +146,22 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 
 	if(contention == 1)
 	{
-		thread_get_index = random_index(thread_get_window->width);
+		window->get_index = random_index(window->get_window->width);
 		contention = 0;
 	}
 
 	// TODO remove? As we already have in loop. Benchmark
 	lateral_node_t* lat_head = lateral->head;
-	if(lat_head != thread_lhead_pointer && likely(lat_head->next != NULL))
+	if(lat_head != window->lhead_pointer && likely(lat_head->next != NULL))
 	{
 		// This should always be safe (!= null)
-		thread_lhead_pointer = lat_head;
+		window->lhead_pointer = lat_head;
 
 		// Should we set this to null if it is?
-		thread_get_window = lat_head->next;
+		window->get_window = lat_head->next;
 
-		if (unlikely(thread_get_index >= thread_get_window->width)) {
-			thread_get_index = 0;
+		if (unlikely(window->get_index >= window->get_window->width)) {
+			window->get_index = 0;
 		}
 	}
 
@@ -159,21 +169,21 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 	{
 
 		//read descriptor
-		descriptor =  set->get_array[thread_get_index].descriptor;
+		descriptor =  set->get_array[window->get_index].descriptor;
 
 		// Check put count, to see that the queue is not empty. (this is not nice, would be better with segment implementation)
-		if (thread_put_window->max > thread_get_window->max)
+		if (window->put_window->max > window->get_window->max)
 		{
-			put_count = thread_put_window->max - thread_put_window->depth;
+			put_count = window->put_window->max - window->put_window->depth;
 		}
 		else
 		{
-			put_count = set->put_array[thread_get_index].descriptor.put_count;
+			put_count = set->put_array[window->get_index].descriptor.put_count;
 		}
 
 		// Read the global get window and possibly sync
 		lateral_node_t* lat_head = lateral->head;
-		if(lat_head != thread_lhead_pointer)
+		if(lat_head != window->lhead_pointer)
 		{
 			if (unlikely(lat_head->next == NULL)) {
 				// Empty return, very rare for lateral to be empty
@@ -181,43 +191,43 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 			}
 
 			// This should always be safe (!= null)
-			thread_lhead_pointer = lat_head;
+			window->lhead_pointer = lat_head;
 
 			// Should we set this to null if it is?
-			thread_get_window = lat_head->next;
+			window->get_window = lat_head->next;
 
-			if (unlikely(thread_get_index >= thread_get_window->width)) {
-				thread_get_index = 0;
+			if (unlikely(window->get_index >= window->get_window->width)) {
+				window->get_index = 0;
 			}
 		}
 
 		// Valid return
-		else if(descriptor.get_count < thread_get_window->max && descriptor.get_count < put_count)
+		else if(descriptor.get_count < window->get_window->max && descriptor.get_count < put_count)
 		{
 			break;
 		}
 
 		// Hop
-		else if (hops != thread_get_window->width)
+		else if (hops != window->get_window->width)
 		{
-			thread_get_index = hop(set, thread_get_index, &random, &hops, thread_get_window->width);
+			window->get_index = hop(set, window->get_index, &random, &hops, window->get_window->width);
 		}
 
 		// Shift window
-		else if (thread_get_window != lateral->tail)	// Checking the window so that there are no nodes diagonally outside current window
+		else if (window->get_window != lateral->tail)	// Checking the window so that there are no nodes diagonally outside current window
 		{
-			assert(__atomic_load_n(&thread_get_window->next, __ATOMIC_SEQ_CST) != NULL);
+			assert(__atomic_load_n(&window->get_window->next, __ATOMIC_SEQ_CST) != NULL);
 
-			shift_get(lateral, thread_lhead_pointer);
+			shift_get(lateral, window->lhead_pointer);
 
 			// We can do this safely, as we know that there was a window above the last one, so we must be in a window now
-			thread_lhead_pointer = lateral->head;
-			thread_get_window = thread_lhead_pointer->next;
-			assert(thread_get_window != NULL);
+			window->lhead_pointer = lateral->head;
+			window->get_window = window->lhead_pointer->next;
+			assert(window->get_window != NULL);
 
 			hops =  0;
-			if (unlikely(thread_get_index >= thread_get_window->width)) {
-				thread_get_index = 0;
+			if (unlikely(window->get_index >= window->get_window->width)) {
+				window->get_index = 0;
 			}
 		}
 
@@ -228,9 +238,9 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 		}
 	}
 
-	if (thread_put_window && likely(thread_get_window->width == thread_put_window->width)) {
+	if (window->put_window && likely(window->get_window->width == window->put_window->width)) {
 		// TODO: Not efficient in prod/cons settings
-		thread_put_index = thread_get_index;
+		window->put_index = window->get_index;
 	}
 	return descriptor;
 }
@@ -240,10 +250,13 @@ width_t random_index(width_t width)
 	return (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % width);
 }
 
-void init_thread_windows(DS_TYPE* set) {
-	thread_lhead_pointer = set->lateral->head;
-	thread_ltail_pointer = set->lateral->tail;
+void init_thread_windows(DS_TYPE* set, thread_window_t* window) {
+	window->lhead_pointer = set->lateral->head;
+	window->ltail_pointer = set->lateral->tail;
+
+	window->get_window = window->lhead_pointer->next;
+	window->put_window = window->ltail_pointer;
 
-	thread_get_window = thread_lhead_pointer->next;
-	thread_put_window = thread_ltail_pointer;
+	window->put_index = 0;
+	window->get_index = 0;
 }
@@ -3,19 +3,20 @@
 
 #include "lateral_queue.h"
 
-
-__thread lateral_node_t* thread_put_window;
-__thread lateral_node_t* thread_get_window;
-__thread lateral_node_t* thread_lhead_pointer;
-__thread lateral_node_t* thread_ltail_pointer;
-__thread width_t thread_put_index;
-__thread width_t thread_get_index;
-
-/* functions */
-descriptor_t put_window(DS_TYPE* set, uint8_t contention);
-descriptor_t get_window(DS_TYPE* set, uint8_t contention);
-width_t random_index(width_t width);
-
-void init_thread_windows(DS_TYPE* set);
+/*
+ * The global windows are the tail and head of the lateral queue kept in the queue, and every thread
+ * keeps the lateral nodes it last saw, along with its indices, in the handle returned by DS_REGISTER.
+ * This header only holds the types, so that it can be included before the queue is defined. The
+ * functions are declared in 2Dd-window_elastic.c.
+ */
+typedef struct thread_window_struct
+{
+	lateral_node_t* put_window;
+	lateral_node_t* get_window;
+	lateral_node_t* lhead_pointer;
+	lateral_node_t* ltail_pointer;
+	width_t put_index;
+	width_t get_index;
+} thread_window_t;
 
 #endif
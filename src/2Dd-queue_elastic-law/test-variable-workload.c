@@ -158,14 +158,14 @@ void sleep_until(uint64_t target_time_ns) {
     }
 }
 
-void* test_loop_producer(DS_TYPE* set, uint64_t* my_putting_count_succ, uint64_t* my_putting_count)
+void* test_loop_producer(DS_HANDLE handle, uint64_t* my_putting_count_succ, uint64_t* my_putting_count)
 {
 	// Directly copied from main_test_loop, TEST_ONLY_UPDATES, for the producer-consumer scenario
 	uint32_t c = my_random(&(seeds[0]),&(seeds[1]),&(seeds[2]));
 
 	uint32_t key = (c & rand_max) + rand_min;
 	START_TS(1);
-	int res = DS_ADD(set, key, key);
+	int res = DS_ADD(handle, key, key);
 
 	// END_TS(1, my_putting_count_succ);
 	ADD_DUR(my_putting_succ);
@@ -177,14 +177,14 @@ void* test_loop_producer(DS_TYPE* set, uint64_t* my_putting_count_succ, uint64_t
 
 }
 
-void* test_loop_consumer(DS_TYPE* set, uint64_t* my_removing_count, uint64_t* my_removing_count_succ)
+void* test_loop_consumer(DS_HANDLE handle, uint64_t* my_removing_count, uint64_t* my_removing_count_succ)
 {
 	// Directly copied from main_test_loop, TEST_ONLY_UPDATES, for the producer-consumer scenario
 	uint32_t c = my_random(&(seeds[0]),&(seeds[1]),&(seeds[2]));
 
 	int removed;
 	// START_TS(2);
-	removed = DS_REMOVE(set);
+	removed = DS_REMOVE(handle);
 
 	if(removed != 0)
 	{
@@ -351,7 +351,7 @@ void* test(void* thread)
     {
 		key = (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (rand_max + 1)) + rand_min;
 
-		if(enqueue(set, key, key, false) == false)
+		if(enqueue(handle, key, key, false) == false)
 		{
 			i--;
 		}
@@ -383,6 +383,7 @@ void* test(void* thread)
 	int interval_ind = 0;
 
 	RR_START_SIMPLE();
+	PERF_COUNTERS_START();
 
 	if (is_producer(thread_id))
 	{
@@ -399,7 +400,7 @@ void* test(void* thread)
 			{
 				for (int i = 0; i < OPS_PER_TS; i++)
 				{
-					test_loop_producer(set, &my_putting_count, &my_putting_count_succ);
+					test_loop_producer(handle, &my_putting_count, &my_putting_count_succ);
 					// TEST_LOOP_ONLY_UPDATES();
 				}
 				#ifdef RELAXATION_ANALYSIS
@@ -407,7 +408,7 @@ void* test(void* thread)
 				#endif
 
 			    // Calculate the elapsed time in nanoseconds
-				my_widths[timeit] = get_put_width();
+				my_widths[timeit] = get_put_width(handle);
 				my_timestamps[timeit] = get_current_time_ns();
 
 				#ifdef RELAXATION_ANALYSIS
@@ -416,7 +417,7 @@ void* test(void* thread)
 				#endif
 				timeit += 1;
 	        }
-			my_widths[timeit] = get_put_width();
+			my_widths[timeit] = get_put_width(handle);
 		    // Set a 1 to signify that you have gone to sleep (1 is reserved for this..)
 			my_timestamps[timeit++] = 1;
 		}
@@ -427,7 +428,7 @@ void* test(void* thread)
 		{
 			for (int i = 0; i < OPS_PER_TS; i++)
 			{
-				test_loop_consumer(set, &my_removing_count, &my_removing_count_succ);
+				test_loop_consumer(handle, &my_removing_count, &my_removing_count_succ);
 				// TEST_LOOP_ONLY_UPDATES();
 			}
 			#ifdef RELAXATION_ANALYSIS
@@ -436,7 +437,7 @@ void* test(void* thread)
 
 		    // Calculate the elapsed time in nanoseconds
 			my_timestamps[timeit] = get_current_time_ns();
-			my_widths[timeit] = get_get_width();
+			my_widths[timeit] = get_get_width(handle);
 
 			#ifdef RELAXATION_ANALYSIS
 				my_error_dists_sizes[timeit] = error_dists.size;
@@ -447,6 +448,7 @@ void* test(void* thread)
 	}
 
 
+	PERF_COUNTERS_STOP();
 	barrier_cross(&barrier);
 	RR_STOP_SIMPLE();
 	if (!thread_id)
@@ -552,6 +554,7 @@ int main(int argc, char **argv)
 		{"num-buckets",               required_argument, NULL, 'b'},
 		{"print-vals",                required_argument, NULL, 'v'},
 		{"vals-pf",                   required_argument, NULL, 'f'},
+		{"pin",                       required_argument, NULL, 'P'},
 		{NULL, 0, NULL, 0}
 	};
 
@@ -559,7 +562,7 @@ int main(int argc, char **argv)
 	while(1)
     {
 		i = 0;
-		c = getopt_long(argc, argv, "hAf:d:i:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:", long_options, &i);
+		c = getopt_long(argc, argv, "hAf:d:i:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:P:", long_options, &i);
 		if(c == -1)
 		break;
 		if(c == 0 && long_options[i].flag == 0)
@@ -607,6 +610,8 @@ int main(int argc, char **argv)
 			"        Fixed Width or Width to thread ratio depending on the k-mode.\n"
 			"  -m, --K Mode <int>\n"
 			"        0 for Fixed Width and Depth, 1 for Fixed Width, 2 for fixed Depth, 3 for fixed Width to thread ratio.\n"
+			"  -P, --pin <policy>\n"
+			"        Pin threads from the sysfs topology: compact-cores-first, scatter-sockets, smt-last or table [DEFAULT=table].\n"
 			, argv[0]);
 			exit(0);
 			case 'd':
@@ -650,6 +655,9 @@ int main(int argc, char **argv)
 			if(atoi(optarg)<=3) k_mode = atoi(optarg);
 			break;
 			break;
+			case 'P':
+			set_pin_policy(optarg);
+			break;
 			case '?':
 			default:
 			printf("Use -h or --help for help\n");
@@ -831,7 +839,7 @@ int main(int argc, char **argv)
 		long unsigned put_fal = (putting_count_total - putting_count_total_succ) ? putting_fal_total / (putting_count_total - putting_count_total_succ) : 0;
 		long unsigned rem_suc = removing_count_total_succ ? removing_suc_total / removing_count_total_succ : 0;
 		long unsigned rem_fal = (removing_count_total - removing_count_total_succ) ? removing_fal_total / (removing_count_total - removing_count_total_succ) : 0;
-		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, get_suc, get_fal, put_suc, put_fal, rem_suc, rem_fal);
+		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, 0LU, 0LU, put_suc, put_fal, rem_suc, rem_fal);
 	#endif
 
 	#define LLU long long unsigned int
@@ -871,6 +879,7 @@ int main(int argc, char **argv)
 	RR_PRINT_CORRECTED();
 	RETRY_STATS_PRINT(total, putting_count_total, removing_count_total, putting_count_total_succ + removing_count_total_succ);
 	LATENCY_DISTRIBUTION_PRINT();
+	PERF_COUNTERS_PRINT(putting_count_total + removing_count_total);
 
 	printf("Push_CAS_fails , %zu\n", put_cas_fail_count_total);
 	printf("Pop_CAS_fails , %zu\n", get_cas_fail_count_total);
@@ -157,7 +157,7 @@ mqueue_t* create_queue(size_t num_threads, width_t width, depth_t depth, width_t
 	set->relaxation_bound = relaxation_bound;
 
 	// Initlialize the window variables
-	initialize_global_window(depth, width);
+	initialize_window(set, depth, width);
 
 	uint64_t i;
 	node_t *node;
@@ -245,8 +245,10 @@ static int deq_cae(volatile descriptor_t* des_loc, descriptor_t* read_des_loc, d
 }
 
 
-int enqueue(mqueue_t* set, skey_t key, sval_t val, int no_init)
+int enqueue(mqueue_handle_t* handle, skey_t key, sval_t val, int no_init)
 {
+	mqueue_t* set = handle->set;
+	thread_window_t* window = &handle->window;
 	node_t* tail;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
@@ -255,27 +257,27 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val, int no_init)
 	while(1)
   {
 
-		descriptor = put_window(set,contention);
-		assert(thread_PWindow.max >= thread_GWindow.max);
-		assert(descriptor.put_count < thread_PWindow.max);
+		descriptor = put_window(handle, contention);
+		assert(window->PWindow.max >= window->GWindow.max);
+		assert(descriptor.put_count < window->PWindow.max);
 
 		tail = descriptor.node; // Use tail->count instead of descriptor->count, as the descriptor can have the wrong count (non-atomic read)
 		// row_t curr_count = tail->count;
 		// ERR: Is this an error in the original algorithm?
-		if (set->put_array[thread_put_index].descriptor.get_count >= thread_PWindow.max) {
+		if (set->put_array[window->put_index].descriptor.get_count >= window->PWindow.max) {
 			continue;
 		}
 
 		new_descriptor.node = new_node;
 
 		// Not very nice to bleed window information here either
-		if (likely(descriptor.get_count >= thread_PWindow.max - thread_PWindow.depth))
+		if (likely(descriptor.get_count >= window->PWindow.max - window->PWindow.depth))
 		{
 			new_descriptor.put_count = descriptor.get_count + 1;
 		}
 		else
 		{
-			new_descriptor.put_count = thread_PWindow.max - thread_PWindow.depth + 1;
+			new_descriptor.put_count = window->PWindow.max - window->PWindow.depth + 1;
 		}
 		// new_node->count = new_descriptor.put_count;
 
@@ -284,16 +286,16 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val, int no_init)
 			if(enq_cae(&tail->next, new_node))
 			{
 				// Linearization of the enqueue, enqueing the node.
-				// assert(new_node->count <= thread_PWindow.max);
-				assert(thread_put_index <= thread_PWindow.width);
-				if (likely(no_init)) dec_put_controller(&controller, set, thread_PWindow);
+				// assert(new_node->count <= window->PWindow.max);
+				assert(window->put_index <= window->PWindow.width);
+				if (likely(no_init)) dec_put_controller(&controller, set, window->PWindow);
 
 				break;
 			}
 			else
 			{
 				contention = 1;
-				if (likely(no_init)) inc_put_controller(&controller, set, thread_PWindow);
+				if (likely(no_init)) inc_put_controller(&controller, set, window->PWindow);
 			}
 		}
 		else
@@ -302,47 +304,49 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val, int no_init)
 			// From the same descriptor, so it must be the same count
 			new_descriptor.node = tail->next;
 
-			if(!CAE(&set->put_array[thread_put_index].descriptor, &descriptor, &new_descriptor))
+			if(!CAE(&set->put_array[window->put_index].descriptor, &descriptor, &new_descriptor))
 			{
 				contention = 1;
 			}
 			else
 			{
 				// I think this assert has actually failed a couple of times
-				assert(new_descriptor.put_count <= thread_PWindow.max);
+				assert(new_descriptor.put_count <= window->PWindow.max);
 				// assert(new_descriptor.node->count == new_descriptor.put_count);	// Should come to the same conclusion
 			}
 		}
 		my_put_cas_fail_count+=1;
   }
 
-	CAE(&set->put_array[thread_put_index].descriptor, &descriptor, &new_descriptor);
+	CAE(&set->put_array[window->put_index].descriptor, &descriptor, &new_descriptor);
 
 	return 1;
 }
 
 
-sval_t dequeue(mqueue_t* set, int no_init)
+sval_t dequeue(mqueue_handle_t* handle, int no_init)
 {
+	mqueue_t* set = handle->set;
+	thread_window_t* window = &handle->window;
 	sval_t val;
 	node_t *head, *tail;
 	uint8_t contention = 0;
 	descriptor_t enq_descriptor, new_enq_descriptor, deq_descriptor, new_deq_descriptor;
 
 	// Not atomic, but ordering guarantees algorithmic correctness as first word is monotonic
-	thread_PWindow.word1 = global_PWindow.content.word1;
-	thread_PWindow.word2 = global_PWindow.content.word2;
+	window->PWindow.word1 = set->PWindow.content.word1;
+	window->PWindow.word2 = set->PWindow.content.word2;
 
 	while (1)
   {
-		deq_descriptor = get_window(set,contention);
+		deq_descriptor = get_window(handle, contention);
 
 		head = deq_descriptor.node;
 
-		if (thread_PWindow.max - thread_PWindow.depth < thread_GWindow.max)
+		if (window->PWindow.max - window->PWindow.depth < window->GWindow.max)
 		{
 			// Normal case, where have have to check head and tail, as they can overlap
-			enq_descriptor = set->put_array[thread_get_index].descriptor;
+			enq_descriptor = set->put_array[window->get_index].descriptor;
 			tail = enq_descriptor.node;
 			if (unlikely(head == tail))	// Empty, or close to it
 			{
@@ -355,7 +359,7 @@ sval_t dequeue(mqueue_t* set, int no_init)
 				{
 					// Try helping pending enqueue
 					new_enq_descriptor.node = tail->next;
-					row_t enq_win_bottom = global_PWindow.content.max - global_PWindow.content.depth;
+					row_t enq_win_bottom = set->PWindow.content.max - set->PWindow.content.depth;
 					if (likely(enq_descriptor.get_count >= enq_win_bottom))
 					{
 						new_enq_descriptor.put_count = enq_descriptor.get_count + 1;
@@ -366,7 +370,7 @@ sval_t dequeue(mqueue_t* set, int no_init)
 					}
 					// new_enq_descriptor.put_count = new_enq_descriptor.node->count;
 
-					if(!CAE(&set->put_array[thread_get_index].descriptor, &enq_descriptor, &new_enq_descriptor))
+					if(!CAE(&set->put_array[window->get_index].descriptor, &enq_descriptor, &new_enq_descriptor))
 					{
 						contention = 1;
 						// TODO: Which controller should we increment here? This basically just happens when we have too few items.
@@ -388,7 +392,7 @@ sval_t dequeue(mqueue_t* set, int no_init)
 			new_deq_descriptor.node = head->next;
 
 			new_deq_descriptor.get_count = deq_descriptor.get_count + 1;
-			row_t min = thread_GWindow.max - thread_GWindow.depth + 1; // The node cannot be dequeued to below the window, as it then should have been dequeus last window. And width can only change at boundaries, so the gap must have stopped at min.
+			row_t min = window->GWindow.max - window->GWindow.depth + 1; // The node cannot be dequeued to below the window, as it then should have been dequeus last window. And width can only change at boundaries, so the gap must have stopped at min.
 			if (unlikely(new_deq_descriptor.get_count < min))
 			{
 				// Gaps must close at the bottom of the window
@@ -396,17 +400,17 @@ sval_t dequeue(mqueue_t* set, int no_init)
 			}
 
 
-			if(deq_cae(&set->get_array[thread_get_index].descriptor, &deq_descriptor, &new_deq_descriptor))
+			if(deq_cae(&set->get_array[window->get_index].descriptor, &deq_descriptor, &new_deq_descriptor))
 			{
 				free_node(head);
-				if (likely(no_init)) dec_get_controller(&controller, set, thread_GWindow);
+				if (likely(no_init)) dec_get_controller(&controller, set, window->GWindow);
 				return new_deq_descriptor.node->val;
 			}
 			else
 			{
 				contention = 1;
 				my_get_cas_fail_count+=1;
-				if (likely(no_init)) inc_get_controller(&controller, set, thread_GWindow);
+				if (likely(no_init)) inc_get_controller(&controller, set, window->GWindow);
 			}
 		}
   }
@@ -454,14 +458,14 @@ void validate_structure(mqueue_t *set)
 	width_t width = set->width;
 	depth_t depth = set->depth;
 
-	width_t put_next_width = global_PWindow.content.next_width;
+	width_t put_next_width = set->PWindow.content.next_width;
 	if (put_next_width != width)
 		printf("WARNING: Global PWindow is not updated and still has next width: %u\n", put_next_width);
 
-	if (put_next_width != global_PWindow.content.width)
+	if (put_next_width != set->PWindow.content.width)
 		printf("WARNING: Global PWindow does not have same width and next width\n");
 
-	row_t put_max = global_PWindow.content.max;
+	row_t put_max = set->PWindow.content.max;
 	for (int i = 0; i < put_next_width; i++)
 	{
 		descriptor_t des = set->put_array[i].descriptor;
@@ -471,8 +475,8 @@ void validate_structure(mqueue_t *set)
 			printf("ERROR: Too high put count at index %d\n", i);
 	}
 
-	width_t get_width = global_GWindow.content.width;
-	row_t get_max = global_GWindow.content.max;
+	width_t get_width = set->GWindow.content.width;
+	row_t get_max = set->GWindow.content.max;
 	for (int i = 0; i < get_width; i++)
 	{
 		descriptor_t des = set->get_array[i].descriptor;
@@ -523,7 +527,7 @@ width_t update_width(mqueue_t *set, width_t width)
 	 * Changes the width of the next global put window. Returns old one
 	 */
 
-	// printf("Setting width to %d, while current max is %zu\n", width, thread_PWindow.max);
+	// printf("Setting width to %d, while current max is %zu\n", width, set->PWindow.content.max);
 	return SWP(&set->width, width);
 
 }
@@ -538,17 +542,17 @@ width_t get_width(mqueue_t *set)
 	return set->width;
 }
 
-width_t get_put_width()
+width_t get_put_width(mqueue_handle_t *handle)
 {
-	return thread_PWindow.width;
+	return handle->window.PWindow.width;
 }
 
-width_t get_get_width()
+width_t get_get_width(mqueue_handle_t *handle)
 {
-	return thread_GWindow.width;
+	return handle->window.GWindow.width;
 }
 
-mqueue_t* queue_register(mqueue_t *set, int thread_id)
+mqueue_handle_t* queue_register(mqueue_t *set, int thread_id)
 {
     ssalloc_init();
 	#if GC == 1
@@ -560,5 +564,14 @@ mqueue_t* queue_register(mqueue_t *set, int thread_id)
     }
 	#endif
 
-    return set;
+	mqueue_handle_t* handle;
+	if ((handle = (mqueue_handle_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mqueue_handle_t))) == NULL)
+	{
+		perror("malloc");
+		exit(1);
+	}
+	handle->set = set;
+	initialize_thread_window(&handle->window);
+
+    return handle;
 }
\ No newline at end of file
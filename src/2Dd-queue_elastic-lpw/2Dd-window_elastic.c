@@ -5,6 +5,13 @@
 
 #include "lateral_queue.c"
 
+/* functions */
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention);
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention);
+width_t random_index(width_t width);
+void initialize_window(DS_TYPE* set, depth_t depth, width_t width);
+void initialize_thread_window(thread_window_t* window);
+
 
 static inline uint64_t min(uint64_t x, uint64_t y)
 {
@@ -64,42 +71,44 @@ static inline depth_t put_depth(DS_TYPE* set) {
 
 }
 
-static inline row_t get_shift_max(DS_TYPE* set)
+static inline row_t get_shift_max(DS_TYPE* set, thread_window_t* window)
 {
 	// Returns the max of the new get window. Can't surpas the put windows max.
 
 	#ifdef DIFF_DEPTH
-	row_t max = thread_GWindow.max + set->get_depth;
+	row_t max = window->GWindow.max + set->get_depth;
 	#else
-	row_t max = thread_GWindow.max + set->depth;
+	row_t max = window->GWindow.max + set->depth;
 	#endif
 
 
-	if (max > thread_PWindow.max || max > global_PWindow.content.max)
+	if (max > window->PWindow.max || max > set->PWindow.content.max)
 	{
 		// Slow, but almost empty, so not the most important
-		max = global_PWindow.content.max;
+		max = set->PWindow.content.max;
 	}
 
 	return max;
 }
 
 // Reads the global pwindow into the thread local one atomically
-static void read_pwindow()
+static void read_pwindow(DS_TYPE* set, thread_window_t* window)
 {
 	// Opt: Can we read it in two consecutive parts? First in that case the version, and then the rest
-	__atomic_load(&global_PWindow.content, &thread_PWindow, __ATOMIC_SEQ_CST);
+	__atomic_load(&set->PWindow.content, &window->PWindow, __ATOMIC_SEQ_CST);
 }
 
-static void read_gwindow()
+static void read_gwindow(DS_TYPE* set, thread_window_t* window)
 {
 	// Opt: Can we read it in two consecutive parts? First in that case the version, and then the rest
-	__atomic_load(&global_GWindow.content, &thread_GWindow, __ATOMIC_SEQ_CST);
+	__atomic_load(&set->GWindow.content, &window->GWindow, __ATOMIC_SEQ_CST);
 }
 
 
-descriptor_t put_window(DS_TYPE* set, uint8_t contention)
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	width_t hops, random;
 	descriptor_t descriptor;
 	put_window_t new_window;
@@ -107,71 +116,71 @@ descriptor_t put_window(DS_TYPE* set, uint8_t contention)
 
 	hops = random = 0;
 
-	window_word1 = global_PWindow.content.word1;
-	if(thread_PWindow.word1 != window_word1)
+	window_word1 = set->PWindow.content.word1;
+	if(window->PWindow.word1 != window_word1)
 	{
-		thread_PWindow.word1 = window_word1;
-		thread_PWindow.word2 = global_PWindow.content.word2; // as we read this strictly after word1 (x86 guarantee), it has to be at least as new (atomic read preferable, but scales horribly)
-		// read_pwindow();
-		assert(thread_PWindow.depth != 0);
+		window->PWindow.word1 = window_word1;
+		window->PWindow.word2 = set->PWindow.content.word2; // as we read this strictly after word1 (x86 guarantee), it has to be at least as new (atomic read preferable, but scales horribly)
+		// read_pwindow(set, window);
+		assert(window->PWindow.depth != 0);
 	}
 
 	// Can happen when you have synchronized width from somewhere else
-	if (contention == 1 || unlikely(thread_put_index >= thread_PWindow.width)) {
-		thread_put_index = random_index(thread_PWindow.width);
+	if (contention == 1 || unlikely(window->put_index >= window->PWindow.width)) {
+		window->put_index = random_index(window->PWindow.width);
 	}
 
 	while(1)
 	{
 		//read descriptor
-		descriptor =  set->put_array[thread_put_index].descriptor;
+		descriptor =  set->put_array[window->put_index].descriptor;
 
 		// Read the global get window and possibly sync
-		window_word1 = global_PWindow.content.word1;
-		if(thread_PWindow.word1 != window_word1)
+		window_word1 = set->PWindow.content.word1;
+		if(window->PWindow.word1 != window_word1)
 		{
-			thread_PWindow.word1 = window_word1;
-			thread_PWindow.word2 = global_PWindow.content.word2; // as we read this strictly after word1 (x86 guarantee), it has to be at least as new (atomic read preferable, but scales horribly)
+			window->PWindow.word1 = window_word1;
+			window->PWindow.word2 = set->PWindow.content.word2; // as we read this strictly after word1 (x86 guarantee), it has to be at least as new (atomic read preferable, but scales horribly)
 			hops = 0;
-			// read_pwindow();
-			if (unlikely(thread_put_index >= thread_PWindow.width)) {
-				thread_put_index = 0;
+			// read_pwindow(set, window);
+			if (unlikely(window->put_index >= window->PWindow.width)) {
+				window->put_index = 0;
 			}
 		}
 
 		// Valid index
-		else if(descriptor.put_count < thread_PWindow.max)
+		else if(descriptor.put_count < window->PWindow.max)
 		{
-			assert(thread_put_index < thread_PWindow.width);
-			if (likely(thread_GWindow.width == thread_PWindow.width)) {
-				thread_get_index = thread_put_index;
+			assert(window->put_index < window->PWindow.width);
+			if (likely(window->GWindow.width == window->PWindow.width)) {
+				window->get_index = window->put_index;
 			}
 			return descriptor;
 		}
 
 		//hop
-		else if(hops < thread_PWindow.width)
+		else if(hops < window->PWindow.width)
 		{
-			thread_put_index = hop(set, thread_put_index, &random, &hops, thread_PWindow.width);
+			window->put_index = hop(set, window->put_index, &random, &hops, window->PWindow.width);
 		}
 
 		//shift window
 		else
 		{
 			// Could skip this
-			if(thread_PWindow.max == global_PWindow.content.max)
+			if(window->PWindow.max == set->PWindow.content.max)
 			{
-				maybe_enq_lateral(set->lateral, thread_PWindow.max, thread_PWindow.width, thread_PWindow.next_width);
+				maybe_enq_lateral(set->lateral, window->PWindow.max, window->PWindow.width, window->PWindow.next_width);
 
 				new_window.depth = put_depth(set);
-				new_window.max = thread_PWindow.max + new_window.depth;
+				new_window.max = window->PWindow.max + new_window.depth;
 				new_window.next_width = set->width;
-				new_window.width = thread_PWindow.next_width;
+				new_window.width = window->PWindow.next_width;
 
-				if(CAE(&global_PWindow.content, &thread_PWindow, &new_window))
+				if(CAE(&set->PWindow.content, &window->PWindow, &new_window))
 				{
 					my_slide_count+=1;
-					thread_PWindow = new_window;
+					window->PWindow = new_window;
 				}
 				else
 				{
@@ -180,16 +189,18 @@ descriptor_t put_window(DS_TYPE* set, uint8_t contention)
 			}
 
 			hops = 0;
-			if (unlikely(thread_put_index >= thread_PWindow.width)) {
-				thread_put_index = 0;
+			if (unlikely(window->put_index >= window->PWindow.width)) {
+				window->put_index = 0;
 			}
 		}
 	}
 
 }
 
-descriptor_t get_window(DS_TYPE* set, uint8_t contention)
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	descriptor_t descriptor;
 	get_window_t new_window;
 	uint64_t window_word1;
@@ -201,29 +212,29 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 
 	if(contention == 1)
 	{
-		thread_get_index = random_index(thread_GWindow.width);
+		window->get_index = random_index(window->GWindow.width);
 		contention = 0;
 	}
 
 	// TODO remove? As we already have in loop. Benchmark
-	window_word1 = global_GWindow.content.word1;
-	if(thread_GWindow.word1 != window_word1)
+	window_word1 = set->GWindow.content.word1;
+	if(window->GWindow.word1 != window_word1)
 	{
-		thread_GWindow.word1 = window_word1;
-		thread_GWindow.word2 = global_GWindow.content.word2; // as we read this strictly after word1 (x86 guarantee), it has to be at least as new (atomic read preferable, but scales horribly)
-		// read_gwindow();
-		if (unlikely(thread_get_index >= thread_GWindow.width)) {
-			thread_get_index = 0;
+		window->GWindow.word1 = window_word1;
+		window->GWindow.word2 = set->GWindow.content.word2; // as we read this strictly after word1 (x86 guarantee), it has to be at least as new (atomic read preferable, but scales horribly)
+		// read_gwindow(set, window);
+		if (unlikely(window->get_index >= window->GWindow.width)) {
+			window->get_index = 0;
 		}
 	}
 
-	row_t put_count_lower_bound = thread_PWindow.max - thread_PWindow.depth;
+	row_t put_count_lower_bound = window->PWindow.max - window->PWindow.depth;
 
 	while(1)
 	{
 
 		//read descriptor
-		descriptor =  set->get_array[thread_get_index].descriptor;
+		descriptor =  set->get_array[window->get_index].descriptor;
 
 		if (put_count_lower_bound >= descriptor.get_count)
 		{
@@ -233,55 +244,55 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 		}
 		else {
 			// Here we must check if the sub-structure is actually empty, which has performance implications
-			put_count = set->put_array[thread_get_index].descriptor.put_count;
+			put_count = set->put_array[window->get_index].descriptor.put_count;
 		}
 
 
 		// Read the global get window and possibly sync
-		window_word1 = global_GWindow.content.word1;
-		if(thread_GWindow.word1 != window_word1)
+		window_word1 = set->GWindow.content.word1;
+		if(window->GWindow.word1 != window_word1)
 		{
-			thread_GWindow.word1 = window_word1;
-			thread_GWindow.word2 = global_GWindow.content.word2; // as we read this strictly after word1 (x86 guarantee), it has to be at least as new (atomic read preferable, but scales horribly)
-			// read_gwindow();
+			window->GWindow.word1 = window_word1;
+			window->GWindow.word2 = set->GWindow.content.word2; // as we read this strictly after word1 (x86 guarantee), it has to be at least as new (atomic read preferable, but scales horribly)
+			// read_gwindow(set, window);
 			hops = notempty = 0;
-			if (unlikely(thread_get_index >= thread_GWindow.width)) {
-				thread_get_index = 0;
+			if (unlikely(window->get_index >= window->GWindow.width)) {
+				window->get_index = 0;
 			}
 		}
 
 		// Valid return
-		else if(descriptor.get_count < thread_GWindow.max && descriptor.get_count < put_count)
+		else if(descriptor.get_count < window->GWindow.max && descriptor.get_count < put_count)
 		{
 			break;
 		}
 
 		// Hop
-		else if (hops != thread_GWindow.width)
+		else if (hops != window->GWindow.width)
 		{
 			//notempty = notempty || descriptor.get_count < put_count;
 			if (notempty == 0 && descriptor.get_count < put_count)
 			{
 				notempty = 1;
 			}
-			thread_get_index = hop(set, thread_get_index, &random, &hops, thread_GWindow.width);
+			window->get_index = hop(set, window->get_index, &random, &hops, window->GWindow.width);
 		}
 
 		// Shift window
-		else if (notempty || thread_GWindow.max != global_PWindow.content.max)	// Checking the window so that there are no nodes diagonally outside current window
+		else if (notempty || window->GWindow.max != set->PWindow.content.max)	// Checking the window so that there are no nodes diagonally outside current window
 		{
-			new_window.max = get_shift_max(set);
-			new_window.width = get_next_window_lateral(set->lateral, thread_GWindow.max, &new_window.max);
-			new_window.depth = new_window.max - thread_GWindow.max;
+			new_window.max = get_shift_max(set, window);
+			new_window.width = get_next_window_lateral(set->lateral, window->GWindow.max, &new_window.max);
+			new_window.depth = new_window.max - window->GWindow.max;
 
-			if(thread_GWindow.max == global_GWindow.content.max)
+			if(window->GWindow.max == set->GWindow.content.max)
 			{
-				assert(new_window.max >= thread_GWindow.max);		// Since the window is not empty, it must be possible to shift up
-				if(CAE(&global_GWindow.content, &thread_GWindow, &new_window))
+				assert(new_window.max >= window->GWindow.max);		// Since the window is not empty, it must be possible to shift up
+				if(CAE(&set->GWindow.content, &window->GWindow, &new_window))
 				{
 					my_slide_count+=1;
 					deq_lateral(set->lateral, new_window.max);
-					thread_GWindow = new_window;
+					window->GWindow = new_window;
 				}
 				else
 				{
@@ -290,8 +301,8 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 			}
 
 			hops = notempty = 0;
-			if (unlikely(thread_get_index >= thread_GWindow.width)) {
-				thread_get_index = 0;
+			if (unlikely(window->get_index >= window->GWindow.width)) {
+				window->get_index = 0;
 			}
 		}
 
@@ -302,8 +313,8 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 		}
 	}
 
-	if (likely(thread_GWindow.width == thread_PWindow.width)) {
-		thread_put_index = thread_get_index;
+	if (likely(window->GWindow.width == window->PWindow.width)) {
+		window->put_index = window->get_index;
 	}
 	return descriptor;
 }
@@ -313,22 +324,31 @@ width_t random_index(width_t width)
 	return (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % width);
 }
 
-void initialize_global_window(depth_t depth, width_t width)
+void initialize_window(DS_TYPE* set, depth_t depth, width_t width)
 {
 	/**
-	 * Initializes the required global window variables
+	 * Initializes the global windows of a queue
 	 */
 
 	assert(depth != 0);
 
 	printf("Initializing! %u %u\n", depth, width);
 
-	global_PWindow.content.max = depth;
-	global_PWindow.content.width = width;
-	global_PWindow.content.next_width = width;
-	global_PWindow.content.depth = depth;
+	set->PWindow.content.max = depth;
+	set->PWindow.content.width = width;
+	set->PWindow.content.next_width = width;
+	set->PWindow.content.depth = depth;
+
+	set->GWindow.content.max = depth;
+	set->GWindow.content.width = width;
+	set->GWindow.content.depth = depth;
+}
+
+void initialize_thread_window(thread_window_t* window)
+{
+	/**
+	 * Initializes the view of the windows of a thread, which is synchronized at its first operation
+	 */
 
-	global_GWindow.content.max = depth;
-	global_GWindow.content.width = width;
-	global_GWindow.content.depth = depth;
+	memset(window, 0, sizeof(thread_window_t));
 }
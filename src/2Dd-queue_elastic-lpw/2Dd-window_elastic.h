@@ -47,19 +47,18 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct padded_get_window_struct
 	uint8_t padding[CACHE_LINE_SIZE - sizeof(get_window_t)];
 } padded_get_window_t;
 
-/*window variables*/
-volatile padded_put_window_t global_PWindow;
-volatile padded_get_window_t global_GWindow;
-
-__thread put_window_t thread_PWindow;
-__thread get_window_t thread_GWindow;
-__thread width_t thread_put_index;
-__thread width_t thread_get_index;
-
-/* functions */
-descriptor_t put_window(DS_TYPE* set, uint8_t contention);
-descriptor_t get_window(DS_TYPE* set, uint8_t contention);
-width_t random_index(width_t width);
-void initialize_global_window(depth_t depth, width_t width);
+/*
+ * The global windows are kept in the queue (PWindow and GWindow), and every thread keeps its view
+ * of them in the handle returned by DS_REGISTER, along with its indices. This header only holds
+ * the types, so that it can be included before the queue is defined. The functions are declared
+ * in 2Dd-window_elastic.c.
+ */
+typedef struct thread_window_struct
+{
+	put_window_t PWindow;
+	get_window_t GWindow;
+	width_t put_index;
+	width_t get_index;
+} thread_window_t;
 
 #endif
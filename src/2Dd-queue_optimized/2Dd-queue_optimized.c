@@ -141,7 +141,7 @@ mqueue_t* create_queue(size_t num_threads, width_t width, depth_t depth, uint8_t
 	set->relaxation_bound = relaxation_bound;
 
 	// Initlialize the window variables
-	initialize_global_window(depth, width);
+	initialize_window(set, depth);
 
 	uint64_t i;
 	node_t *node;
@@ -225,8 +225,10 @@ static int deq_cae(volatile descriptor_t* des_loc, descriptor_t* read_des_loc, d
 }
 
 
-int enqueue(mqueue_t* set, skey_t key, sval_t val)
+int enqueue(mqueue_handle_t* handle, skey_t key, sval_t val)
 {
+	mqueue_t* set = handle->set;
+	thread_window_t* window = &handle->window;
 	node_t* tail;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
@@ -235,14 +237,14 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val)
 	while(1)
   {
 
-		descriptor = put_window(set,contention);
-		assert(thread_PWindow.max >= thread_GWindow.max);
-		assert(descriptor.put_count < thread_PWindow.max);
+		descriptor = put_window(handle, contention);
+		assert(window->PWindow.max >= window->GWindow.max);
+		assert(descriptor.put_count < window->PWindow.max);
 
 		tail = descriptor.node; // Use tail->count instead of descriptor->count, as the descriptor can have the wrong count (non-atomic read)
 		// row_t curr_count = tail->count;
 		// ERR: Is this an error in the original algorithm?
-		if (set->put_array[thread_put_index].descriptor.get_count >= thread_PWindow.max) {
+		if (set->put_array[window->put_index].descriptor.get_count >= window->PWindow.max) {
 			continue;
 		}
 
@@ -267,7 +269,7 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val)
 			// From the same descriptor, so it must be the same count
 			new_descriptor.node = tail->next;
 
-			if(!CAE(&set->put_array[thread_put_index].descriptor, &descriptor, &new_descriptor))
+			if(!CAE(&set->put_array[window->put_index].descriptor, &descriptor, &new_descriptor))
 			{
 				contention = 1;
 			}
@@ -275,28 +277,30 @@ int enqueue(mqueue_t* set, skey_t key, sval_t val)
 		my_put_cas_fail_count+=1;
   }
 
-	CAE(&set->put_array[thread_put_index].descriptor, &descriptor, &new_descriptor);
+	CAE(&set->put_array[window->put_index].descriptor, &descriptor, &new_descriptor);
 
 	return 1;
 }
 
 
-sval_t dequeue(mqueue_t* set)
+sval_t dequeue(mqueue_handle_t* handle)
 {
+	mqueue_t* set = handle->set;
+	thread_window_t* window = &handle->window;
 	sval_t val;
 	node_t *head, *tail;
 	uint8_t contention = 0;
 	descriptor_t enq_descriptor, new_enq_descriptor, deq_descriptor, new_deq_descriptor;
-	thread_PWindow.max = global_PWindow.content.max;
+	window->PWindow.max = set->PWindow.content.max;
 
 	while (1)
     {
-		deq_descriptor = get_window(set,contention);
+		deq_descriptor = get_window(handle, contention);
 
 		head = deq_descriptor.node;
-		enq_descriptor = set->put_array[thread_get_index].descriptor;
+		enq_descriptor = set->put_array[window->get_index].descriptor;
 
-		if (thread_PWindow.max > thread_GWindow.max) {
+		if (window->PWindow.max > window->GWindow.max) {
 			// Don't have to read tail, potentially saving a cache miss (especially in prod/con)
 			goto safe_deq;
 		}
@@ -316,7 +320,7 @@ sval_t dequeue(mqueue_t* set)
 				new_enq_descriptor.node = tail->next;
 				new_enq_descriptor.put_count = enq_descriptor.put_count + 1;
 
-				if(!CAE(&set->put_array[thread_get_index].descriptor, &enq_descriptor, &new_enq_descriptor))
+				if(!CAE(&set->put_array[window->get_index].descriptor, &enq_descriptor, &new_enq_descriptor))
 				{
 					contention = 1;
 				}
@@ -329,7 +333,7 @@ sval_t dequeue(mqueue_t* set)
 
 			new_deq_descriptor.get_count = deq_descriptor.get_count + 1;
 
-			if(deq_cae(&set->get_array[thread_get_index].descriptor, &deq_descriptor, &new_deq_descriptor))
+			if(deq_cae(&set->get_array[window->get_index].descriptor, &deq_descriptor, &new_deq_descriptor))
 			{
 				free_node(head);
 				return new_deq_descriptor.node->val;
@@ -364,7 +368,7 @@ size_t queue_size(mqueue_t *set)
 	return size;
 }
 
-mqueue_t* queue_register(mqueue_t *set, int thread_id)
+mqueue_handle_t* queue_register(mqueue_t *set, int thread_id)
 {
     ssalloc_init();
 	#if GC == 1
@@ -376,8 +380,29 @@ mqueue_t* queue_register(mqueue_t *set, int thread_id)
     }
 	#endif
 
-	thread_depth = set->depth;
-	thread_width = set->width;
+	mqueue_handle_t* handle;
+	if ((handle = (mqueue_handle_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mqueue_handle_t))) == NULL)
+	{
+		perror("malloc");
+		exit(1);
+	}
+	handle->set = set;
+	initialize_thread_window(set, &handle->window);
+
+    return handle;
+}
 
-    return set;
+// Frees the handle of a thread, which can't operate on the queue any more
+void queue_unregister(mqueue_handle_t* handle)
+{
+	ssfree((void*) handle);
+}
+
+// Frees the descriptor arrays of the queue, once no thread uses it any more. The nodes
+// still in the sub-queues are left to the allocators of the threads.
+void destroy_queue(mqueue_t* set)
+{
+	ssfree((void*) set->get_array);
+	ssfree((void*) set->put_array);
+	ssfree((void*) set);
 }
@@ -2,6 +2,13 @@
 #include "2Dd-window_optimized.h"
 #include "2Dd-queue_optimized.h"
 
+/* functions */
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention);
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention);
+width_t random_index(width_t width);
+void initialize_window(DS_TYPE* set, depth_t depth);
+void initialize_thread_window(DS_TYPE* set, thread_window_t* window);
+
 static inline uint64_t min(uint64_t x, uint64_t y)
 {
 	if (x <= y)
@@ -51,8 +58,10 @@ static inline width_t hop(DS_TYPE* set, width_t index, width_t* random, width_t*
 
 }
 
-descriptor_t put_window(DS_TYPE* set, uint8_t contention)
+descriptor_t put_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	width_t hops, random;
 	descriptor_t descriptor;
 	window_t new_window;
@@ -61,49 +70,49 @@ descriptor_t put_window(DS_TYPE* set, uint8_t contention)
 
 	if(contention == 1)
 	{
-		thread_put_index = random_index(thread_width);
+		window->put_index = random_index(window->width);
 		contention = 0;
 	}
 
-	thread_PWindow.max = global_PWindow.content.max;
+	window->PWindow.max = set->PWindow.content.max;
 
 	while(1)
 	{
 		//read descriptor
-		descriptor =  set->put_array[thread_put_index].descriptor;
+		descriptor =  set->put_array[window->put_index].descriptor;
 
 		// Read the global get window and possibly sync
-		row_t gmax = global_PWindow.content.max;
-		if(thread_PWindow.max != gmax)
+		row_t gmax = set->PWindow.content.max;
+		if(window->PWindow.max != gmax)
 		{
-			thread_PWindow.max = gmax;
+			window->PWindow.max = gmax;
 			hops = 0;
 		}
 
 		// Valid index
-		else if(descriptor.put_count < thread_PWindow.max)
+		else if(descriptor.put_count < window->PWindow.max)
 		{
-			thread_get_index = thread_put_index;
+			window->get_index = window->put_index;
 			return descriptor;
 		}
 
 		//hop
-		else if(hops < thread_width)
+		else if(hops < window->width)
 		{
-			thread_put_index = hop(set, thread_put_index, &random, &hops, thread_width);
+			window->put_index = hop(set, window->put_index, &random, &hops, window->width);
 		}
 
 		//shift window
 		else
 		{
 			// Could skip this
-			if(thread_PWindow.max == global_PWindow.content.max)
+			if(window->PWindow.max == set->PWindow.content.max)
 			{
-				new_window.max = thread_PWindow.max + thread_depth;
-				if(CAE(&global_PWindow.content, &thread_PWindow, &new_window))
+				new_window.max = window->PWindow.max + window->depth;
+				if(CAE(&set->PWindow.content, &window->PWindow, &new_window))
 				{
 					my_slide_count+=1;
-					thread_PWindow = new_window;
+					window->PWindow = new_window;
 				}
 				else
 				{
@@ -117,8 +126,10 @@ descriptor_t put_window(DS_TYPE* set, uint8_t contention)
 
 }
 
-descriptor_t get_window(DS_TYPE* set, uint8_t contention)
+descriptor_t get_window(DS_HANDLE handle, uint8_t contention)
 {
+	DS_TYPE* set = handle->set;
+	thread_window_t* window = &handle->window;
 	descriptor_t descriptor;
 	window_t new_window;
 	row_t put_count;
@@ -129,59 +140,59 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 
 	if(contention == 1)
 	{
-		thread_get_index = random_index(thread_width);
+		window->get_index = random_index(window->width);
 		contention = 0;
 	}
 
-	thread_GWindow.max = global_GWindow.content.max;
+	window->GWindow.max = set->GWindow.content.max;
 
 	while(1)
 	{
 
 		//read descriptor
-		descriptor =  set->get_array[thread_get_index].descriptor;
-		if (thread_GWindow.max < thread_PWindow.max) {
-			put_count = thread_PWindow.max - thread_depth;
+		descriptor =  set->get_array[window->get_index].descriptor;
+		if (window->GWindow.max < window->PWindow.max) {
+			put_count = window->PWindow.max - window->depth;
 		}
 		else {
-			put_count = set->put_array[thread_get_index].descriptor.put_count;
+			put_count = set->put_array[window->get_index].descriptor.put_count;
 		}
 		// Read the global get window and possibly sync
-		row_t gmax = global_GWindow.content.max;
-		if(thread_GWindow.max != gmax)
+		row_t gmax = set->GWindow.content.max;
+		if(window->GWindow.max != gmax)
 		{
-			thread_GWindow.max = gmax;
+			window->GWindow.max = gmax;
 			hops = notempty = 0;
 		}
 
 		// Valid return
-		else if(descriptor.get_count < thread_GWindow.max && descriptor.get_count < put_count)
+		else if(descriptor.get_count < window->GWindow.max && descriptor.get_count < put_count)
 		{
 			break;
 		}
 
 		// Hop
-		else if (hops != thread_width)
+		else if (hops != window->width)
 		{
 			//notempty = notempty || descriptor.get_count < put_count;
 			if (notempty == 0 && descriptor.get_count < put_count)
 			{
 				notempty = 1;
 			}
-			thread_get_index = hop(set, thread_get_index, &random, &hops, thread_width);
+			window->get_index = hop(set, window->get_index, &random, &hops, window->width);
 		}
 
 		// Shift window
-		else if (notempty || thread_GWindow.max != global_PWindow.content.max)	// Checking the window so that there are no nodes diagonally outside current window
+		else if (notempty || window->GWindow.max != set->PWindow.content.max)	// Checking the window so that there are no nodes diagonally outside current window
 		{
-			new_window.max = thread_GWindow.max + thread_depth;
+			new_window.max = window->GWindow.max + window->depth;
 
-			if(thread_GWindow.max == global_GWindow.content.max)
+			if(window->GWindow.max == set->GWindow.content.max)
 			{
-				if(CAE(&global_GWindow.content, &thread_GWindow, &new_window))
+				if(CAE(&set->GWindow.content, &window->GWindow, &new_window))
 				{
 					my_slide_count+=1;
-					thread_GWindow = new_window;
+					window->GWindow = new_window;
 				}
 				else
 				{
@@ -199,7 +210,7 @@ descriptor_t get_window(DS_TYPE* set, uint8_t contention)
 		}
 	}
 
-	thread_put_index = thread_get_index;
+	window->put_index = window->get_index;
 	return descriptor;
 }
 
@@ -208,17 +219,31 @@ width_t random_index(width_t width)
 	return (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % width);
 }
 
-void initialize_global_window(depth_t depth, width_t width)
+void initialize_window(DS_TYPE* set, depth_t depth)
 {
 	/**
-	 * Initializes the required global window variables
+	 * Initializes the global windows of a queue
 	 */
 
 	assert(depth != 0);
 
-	printf("Initializing! %u %u\n", depth, width);
+	printf("Initializing! %u %u\n", depth, set->width);
+
+	set->PWindow.content.max = depth;
+	set->GWindow.content.max = depth;
+}
+
+void initialize_thread_window(DS_TYPE* set, thread_window_t* window)
+{
+	/**
+	 * Initializes the view of the windows of a thread, which is synchronized at its first operation
+	 */
 
-	global_PWindow.content.max = depth;
-	global_GWindow.content.max = depth;
+	window->PWindow.max = 0;
+	window->GWindow.max = 0;
+	window->depth = set->depth;
+	window->width = set->width;
+	window->put_index = 0;
+	window->get_index = 0;
 }
 
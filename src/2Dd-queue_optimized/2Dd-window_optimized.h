@@ -12,23 +12,20 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct padded_window_struct
 	uint8_t padding[CACHE_LINE_SIZE - sizeof(window_t)];
 } padded_window_t;
 
-
-/*window variables*/
-volatile padded_window_t global_PWindow;
-volatile padded_window_t global_GWindow;
-
-__thread window_t thread_PWindow;
-__thread window_t thread_GWindow;
-__thread depth_t thread_depth;
-__thread width_t thread_width;
-__thread width_t thread_put_index;
-__thread width_t thread_get_index;
-
-/* functions */
-descriptor_t put_window(DS_TYPE* set, uint8_t contention);
-descriptor_t get_window(DS_TYPE* set, uint8_t contention);
-width_t random_index(width_t width);
-void initialize_global_window(depth_t depth, width_t width);
-void ds_thread_init(DS_TYPE* set);
+/*
+ * The global windows are kept in the queue (PWindow and GWindow), and every thread keeps its view
+ * of them in the handle returned by DS_REGISTER, along with its indices and the depth and width it
+ * registered with. This header only holds the types, so that it can be included before the queue
+ * is defined. The functions are declared in 2Dd-window_optimized.c.
+ */
+typedef struct thread_window_struct
+{
+	window_t PWindow;
+	window_t GWindow;
+	depth_t depth;
+	width_t width;
+	width_t put_index;
+	width_t get_index;
+} thread_window_t;
 
 #endif
@@ -71,6 +71,8 @@ uint64_t width = 1;
 uint64_t depth = 1;
 uint8_t k_mode = 0;
 size_t side_work = 0;
+double open_loop_rate = 0;
+int open_loop_poisson = 0;
 
 TEST_VARS_GLOBAL;
 
@@ -196,10 +198,12 @@ void* test(void* thread)
 	RETRY_STATS_ZERO();
 	barrier_cross(&barrier_global);
 	RR_START_SIMPLE();
+	PERF_COUNTERS_START();
 	while (stop == 0)
     {
 		SPECIFIC_TEST_LOOP();
 	}
+	PERF_COUNTERS_STOP();
 	barrier_cross(&barrier);
 	RR_STOP_SIMPLE();
 	if (!thread_id)
@@ -260,6 +264,9 @@ int main(int argc, char **argv)
 		{"num-buckets",               required_argument, NULL, 'b'},
 		{"print-vals",                required_argument, NULL, 'v'},
 		{"vals-pf",                   required_argument, NULL, 'f'},
+		{"pin",                       required_argument, NULL, 'P'},
+		{"rate",                      required_argument, NULL, 'R'},
+		{"poisson",                   no_argument,       NULL, 'O'},
 		{NULL, 0, NULL, 0}
 	};
 
@@ -267,7 +274,7 @@ int main(int argc, char **argv)
 	while(1)
     {
 		i = 0;
-		c = getopt_long(argc, argv, "hAf:d:i:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:", long_options, &i);
+		c = getopt_long(argc, argv, "hAf:d:i:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:P:R:O", long_options, &i);
 		if(c == -1)
 		break;
 		if(c == 0 && long_options[i].flag == 0)
@@ -315,6 +322,12 @@ int main(int argc, char **argv)
 			"        Fixed Width or Width to thread ratio depending on the k-mode.\n"
 			"  -m, --K Mode <int>\n"
 			"        0 for Fixed Width and Depth, 1 for Fixed Width, 2 for fixed Depth, 3 for fixed Width to thread ratio.\n"
+			"  -P, --pin <policy>\n"
+			"        Pin threads from the sysfs topology: compact-cores-first, scatter-sockets, smt-last or table [DEFAULT=table].\n"
+			"  -R, --rate <double>\n"
+			"        Operations per second of each thread in the open-loop workload, WORKLOAD=5 [DEFAULT=0].\n"
+			"  -O, --poisson\n"
+			"        Start the open-loop operations as a Poisson process instead of evenly spaced.\n"
 			, argv[0]);
 			exit(0);
 			case 'd':
@@ -358,6 +371,15 @@ int main(int argc, char **argv)
 			if(atoi(optarg)<=3) k_mode = atoi(optarg);
 			break;
 			break;
+			case 'P':
+			set_pin_policy(optarg);
+			break;
+			case 'R':
+			open_loop_rate = atof(optarg);
+			break;
+			case 'O':
+			open_loop_poisson = 1;
+			break;
 			case '?':
 			default:
 			printf("Use -h or --help for help\n");
@@ -383,6 +405,7 @@ int main(int argc, char **argv)
 	printf("Initial, %zu \n", initial);
 	printf("Range, %zu \n", range);
 	printf("Algorithm, OPTIK \n");
+	OPEN_LOOP_INIT();
 
 	double kb = initial * sizeof(DS_NODE) / 1024.0;
 	double mb = kb / 1024.0;
@@ -529,7 +552,7 @@ int main(int argc, char **argv)
 		long unsigned put_fal = (putting_count_total - putting_count_total_succ) ? putting_fal_total / (putting_count_total - putting_count_total_succ) : 0;
 		long unsigned rem_suc = removing_count_total_succ ? removing_suc_total / removing_count_total_succ : 0;
 		long unsigned rem_fal = (removing_count_total - removing_count_total_succ) ? removing_fal_total / (removing_count_total - removing_count_total_succ) : 0;
-		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, get_suc, get_fal, put_suc, put_fal, rem_suc, rem_fal);
+		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, 0LU, 0LU, put_suc, put_fal, rem_suc, rem_fal);
 	#endif
 
 	#define LLU long long unsigned int
@@ -570,6 +593,8 @@ int main(int argc, char **argv)
 	RR_PRINT_CORRECTED();
 	RETRY_STATS_PRINT(total, putting_count_total, removing_count_total, putting_count_total_succ + removing_count_total_succ);
 	LATENCY_DISTRIBUTION_PRINT();
+	PERF_COUNTERS_PRINT(putting_count_total + removing_count_total);
+	OPEN_LOOP_PRINT();
 
 	printf("Push_CAS_fails , %zu\n", put_cas_fail_count_total);
 	printf("Pop_CAS_fails , %zu\n", get_cas_fail_count_total);
@@ -124,6 +124,9 @@ mstack_t* create_stack(size_t num_threads, uint64_t width, uint64_t depth, uint8
 	set->k_mode = k_mode;
 	set->relaxation_bound = relaxation_bound;
 
+	// Initlialize the window variables
+	initialize_window(set, depth);
+
 	int i;
 	for(i=0; i < set->width; i++)
 	{
@@ -179,20 +182,21 @@ static int do_cae(volatile descriptor_t* des_loc, descriptor_t* read_des_loc, de
 #endif
 }
 
-int push(mstack_t *set, skey_t key, sval_t val)
+int push(mstack_handle_t* handle, skey_t key, sval_t val)
 {
+	mstack_t* set = handle->set;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
 
 	node_t* new_node = create_node(key, val, NULL);
 	while(1)
 	{
-		descriptor = put_window(set,contention);
+		descriptor = put_window(handle, contention);
 		new_node->next = descriptor.node;
 		new_descriptor.node = new_node;
 		new_descriptor.get_count = descriptor.get_count;
 		new_descriptor.put_count = descriptor.put_count + 1;
-		if(do_cae(&set->put_array[thread_index].descriptor, &descriptor, &new_descriptor, 1))
+		if(do_cae(&set->put_array[handle->window.index].descriptor, &descriptor, &new_descriptor, 1))
 		{
 			return 1;
 		}
@@ -205,20 +209,21 @@ int push(mstack_t *set, skey_t key, sval_t val)
 	}
 }
 
-sval_t pop(mstack_t *set)
+sval_t pop(mstack_handle_t* handle)
 {
+	mstack_t* set = handle->set;
 	uint8_t contention = 0;
 	descriptor_t descriptor, new_descriptor;
 	while (1)
     {
-		descriptor = get_window(set,contention);
+		descriptor = get_window(handle, contention);
 		if(descriptor.node!=NULL)
 		{
 			new_descriptor.node = descriptor.node->next;
 			new_descriptor.put_count = descriptor.put_count;
 			new_descriptor.get_count = descriptor.get_count + 1;
 
-			if(do_cae(&set->get_array[thread_index].descriptor, &descriptor, &new_descriptor, 0))
+			if(do_cae(&set->get_array[handle->window.index].descriptor, &descriptor, &new_descriptor, 0))
 			{
 				sval_t node_val = descriptor.node->val;
 				//garbage collector
@@ -259,7 +264,7 @@ size_t stack_size(mstack_t *set)
 	return size;
 }
 
-mstack_t* register_stack(mstack_t *set, int thread_id)
+mstack_handle_t* register_stack(mstack_t *set, int thread_id)
 {
     ssalloc_init();
 	#if GC == 1
@@ -271,5 +276,14 @@ mstack_t* register_stack(mstack_t *set, int thread_id)
     }
 	#endif
 
-    return set;
+	mstack_handle_t* handle;
+	if ((handle = (mstack_handle_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mstack_handle_t))) == NULL)
+	{
+		perror("malloc");
+		exit(1);
+	}
+	handle->set = set;
+	initialize_thread_window(&handle->window);
+
+    return handle;
 }
@@ -17,8 +17,8 @@ __thread uint64_t enq_timestamp, deq_timestamp;
 #endif
 
 
-// TODO: use ssmem_alloc when using GC (this uses ssmem instead of ssalloc)
-segment_t* create_segment(skey_t key, sval_t val, segment_t* next, uint64_t node_idx) {
+// Create a segment with the first count slots already filled with vals
+static segment_t* create_segment_batch(sval_t *vals, uint64_t count, uint64_t node_idx) {
 	#if GC == 1
         segment_t* segment = (segment_t*) ssmem_alloc(alloc, sizeof(segment_t) + BUFFER_SIZE*sizeof(sval_t));
 	#else
@@ -26,14 +26,19 @@ segment_t* create_segment(skey_t key, sval_t val, segment_t* next, uint64_t node
 	#endif
     segment->next = NULL;
     segment->deq_idx = 0;
-    segment->enq_idx = 1;
+    segment->enq_idx = count;
     segment->node_idx = node_idx;
 
-    segment->items[0] = val;
-    memset((void*) &segment->items[1], 0, (BUFFER_SIZE - 1)*sizeof(sval_t));
+    memcpy((void*) &segment->items[0], vals, count*sizeof(sval_t));
+    memset((void*) &segment->items[count], 0, (BUFFER_SIZE - count)*sizeof(sval_t));
     return segment;
 }
 
+// TODO: use ssmem_alloc when using GC (this uses ssmem instead of ssalloc)
+segment_t* create_segment(skey_t key, sval_t val, segment_t* next, uint64_t node_idx) {
+    return create_segment_batch(&val, 1, node_idx);
+}
+
 static int enq_cae(volatile sval_t* item_loc, sval_t new_value)
 {
 	sval_t expected = EMPTY;
@@ -127,6 +132,11 @@ int faaaq_enqueue(faaaq_t *q, skey_t key, sval_t val){
         {
             return 1;
         }
+#ifdef ADAPTIVE_CHOICE
+        // A dequeuer took the slot before the item was put there, only counted for the choice
+        // controller so that the CAS fails of the other builds stay comparable
+        my_put_cas_fail_count+=1;
+#endif
     }
 }
 
@@ -156,10 +166,113 @@ sval_t faaaq_dequeue(faaaq_t *q) {
         {
             return item;
         }
+#ifdef ADAPTIVE_CHOICE
+        my_get_cas_fail_count+=1;
+#endif
     }
     return 0;
 }
 
+// Enqueue n items by reserving a contiguous range of slots with a single FAA.
+// Slots already invalidated by racing dequeuers are skipped, and the rest of the batch is retried.
+uint32_t faaaq_enqueue_batch(faaaq_t *q, skey_t *keys, sval_t *vals, uint32_t n) {
+    uint32_t done = 0;
+    while (done < n)
+    {
+        segment_t *tail = q->tail;
+        uint64_t want = n - done;
+        //Linearization point
+        uint64_t idx = FAA_U64(&tail->enq_idx, want);
+        ENQ_TIMESTAMP;
+        if(idx > BUFFER_SIZE - 1)
+        {
+            if (tail != q->tail) continue;
+            segment_t *next = tail->next;
+            if(next == NULL)
+            {
+                // Put as much of the remaining batch as fits directly into the new segment
+                uint64_t fill = want < BUFFER_SIZE ? want : BUFFER_SIZE;
+                segment_t *new_segment = create_segment_batch(&vals[done], fill, tail->node_idx + 1);
+                segment_t* null_segment = NULL;
+                if(CAE(&tail->next, &null_segment, &new_segment)){
+                    CAE(&q->tail, &tail, &new_segment);
+                    #ifdef RELAXATION_TIMER_ANALYSIS
+                        for (uint64_t i = 0; i < fill; i++)
+                        {
+                            add_relaxed_put(vals[done + i], enq_timestamp);
+                        }
+                    #endif
+                    done += fill;
+                    continue;
+                }
+                #if GC == 1
+					ssmem_free(alloc, (void*) new_segment);
+				#endif
+
+            }
+            else {
+                CAE(&q->tail, &tail, &next);
+            }
+            continue;
+        }
+
+        uint64_t end = idx + want;
+        if (end > BUFFER_SIZE) end = BUFFER_SIZE;
+        for (; idx < end; idx++)
+        {
+            if (enq_cae(&tail->items[idx], vals[done]))
+            {
+                done++;
+            }
+        }
+    }
+    return done;
+}
+
+// Dequeue up to n items from the head segment with a single FAA, returning how many were found.
+// Only claims slots that have been reserved by enqueuers, to not force them to retry.
+uint32_t faaaq_dequeue_batch(faaaq_t *q, sval_t *out, uint32_t n) {
+    uint32_t got = 0;
+    while (got < n)
+    {
+        segment_t *head = q->head;
+        uint64_t deq_idx = head->deq_idx;
+        uint64_t enq_idx = head->enq_idx;
+        if (deq_idx >= enq_idx && head->next == NULL) break;
+
+        uint64_t want = n - got;
+        if (deq_idx < enq_idx && enq_idx - deq_idx < want) want = enq_idx - deq_idx;
+
+        //Linearization point
+        uint64_t idx = FAA_U64(&head->deq_idx, want);
+        DEQ_TIMESTAMP;
+        if(idx > BUFFER_SIZE - 1)
+        {
+            segment_t *next = head->next;
+            if(next == NULL) break;
+            if (CAE(&q->head, &head, &next))
+            {
+                #if GC == 1
+    				ssmem_free(alloc, (void*) head);
+    			#endif
+            }
+            continue;
+        }
+
+        uint64_t end = idx + want;
+        if (end > BUFFER_SIZE) end = BUFFER_SIZE;
+        for (; idx < end; idx++)
+        {
+            sval_t item = deq_swp(&head->items[idx]);
+            if(item != EMPTY)
+            {
+                out[got++] = item;
+            }
+        }
+    }
+    return got;
+}
+
 void init_faaaq_queue(faaaq_t *q) {
 	#if GC == 1
         segment_t* segment = (segment_t*) ssmem_alloc(alloc, sizeof(segment_t) + BUFFER_SIZE*sizeof(sval_t));
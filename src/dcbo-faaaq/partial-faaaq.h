@@ -32,6 +32,8 @@
 #define PARTIAL_TAIL_VERSION(q)     faaaq_enq_count(q)
 #define PARTIAL_ENQ_COUNT(q)        faaaq_enq_count(q)
 #define PARTIAL_DEQ_COUNT(q)        faaaq_deq_count(q)
+#define PARTIAL_ENQUEUE_BATCH(q, k, v, n)   faaaq_enqueue_batch(q, k, v, n)
+#define PARTIAL_DEQUEUE_BATCH(q, o, n)      faaaq_dequeue_batch(q, o, n)
 #define EMPTY						((sval_t)0)
 
 // Internally used macros
@@ -72,6 +74,8 @@ extern __thread unsigned long my_slide_count;
 /* Interfaces */
 int faaaq_enqueue(faaaq_t *queue, skey_t key, sval_t val);
 sval_t faaaq_dequeue(faaaq_t *queue);
+uint32_t faaaq_enqueue_batch(faaaq_t *queue, skey_t *keys, sval_t *vals, uint32_t n);
+uint32_t faaaq_dequeue_batch(faaaq_t *queue, sval_t *out, uint32_t n);
 void init_faaaq_queue(faaaq_t *queue);
 size_t faaaq_queue_size(faaaq_t *queue);
 uint64_t faaaq_enq_count(faaaq_t *queue);
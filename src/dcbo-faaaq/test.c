@@ -37,6 +37,12 @@
 
 #include "d-balanced-queue.h"
 
+// With --wait-ns, empty dequeues and enqueues on a full queue park instead of returning at once
+#undef DS_ADD
+#undef DS_REMOVE
+#define DS_ADD(s,k,v)       (wait_ns ? DS_ADD_WAIT(s, k, v, wait_ns) : enqueue(s, k, v))
+#define DS_REMOVE(s)        (wait_ns ? DS_REMOVE_WAIT(s, wait_ns) : dequeue(s))
+
 #if !defined(VALIDATESIZE)
 	#define VALIDATESIZE 1
 #endif
@@ -69,6 +75,16 @@ uint64_t relaxation_bound = 1;
 uint64_t width = 1;
 uint64_t choices = 2;
 size_t side_work = 0;
+double open_loop_rate = 0;
+int open_loop_poisson = 0;
+size_t batch_size = 1;
+uint32_t numa_nodes = 0;
+uint32_t remote_percent = 100;
+uint64_t wait_ns = 0;
+size_t capacity = 0;
+uint64_t error_budget = 0;
+uint64_t elastic_width = 0;
+uint64_t max_width = 0;
 
 TEST_VARS_GLOBAL;
 
@@ -86,6 +102,10 @@ volatile unsigned long *slide_count;
 volatile ticks *removing_count;
 volatile ticks *removing_count_succ;
 volatile ticks *total;
+#ifdef ADAPTIVE_CHOICE
+double *enqueue_choices;
+double *dequeue_choices;
+#endif
 
 
 /* ################################################################### *
@@ -155,6 +175,8 @@ void* test(void* thread)
 
 	uint64_t key;
 	int c = 0;
+	skey_t *batch_keys = (skey_t*) malloc(batch_size * sizeof(skey_t));
+	sval_t *batch_vals = (sval_t*) malloc(batch_size * sizeof(sval_t));
 	uint32_t scale_rem = (uint32_t) (update_rate * UINT_MAX);
 	uint32_t scale_put = (uint32_t) (put_rate * UINT_MAX);
 
@@ -190,10 +212,22 @@ void* test(void* thread)
 	RETRY_STATS_ZERO();
 	barrier_cross(&barrier_global);
 	RR_START_SIMPLE();
-	while (stop == 0)
-    {
-		TEST_LOOP_ONLY_UPDATES();
+	PERF_COUNTERS_START();
+	if (batch_size > 1)
+	{
+		while (stop == 0)
+		{
+			TEST_LOOP_BATCH_UPDATES();
+		}
 	}
+	else
+	{
+		while (stop == 0)
+		{
+			TEST_LOOP_ONLY_UPDATES();
+		}
+	}
+	PERF_COUNTERS_STOP();
 	barrier_cross(&barrier);
 	RR_STOP_SIMPLE();
 	if (!thread_id)
@@ -221,6 +255,9 @@ void* test(void* thread)
 	null_count[thread_id]=my_null_count;
 	hop_count[thread_id]=my_hop_count;
 	slide_count[thread_id]=my_slide_count;
+#ifdef ADAPTIVE_CHOICE
+	d_balanced_mean_choices(handle, &enqueue_choices[thread_id], &dequeue_choices[thread_id]);
+#endif
 
 	EXEC_IN_DEC_ID_ORDER(thread_id, num_threads)
     {
@@ -229,6 +266,9 @@ void* test(void* thread)
 	}
 	EXEC_IN_DEC_ID_ORDER_END(&barrier);
 
+	free(batch_keys);
+	free(batch_vals);
+
 	SSPFDTERM();
 	#if GC == 1
 		ssmem_term();
@@ -254,6 +294,17 @@ int main(int argc, char **argv)
 		{"num-buckets",               required_argument, NULL, 'b'},
 		{"print-vals",                required_argument, NULL, 'v'},
 		{"vals-pf",                   required_argument, NULL, 'f'},
+		{"batch-size",                required_argument, NULL, 'B'},
+		{"numa-nodes",                required_argument, NULL, 'N'},
+		{"remote-percent",            required_argument, NULL, 'L'},
+		{"wait-ns",                   required_argument, NULL, 'W'},
+		{"capacity",                  required_argument, NULL, 'C'},
+		{"error-budget",              required_argument, NULL, 'E'},
+		{"elastic-width",             required_argument, NULL, 'e'},
+		{"max-width",                 required_argument, NULL, 'M'},
+		{"pin",                       required_argument, NULL, 'P'},
+		{"rate",                      required_argument, NULL, 'R'},
+		{"poisson",                   no_argument,       NULL, 'O'},
 		{NULL, 0, NULL, 0}
 	};
 
@@ -261,7 +312,7 @@ int main(int argc, char **argv)
 	while(1)
     {
 		i = 0;
-		c = getopt_long(argc, argv, "hAf:d:i:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:c:", long_options, &i);
+		c = getopt_long(argc, argv, "hAf:d:i:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:c:B:N:L:W:C:E:e:M:P:R:O", long_options, &i);
 		if(c == -1)
 		break;
 		if(c == 0 && long_options[i].flag == 0)
@@ -305,6 +356,28 @@ int main(int argc, char **argv)
 			"        Width (Number of sub-structures).\n"
 			"  -c, --choices <int>\n"
 			"        The number of choices to use (refered to as d in d-balanced queues) [DEFAULT=2].\n"
+			"  -B, --batch-size <int>\n"
+			"        Number of items moved by each enqueue/dequeue operation [DEFAULT=1].\n"
+			"  -N, --numa-nodes <int>\n"
+			"        Number of sub-queue partitions in NUMA=1 builds [DEFAULT=NUMA nodes of the machine].\n"
+			"  -L, --remote-percent <int>\n"
+			"        Percentage of samples drawn from all sub-queues instead of the local partition in NUMA=1 builds [DEFAULT=100].\n"
+			"  -W, --wait-ns <int>\n"
+			"        Let dequeues (and enqueues on a full queue) wait up to this many ns, parking after a short spin [DEFAULT=0].\n"
+			"  -C, --capacity <int>\n"
+			"        Bound the queue to about this many items, failing enqueues when full [DEFAULT=0 (unbounded)].\n"
+			"  -E, --error-budget <int>\n"
+			"        Estimated rank error the per thread d stays below in ADAPTIVE=1 builds, where -c is the starting d [DEFAULT=0 (none)].\n"
+			"  -e, --elastic-width <int>\n"
+			"        Change the width to this halfway through the test in ELASTIC=1 builds [DEFAULT=0 (no change)].\n"
+			"  -M, --max-width <int>\n"
+			"        Number of allocated sub-queues, which the width can grow to, in ELASTIC=1 builds [DEFAULT=max of -w and -e].\n"
+			"  -P, --pin <policy>\n"
+			"        Pin threads from the sysfs topology: compact-cores-first, scatter-sockets, smt-last or table [DEFAULT=table].\n"
+			"  -R, --rate <double>\n"
+			"        Operations per second of each thread in the open-loop workload, WORKLOAD=5 [DEFAULT=0].\n"
+			"  -O, --poisson\n"
+			"        Start the open-loop operations as a Poisson process instead of evenly spaced.\n"
 			, argv[0]);
 			exit(0);
 			case 'd':
@@ -343,9 +416,43 @@ int main(int argc, char **argv)
 			break;
 			case 'c':
 			choices = atoi(optarg);
+			break;
+			case 'B':
+			batch_size = atoi(optarg);
+			break;
+			case 'N':
+			numa_nodes = atoi(optarg);
+			break;
+			case 'L':
+			remote_percent = atoi(optarg);
+			break;
+			case 'W':
+			wait_ns = strtoull(optarg, NULL, 10);
+			break;
+			case 'C':
+			capacity = atol(optarg);
+			break;
+			case 'E':
+			error_budget = strtoull(optarg, NULL, 10);
+			break;
+			case 'e':
+			elastic_width = atoi(optarg);
+			break;
+			case 'M':
+			max_width = atoi(optarg);
+			break;
 			case 'm':
 			case 'k':
 			break;
+			case 'P':
+			set_pin_policy(optarg);
+			break;
+			case 'R':
+			open_loop_rate = atof(optarg);
+			break;
+			case 'O':
+			open_loop_poisson = 1;
+			break;
 			case '?':
 			default:
 			printf("Use -h or --help for help\n");
@@ -371,6 +478,7 @@ int main(int argc, char **argv)
 	printf("Initial, %zu \n", initial);
 	printf("Range, %zu \n", range);
 	printf("Algorithm, OPTIK \n");
+	OPEN_LOOP_INIT();
 
 	double kb = initial * sizeof(DS_NODE) / 1024.0;
 	double mb = kb / 1024.0;
@@ -408,8 +516,29 @@ int main(int argc, char **argv)
 	timeout.tv_nsec = (duration % 1000) * 1000000;
 	stop = 0;
 
+#ifdef NUMA_PARTITIONS
+	DS_TYPE* set = DS_NEW_NUMA(width, choices, num_threads, numa_nodes, remote_percent);
+#elif defined(ELASTIC_WIDTH)
+	// Make sure the elastic width fits in the allocated sub-queues
+	if (max_width < width) max_width = width;
+	if (max_width < elastic_width) max_width = elastic_width;
+	DS_TYPE* set = DS_NEW_ELASTIC(width, max_width, choices, num_threads);
+#else
 	DS_TYPE* set = DS_NEW(width, choices, num_threads);
+#endif
 	assert(set != NULL);
+	if (capacity != 0)
+	{
+		if (capacity < initial)
+		{
+			printf("The capacity %zu can't hold the %zu initial items\n", capacity, initial);
+			exit(1);
+		}
+		d_balanced_set_capacity(set, capacity);
+	}
+#ifdef ADAPTIVE_CHOICE
+	d_balanced_set_error_budget(set, error_budget);
+#endif
 
 	/* Initializes the local data */
 	putting_succ = (ticks *) calloc(num_threads , sizeof(ticks));
@@ -424,6 +553,10 @@ int main(int argc, char **argv)
 	get_cas_fail_count = (unsigned long *) calloc(num_threads , sizeof(unsigned long));
 	null_count = (unsigned long *) calloc(num_threads , sizeof(unsigned long));
 	slide_count = (unsigned long *) calloc(num_threads , sizeof(unsigned long));
+#ifdef ADAPTIVE_CHOICE
+	enqueue_choices = (double *) calloc(num_threads , sizeof(double));
+	dequeue_choices = (double *) calloc(num_threads , sizeof(double));
+#endif
 	hop_count = (unsigned long *) calloc(num_threads , sizeof(unsigned long));
 
 	pthread_t threads[num_threads];
@@ -459,10 +592,26 @@ int main(int argc, char **argv)
 	and set the timer before they cross to start the test loop*/
 	barrier_cross(&barrier_global);
 	gettimeofday(&start, NULL);
+#ifdef ELASTIC_WIDTH
+	if (elastic_width != 0)
+	{
+		struct timespec timeout_halved;
+		timeout_halved.tv_sec = (duration / 2) / 1000;
+		timeout_halved.tv_nsec = ((duration / 2) % 1000) * 1000000;
+		nanosleep(&timeout_halved, NULL);
+		update_width(set, elastic_width);
+		nanosleep(&timeout_halved, NULL);
+	}
+	else
+#endif
 	nanosleep(&timeout, NULL);
 
 	stop = 1;
 	gettimeofday(&end, NULL);
+	if (wait_ns)
+	{
+		d_balanced_wake_all(set);
+	}
 	duration = (end.tv_sec * 1000 + end.tv_usec / 1000) - (start.tv_sec * 1000 + start.tv_usec / 1000);
 
 	for(t = 0; t < num_threads; t++)
@@ -515,7 +664,7 @@ int main(int argc, char **argv)
 		long unsigned put_fal = (putting_count_total - putting_count_total_succ) ? putting_fal_total / (putting_count_total - putting_count_total_succ) : 0;
 		long unsigned rem_suc = removing_count_total_succ ? removing_suc_total / removing_count_total_succ : 0;
 		long unsigned rem_fal = (removing_count_total - removing_count_total_succ) ? removing_fal_total / (removing_count_total - removing_count_total_succ) : 0;
-		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, get_suc, get_fal, put_suc, put_fal, rem_suc, rem_fal);
+		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, 0LU, 0LU, put_suc, put_fal, rem_suc, rem_fal);
 	#endif
 
 	#define LLU long long unsigned int
@@ -556,6 +705,8 @@ int main(int argc, char **argv)
 	RR_PRINT_CORRECTED();
 	RETRY_STATS_PRINT(total, putting_count_total, removing_count_total, putting_count_total_succ + removing_count_total_succ);
 	LATENCY_DISTRIBUTION_PRINT();
+	PERF_COUNTERS_PRINT(putting_count_total + removing_count_total);
+	OPEN_LOOP_PRINT();
 
 	#ifdef RELAXATION_TIMER_ANALYSIS
 		print_relaxation_measurements(num_threads);
@@ -568,8 +719,30 @@ int main(int argc, char **argv)
 	printf("Null_Count , %zu\n", null_count_total);
 	printf("Hop_Count , %zu\n", hop_count_total);
 	printf("Slide_Count , %zu\n", slide_count_total);
+#ifdef ELASTIC_WIDTH
+	printf("Starting_width , %lu\n", width);
+	printf("Max width , %u\n", set->max_width);
+#endif
 	printf("Width , %u\n", set->width);
 	printf("Choices (d) , %u\n", set->d);
+	printf("Batch size , %zu\n", batch_size);
+	printf("Capacity , %zu\n", capacity);
+#ifdef ADAPTIVE_CHOICE
+	// The mean over the threads of the d each thread used on average
+	double enqueue_d = 0, dequeue_d = 0;
+	for(t=0; t < num_threads; t++)
+	{
+		enqueue_d += enqueue_choices[t] / num_threads;
+		dequeue_d += dequeue_choices[t] / num_threads;
+	}
+	printf("Error budget , %lu\n", error_budget);
+	printf("Mean enqueue choices , %.2f\n", enqueue_d);
+	printf("Mean dequeue choices , %.2f\n", dequeue_d);
+#endif
+#ifdef NUMA_PARTITIONS
+	printf("NUMA partitions , %u\n", set->nodes);
+	printf("Remote percent , %u\n", remote_percent);
+#endif
 
 	pthread_exit(NULL);
 
@@ -1,87 +1,566 @@
 #include "d-balanced-queue.h"
+#ifdef NUMA_PARTITIONS
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#endif
 
 // Internal thread local count for double-collect
 // Don't have in header as it would double-instantiate both here and in the test file
+// It is shared by all queues the thread registers with, so it grows to the widest of them
 __thread uint64_t *double_collect_counts;
+__thread uint32_t double_collect_size;
 __thread ssmem_allocator_t* alloc;
+#ifdef ADAPTIVE_CHOICE
+#define ENQ_CHOICES(handle) ((handle)->enq_choices.d)
+#define DEQ_CHOICES(handle) ((handle)->deq_choices.d)
+#else
+#define ENQ_CHOICES(handle) ((handle)->set->d)
+#define DEQ_CHOICES(handle) ((handle)->set->d)
+#endif
+#ifdef ELASTIC_WIDTH
+#define ALLOCATED_WIDTH(set) ((set)->max_width)
+#else
+#define ALLOCATED_WIDTH(set) ((set)->width)
+#endif
 __thread handle_t lcrq_handle;
 
-int enqueue(mqueue_t *set, skey_t key, sval_t val) {
-    #ifdef LENGTH_HEURISTIC
-    #define ENQ_HEURISTIC(q) PARTIAL_LENGTH(q)
-    #else
-    #define ENQ_HEURISTIC(q) PARTIAL_ENQ_COUNT(q)
-    #endif
+#ifdef LENGTH_HEURISTIC
+#define ENQ_HEURISTIC(q) PARTIAL_LENGTH(q)
+#define DEQ_HEURISTIC(q) -PARTIAL_LENGTH(q)
+#else
+#define ENQ_HEURISTIC(q) PARTIAL_ENQ_COUNT(q)
+#define DEQ_HEURISTIC(q) PARTIAL_DEQ_COUNT(q)
+#endif
+
+// The i:th of the d samples of an operation, where r keeps the random bits between the calls, as
+// each 64 random bits give two samples
+static inline uint32_t sample_index(mqueue_handle_t *handle, int i, uint64_t *r) {
+#ifdef NUMA_PARTITIONS
+    return random_index(handle);
+#else
+    if ((i & 1) == 0) *r = wyrand(&handle->index_seed);
+    return reduce_range(i & 1 ? (uint32_t) (*r >> 32) : (uint32_t) *r, handle->set->width);
+#endif
+}
+
+// Sets the hint bit of a sub-queue after an enqueue into it, only writing if it was cleared
+static inline void hint_nonempty(mqueue_t *set, uint32_t index) {
+    volatile uint64_t *word = &set->nonempty[index / 64];
+    uint64_t mask = 1ULL << (index % 64);
+    if (unlikely((*word & mask) == 0))
+    {
+        __sync_fetch_and_or(word, mask);
+    }
+}
+
+// Clears the hint bit of a sub-queue a dequeue found empty. The sub-queue is checked again after
+// the bit is cleared, so an enqueue that saw the bit still set is not hidden by it.
+static inline void hint_empty(mqueue_t *set, uint32_t index) {
+    volatile uint64_t *word = &set->nonempty[index / 64];
+    uint64_t mask = 1ULL << (index % 64);
+    if (*word & mask)
+    {
+        __sync_fetch_and_and(word, ~mask);
+        if (PARTIAL_LENGTH(SUBQUEUE(set, index)) != 0)
+        {
+            __sync_fetch_and_or(word, mask);
+        }
+    }
+}
 
-    uint32_t opt_index = random_index(set);
-    uint64_t opt = ENQ_HEURISTIC(&set->queues[opt_index]);
-    for(int i = 1; i < set->d; i++ )
+// Sample d sub-queues and return the best one to enqueue into
+static inline uint32_t enqueue_index(mqueue_handle_t *handle) {
+    mqueue_t *set = handle->set;
+    uint64_t r;
+    uint32_t opt_index = sample_index(handle, 0, &r);
+    uint64_t opt = ENQ_HEURISTIC(SUBQUEUE(set, opt_index));
+    for(int i = 1; i < ENQ_CHOICES(handle); i++ )
     {
-        uint32_t index = random_index(set);
-        uint64_t index_val = ENQ_HEURISTIC(&set->queues[index]);
+        uint32_t index = sample_index(handle, i, &r);
+        uint64_t index_val = ENQ_HEURISTIC(SUBQUEUE(set, index));
         if(index_val < opt)
         {
             opt_index = index;
             opt = index_val;
         }
     }
-
-    return PARTIAL_ENQUEUE(&set->queues[opt_index], key, val);
+#ifdef ADAPTIVE_CHOICE
+    if (choice_probe(&handle->enq_choices))
+    {
+        choice_probe_error(&handle->enq_choices, set->width, opt, ENQ_HEURISTIC(SUBQUEUE(set, random_index(handle))));
+    }
+#endif
+    return opt_index;
 }
 
-sval_t dequeue(mqueue_t *set) {
-    #ifdef LENGTH_HEURISTIC
-    #define DEQ_HEURISTIC(q) -PARTIAL_LENGTH(q)
-    #else
-    #define DEQ_HEURISTIC(q) PARTIAL_DEQ_COUNT(q)
-    #endif
-
-    uint32_t opt_index = random_index(set);
-    int64_t opt = DEQ_HEURISTIC(&set->queues[opt_index]);
-    for(int i = 1; i < set->d; i++ )
+// Sample d sub-queues and return the best one to dequeue from
+static inline uint32_t dequeue_index(mqueue_handle_t *handle) {
+    mqueue_t *set = handle->set;
+    uint64_t r;
+    uint32_t opt_index = sample_index(handle, 0, &r);
+    int64_t opt = DEQ_HEURISTIC(SUBQUEUE(set, opt_index));
+    for(int i = 1; i < DEQ_CHOICES(handle); i++ )
     {
-        uint32_t index = random_index(set);
-        int64_t index_val = DEQ_HEURISTIC(&set->queues[index]);
+        uint32_t index = sample_index(handle, i, &r);
+        int64_t index_val = DEQ_HEURISTIC(SUBQUEUE(set, index));
         if(index_val < opt)
         {
             opt_index = index;
             opt = index_val;
         }
     }
+#ifdef ADAPTIVE_CHOICE
+    if (choice_probe(&handle->deq_choices))
+    {
+        choice_probe_error(&handle->deq_choices, set->width, opt, DEQ_HEURISTIC(SUBQUEUE(set, random_index(handle))));
+    }
+#endif
+    return opt_index;
+}
+
+// Wakes consumers parked in dequeue_wait, only touching the futex word if there are any. The
+// sub-queues publish items with locked instructions, so the item is visible before sleepers is read.
+static inline void wake_sleepers(mqueue_t *set, int count) {
+    if (unlikely(set->sleepers != 0))
+    {
+        FAI_U32(&set->wake_epoch);
+        futex_wake(&set->wake_epoch, count);
+    }
+}
+
+// Same for producers parked in enqueue_wait on a full queue
+static inline void wake_producers(mqueue_t *set, int count) {
+    if (unlikely(set->producers != 0))
+    {
+        FAI_U32(&set->space_epoch);
+        futex_wake(&set->space_epoch, count);
+    }
+}
+
+// True if the sub-queue has no room for n more items. Only reads the counts the sub-queue already
+// keeps, so concurrent enqueuers can each overshoot the capacity by one batch.
+static inline int subqueue_full(mqueue_t *set, uint32_t index, uint32_t n) {
+    return set->sub_capacity != 0 && PARTIAL_LENGTH(SUBQUEUE(set, index)) + n > set->sub_capacity;
+}
+
+// Returns a sub-queue with room for n more items, opt_index if it has room. Otherwise the choice is
+// sampled once more, and then all sub-queues are scanned from there, so that a bounded queue is only
+// full when none of its sub-queues has room, which is signaled by returning UINT32_MAX.
+static inline uint32_t enqueue_room(mqueue_handle_t *handle, uint32_t opt_index, uint32_t n) {
+    mqueue_t *set = handle->set;
+    if (likely(!subqueue_full(set, opt_index, n))) return opt_index;
+
+    uint32_t index = enqueue_index(handle);
+    if (!subqueue_full(set, index, n)) return index;
+
+    uint32_t width = set->width;
+    for (uint32_t i = 1; i < width; i++)
+    {
+        index = index + 1 >= width ? 0 : index + 1;
+        if (!subqueue_full(set, index, n)) return index;
+    }
+    return UINT32_MAX;
+}
+
+// Parks on the futex word while it is still expected, until deadline (0 to wait forever).
+// Returns 0 if the deadline had already passed.
+static inline int park_until(volatile uint32_t *epoch, uint32_t expected, uint64_t deadline) {
+    if (deadline == 0)
+    {
+        futex_wait(epoch, expected, NULL);
+        return 1;
+    }
+
+    uint64_t now = monotonic_ns();
+    if (now >= deadline) return 0;
+    struct timespec timeout = { (deadline - now) / 1000000000ULL, (deadline - now) % 1000000000ULL };
+    futex_wait(epoch, expected, &timeout);
+    return 1;
+}
+
+// Announces an enqueue before it reads the width, so that update_width can wait for the enqueues
+// that might still use a sub-queue it retires
+static inline void width_enter(mqueue_handle_t *handle) {
+#ifdef ELASTIC_WIDTH
+    __atomic_store_n(&handle->announcement->epoch, handle->set->resize_epoch, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void width_exit(mqueue_handle_t *handle) {
+#ifdef ELASTIC_WIDTH
+    __atomic_store_n(&handle->announcement->epoch, 0, __ATOMIC_RELEASE);
+#endif
+}
+
+#ifdef ELASTIC_WIDTH
+// Moves one item from the last retired sub-queue into a live one, or stops scanning that sub-queue
+// in the double-collect once it is empty. The item is in neither sub-queue while it is moved, so
+// the double-collect checks moving and moved before it returns EMPTY.
+static void drain_retired(mqueue_handle_t *handle, width_bounds_t bounds) {
+    mqueue_t *set = handle->set;
+    uint32_t retired = bounds.collect - 1;
+    FAI_U32(&set->moving);
+    sval_t v = PARTIAL_DEQUEUE(SUBQUEUE(set, retired));
+    if (v != EMPTY)
+    {
+        width_enter(handle);
+        uint32_t index = enqueue_index(handle);
+        PARTIAL_ENQUEUE(SUBQUEUE(set, index), (skey_t) v, v);
+        hint_nonempty(set, index);
+        width_exit(handle);
+        FAI_U32(&set->moved);
+    }
+    FAD_U32(&set->moving);
+
+    if (v == EMPTY)
+    {
+        width_bounds_t next = bounds;
+        next.collect -= 1;
+        CAS(&set->bounds.word, bounds.word, next.word);
+    }
+}
+#endif
+
+// Helps draining the retired sub-queues, if there are any
+static inline void width_drain(mqueue_handle_t *handle) {
+#ifdef ELASTIC_WIDTH
+    width_bounds_t bounds;
+    bounds.word = handle->set->bounds.word;
+    if (unlikely(bounds.collect > bounds.floor))
+    {
+        drain_retired(handle, bounds);
+    }
+#endif
+}
+
+// Returns QUEUE_FULL without enqueueing if no sub-queue has room, see enqueue_room
+int enqueue(mqueue_handle_t *handle, skey_t key, sval_t val) {
+    mqueue_t *set = handle->set;
+#ifdef ADAPTIVE_CHOICE
+    unsigned long cas_failures = my_put_cas_fail_count;
+#endif
+    width_enter(handle);
+    uint32_t opt_index = enqueue_room(handle, enqueue_index(handle), 1);
+    if (opt_index == UINT32_MAX)
+    {
+        width_exit(handle);
+        return QUEUE_FULL;
+    }
+    int res = PARTIAL_ENQUEUE(SUBQUEUE(set, opt_index), key, val);
+    hint_nonempty(set, opt_index);
+    width_exit(handle);
+    wake_sleepers(set, 1);
+#ifdef ADAPTIVE_CHOICE
+    update_choice_controller(&handle->enq_choices, my_put_cas_fail_count - cas_failures, 0, set->error_budget, set->d);
+#endif
+    return res;
+}
+
+sval_t dequeue(mqueue_handle_t *handle) {
+    mqueue_t *set = handle->set;
+#ifdef ADAPTIVE_CHOICE
+    unsigned long cas_failures = my_get_cas_fail_count;
+#endif
+    width_drain(handle);
+    uint32_t opt_index = dequeue_index(handle);
+    sval_t v = PARTIAL_DEQUEUE(SUBQUEUE(set, opt_index));
+#ifdef ADAPTIVE_CHOICE
+    int empty = v == EMPTY;
+#endif
+    if(v == EMPTY) v = double_collect(handle, opt_index + 1);
+    if(v != EMPTY) wake_producers(set, 1);
+#ifdef ADAPTIVE_CHOICE
+    // Only counts the empty sample if the double-collect found an item elsewhere
+    update_choice_controller(&handle->deq_choices, my_get_cas_fail_count - cas_failures, empty && v != EMPTY, set->error_budget, set->d);
+#endif
+    return v;
+}
+
+// Like enqueue, but waits up to timeout_ns (or QUEUE_WAIT_FOREVER) for room if the queue is full.
+// Spins for QUEUE_WAIT_SPINS attempts before parking on the space_epoch futex.
+int enqueue_wait(mqueue_handle_t *handle, skey_t key, sval_t val, uint64_t timeout_ns) {
+    mqueue_t *set = handle->set;
+    int res;
+    for (int i = 0; i < QUEUE_WAIT_SPINS; i++)
+    {
+        if ((res = enqueue(handle, key, val)) != QUEUE_FULL) return res;
+        PAUSE;
+    }
+
+    uint64_t deadline = timeout_ns == QUEUE_WAIT_FOREVER ? 0 : monotonic_ns() + timeout_ns;
+    while (1)
+    {
+        // Announce the producer before the last check, so that a dequeue after the check sees it
+        FAI_U32(&set->producers);
+        uint32_t epoch = set->space_epoch;
+        res = enqueue(handle, key, val);
+        int waited = res == QUEUE_FULL && !set->closed && park_until(&set->space_epoch, epoch, deadline);
+        FAD_U32(&set->producers);
+        if (!waited || set->closed) return res;
+    }
+}
+
+// Like dequeue, but waits up to timeout_ns (or QUEUE_WAIT_FOREVER) for an item if the queue is empty.
+// Spins for QUEUE_WAIT_SPINS attempts before parking on the wake_epoch futex.
+sval_t dequeue_wait(mqueue_handle_t *handle, uint64_t timeout_ns) {
+    mqueue_t *set = handle->set;
+    sval_t v;
+    for (int i = 0; i < QUEUE_WAIT_SPINS; i++)
+    {
+        if ((v = dequeue(handle)) != EMPTY) return v;
+        PAUSE;
+    }
+
+    uint64_t deadline = timeout_ns == QUEUE_WAIT_FOREVER ? 0 : monotonic_ns() + timeout_ns;
+    while (1)
+    {
+        // Announce the sleeper before the last check, so that an enqueue after the check sees it
+        FAI_U32(&set->sleepers);
+        uint32_t epoch = set->wake_epoch;
+        v = dequeue(handle);
+        int waited = v == EMPTY && !set->closed && park_until(&set->wake_epoch, epoch, deadline);
+        FAD_U32(&set->sleepers);
+        if (!waited || set->closed) return v;
+    }
+}
+
+// Closes the queue for waiting and wakes all producers and consumers parked in enqueue_wait and
+// dequeue_wait, e.g. to let them see that a benchmark has stopped. From then on the waits return
+// QUEUE_FULL or EMPTY instead of parking again. The flag is set before the epochs are bumped, so a
+// waiter that read the old epoch is woken and one that read the new epoch sees the flag.
+void d_balanced_wake_all(mqueue_t *set) {
+    __atomic_store_n(&set->closed, 1, __ATOMIC_SEQ_CST);
+    FAI_U32(&set->wake_epoch);
+    futex_wake(&set->wake_epoch, INT_MAX);
+    FAI_U32(&set->space_epoch);
+    futex_wake(&set->space_epoch, INT_MAX);
+}
+
+// Bounds the queue to about capacity items (0 for unbounded), split evenly over the sub-queues
+void d_balanced_set_capacity(mqueue_t *set, size_t capacity) {
+    set->capacity = capacity;
+    set->sub_capacity = (capacity + set->width - 1) / set->width;
+}
+
+#ifdef ADAPTIVE_CHOICE
+// Sets the rank error the adaptive d aims to stay below (0 for none, where d only follows contention
+// and empty samples)
+void d_balanced_set_error_budget(mqueue_t *set, uint64_t budget) {
+    set->error_budget = budget;
+}
+
+// The mean d of the enqueues and dequeues through the handle
+void d_balanced_mean_choices(mqueue_handle_t *handle, double *enqueue_d, double *dequeue_d) {
+    *enqueue_d = choice_mean(&handle->enq_choices);
+    *dequeue_d = choice_mean(&handle->deq_choices);
+}
+#endif
 
-    sval_t v = PARTIAL_DEQUEUE(&(set->queues[opt_index]));
-    if(v != EMPTY) return v;
-    return double_collect(set, opt_index + 1);
+// Enqueue all n items into one sub-queue, only doing the d-choice sampling once for the whole batch.
+// Returns QUEUE_FULL without enqueueing anything if they don't fit in any sub-queue.
+int enqueue_batch(mqueue_handle_t *handle, skey_t *keys, sval_t *vals, uint32_t n) {
+    mqueue_t *set = handle->set;
+#ifdef ADAPTIVE_CHOICE
+    unsigned long cas_failures = my_put_cas_fail_count;
+#endif
+    width_enter(handle);
+    uint32_t opt_index = enqueue_room(handle, enqueue_index(handle), n);
+    if (opt_index == UINT32_MAX)
+    {
+        width_exit(handle);
+        return QUEUE_FULL;
+    }
+    int res = PARTIAL_ENQUEUE_BATCH(SUBQUEUE(set, opt_index), keys, vals, n);
+    hint_nonempty(set, opt_index);
+    width_exit(handle);
+    wake_sleepers(set, n);
+#ifdef ADAPTIVE_CHOICE
+    update_choice_controller(&handle->enq_choices, my_put_cas_fail_count - cas_failures, 0, set->error_budget, set->d);
+#endif
+    return res;
 }
 
-sval_t double_collect(mqueue_t *set, uint32_t start_index){
+// Dequeue up to n items from one sampled sub-queue into out, returning the number of dequeued items.
+// Falls back to a single double-collect dequeue if the sampled sub-queue is empty.
+uint32_t dequeue_batch(mqueue_handle_t *handle, sval_t *out, uint32_t n) {
+    mqueue_t *set = handle->set;
+#ifdef ADAPTIVE_CHOICE
+    unsigned long cas_failures = my_get_cas_fail_count;
+#endif
+    width_drain(handle);
+    uint32_t opt_index = dequeue_index(handle);
+    uint32_t got = PARTIAL_DEQUEUE_BATCH(SUBQUEUE(set, opt_index), out, n);
+#ifdef ADAPTIVE_CHOICE
+    int empty = got == 0;
+#endif
+    if(got == 0)
+    {
+        out[0] = double_collect(handle, opt_index + 1);
+        got = out[0] != EMPTY;
+    }
+    wake_producers(set, got);
+#ifdef ADAPTIVE_CHOICE
+    update_choice_controller(&handle->deq_choices, my_get_cas_fail_count - cas_failures, empty && got != 0, set->error_budget, set->d);
+#endif
+    return got;
+}
+
+// Tries to dequeue from the sub-queues below width whose hint bit is set, starting from start_index
+static sval_t hinted_collect(mqueue_handle_t *handle, uint32_t width, uint32_t start_index)
+{
+    mqueue_t *set = handle->set;
+    uint32_t words = (width + 63) / 64;
+    uint32_t word = start_index < width ? start_index / 64 : 0;
+    uint32_t shift = start_index % 64;
+
+    for(uint32_t k = 0; k < words; k++)
+    {
+        // Rotate the bits so that the threads start at different sub-queues
+        uint64_t bits = set->nonempty[word];
+        bits = shift ? (bits >> shift) | (bits << (64 - shift)) : bits;
+        while (bits)
+        {
+            uint32_t index = word * 64 + ((__builtin_ctzll(bits) + shift) % 64);
+            bits &= bits - 1;
+            if (index >= width) continue;
+
+            sval_t v = PARTIAL_DEQUEUE(SUBQUEUE(set, index));
+            if(v != EMPTY) return v;
+            hint_empty(set, index);
+        }
+        if (++word == words) word = 0;
+    }
+    return EMPTY;
+}
+
+// Looks for an item in all sub-queues, and returns EMPTY only if all were seen empty at once. The
+// sub-queues with their hint bit set are tried first, which mostly finds the item of a nearly empty
+// queue without touching every sub-queue, while the full version-checked passes decide emptiness.
+sval_t double_collect(mqueue_handle_t *handle, uint32_t start_index){
+    mqueue_t *set = handle->set;
     uint32_t index;
     uint64_t throwaway;
+    uint32_t width;
+#ifdef ELASTIC_WIDTH
+    width_bounds_t bounds;
+    uint32_t moved;
+#endif
 
     start:
-    // Loop through all, collecting their tail versions and then try to dequeue if not empty
-    for(uint32_t i = 0; i<set->width; i++){
-        index = (start_index + i) % set->width; // TODO: Optimize away modulo
+#ifdef ELASTIC_WIDTH
+    // Also scan the retired sub-queues that are not yet drained
+    bounds.word = set->bounds.word;
+    moved = set->moved;
+    width = bounds.collect;
+#else
+    width = set->width;
+#endif
+    sval_t hinted = hinted_collect(handle, width, start_index);
+    if(hinted != EMPTY) return hinted;
+
+    // Loop through all from start_index, wrapping around, collecting their tail versions and then try
+    // to dequeue if not empty
+    if (start_index >= width) start_index = 0;
+    index = start_index;
+    for(uint32_t i = 0; i<width; i++, index = index + 1 == width ? 0 : index + 1){
 
-        double_collect_counts[index] = PARTIAL_TAIL_VERSION(&set->queues[index]);
-        sval_t v = PARTIAL_DEQUEUE(&(set->queues[index]));
+        double_collect_counts[index] = PARTIAL_TAIL_VERSION(SUBQUEUE(set, index));
+        sval_t v = PARTIAL_DEQUEUE(SUBQUEUE(set, index));
         if(v != EMPTY) return v;
+        hint_empty(set, index);
     }
 
     // Return empty if all counts are the same and the queues are still empty, otherwise restart
-    for(uint32_t i = 0; i<set->width; i++){
-        index = (start_index + i) % set->width;
-        if (double_collect_counts[index] != PARTIAL_TAIL_VERSION(&(set->queues[index])))
+    index = start_index;
+    for(uint32_t i = 0; i<width; i++, index = index + 1 == width ? 0 : index + 1){
+        if (double_collect_counts[index] != PARTIAL_TAIL_VERSION(SUBQUEUE(set, index)))
         {
             start_index = index;
             goto start;
         }
     }
+#ifdef ELASTIC_WIDTH
+    // Restart if sub-queues were added, or an item was moved out of a retired sub-queue meanwhile
+    if (set->bounds.word != bounds.word || set->moving != 0 || set->moved != moved)
+    {
+        goto start;
+    }
+#endif
 
     return EMPTY;
 }
 
+#ifdef NUMA_PARTITIONS
+// Allocates each partition of sub-queues on its own pages, preferably on the memory of its node
+static void allocate_partitions(mqueue_t *set, uint32_t nodes)
+{
+    uint32_t machine_nodes = topology_node_count();
+    size_t page_size = sysconf(_SC_PAGESIZE);
+
+    set->nodes = nodes == 0 ? machine_nodes : nodes;
+    if (set->nodes > set->width)
+    {
+        set->nodes = set->width;
+    }
+    if ((set->slots = (PARTIAL_T**) malloc(set->width * sizeof(PARTIAL_T*))) == NULL)
+    {
+		perror("malloc");
+		exit(1);
+    }
+
+    for (uint32_t p = 0; p < set->nodes; p++)
+    {
+        uint32_t first = p * set->width / set->nodes;
+        uint32_t count = (p + 1) * set->width / set->nodes - first;
+        size_t size = (count * sizeof(PARTIAL_T) + page_size - 1) & ~(page_size - 1);
+        PARTIAL_T *partition = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (partition == MAP_FAILED)
+        {
+            perror("mmap");
+            exit(1);
+        }
+
+        // Only a preference, so the partition is still usable if the node can't be used
+        uint32_t node = p % machine_nodes;
+        if (node < 8 * sizeof(unsigned long))
+        {
+            unsigned long node_mask = 1UL << node;
+            syscall(SYS_mbind, partition, size, MPOL_PREFERRED, &node_mask, 8 * sizeof(node_mask), 0);
+        }
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            set->slots[first + i] = &partition[i];
+        }
+    }
+    set->queues = set->slots[0];
+}
+
+mqueue_t* create_queue(uint32_t n_partial, uint32_t d, int nbr_threads)
+{
+    // One partition per node, but sampling uniformly as without partitions
+    return create_queue_numa(n_partial, d, nbr_threads, 0, 100);
+}
+
+// Partitions the sub-queues over nodes (0 for the nodes of the machine), and lets every sample
+// be drawn from all sub-queues with probability remote_percent, and from the local partition otherwise
+mqueue_t* create_queue_numa(uint32_t n_partial, uint32_t d, int nbr_threads, uint32_t nodes, uint32_t remote_percent)
+#elif defined(ELASTIC_WIDTH)
 mqueue_t* create_queue(uint32_t n_partial, uint32_t d, int nbr_threads)
+{
+    return create_queue_elastic(n_partial, n_partial, d, nbr_threads);
+}
+
+// Allocates max_width sub-queues, of which the first n_partial are used until update_width
+mqueue_t* create_queue_elastic(uint32_t n_partial, uint32_t max_width, uint32_t d, int nbr_threads)
+#else
+mqueue_t* create_queue(uint32_t n_partial, uint32_t d, int nbr_threads)
+#endif
 {
     //Allocate n_partial MS
     mqueue_t *set;
@@ -102,37 +581,195 @@ mqueue_t* create_queue(uint32_t n_partial, uint32_t d, int nbr_threads)
 		perror("malloc");
 		exit(1);
     }
-	set->queues = ssalloc_aligned(CACHE_LINE_SIZE, n_partial*sizeof(PARTIAL_T)); //ssalloc(width);
 	set->width = n_partial;
     set->d = d;
+    set->sleepers = 0;
+    set->wake_epoch = 0;
+    set->producers = 0;
+    set->space_epoch = 0;
+    set->closed = 0;
+    set->capacity = 0;
+    set->sub_capacity = 0;
+#ifdef ADAPTIVE_CHOICE
+    set->error_budget = 0;
+#endif
+#ifdef ELASTIC_WIDTH
+    set->max_width = max_width < n_partial ? n_partial : max_width;
+    if (set->max_width > UINT16_MAX)
+    {
+        fprintf(stderr, "The max width can be at most %u\n", UINT16_MAX);
+        exit(1);
+    }
+    set->bounds.collect = n_partial;
+    set->bounds.floor = n_partial;
+    set->bounds.version = 0;
+    set->moving = 0;
+    set->moved = 0;
+    set->resize_epoch = 1;
+    set->resizing = 0;
+    set->n_threads = nbr_threads;
+    if ((set->announcements = (width_announcement_t*) ssalloc_aligned(CACHE_LINE_SIZE, nbr_threads * sizeof(width_announcement_t))) == NULL)
+    {
+		perror("malloc");
+		exit(1);
+    }
+    memset(set->announcements, 0, nbr_threads * sizeof(width_announcement_t));
+#endif
+#ifdef NUMA_PARTITIONS
+    allocate_partitions(set, nodes);
+    set->remote_threshold = remote_percent >= 100 ? (1ULL << 32) : ((uint64_t) remote_percent << 32) / 100;
+#else
+	set->queues = ssalloc_aligned(CACHE_LINE_SIZE, ALLOCATED_WIDTH(set)*sizeof(PARTIAL_T)); //ssalloc(width);
+#endif
 
 
 	uint32_t i;
-	for(i=0; i < set->width; i++)
+	for(i=0; i < ALLOCATED_WIDTH(set); i++)
 	{
-        INIT_PARTIAL(&(set->queues[i]), nbr_threads);
+        INIT_PARTIAL(SUBQUEUE(set, i), nbr_threads);
 	}
 
+    size_t hint_words = (ALLOCATED_WIDTH(set) + 63) / 64;
+    if ((set->nonempty = (volatile uint64_t*) ssalloc_aligned(CACHE_LINE_SIZE, hint_words * sizeof(uint64_t))) == NULL)
+    {
+		perror("malloc");
+		exit(1);
+    }
+    memset((void*) set->nonempty, 0, hint_words * sizeof(uint64_t));
+
 	return set;
 }
 
+// Frees the sub-queue array and the bookkeeping of the queue, once no thread uses it any more.
+// The nodes still in the sub-queues are left to the allocators of the threads.
+void destroy_queue(mqueue_t *set)
+{
+#ifdef NUMA_PARTITIONS
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    for (uint32_t p = 0; p < set->nodes; p++)
+    {
+        uint32_t first = p * set->width / set->nodes;
+        uint32_t count = (p + 1) * set->width / set->nodes - first;
+        size_t size = (count * sizeof(PARTIAL_T) + page_size - 1) & ~(page_size - 1);
+        munmap(set->slots[first], size);
+    }
+    free(set->slots);
+#else
+    ssfree((void*) set->queues);
+#endif
+#ifdef ELASTIC_WIDTH
+    ssfree((void*) set->announcements);
+#endif
+    ssfree((void*) set->nonempty);
+    ssfree((void*) set);
+}
+
 size_t queue_size(mqueue_t *set)
 {
     uint64_t total = 0;
-    for(int i=0; i<set->width; i++){
-        total+=PARTIAL_LENGTH(&set->queues[i]);
+    for(int i=0; i<ALLOCATED_WIDTH(set); i++){
+        total+=PARTIAL_LENGTH(SUBQUEUE(set, i));
     }
     return total;
 }
 
-uint32_t random_index(mqueue_t *set)
+#ifdef ELASTIC_WIDTH
+// Backoff of the waits in update_width, which spins for QUEUE_WAIT_SPINS rounds and then yields the
+// core, as the thread waited for may have been descheduled
+static inline void resize_backoff(uint32_t *rounds) {
+    if (*rounds < QUEUE_WAIT_SPINS)
+    {
+        (*rounds)++;
+        PAUSE;
+    }
+    else
+    {
+        sched_yield();
+    }
+}
+
+// Changes the number of sub-queues that enqueues use and dequeues sample to width (at most
+// max_width), returning the old width. Sub-queues beyond a smaller width are retired once no
+// enqueue can reach them, after which dequeues drain them into the live ones, and until then the
+// double-collect keeps scanning them.
+uint32_t update_width(mqueue_t *set, uint32_t width)
 {
-	return (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (set->width));
+    width_bounds_t bounds, next;
+    uint32_t rounds = 0;
+    if (width < 1) width = 1;
+    if (width > set->max_width) width = set->max_width;
+    while (!CAS(&set->resizing, 0, 1))
+    {
+        resize_backoff(&rounds);
+    }
+
+    uint32_t old_width = set->width;
+    if (width >= old_width)
+    {
+        // Scan the new sub-queues in the double-collect before enqueues can reach them
+        do {
+            bounds.word = set->bounds.word;
+            next.collect = bounds.collect > width ? bounds.collect : width;
+            next.floor = width;
+            next.version = bounds.version + 1;
+        } while (!CAS(&set->bounds.word, bounds.word, next.word));
+        __atomic_store_n(&set->width, width, __ATOMIC_SEQ_CST);
+    }
+    else
+    {
+        __atomic_store_n(&set->width, width, __ATOMIC_SEQ_CST);
+
+        // Wait for the enqueues which started before the new width was visible
+        uint64_t epoch = IAF_U64(&set->resize_epoch);
+        for (uint32_t t = 0; t < set->n_threads; t++)
+        {
+            uint64_t announced;
+            rounds = 0;
+            while ((announced = __atomic_load_n(&set->announcements[t].epoch, __ATOMIC_SEQ_CST)) != 0 && announced < epoch)
+            {
+                resize_backoff(&rounds);
+            }
+        }
+
+        // Only now can the retired sub-queues be drained
+        do {
+            bounds.word = set->bounds.word;
+            next.collect = bounds.collect;
+            next.floor = width;
+            next.version = bounds.version + 1;
+        } while (!CAS(&set->bounds.word, bounds.word, next.word));
+    }
+
+    // Keep the capacity of the whole queue, over the new number of sub-queues
+    set->sub_capacity = (set->capacity + width - 1) / width;
+
+    __atomic_store_n(&set->resizing, 0, __ATOMIC_RELEASE);
+    return old_width;
+}
+#endif
+
+uint32_t random_index(mqueue_handle_t *handle)
+{
+    mqueue_t *set = handle->set;
+#ifdef NUMA_PARTITIONS
+    // Remote samples are uniform over all sub-queues, so every sub-queue keeps a probability of at
+    // least remote_percent / width to be sampled, which the d-choice balancing relies on
+    uint64_t r = wyrand(&handle->index_seed);
+    if ((r >> 32) >= set->remote_threshold)
+    {
+        return handle->local_first + reduce_range((uint32_t) r, handle->local_width);
+    }
+    return reduce_range((uint32_t) r, set->width);
+#else
+    return reduce_range((uint32_t) wyrand(&handle->index_seed), set->width);
+#endif
 }
 
-// Set up thread local variables for the queue
-mqueue_t* d_balanced_register(mqueue_t *set, int thread_id)
+// Returns the handle of the thread for the queue, which holds its view of the queue, and sets up
+// the thread local variables shared by all queues of the thread
+mqueue_handle_t* d_balanced_register(mqueue_t *set, int thread_id)
 {
+    mqueue_handle_t *handle;
     ssalloc_init();
 	#if GC == 1
     if (alloc == NULL)
@@ -143,9 +780,52 @@ mqueue_t* d_balanced_register(mqueue_t *set, int thread_id)
     }
 	#endif
 
-	double_collect_counts = malloc(set->width*sizeof(uint64_t));
+    if (double_collect_size < ALLOCATED_WIDTH(set))
+    {
+        double_collect_size = ALLOCATED_WIDTH(set);
+        double_collect_counts = realloc(double_collect_counts, double_collect_size*sizeof(uint64_t));
+        assert(double_collect_counts != NULL);
+    }
+
+	if ((handle = (mqueue_handle_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mqueue_handle_t))) == NULL)
+    {
+		perror("malloc");
+		exit(1);
+    }
+    handle->set = set;
+    handle->index_seed = wyrand_seed(thread_id);
+#ifdef ELASTIC_WIDTH
+    // Without an announcement slot, a shrink could retire a sub-queue under the thread's enqueues
+    if (thread_id < 0 || thread_id >= set->n_threads)
+    {
+        fprintf(stderr, "Thread %d can't register to an elastic queue created for %u threads\n", thread_id, set->n_threads);
+        exit(1);
+    }
+    handle->announcement = &set->announcements[thread_id];
+#endif
+#ifdef ADAPTIVE_CHOICE
+    init_choice_controller(&handle->enq_choices, set->d);
+    init_choice_controller(&handle->deq_choices, set->d);
+#endif
+#ifdef NUMA_PARTITIONS
+    // Use the node of the thread's cpu if there is a partition per node, and spread the threads otherwise
+    uint32_t partition = thread_id % set->nodes;
+    int cpu = sched_getcpu();
+    if (cpu >= 0 && set->nodes <= topology_node_count())
+    {
+        partition = topology_node(cpu) % set->nodes;
+    }
+    handle->local_first = partition * set->width / set->nodes;
+    handle->local_width = (partition + 1) * set->width / set->nodes - handle->local_first;
+#endif
 #ifdef RELAXATION_TIMER_ANALYSIS
 	init_relaxation_analysis_local(thread_id);
 #endif
-    return set;
+    return handle;
+}
+
+// Frees the handle of a thread, which can't operate on the queue any more.
+void d_balanced_unregister(mqueue_handle_t *handle)
+{
+    ssfree((void*) handle);
 }
\ No newline at end of file
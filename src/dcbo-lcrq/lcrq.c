@@ -360,6 +360,24 @@ int dequeue_wrap(queue_t *q, handle_t *th) {
   return 0;
 }
 
+// The CRQ rings have no way to reserve several slots at once, so batches are done item by item
+uint32_t enqueue_batch_wrap(queue_t *q, handle_t *th, sval_t *vals, uint32_t n) {
+  for (uint32_t i = 0; i < n; i++) {
+    enqueue_(q, th, (void*) vals[i]);
+  }
+  return n;
+}
+
+uint32_t dequeue_batch_wrap(queue_t *q, handle_t *th, sval_t *out, uint32_t n) {
+  uint32_t got = 0;
+  while (got < n) {
+    int64_t val = (int64_t) dequeue_(q, th);
+    if (val == -1) break;
+    out[got++] = val;
+  }
+  return got;
+}
+
 //Need one more function here. Enq count does not guarantee uniqueness!
 uint64_t lcrq_enq_count (queue_t *q){
   RingQueue *tail = q->tail;
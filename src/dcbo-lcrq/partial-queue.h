@@ -20,6 +20,8 @@ void handle_free(handle_t *h);
 #define PARTIAL_TAIL_VERSION(q)     lcrq_tail_version(q)
 #define PARTIAL_ENQ_COUNT(q)        lcrq_enq_count(q)
 #define PARTIAL_DEQ_COUNT(q)        lcrq_deq_count(q)
+#define PARTIAL_ENQUEUE_BATCH(q, k, v, n)   enqueue_batch_wrap(q, &lcrq_handle, v, n)
+#define PARTIAL_DEQUEUE_BATCH(q, o, n)      dequeue_batch_wrap(q, &lcrq_handle, o, n)
 #define EMPTY						((sval_t)0)
 
 extern __thread handle_t lcrq_handle;
@@ -27,6 +29,8 @@ extern __thread handle_t lcrq_handle;
 // Expose functions
 int enqueue_wrap(queue_t *q, handle_t *th, sval_t v);
 int dequeue_wrap(queue_t *q, handle_t *th);
+uint32_t enqueue_batch_wrap(queue_t *q, handle_t *th, sval_t *vals, uint32_t n);
+uint32_t dequeue_batch_wrap(queue_t *q, handle_t *th, sval_t *out, uint32_t n);
 uint64_t lcrq_queue_size(queue_t *q);
 uint64_t lcrq_enq_count(queue_t *q);
 uint64_t lcrq_deq_count(queue_t *q);
@@ -66,6 +66,46 @@ static int enq_cae(node_t** next_node_loc, node_t* new_node)
 #endif
 }
 
+// Like enq_cae, but links a whole pre-built chain of nodes with a single CAS
+static int enq_chain_cae(node_t** next_node_loc, node_t* first_node)
+{
+	node_t* expected = NULL;
+#ifdef RELAXATION_TIMER_ANALYSIS
+	if (CAE(next_node_loc, &expected, &first_node))
+	{
+		uint64_t timestamp = get_timestamp();
+		for (node_t* node = first_node; node != NULL; node = node->next)
+		{
+			add_relaxed_put(node->val, timestamp);
+		}
+		return true;
+	}
+	return false;
+
+#elif RELAXATION_ANALYSIS
+
+	lock_relaxation_lists();
+
+	if (CAE(next_node_loc, &expected, &first_node))
+	{
+		for (node_t* node = first_node; node != NULL; node = node->next)
+		{
+			node->val = gen_relaxation_count();
+			add_linear(node->val, 0);
+		}
+		unlock_relaxation_lists();
+		return true;
+	}
+	else {
+		unlock_relaxation_lists();
+		return false;
+	}
+
+#else
+	return CAE(next_node_loc, &expected, &first_node);
+#endif
+}
+
 static int deq_cae(volatile descriptor_t* des_loc, descriptor_t* read_des_loc, descriptor_t* new_des_loc)
 {
 #ifdef RELAXATION_TIMER_ANALYSIS
@@ -97,6 +137,47 @@ static int deq_cae(volatile descriptor_t* des_loc, descriptor_t* read_des_loc, d
 #endif
 }
 
+// Like deq_cae, but moves the head past count nodes at once
+static int deq_chain_cae(volatile descriptor_t* des_loc, descriptor_t* read_des_loc, descriptor_t* new_des_loc, uint32_t count)
+{
+#ifdef RELAXATION_TIMER_ANALYSIS
+	if (CAE(des_loc, read_des_loc, new_des_loc))
+	{
+		uint64_t timestamp = get_timestamp();
+		node_t* node = read_des_loc->node;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			node = node->next;
+			add_relaxed_get(node->val, timestamp);
+		}
+		return true;
+	}
+	return false;
+
+#elif RELAXATION_ANALYSIS
+
+	lock_relaxation_lists();
+	if (CAE(des_loc, read_des_loc, new_des_loc))
+	{
+		node_t* node = read_des_loc->node;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			node = node->next;
+			remove_linear(node->val);
+		}
+		unlock_relaxation_lists();
+		return true;
+	}
+	else {
+		unlock_relaxation_lists();
+		return false;
+	}
+
+#else
+	return CAE(des_loc, read_des_loc, new_des_loc);
+#endif
+}
+
 int ms_enqueue(ms_queue_t *q, skey_t key, sval_t val)
 {
     node_t* new_node = create_ms_node(key, val, NULL);
@@ -170,6 +251,101 @@ sval_t ms_dequeue(ms_queue_t *q)
     }
 }
 
+// Enqueue n items by building the chain of nodes locally and splicing it in with one CAS.
+// The tail is then swung over the whole chain, or advanced node by node by helping threads if that fails.
+uint32_t ms_enqueue_batch(ms_queue_t *q, skey_t *keys, sval_t *vals, uint32_t n)
+{
+	node_t* first_node = create_ms_node(keys[0], vals[0], NULL);
+	node_t* last_node = first_node;
+	for (uint32_t i = 1; i < n; i++)
+	{
+		last_node->next = create_ms_node(keys[i], vals[i], NULL);
+		last_node = last_node->next;
+	}
+
+	descriptor_t tail;
+    while(1)
+	{
+		tail = q->tail;
+		if(tail.node->next == NULL)
+		{
+			if(enq_chain_cae((node_t **) &tail.node->next, first_node))
+			{
+				break;
+			}
+		}
+		else
+		{
+            descriptor_t new_tail;
+            new_tail.count = tail.count + 1;
+            new_tail.node = tail.node->next;
+			CAE(&q->tail, &tail, &new_tail);
+		}
+
+		my_put_cas_fail_count+=1;
+	}
+    descriptor_t new_tail;
+    new_tail.count = tail.count + n;
+    new_tail.node = last_node;
+	CAE(&q->tail, &tail, &new_tail);
+	return n;
+}
+
+// Dequeue up to n items by moving the head past several nodes with one CAS, without passing the tail
+uint32_t ms_dequeue_batch(ms_queue_t *q, sval_t *out, uint32_t n)
+{
+	descriptor_t head, tail, new_tail, new_head;
+
+	while (1)
+    {
+		head = q->head;
+		tail = q->tail;
+
+		if (unlikely(head.node == tail.node))
+		{
+			if(head.node->next == NULL)
+			{
+				my_null_count+=1;
+				return 0;
+			}
+			else
+			{
+				new_tail.count = tail.count + 1;
+                new_tail.node = tail.node->next;
+				CAE(&q->tail, &tail, &new_tail);
+			}
+		}
+		else
+		{
+			node_t* last_node = head.node->next;
+			uint32_t count = 1;
+			while (count < n && last_node != tail.node && last_node->next != NULL)
+			{
+				last_node = last_node->next;
+				count++;
+			}
+
+			new_head.count = head.count + count;
+            new_head.node = last_node;
+			if(deq_chain_cae((descriptor_t*) &q->head, &head, &new_head, count))
+			{
+				// The last claimed node becomes the new sentinel, free the ones before it
+				node_t* node = head.node;
+				for (uint32_t i = 0; i < count; i++)
+				{
+					node_t* next = node->next;
+					out[i] = next->val;
+					#if GC == 1
+						ssmem_free(alloc, (void*) node);
+					#endif
+					node = next;
+				}
+				return count;
+			}
+		}
+    }
+}
+
 size_t ms_queue_size(ms_queue_t *q){
 	return q->tail.count - q->head.count;
 }
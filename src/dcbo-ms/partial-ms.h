@@ -32,6 +32,8 @@
 #define PARTIAL_TAIL_VERSION(q)		ms_enq_count(q)
 #define PARTIAL_ENQ_COUNT(q)        ms_enq_count(q)
 #define PARTIAL_DEQ_COUNT(q)        ms_deq_count(q)
+#define PARTIAL_ENQUEUE_BATCH(q, k, v, n)   ms_enqueue_batch(q, k, v, n)
+#define PARTIAL_DEQUEUE_BATCH(q, o, n)      ms_dequeue_batch(q, o, n)
 #define EMPTY						((sval_t)0)
 
 
@@ -74,6 +76,8 @@ extern __thread unsigned long my_slide_count;
 /* Interfaces */
 int ms_enqueue(ms_queue_t *set, skey_t key, sval_t val);
 sval_t ms_dequeue(ms_queue_t *q);
+uint32_t ms_enqueue_batch(ms_queue_t *q, skey_t *keys, sval_t *vals, uint32_t n);
+uint32_t ms_dequeue_batch(ms_queue_t *q, sval_t *out, uint32_t n);
 void init_ms_queue(ms_queue_t *q);
 size_t ms_queue_size(ms_queue_t *set);
 uint64_t ms_enq_count(ms_queue_t *set);
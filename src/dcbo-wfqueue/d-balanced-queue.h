@@ -16,6 +16,10 @@
 #include "lock_if.h"
 #include "ssmem.h"
 #include "utils.h"
+#include "futex.h"
+#ifdef ADAPTIVE_CHOICE
+#include "choice_controller.h"
+#endif
 
 // Include specific partial queue
 #include "partial-wfqueue.h"
@@ -26,22 +30,123 @@
 
 #define DS_ADD(s,k,v)       enqueue(s,k,v)
 #define DS_REMOVE(s)        dequeue(s)
+#define DS_REMOVE_WAIT(s,t) dequeue_wait(s,t)
+#define DS_ADD_WAIT(s,k,v,t)    enqueue_wait(s,k,v,t)
 #define DS_SIZE(s)          queue_size(s)
 #define DS_NEW(w,d,i)       create_queue(w,d,i)
 #define DS_REGISTER(q,i)	d_balanced_register(q,i)
+#define DS_UNREGISTER(h)    d_balanced_unregister(h)
+#define DS_DESTROY(s)       destroy_queue(s)
+#define DS_ADD_BATCH(s,k,v,n)   enqueue_batch(s,k,v,n)
+#define DS_REMOVE_BATCH(s,o,n)  dequeue_batch(s,o,n)
+#ifdef NUMA_PARTITIONS
+#define DS_NEW_NUMA(w,d,i,n,r)  create_queue_numa(w,d,i,n,r)
+#endif
+#ifdef ELASTIC_WIDTH
+#define DS_NEW_ELASTIC(w,m,d,i) create_queue_elastic(w,m,d,i)
+#endif
+#if defined(ELASTIC_WIDTH) && defined(NUMA_PARTITIONS)
+#error "ELASTIC=1 and NUMA=1 can't be combined"
+#endif
 
-#define DS_HANDLE 			mqueue_t*
+#define DS_HANDLE 			mqueue_handle_t*
 #define DS_TYPE             mqueue_t
 #define DS_NODE             sval_t
 
+#ifdef ELASTIC_WIDTH
+// The sub-queues in [floor, collect) are retired ones that no enqueue can reach any more, which
+// dequeues drain into the live ones, while the double-collect scans all of [0, collect). The version
+// is bumped by every update_width, so that a drain never acts on stale bounds.
+typedef union width_bounds
+{
+	struct {
+		uint16_t collect;
+		uint16_t floor;
+		uint32_t version;
+	};
+	uint64_t word;
+} width_bounds_t;
+
+// The resize epoch the current enqueue of a thread started in, 0 when the thread isn't enqueueing
+typedef ALIGNED(CACHE_LINE_SIZE) struct width_announcement
+{
+	volatile uint64_t epoch;
+	uint8_t padding[CACHE_LINE_SIZE - sizeof(uint64_t)];
+} width_announcement_t;
+#endif
+
 typedef ALIGNED(CACHE_LINE_SIZE) struct mqueue_file
 {
 	PARTIAL_T *queues;
-	uint32_t width;
+	volatile uint32_t width;
     uint32_t d;
+#ifdef NUMA_PARTITIONS
+	PARTIAL_T **slots;            // Sub-queue i, as each NUMA partition is allocated separately
+	uint64_t remote_threshold;    // A sample is drawn from all sub-queues if 32 random bits are below this
+	uint32_t nodes;               // Number of partitions, the sub-queues of partition p are contiguous
+	uint8_t padding[CACHE_LINE_SIZE - 2*sizeof(PARTIAL_T*) - sizeof(uint64_t) - 3*sizeof(int32_t)];
+#else
 	uint8_t padding[CACHE_LINE_SIZE - (sizeof(PARTIAL_T*)) - 2*sizeof(int32_t)];
+#endif
+	// Consumers parked in dequeue_wait, and the futex word enqueuers bump to wake them
+	ALIGNED(CACHE_LINE_SIZE) volatile uint32_t sleepers;
+	volatile uint32_t wake_epoch;
+	// Producers parked in enqueue_wait on a full queue, and the futex word dequeuers bump to wake them
+	volatile uint32_t producers;
+	volatile uint32_t space_epoch;
+	volatile uint32_t closed;     // Set by d_balanced_wake_all, waits return instead of parking
+	uint64_t capacity;            // Capacity of the whole queue, 0 if unbounded
+	uint64_t sub_capacity;        // Capacity of each sub-queue, 0 if unbounded
+	volatile uint64_t *nonempty;  // Hint bit per sub-queue that may have items, see double_collect
+#ifdef ADAPTIVE_CHOICE
+	uint64_t error_budget;        // Rank error the adaptive d aims to stay below, 0 if none
+#endif
+#ifdef ELASTIC_WIDTH
+	// Only written by update_width and the drains of retired sub-queues
+	ALIGNED(CACHE_LINE_SIZE) volatile width_bounds_t bounds;
+	volatile uint32_t moving;     // Items being moved out of a retired sub-queue, in neither sub-queue
+	volatile uint32_t moved;      // Moves finished, bumped before moving is decremented
+	volatile uint64_t resize_epoch;
+	volatile uint32_t resizing;   // Serializes update_width
+	uint32_t max_width;           // Allocated sub-queues, which the width can grow to
+	uint32_t n_threads;
+	width_announcement_t *announcements;
+#endif
 } mqueue_t;
 
+// Per-thread handle, returned by DS_REGISTER. It holds the thread's view of the queue, so that a
+// thread can operate on several queues.
+typedef ALIGNED(CACHE_LINE_SIZE) struct mqueue_handle
+{
+	mqueue_t *set;
+	uint64_t index_seed;          // The thread's stream of random bits for sampling sub-queues
+#ifdef NUMA_PARTITIONS
+	uint32_t local_first;         // The partition of the NUMA node the thread runs on
+	uint32_t local_width;
+#endif
+#ifdef ELASTIC_WIDTH
+	width_announcement_t *announcement;  // Where enqueues are announced to update_width
+#endif
+#ifdef ADAPTIVE_CHOICE
+	choice_controller_t enq_choices;     // The d of the thread's enqueues and dequeues, started at set->d
+	choice_controller_t deq_choices;
+#endif
+	handle_t *sub_handles;        // The thread's handle of every sub-queue
+} mqueue_handle_t;
+
+#ifdef NUMA_PARTITIONS
+#define SUBQUEUE(set, i)    ((set)->slots[i])
+#else
+#define SUBQUEUE(set, i)    (&(set)->queues[i])
+#endif
+
+// Returned by the enqueues of a bounded queue without room for the items
+#define QUEUE_FULL              0
+
+// Number of attempts before enqueue_wait and dequeue_wait park the thread
+#define QUEUE_WAIT_SPINS        64
+#define QUEUE_WAIT_FOREVER      UINT64_MAX
+
 /*Global variables*/
 
 
@@ -56,12 +161,31 @@ extern __thread unsigned long my_hop_count;
 extern __thread unsigned long my_slide_count;
 
 /* Interfaces */
-int enqueue(mqueue_t *set, skey_t key, sval_t val);
-sval_t dequeue(mqueue_t *set);
+int enqueue(mqueue_handle_t *handle, skey_t key, sval_t val);
+sval_t dequeue(mqueue_handle_t *handle);
+int enqueue_wait(mqueue_handle_t *handle, skey_t key, sval_t val, uint64_t timeout_ns);
+sval_t dequeue_wait(mqueue_handle_t *handle, uint64_t timeout_ns);
+void d_balanced_wake_all(mqueue_t *set);
+void d_balanced_set_capacity(mqueue_t *set, size_t capacity);
+#ifdef ADAPTIVE_CHOICE
+void d_balanced_set_error_budget(mqueue_t *set, uint64_t budget);
+void d_balanced_mean_choices(mqueue_handle_t *handle, double *enqueue_d, double *dequeue_d);
+#endif
+int enqueue_batch(mqueue_handle_t *handle, skey_t *keys, sval_t *vals, uint32_t n);
+uint32_t dequeue_batch(mqueue_handle_t *handle, sval_t *out, uint32_t n);
 mqueue_t* create_queue(uint32_t n_partial, uint32_t d, int nbr_threads);
+#ifdef NUMA_PARTITIONS
+mqueue_t* create_queue_numa(uint32_t n_partial, uint32_t d, int nbr_threads, uint32_t nodes, uint32_t remote_percent);
+#endif
+#ifdef ELASTIC_WIDTH
+mqueue_t* create_queue_elastic(uint32_t n_partial, uint32_t max_width, uint32_t d, int nbr_threads);
+uint32_t update_width(mqueue_t *set, uint32_t width);
+#endif
+void destroy_queue(mqueue_t *set);
 size_t queue_size(mqueue_t *set);
-uint32_t random_index(mqueue_t *set);
-sval_t double_collect(mqueue_t *set, uint32_t start_index);
-mqueue_t* d_balanced_register(mqueue_t *set, int thread_id);
+uint32_t random_index(mqueue_handle_t *handle);
+sval_t double_collect(mqueue_handle_t *handle, uint32_t start_index);
+mqueue_handle_t* d_balanced_register(mqueue_t *set, int thread_id);
+void d_balanced_unregister(mqueue_handle_t *handle);
 
 #endif
\ No newline at end of file
@@ -440,6 +440,7 @@ void wfqueue_init(queue_t *q, int nprocs) {
 
     q->Ei = 1;
     q->Di = 1;
+    q->_tail_handle = NULL;
 
     assert(nprocs != 0);
     q->nprocs = nprocs;
@@ -540,6 +541,24 @@ sval_t dequeue_wrap(handle_t *th) {
   return (sval_t)wfqueue_dequeue(th->queue, th);
 }
 
+// The wait-free queue reserves cells one at a time, so batches are done item by item
+uint32_t enqueue_batch_wrap(handle_t *th, sval_t *vals, uint32_t n) {
+  for (uint32_t i = 0; i < n; i++) {
+    wfqueue_enqueue(th->queue, th, (void*) vals[i]);
+  }
+  return n;
+}
+
+uint32_t dequeue_batch_wrap(handle_t *th, sval_t *out, uint32_t n) {
+  uint32_t got = 0;
+  while (got < n) {
+    sval_t val = (sval_t) wfqueue_dequeue(th->queue, th);
+    if (val == EMPTY) break;
+    out[got++] = val;
+  }
+  return got;
+}
+
 uint64_t wfqueue_enq_count(queue_t *q)
 {
     return q->Ei;
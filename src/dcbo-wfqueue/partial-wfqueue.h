@@ -13,15 +13,18 @@
 #error "Cannot use lock-based relaxation analysis for wfqueue due to complexity of helping threads"
 #endif
 
-// Define generics for d-balanced-queue
+// Define generics for d-balanced-queue, where the sub-queue handles of the calling thread are in
+// the d-CBO handle, which is called handle wherever these are used
 #define PARTIAL_T                   queue_t
-#define PARTIAL_ENQUEUE(q,k,v,i)    enqueue_wrap(&thread_handles[i], (void*) v)
-#define PARTIAL_DEQUEUE(q, index)   dequeue_wrap(&thread_handles[index])
+#define PARTIAL_ENQUEUE(q,k,v,i)    enqueue_wrap(&handle->sub_handles[i], (void*) v)
+#define PARTIAL_DEQUEUE(q, index)   dequeue_wrap(&handle->sub_handles[index])
 #define INIT_PARTIAL(q,n)           wfqueue_init(q,n)
 #define PARTIAL_LENGTH(q)           wfqueue_length_heuristic(q)
 #define PARTIAL_TAIL_VERSION(q)     wfqueue_enq_count(q)
 #define PARTIAL_ENQ_COUNT(q)        wfqueue_enq_count(q)
 #define PARTIAL_DEQ_COUNT(q)        wfqueue_deq_count(q)
+#define PARTIAL_ENQUEUE_BATCH(q,k,v,n,i)    enqueue_batch_wrap(&handle->sub_handles[i], v, n)
+#define PARTIAL_DEQUEUE_BATCH(q,o,n,i)      dequeue_batch_wrap(&handle->sub_handles[i], o, n)
 #define EMPTY						            ((sval_t)0)
 
 #define INTERNAL_EMPTY ((void *) 0)
@@ -168,6 +171,8 @@ extern __thread ssmem_allocator_t* alloc;
 // Expose functions
 int enqueue_wrap(handle_t *th, void *v);
 sval_t dequeue_wrap(handle_t *th);
+uint32_t enqueue_batch_wrap(handle_t *th, sval_t *vals, uint32_t n);
+uint32_t dequeue_batch_wrap(handle_t *th, sval_t *out, uint32_t n);
 queue_t* wfqueue_create(int nprocs, int thread_id);
 void wfqueue_init(queue_t *q, int nprocs);
 handle_t* wfqueue_register(queue_t *q, handle_t* th, int id);
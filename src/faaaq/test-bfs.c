@@ -2,11 +2,15 @@
 #include <stdio.h>
 #include "faaaq.h"
 #include "rapl_read.h"
+#include "bfs_stats.h"
 
 
 char *filepath;
 uint64_t root = 1;
 bool directed = false;
+bool print_levels = false;
+uint32_t id_bits = 0;
+graph_order_t order = GRAPH_ORDER_NONE;
 
 size_t initial = DEFAULT_INITIAL;
 size_t range = DEFAULT_RANGE;
@@ -44,7 +48,6 @@ volatile unsigned long *slide_count;
 volatile ticks *removing_count;
 volatile ticks *removing_count_succ;
 volatile ticks *total;
-volatile uint64_t active_threads;
 uint64_t *start_times;
 uint64_t *end_times;
 uint64_t *work;
@@ -75,7 +78,6 @@ typedef struct thread_data
     graph_t* g;
 } thread_data_t;
 
-#define MAX_FAILURES 100
 
 uint64_t get_time()
 {
@@ -84,54 +86,64 @@ uint64_t get_time()
 	return (uint64_t)ts.tv_sec * 1e9 + ts.tv_nsec;
 }
 
+// Defines NAME over the ID_T vertex ids and distances of a graph, with the arrays of SUFFIX from graph.h
+#define DEFINE_RUN_BFS(NAME, SUFFIX, ID_T)																		\
+void NAME(DS_HANDLE set, graph_t *g)																			\
+{																												\
+	uint64_t idle_start = 0;																					\
+	while (1)																									\
+	{																											\
+		uint64_t current = DS_REMOVE(set);																		\
+		if (!current)																							\
+		{																										\
+			/* The counters of every thread are only read when out of items */									\
+			if (idle_start == 0) idle_start = get_time();														\
+			if (bfs_terminated()) break;																		\
+			continue;																							\
+		}																										\
+		if (idle_start != 0)																					\
+		{																										\
+			bfs_idle(thread_id, get_time() - idle_start);														\
+			idle_start = 0;																						\
+		}																										\
+																												\
+		ID_T *neighbors;																						\
+		uint64_t size = get_neighbors##SUFFIX(g, current, &neighbors);											\
+		ID_T current_distance = g->distances##SUFFIX[current];													\
+		bfs_expanded(thread_id, current_distance);																\
+																												\
+		for (int i = 0; i < size; i++)																			\
+		{																										\
+			ID_T current_neighbor = neighbors[i];																\
+			ID_T distance = g->distances##SUFFIX[current_neighbor];												\
+			ID_T inc_current_distance = current_distance + 1;													\
+																												\
+			while (inc_current_distance < distance)																\
+			{																									\
+				if (likely(CAE(&g->distances##SUFFIX[current_neighbor], &distance, &inc_current_distance)))		\
+				{																								\
+					/* Possible contention here. Could cache pad this array */									\
+					work[thread_id]++;																			\
+					bfs_added(thread_id);																		\
+					DS_ADD(set, current_neighbor, current_neighbor);											\
+					break;																						\
+				}																								\
+			}																									\
+		}																										\
+		bfs_processed(thread_id);																				\
+	}																											\
+	/* The run ends when the last item was processed, which this thread has just seen */						\
+	end_times[thread_id] = get_time();																			\
+	bfs_idle(thread_id, end_times[thread_id] - idle_start);														\
+}
+
+DEFINE_RUN_BFS(run_bfs_32, 32, uint32_t)
+DEFINE_RUN_BFS(run_bfs_64, , uint64_t)
+
 void run_bfs(DS_HANDLE set, graph_t *g)
 {
-	bool is_active = true;
-	uint64_t failures = 0;
-	while (failures < MAX_FAILURES || get_time() - end_times[thread_id] < 100000000 || active_threads != 0)
-	{
-		uint64_t current;
-		while ((current = DS_REMOVE(set)))
-		{
-			// Successfully dequeued an item
-			if (!is_active)
-			{
-				FAI_U64(&active_threads);
-				is_active = true;
-				failures = 0;
-			}
-
-			uint64_t *neighbors;
-			uint64_t size = get_neighbors(g, current, &neighbors);
-			uint64_t current_distance = g->distances[current];
-
-			for (int i = 0; i < size; i++)
-			{
-				uint64_t current_neighbor = neighbors[i];
-				uint64_t distance = g->distances[current_neighbor];
-				uint64_t inc_current_distance = current_distance + 1;
-
-				while (inc_current_distance < distance)
-				{
-					if (likely(CAE(&g->distances[current_neighbor], &distance, &inc_current_distance)))
-					{
-						// Possible contention here. Could cache pad this array
-						work[thread_id]++;
-						DS_ADD(set, current_neighbor, current_neighbor);
-						break;
-					}
-				}
-			}
-		}
-		if (is_active)
-		{
-			FAD_U64(&active_threads);
-			is_active = false;
-			// Find the timestamp when the final thread did its first 'final' empty dequeue
-			end_times[thread_id] = get_time();
-		}
-		failures += 1;
-	}
+	if (g->id_bits == 32) run_bfs_32(set, g);
+	else run_bfs_64(set, g);
 }
 
 
@@ -153,14 +165,20 @@ void* test(void* thread)
     seeds = seed_rand();
     RR_INIT(thread_id);
     DS_HANDLE handle = DS_REGISTER(td->set, thread_id);
-    if (thread_id == 0) DS_ADD(handle, root, root);
-	td->g->distances[root] = 0;
+    if (thread_id == 0)
+    {
+        bfs_added(thread_id);
+        DS_ADD(handle, root, root);
+    }
+	set_distance(td->g, root, 0);
 	barrier_cross(&barrier);
 	struct timespec ts;
     clock_gettime(CLOCK_REALTIME, &ts);
     start_times[thread_id] = (uint64_t)ts.tv_sec * 1e9 + ts.tv_nsec;
 
+	PERF_COUNTERS_START();
 	run_bfs(handle, td->g);
+	PERF_COUNTERS_STOP();
 	barrier_cross(&barrier_global);
 
 	THREAD_END();
@@ -180,6 +198,10 @@ int main(int argc, char **argv){
 		{"filepath",                  required_argument, NULL, 'f'},
 		{"root",                      required_argument, NULL, 'r'},
 		{"directed",               	  no_argument,       NULL, 'd'},
+		{"id-bits",                   required_argument, NULL, 'b'},
+		{"order",                     required_argument, NULL, 'o'},
+		{"levels",                    no_argument,       NULL, 'L'},
+		{"pin",                       required_argument, NULL, 'P'},
 		{NULL, 0, NULL, 0}
 	};
 
@@ -187,7 +209,7 @@ int main(int argc, char **argv){
 	while(1)
     {
 		i = 0;
-		c = getopt_long(argc, argv, "hAf:di:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:c:", long_options, &i);
+		c = getopt_long(argc, argv, "hAf:di:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:c:P:o:L", long_options, &i);
 		if(c == -1)
 		break;
 		if(c == 0 && long_options[i].flag == 0)
@@ -215,6 +237,14 @@ int main(int argc, char **argv){
 			"        The starting node of the bfs.\n"
 			"  -d, --directed \n"
 			"        Parses the graph as directed [DEFAULT=false].\n"
+			"  -b, --id-bits <int>\n"
+			"        Width of the vertex ids, 32, 64 or 0 for 32 whenever the graph fits [DEFAULT=0].\n"
+			"  -o, --order <str>\n"
+			"        Renumber the vertices for locality: none, bfs or rcm (reverse Cuthill-McKee) [DEFAULT=none].\n"
+			"  -L, --levels\n"
+			"        Print the vertices and expansions at every distance.\n"
+			"  -P, --pin <policy>\n"
+			"        Pin threads from the sysfs topology: compact-cores-first, scatter-sockets, smt-last or table [DEFAULT=table].\n"
 			, argv[0]);
 			exit(0);
 			case 'n':
@@ -229,11 +259,23 @@ int main(int argc, char **argv){
 			case 'd':
 			directed = true;
 			break;
+			case 'b':
+			id_bits = atoi(optarg);
+			break;
+			case 'o':
+			order = parse_graph_order(optarg);
+			break;
+			case 'L':
+			print_levels = true;
+			break;
 			case 'w':
 			case 'c':
 			case 'm':
 			case 'k':
             case 'l':
+			break;
+			case 'P':
+			set_pin_policy(optarg);
 			break;
 			case '?':
 			default:
@@ -288,11 +330,12 @@ int main(int argc, char **argv){
 	pthread_attr_init(&attr);
 	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
 
-    graph_t* g = parse_mtx_file(filepath, directed);
+    graph_t* g = parse_mtx_file(filepath, directed, id_bits, order);
+    root = graph_vertex(g, root);
 
 	thread_data_t* tds = (thread_data_t*) malloc(num_threads * sizeof(thread_data_t));
 
-	active_threads = num_threads;
+	bfs_stats_init(num_threads);
 
 	long t;
 	for(t = 0; t < num_threads; t++)
@@ -355,7 +398,7 @@ int main(int argc, char **argv){
 	uint64_t distances = 0;
 	uint64_t visited = 0;
 	for(uint64_t i = 1; i <= g->n_verticies; i++) {
-		uint64_t distance = g->distances[i];
+		uint64_t distance = get_distance(g, i);
 		if (distance != UINT64_MAX){
 			visited++;
 			distances += distance;
@@ -366,7 +409,9 @@ int main(int argc, char **argv){
 	printf("elapsed_time , %.3f \n", ((double)max_end - min_start)/1000000);
 	printf("average_distance , %.3f \n", ((double)distances/visited));
 	printf("vertices_visited , %lu \n", visited);
+	printf("id_bits , %u \n", g->id_bits);
 	printf("total_work , %lu \n", total_work);
+	bfs_stats_print(g, print_levels);
 
 	volatile ticks putting_suc_total = 0;
 	volatile ticks putting_fal_total = 0;
@@ -406,7 +451,7 @@ int main(int argc, char **argv){
 		long unsigned put_fal = (putting_count_total - putting_count_total_succ) ? putting_fal_total / (putting_count_total - putting_count_total_succ) : 0;
 		long unsigned rem_suc = removing_count_total_succ ? removing_suc_total / removing_count_total_succ : 0;
 		long unsigned rem_fal = (removing_count_total - removing_count_total_succ) ? removing_fal_total / (removing_count_total - removing_count_total_succ) : 0;
-		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, get_suc, get_fal, put_suc, put_fal, rem_suc, rem_fal);
+		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, 0LU, 0LU, put_suc, put_fal, rem_suc, rem_fal);
 	#endif
 
 	#define LLU long long unsigned int
@@ -440,6 +485,7 @@ int main(int argc, char **argv){
 	RR_PRINT_CORRECTED();
 	RETRY_STATS_PRINT(total, putting_count_total, removing_count_total, putting_count_total_succ + removing_count_total_succ);
 	LATENCY_DISTRIBUTION_PRINT();
+	PERF_COUNTERS_PRINT(total_work);
 
 	#ifdef RELAXATION_TIMER_ANALYSIS
 		print_relaxation_measurements(num_threads);
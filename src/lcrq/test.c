@@ -70,6 +70,8 @@ uint64_t relaxation_bound = 1;
 uint64_t width = 1;
 uint64_t choices = 2;
 size_t side_work = 0;
+double open_loop_rate = 0;
+int open_loop_poisson = 0;
 
 TEST_VARS_GLOBAL;
 
@@ -187,10 +189,12 @@ void* test(void* thread)
 	RETRY_STATS_ZERO();
 	barrier_cross(&barrier_global);
 	RR_START_SIMPLE();
+	PERF_COUNTERS_START();
 	while (stop == 0)
     {
 		TEST_LOOP_ONLY_UPDATES();
 	}
+	PERF_COUNTERS_STOP();
 	barrier_cross(&barrier);
 	RR_STOP_SIMPLE();
 	if (!thread_id)
@@ -251,6 +255,9 @@ int main(int argc, char **argv)
 		{"num-buckets",               required_argument, NULL, 'b'},
 		{"print-vals",                required_argument, NULL, 'v'},
 		{"vals-pf",                   required_argument, NULL, 'f'},
+		{"pin",                       required_argument, NULL, 'P'},
+		{"rate",                      required_argument, NULL, 'R'},
+		{"poisson",                   no_argument,       NULL, 'O'},
 		{NULL, 0, NULL, 0}
 	};
 
@@ -258,7 +265,7 @@ int main(int argc, char **argv)
 	while(1)
     {
 		i = 0;
-		c = getopt_long(argc, argv, "hAf:d:i:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:c:", long_options, &i);
+		c = getopt_long(argc, argv, "hAf:d:i:n:r:u:m:a:l:p:b:v:f:y:z:k:w:s:c:P:R:O", long_options, &i);
 		if(c == -1)
 		break;
 		if(c == 0 && long_options[i].flag == 0)
@@ -302,6 +309,12 @@ int main(int argc, char **argv)
 			"        Width (Number of sub-structures).\n"
 			"  -c, --choices <int>\n"
 			"        The number of choices to use (refered to as d in d-balanced queues) [DEFAULT=2].\n"
+			"  -P, --pin <policy>\n"
+			"        Pin threads from the sysfs topology: compact-cores-first, scatter-sockets, smt-last or table [DEFAULT=table].\n"
+			"  -R, --rate <double>\n"
+			"        Operations per second of each thread in the open-loop workload, WORKLOAD=5 [DEFAULT=0].\n"
+			"  -O, --poisson\n"
+			"        Start the open-loop operations as a Poisson process instead of evenly spaced.\n"
 			, argv[0]);
 			exit(0);
 			case 'd':
@@ -343,6 +356,15 @@ int main(int argc, char **argv)
 			case 'm':
 			case 'k':
 			break;
+			case 'P':
+			set_pin_policy(optarg);
+			break;
+			case 'R':
+			open_loop_rate = atof(optarg);
+			break;
+			case 'O':
+			open_loop_poisson = 1;
+			break;
 			case '?':
 			default:
 			printf("Use -h or --help for help\n");
@@ -368,6 +390,7 @@ int main(int argc, char **argv)
 	printf("Initial, %zu \n", initial);
 	printf("Range, %zu \n", range);
 	printf("Algorithm, OPTIK \n");
+	OPEN_LOOP_INIT();
 
 	double kb = initial * sizeof(DS_NODE) / 1024.0;
 	double mb = kb / 1024.0;
@@ -513,7 +536,7 @@ int main(int argc, char **argv)
 		long unsigned put_fal = (putting_count_total - putting_count_total_succ) ? putting_fal_total / (putting_count_total - putting_count_total_succ) : 0;
 		long unsigned rem_suc = removing_count_total_succ ? removing_suc_total / removing_count_total_succ : 0;
 		long unsigned rem_fal = (removing_count_total - removing_count_total_succ) ? removing_fal_total / (removing_count_total - removing_count_total_succ) : 0;
-		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, get_suc, get_fal, put_suc, put_fal, rem_suc, rem_fal);
+		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, 0LU, 0LU, put_suc, put_fal, rem_suc, rem_fal);
 	#endif
 
 	#define LLU long long unsigned int
@@ -554,6 +577,8 @@ int main(int argc, char **argv)
 	RR_PRINT_CORRECTED();
 	RETRY_STATS_PRINT(total, putting_count_total, removing_count_total, putting_count_total_succ + removing_count_total_succ);
 	LATENCY_DISTRIBUTION_PRINT();
+	PERF_COUNTERS_PRINT(putting_count_total + removing_count_total);
+	OPEN_LOOP_PRINT();
 
 	#ifdef RELAXATION_TIMER_ANALYSIS
 		print_relaxation_measurements(num_threads);
@@ -0,0 +1,88 @@
+#ifndef RQ_ADAPTER_H
+#define RQ_ADAPTER_H
+
+#include "relaxed.h"
+
+/*
+ * Binds the DS_* macros of the design included before this header to a registry entry.
+ * The adapter defines rq_new, which maps rq_params_t to the DS_NEW arguments of the design,
+ * and then uses RQ_ADAPTER(symbol, "name"). Define RQ_NO_SIZE if the design has no DS_SIZE.
+ * DS_UNREGISTER and DS_DESTROY are optional, a design without them keeps its memory.
+ *
+ * Everything but rq_ops_<symbol> is made local to the adapter object by the Makefile,
+ * so designs sharing function and variable names can live in the same library.
+ */
+
+static DS_TYPE* rq_new(const rq_params_t* params);
+
+static void* rq_design_create(const rq_params_t* params)
+{
+	return (void*) rq_new(params);
+}
+
+static void* rq_design_register(void* queue, int thread_id)
+{
+	return (void*) DS_REGISTER((DS_TYPE*) queue, thread_id);
+}
+
+static int rq_design_enqueue(void* handle, rq_key_t key, rq_val_t val)
+{
+	return DS_ADD((DS_HANDLE) handle, (skey_t) key, (sval_t) val);
+}
+
+static rq_val_t rq_design_dequeue(void* handle)
+{
+	return (rq_val_t) DS_REMOVE((DS_HANDLE) handle);
+}
+
+#ifdef RQ_NO_SIZE
+#define RQ_DESIGN_SIZE NULL
+#else
+static size_t rq_design_size(void* queue)
+{
+	return (size_t) DS_SIZE((DS_TYPE*) queue);
+}
+#define RQ_DESIGN_SIZE rq_design_size
+#endif
+
+#ifdef DS_UNREGISTER
+static void rq_design_unregister(void* handle)
+{
+	DS_UNREGISTER((DS_HANDLE) handle);
+}
+#define RQ_DESIGN_UNREGISTER rq_design_unregister
+#else
+#define RQ_DESIGN_UNREGISTER NULL
+#endif
+
+#ifdef DS_DESTROY
+static void rq_design_destroy(void* queue)
+{
+	DS_DESTROY((DS_TYPE*) queue);
+}
+#define RQ_DESIGN_DESTROY rq_design_destroy
+#else
+#define RQ_DESIGN_DESTROY NULL
+#endif
+
+// bench-dispatch.c includes an adapter next to the library, where its entry has to stay local
+#ifdef RQ_ADAPTER_LOCAL
+#define RQ_ADAPTER_STORAGE static
+#else
+#define RQ_ADAPTER_STORAGE
+#endif
+
+#define RQ_ADAPTER(symbol, kind)			\
+	RQ_ADAPTER_STORAGE const rq_ops_t rq_ops_##symbol =	\
+	{										\
+		.name = kind,						\
+		.create = rq_design_create,			\
+		.register_thread = rq_design_register,	\
+		.enqueue = rq_design_enqueue,		\
+		.dequeue = rq_design_dequeue,		\
+		.size = RQ_DESIGN_SIZE,				\
+		.unregister = RQ_DESIGN_UNREGISTER,	\
+		.destroy = RQ_DESIGN_DESTROY,		\
+	}
+
+#endif
@@ -0,0 +1,299 @@
+/*
+ * Measures the cost of going through the librelaxed registry, by running the same
+ * 50% enqueue / 50% dequeue workload on one design both through its DS_* macros
+ * (as the per-design benchmarks do) and through rq_enqueue/rq_dequeue.
+ *
+ * The design is picked at compile time with DESIGN=<name>, as the macro-bound run
+ * needs the design code in this translation unit.
+ */
+
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "utils.h"
+#include "barrier.h"
+
+// Keep the registry entry of the included adapter out of the way of the one in the library
+#define RQ_ADAPTER_LOCAL
+#include RQ_BENCH_ADAPTER
+
+// Defined in the library, next to the other thread local variables the designs use
+extern __thread int thread_id;
+
+size_t initial = 1024;
+size_t num_threads = DEFAULT_NB_THREADS;
+size_t duration = DEFAULT_DURATION;
+size_t repeats = 3;
+
+volatile int stop;
+barrier_t bench_barrier, bench_barrier_global;
+
+typedef struct thread_data
+{
+	int id;
+	int dispatch;
+	DS_TYPE* set;
+	rq_t* queue;
+	DS_HANDLE handle;			// The handle of the run, freed once the threads are joined
+	rq_handle_t* rq_handle;
+	uint64_t ops;
+} thread_data_t;
+
+// Identical loops, so that the only difference is how the operations are bound
+#define BENCH_LOOP(handle, add, remove)							\
+	for (i = 0; i < num_elems_thread; i++)						\
+	{															\
+		add(handle, (i << 8 | thread_id) + 1, (i << 8 | thread_id) + 1);	\
+	}															\
+	barrier_cross(&bench_barrier);									\
+	barrier_cross(&bench_barrier_global);								\
+	while (stop == 0)											\
+	{															\
+		if (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) & 1)	\
+		{														\
+			add(handle, (i << 8 | thread_id) + 1, (i << 8 | thread_id) + 1);	\
+			i++;												\
+		}														\
+		else													\
+		{														\
+			remove(handle);										\
+		}														\
+		ops++;													\
+	}
+
+void* test(void* thread)
+{
+	thread_data_t* td = (thread_data_t*) thread;
+	uint64_t i, ops = 0;
+	uint64_t num_elems_thread = initial / num_threads + (td->id < initial % num_threads);
+
+	set_cpu(td->id);
+	seeds = seed_rand();
+
+	if (td->dispatch)
+	{
+		rq_handle_t* handle = rq_register(td->queue, td->id);
+		td->rq_handle = handle;
+		BENCH_LOOP(handle, rq_enqueue, rq_dequeue);
+	}
+	else
+	{
+		thread_id = td->id;
+		DS_HANDLE handle = DS_REGISTER(td->set, td->id);
+		td->handle = handle;
+		BENCH_LOOP(handle, DS_ADD, DS_REMOVE);
+	}
+
+	td->ops = ops;
+	return NULL;
+}
+
+// Returns the throughput in Mops/s
+double run(int dispatch, rq_params_t* params)
+{
+	pthread_t threads[num_threads];
+	thread_data_t tds[num_threads];
+	struct timeval start, end;
+	struct timespec timeout;
+	uint64_t ops = 0;
+	DS_TYPE* set = NULL;
+	rq_t* queue = NULL;
+	size_t t;
+
+	if (dispatch)
+	{
+		queue = rq_create(RQ_BENCH_KIND, params);
+	}
+	else
+	{
+		set = rq_new(params);
+	}
+
+	timeout.tv_sec = duration / 1000;
+	timeout.tv_nsec = (duration % 1000) * 1000000;
+	stop = 0;
+	barrier_init(&bench_barrier_global, num_threads + 1);
+	barrier_init(&bench_barrier, num_threads);
+
+	for (t = 0; t < num_threads; t++)
+	{
+		tds[t].id = t;
+		tds[t].dispatch = dispatch;
+		tds[t].set = set;
+		tds[t].queue = queue;
+		if (pthread_create(&threads[t], NULL, test, tds + t))
+		{
+			perror("pthread_create");
+			exit(1);
+		}
+	}
+
+	barrier_cross(&bench_barrier_global);
+	gettimeofday(&start, NULL);
+	nanosleep(&timeout, NULL);
+	stop = 1;
+	gettimeofday(&end, NULL);
+
+	for (t = 0; t < num_threads; t++)
+	{
+		pthread_join(threads[t], NULL);
+		ops += tds[t].ops;
+	}
+
+	// Free the queue of the repeat, so that the next one doesn't run on a grown heap
+	for (t = 0; t < num_threads; t++)
+	{
+		if (dispatch)
+		{
+			rq_unregister(tds[t].rq_handle);
+		}
+#ifdef DS_UNREGISTER
+		else
+		{
+			DS_UNREGISTER(tds[t].handle);
+		}
+#endif
+	}
+	if (dispatch)
+	{
+		rq_destroy(queue);
+	}
+#ifdef DS_DESTROY
+	else
+	{
+		DS_DESTROY(set);
+	}
+#endif
+
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+	return ops / seconds / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+	rq_params_t params;
+	rq_params_init(&params);
+	set_cpu(0);
+	seeds = seed_rand();
+
+	struct option long_options[] = {
+		{"help",                      no_argument,       NULL, 'h'},
+		{"duration",                  required_argument, NULL, 'd'},
+		{"initial-size",              required_argument, NULL, 'i'},
+		{"num-threads",               required_argument, NULL, 'n'},
+		{"width",                     required_argument, NULL, 'w'},
+		{"choices",                   required_argument, NULL, 'c'},
+		{"depth",                     required_argument, NULL, 'l'},
+		{"relaxation-bound",          required_argument, NULL, 'k'},
+		{"k-mode",                    required_argument, NULL, 'm'},
+		{"repeats",                   required_argument, NULL, 'R'},
+		{"pin",                       required_argument, NULL, 'P'},
+		{NULL, 0, NULL, 0}
+	};
+
+	int i, c;
+	while (1)
+	{
+		i = 0;
+		c = getopt_long(argc, argv, "hd:i:n:w:c:l:k:m:R:P:", long_options, &i);
+		if (c == -1)
+			break;
+		switch (c)
+		{
+			case 'h':
+				printf("librelaxed dispatch overhead for " RQ_BENCH_KIND
+				"\n"
+				"\n"
+				"Usage:\n"
+				"  %s [options...]\n"
+				"\n"
+				"Options:\n"
+				"  -h, --help\n"
+				"        Print this message\n"
+				"  -d, --duration <int>\n"
+				"        Duration of every run in milliseconds\n"
+				"  -i, --initial-size <int>\n"
+				"        Number of elements to insert before every run\n"
+				"  -n, --num-threads <int>\n"
+				"        Number of threads\n"
+				"  -w, --width <int>\n"
+				"        Width (Number of sub-structures)\n"
+				"  -c, --choices <int>\n"
+				"        The number of choices in the d-CBO queues [DEFAULT=2]\n"
+				"  -l, --depth <int>\n"
+				"        Window depth in the 2D queues\n"
+				"  -k, --relaxation-bound <int>\n"
+				"        Relaxation bound in the 2D queues\n"
+				"  -m, --k-mode <int>\n"
+				"        How the 2D queues use the relaxation bound\n"
+				"  -R, --repeats <int>\n"
+				"        Runs per binding, the best one is reported [DEFAULT=3]\n"
+				"  -P, --pin <policy>\n"
+				"        Pin threads from the sysfs topology: compact-cores-first, scatter-sockets, smt-last or table [DEFAULT=table]\n"
+				, argv[0]);
+				exit(0);
+			case 'd':
+				duration = atoi(optarg);
+				break;
+			case 'i':
+				initial = atoi(optarg);
+				break;
+			case 'n':
+				num_threads = atoi(optarg);
+				break;
+			case 'w':
+				params.width = atoi(optarg);
+				break;
+			case 'c':
+				params.choices = atoi(optarg);
+				break;
+			case 'l':
+				params.depth = atoi(optarg);
+				break;
+			case 'k':
+				params.relaxation_bound = atoi(optarg);
+				break;
+			case 'm':
+				params.k_mode = atoi(optarg);
+				break;
+			case 'R':
+				repeats = atoi(optarg);
+				break;
+			case 'P':
+				set_pin_policy(optarg);
+				break;
+			case '?':
+			default:
+				printf("Use -h or --help for help\n");
+				exit(1);
+		}
+	}
+	params.num_threads = num_threads;
+
+	printf("Design , %s\n", RQ_BENCH_KIND);
+	printf("Number of threads , %zu\n", num_threads);
+	printf("Duration (ms) , %zu\n", duration);
+
+	// Alternate the bindings so that both see the same machine state
+	double direct = 0, dispatch = 0;
+	size_t r;
+	for (r = 0; r < repeats; r++)
+	{
+		double mops = run(0, &params);
+		if (mops > direct)
+			direct = mops;
+		mops = run(1, &params);
+		if (mops > dispatch)
+			dispatch = mops;
+	}
+
+	printf("Direct Mops , %.3f\n", direct);
+	printf("Dispatch Mops , %.3f\n", dispatch);
+	printf("Dispatch overhead (ns/op) , %.3f\n", 1e3 * num_threads * (1 / dispatch - 1 / direct));
+
+	return 0;
+}
@@ -0,0 +1,1453 @@
+/*
+ * relaxbench: one benchmark driver for every design of the registry, with the workloads of the
+ * per-design test.c copies behind a runtime option instead of a WORKLOAD build flag.
+ *
+ *   uniform    every thread enqueues with probability -p and otherwise dequeues
+ *   prodcon    -x producer threads only enqueue and the others only dequeue
+ *   over-time  uniform, with the throughput sampled every -T ms
+ *   variable   uniform, with the enqueue probability changed by the phases of -V
+ *   bfs        breadth first search on a .mtx graph, as test-bfs.c
+ *
+ * The results are printed as "key , value" lines like the other benchmarks, or as JSON or CSV
+ * with -F, so that the scripts do not have to scrape the text of every test.c.
+ *
+ * With --sweep, every point of a grid of thread counts, widths and so on is run in the same
+ * process. The threads are started and pinned once, so their SSMEM allocators are only set up
+ * once, and the warmup and measured runs of a point share its queue.
+ */
+
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "utils.h"
+#include "barrier.h"
+#include "graph.h"
+#include "bfs_stats.h"
+#include "latency_histogram.h"
+#include "perf_counters.h"
+#include "relaxed.h"
+
+// Defined in the library, next to the other thread local variables the designs use
+extern __thread unsigned long my_put_cas_fail_count;
+extern __thread unsigned long my_get_cas_fail_count;
+
+#define MAX_THREADS 1024
+#define MAX_PHASES 64
+#define MAX_RESULTS 128
+#define MAX_SWEEP_VALUES 256
+
+typedef enum workload
+{
+	WORKLOAD_UNIFORM,
+	WORKLOAD_PRODCON,
+	WORKLOAD_OVER_TIME,
+	WORKLOAD_VARIABLE,
+	WORKLOAD_BFS,
+} workload_t;
+
+static const char* workload_names[] = { "uniform", "prodcon", "over-time", "variable", "bfs" };
+
+typedef enum format
+{
+	FORMAT_TEXT,
+	FORMAT_JSON,
+	FORMAT_CSV,
+} format_t;
+
+// The latency histograms of every thread, with -H
+enum { LAT_ENQUEUE, LAT_DEQUEUE, LAT_EMPTY, LAT_TYPES };
+
+typedef struct phase
+{
+	uint32_t put_percent;
+	uint64_t duration;			// ms
+} phase_t;
+
+char *kind = "dcbo-faaaq";
+workload_t workload = WORKLOAD_UNIFORM;
+format_t format = FORMAT_TEXT;
+size_t num_threads = DEFAULT_NB_THREADS;
+size_t duration = DEFAULT_DURATION;
+size_t initial = DEFAULT_INITIAL;
+uint32_t put_percent = 50;
+size_t producers_arg = 0;		// 0 is half of the threads
+size_t producers;
+size_t interval = 100;			// ms between the samples of over-time and variable
+phase_t phases[MAX_PHASES];
+size_t num_phases;
+char phases_arg[1024];
+bool record_latency = false;
+
+char *filepath;
+uint64_t root = 1;
+bool directed = false;
+graph_order_t order = GRAPH_ORDER_NONE;
+graph_t *g;
+
+// The parameters --sweep can vary, in the order of the rq_params_t fields after the threads
+typedef enum sweep_param
+{
+	SWEEP_THREADS,
+	SWEEP_WIDTH,
+	SWEEP_CHOICES,
+	SWEEP_DEPTH,
+	SWEEP_PUT,
+	SWEEP_PARAMS,
+} sweep_param_t;
+
+static const char* sweep_names[SWEEP_PARAMS] = { "threads", "width", "choices", "depth", "put" };
+
+typedef struct sweep_axis
+{
+	sweep_param_t param;
+	uint64_t values[MAX_SWEEP_VALUES];
+	size_t num_values;
+} sweep_axis_t;
+
+sweep_axis_t axes[SWEEP_PARAMS];
+size_t num_axes;
+char *sweep_arg;
+size_t warmups = 0;
+size_t repeats = 1;
+
+// The results go to the original stdout, see main
+FILE *out;
+size_t runs_printed;
+double ticks_per_ns;
+
+// The enqueue probability as a fraction of 2^32, changed by the main thread in variable
+volatile uint64_t put_threshold;
+volatile int stop;
+barrier_t barrier, barrier_global;
+
+// The threads of the pool wait here for every run, and the ones beyond num_threads skip it
+volatile int pool_exit;
+barrier_t pool_barrier;
+bool fill_queue;				// Insert the initial items, only in the first run on a queue
+uint64_t expected_size;
+
+typedef enum role
+{
+	ROLE_MIXED,
+	ROLE_PRODUCER,
+	ROLE_CONSUMER,
+} role_t;
+
+// Only written by its own thread, apart from ops which the main thread samples, and the counters
+// the main thread resets between the runs
+typedef struct ALIGNED(CACHE_LINE_SIZE) thread_data
+{
+	int id;
+	role_t role;
+	rq_t* queue;
+	rq_t* registered;			// The queue handle belongs to
+	rq_handle_t* handle;
+	uint64_t next_item;
+	volatile uint64_t ops;
+	uint64_t enqueues;
+	uint64_t failed_enqueues;
+	uint64_t dequeues;
+	uint64_t empty_dequeues;
+	uint64_t put_cas_fails;
+	uint64_t get_cas_fails;
+	uint64_t start_time;
+	uint64_t end_time;
+	lat_hist_t* hist;
+} thread_data_t;
+
+/* ################################################################### *
+ * RESULTS
+ * ################################################################### */
+
+// The results of a run in the order they were added, kept as text so that every format prints
+// them the same way
+typedef enum result_type
+{
+	RESULT_NUMBER,
+	RESULT_STRING,
+	RESULT_NA,					// Not measured, printed as n/a or null
+} result_type_t;
+
+typedef struct result
+{
+	const char* key;
+	char value[1024];
+	result_type_t type;
+} result_t;
+
+// One throughput sample of over-time and variable
+typedef struct sample
+{
+	double time;				// ms since the start, at the end of the sample
+	uint64_t ops;
+	double mops;
+	uint32_t put_percent;
+} sample_t;
+
+result_t results[MAX_RESULTS];
+size_t num_results;
+sample_t *samples;
+size_t num_samples, max_samples;
+
+static result_t* result_add(const char* key, result_type_t type)
+{
+	if (num_results == MAX_RESULTS)
+	{
+		printf("Too many results\n");
+		exit(1);
+	}
+	result_t* r = &results[num_results++];
+	r->key = key;
+	r->type = type;
+	return r;
+}
+
+static void result_str(const char* key, const char* value)
+{
+	snprintf(result_add(key, RESULT_STRING)->value, sizeof(results[0].value), "%s", value);
+}
+
+static void result_na(const char* key)
+{
+	snprintf(result_add(key, RESULT_NA)->value, sizeof(results[0].value), "n/a");
+}
+
+static void result_u64(const char* key, uint64_t value)
+{
+	snprintf(result_add(key, RESULT_NUMBER)->value, sizeof(results[0].value), "%lu", value);
+}
+
+static void result_double(const char* key, double value)
+{
+	snprintf(result_add(key, RESULT_NUMBER)->value, sizeof(results[0].value), "%.3f", value);
+}
+
+static void sample_add(double time, uint64_t ops, double mops, uint32_t percent)
+{
+	if (num_samples == max_samples)
+	{
+		max_samples = max_samples ? 2 * max_samples : 64;
+		if ((samples = (sample_t*) realloc(samples, max_samples * sizeof(sample_t))) == NULL)
+		{
+			perror("realloc");
+			exit(1);
+		}
+	}
+	samples[num_samples++] = (sample_t) { time, ops, mops, percent };
+}
+
+static void print_json_string(const char* s)
+{
+	fputc('"', out);
+	for (; *s; s++)
+	{
+		if (*s == '"' || *s == '\\')
+		{
+			fputc('\\', out);
+		}
+		fputc(*s, out);
+	}
+	fputc('"', out);
+}
+
+// Prints the results of a run, where a sweep prints its runs one after the other: as blocks
+// separated by an empty line, as the objects of the "runs" array, or as rows under one header
+static void print_results()
+{
+	// The objects in "runs" are indented one more level
+	const char* indent = sweep_arg ? "    " : "";
+	size_t r, s;
+	switch (format)
+	{
+		case FORMAT_TEXT:
+			if (runs_printed > 0)
+			{
+				fprintf(out, "\n");
+			}
+			for (r = 0; r < num_results; r++)
+			{
+				fprintf(out, "%s , %s\n", results[r].key, results[r].value);
+			}
+			if (num_samples > 0)
+			{
+				fprintf(out, "#time_ms ops mops put_percent\n");
+			}
+			for (s = 0; s < num_samples; s++)
+			{
+				fprintf(out, "sample , %.1f , %lu , %.3f , %u\n", samples[s].time, samples[s].ops, samples[s].mops,
+					samples[s].put_percent);
+			}
+			break;
+		case FORMAT_JSON:
+			fprintf(out, "%s%s{\n", runs_printed > 0 ? ",\n" : "", indent);
+			for (r = 0; r < num_results; r++)
+			{
+				fprintf(out, "%s  \"%s\": ", indent, results[r].key);
+				if (results[r].type == RESULT_STRING)
+				{
+					print_json_string(results[r].value);
+				}
+				else if (results[r].type == RESULT_NA)
+				{
+					fprintf(out, "null");
+				}
+				else
+				{
+					fprintf(out, "%s", results[r].value);
+				}
+				fprintf(out, ",\n");
+			}
+			fprintf(out, "%s  \"series\": [", indent);
+			for (s = 0; s < num_samples; s++)
+			{
+				fprintf(out, "%s\n%s    {\"time_ms\": %.1f, \"ops\": %lu, \"mops\": %.3f, \"put_percent\": %u}",
+					s ? "," : "", indent, samples[s].time, samples[s].ops, samples[s].mops, samples[s].put_percent);
+			}
+			fprintf(out, "%s%s]\n%s}", num_samples ? "\n  " : "", num_samples ? indent : "", indent);
+			if (sweep_arg == NULL)
+			{
+				fprintf(out, "\n");
+			}
+			break;
+		case FORMAT_CSV:
+			// One row per sample, or a single row, with the results repeated on every row. The
+			// runs of a workload have the same keys, so the header is only printed once.
+			if (runs_printed == 0)
+			{
+				for (r = 0; r < num_results; r++)
+				{
+					fprintf(out, "%s%s", r ? "," : "", results[r].key);
+				}
+				fprintf(out, num_samples ? ",sample_time_ms,sample_ops,sample_mops,sample_put_percent\n" : "\n");
+			}
+			for (s = 0; s == 0 || s < num_samples; s++)
+			{
+				for (r = 0; r < num_results; r++)
+				{
+					// The phases of variable and the sweep are the only values with commas
+					fprintf(out, strchr(results[r].value, ',') ? "%s\"%s\"" : "%s%s", r ? "," : "", results[r].value);
+				}
+				if (num_samples)
+				{
+					fprintf(out, ",%.1f,%lu,%.3f,%u", samples[s].time, samples[s].ops, samples[s].mops, samples[s].put_percent);
+				}
+				fprintf(out, "\n");
+			}
+			break;
+	}
+	fflush(out);
+	runs_printed++;
+	num_results = 0;
+	num_samples = 0;
+}
+
+/* ################################################################### *
+ * WORKLOADS
+ * ################################################################### */
+
+uint64_t get_time()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static inline void bench_enqueue(rq_handle_t* handle, thread_data_t* td, rq_val_t val)
+{
+	ticks start = record_latency ? getticks() : 0;
+	int ok = rq_enqueue(handle, val, val);
+	if (record_latency)
+	{
+		lat_hist_record(&td->hist[LAT_ENQUEUE], (int64_t) (getticks() - start));
+	}
+	if (likely(ok))
+	{
+		td->enqueues++;
+	}
+	else
+	{
+		td->failed_enqueues++;
+	}
+}
+
+static inline void bench_dequeue(rq_handle_t* handle, thread_data_t* td)
+{
+	ticks start = record_latency ? getticks() : 0;
+	rq_val_t val = rq_dequeue(handle);
+	if (record_latency)
+	{
+		lat_hist_record(&td->hist[val == RQ_EMPTY ? LAT_EMPTY : LAT_DEQUEUE], (int64_t) (getticks() - start));
+	}
+	if (val == RQ_EMPTY)
+	{
+		td->empty_dequeues++;
+	}
+	else
+	{
+		td->dequeues++;
+	}
+}
+
+// The enqueue/dequeue workloads, with the items numbered so that they are unique and never RQ_EMPTY
+void run_ops(rq_handle_t* handle, thread_data_t* td)
+{
+	uint64_t seed = wyrand_seed(td->id);
+	uint64_t i = td->next_item, ops = 0;
+	uint64_t num_elems_thread = initial / num_threads + (td->id < initial % num_threads);
+
+	for (; fill_queue && i < num_elems_thread; i++)
+	{
+		if (!rq_enqueue(handle, i * num_threads + td->id + 1, i * num_threads + td->id + 1))
+		{
+			printf("Could not enqueue the initial items, the queue is full\n");
+			exit(1);
+		}
+	}
+	barrier_cross(&barrier);
+	barrier_cross(&barrier_global);
+
+#if defined(PERF_COUNTERS)
+	perf_counters_start(td->id);
+#endif
+	while (stop == 0)
+	{
+		bool put = td->role == ROLE_PRODUCER
+			|| (td->role == ROLE_MIXED && (wyrand(&seed) >> 32) < put_threshold);
+		if (put)
+		{
+			bench_enqueue(handle, td, i * num_threads + td->id + 1);
+			i++;
+		}
+		else
+		{
+			bench_dequeue(handle, td);
+		}
+		td->ops = ++ops;
+	}
+#if defined(PERF_COUNTERS)
+	perf_counters_stop(td->id);
+#endif
+	td->next_item = i;
+}
+
+void run_bfs(rq_handle_t* handle, thread_data_t* td)
+{
+	uint64_t idle_start = 0;
+	int id = td->id;
+
+	if (id == 0)
+	{
+		bfs_added(id);
+		rq_enqueue(handle, 0, root);
+	}
+	barrier_cross(&barrier);
+	barrier_cross(&barrier_global);
+	td->start_time = get_time();
+
+#if defined(PERF_COUNTERS)
+	perf_counters_start(td->id);
+#endif
+	while (1)
+	{
+		rq_val_t current = rq_dequeue(handle);
+		if (current == RQ_EMPTY)
+		{
+			// The counters of every thread are only read when out of items
+			td->empty_dequeues++;
+			if (idle_start == 0) idle_start = get_time();
+			if (bfs_terminated()) break;
+			continue;
+		}
+		td->dequeues++;
+		if (idle_start != 0)
+		{
+			bfs_idle(id, get_time() - idle_start);
+			idle_start = 0;
+		}
+
+		uint64_t *neighbors;
+		uint64_t size = get_neighbors(g, current, &neighbors);
+		uint64_t distance = g->distances[current];
+		uint64_t next_distance = distance + 1;
+		bfs_expanded(id, distance);
+
+		for (uint64_t n = 0; n < size; n++)
+		{
+			uint64_t neighbor = neighbors[n];
+			uint64_t old_distance = g->distances[neighbor];
+			while (next_distance < old_distance)
+			{
+				if (likely(CAE(&g->distances[neighbor], &old_distance, &next_distance)))
+				{
+					bfs_added(id);
+					rq_enqueue(handle, next_distance, neighbor);
+					td->enqueues++;
+					break;
+				}
+			}
+		}
+		bfs_processed(id);
+	}
+#if defined(PERF_COUNTERS)
+	perf_counters_stop(td->id);
+#endif
+
+	// The run ends when the last item was processed, which this thread has just seen
+	td->end_time = get_time();
+	bfs_idle(id, td->end_time - idle_start);
+}
+
+void test(thread_data_t* td)
+{
+	my_put_cas_fail_count = 0;
+	my_get_cas_fail_count = 0;
+
+	// A thread only registers once to every queue, as the handle keeps its state between the runs
+	if (td->registered != td->queue)
+	{
+		td->handle = rq_register(td->queue, td->id);
+		td->registered = td->queue;
+	}
+	if (workload == WORKLOAD_BFS)
+	{
+		run_bfs(td->handle, td);
+	}
+	else
+	{
+		run_ops(td->handle, td);
+	}
+
+	td->put_cas_fails = my_put_cas_fail_count;
+	td->get_cas_fails = my_get_cas_fail_count;
+}
+
+// The threads live for the whole sweep, pinned once, and run every run they are part of
+void* pool_thread(void* thread)
+{
+	thread_data_t* td = (thread_data_t*) thread;
+
+	set_cpu(td->id);
+	if (record_latency)
+	{
+		td->hist = lat_hist_new(LAT_TYPES);
+	}
+
+	while (1)
+	{
+		barrier_cross(&pool_barrier);
+		if (pool_exit)
+		{
+			break;
+		}
+		if ((size_t) td->id < num_threads)
+		{
+			test(td);
+		}
+		barrier_cross(&pool_barrier);
+	}
+
+	free(td->hist);
+	return NULL;
+}
+
+static uint64_t threshold(uint32_t percent)
+{
+	return ((uint64_t) percent << 32) / 100;
+}
+
+// Sleeps until the end of the run, while sampling the throughput and switching the phases of
+// variable. The phases are switched at their exact time, and a sample is labelled with the
+// enqueue percentage at its end.
+static void sample_run(thread_data_t* tds, uint64_t start)
+{
+	uint64_t end = start + duration * 1000000;
+	uint64_t next_sample = start + interval * 1000000;
+	uint64_t phase_end = end;
+	uint64_t last_time = start, last_ops = 0;
+	size_t phase = 0;
+	uint32_t percent = put_percent;
+
+	if (workload == WORKLOAD_VARIABLE)
+	{
+		percent = phases[0].put_percent;
+		phase_end = start + phases[0].duration * 1000000;
+	}
+
+	while (1)
+	{
+		uint64_t wake = next_sample < phase_end ? next_sample : phase_end;
+		if (wake > end) wake = end;
+		uint64_t now = get_time();
+		if (wake > now)
+		{
+			struct timespec timeout = { (wake - now) / 1000000000, (wake - now) % 1000000000 };
+			nanosleep(&timeout, NULL);
+		}
+		now = get_time();
+
+		if (now >= next_sample || now >= end)
+		{
+			uint64_t ops = 0;
+			for (size_t t = 0; t < num_threads; t++)
+			{
+				ops += tds[t].ops;
+			}
+			sample_add((now - start) / 1e6, ops - last_ops, (double) (ops - last_ops) * 1000 / (now - last_time), percent);
+			last_ops = ops;
+			last_time = now;
+			while (next_sample <= now) next_sample += interval * 1000000;
+		}
+		if (now >= end)
+		{
+			return;
+		}
+		if (workload == WORKLOAD_VARIABLE && now >= phase_end && phase + 1 < num_phases)
+		{
+			phase++;
+			percent = phases[phase].put_percent;
+			put_threshold = threshold(percent);
+			phase_end += phases[phase].duration * 1000000;
+		}
+	}
+}
+
+/* ################################################################### *
+ * REPORTING
+ * ################################################################### */
+
+static void report_latencies(thread_data_t* tds)
+{
+	static const char* keys[LAT_TYPES][5] =
+	{
+		{ "enqueue_p50_ns", "enqueue_p90_ns", "enqueue_p99_ns", "enqueue_p999_ns", "enqueue_max_ns" },
+		{ "dequeue_p50_ns", "dequeue_p90_ns", "dequeue_p99_ns", "dequeue_p999_ns", "dequeue_max_ns" },
+		{ "empty_dequeue_p50_ns", "empty_dequeue_p90_ns", "empty_dequeue_p99_ns", "empty_dequeue_p999_ns", "empty_dequeue_max_ns" },
+	};
+	static const double quantiles[4] = { 0.5, 0.9, 0.99, 0.999 };
+
+	for (int l = 0; l < LAT_TYPES; l++)
+	{
+		lat_hist_t* merged = lat_hist_new(1);
+		for (size_t t = 0; t < num_threads; t++)
+		{
+			lat_hist_merge(merged, &tds[t].hist[l]);
+		}
+		if (merged->count > 0)
+		{
+			for (int q = 0; q < 4; q++)
+			{
+				result_double(keys[l][q], lat_hist_percentile(merged, quantiles[q]) / ticks_per_ns);
+			}
+			result_double(keys[l][4], merged->max / ticks_per_ns);
+		}
+		else
+		{
+			// Every run has the same keys, which CSV needs
+			for (int q = 0; q < 5; q++)
+			{
+				result_na(keys[l][q]);
+			}
+		}
+		free(merged);
+	}
+}
+
+#if defined(PERF_COUNTERS)
+static void report_perf_counters(uint64_t ops)
+{
+	static const char* per_op_keys[PERF_NUM_EVENTS] =
+	{
+		"Cycles_per_op", "Instructions_per_op", "LLC_misses_per_op", "Remote_node_misses_per_op", "HITM_per_op"
+	};
+	int64_t sums[PERF_NUM_EVENTS];
+	perf_counters_sum(num_threads, sums);
+	for (int e = 0; e < PERF_NUM_EVENTS; e++)
+	{
+		if (sums[e] < 0)
+		{
+			result_na(perf_events[e].name);
+			continue;
+		}
+		result_u64(perf_events[e].name, sums[e]);
+		if (ops > 0)
+		{
+			result_double(per_op_keys[e], (double) sums[e] / ops);
+		}
+	}
+}
+#endif
+
+static void report_ops(rq_t* queue, thread_data_t* tds, uint64_t elapsed)
+{
+	uint64_t enqueues = 0, failed_enqueues = 0, dequeues = 0, empty_dequeues = 0;
+	uint64_t put_cas_fails = 0, get_cas_fails = 0;
+	for (size_t t = 0; t < num_threads; t++)
+	{
+		enqueues += tds[t].enqueues;
+		failed_enqueues += tds[t].failed_enqueues;
+		dequeues += tds[t].dequeues;
+		empty_dequeues += tds[t].empty_dequeues;
+		put_cas_fails += tds[t].put_cas_fails;
+		get_cas_fails += tds[t].get_cas_fails;
+	}
+	uint64_t ops = enqueues + failed_enqueues + dequeues + empty_dequeues;
+
+	result_double("duration_ms", elapsed / 1e6);
+	result_u64("enqueues", enqueues);
+	result_u64("failed_enqueues", failed_enqueues);
+	result_u64("dequeues", dequeues);
+	result_u64("empty_dequeues", empty_dequeues);
+	// Mops counts the operations which changed the queue, as the per-design tests do
+	result_double("Mops", (double) (enqueues + dequeues) * 1000 / elapsed);
+	result_double("Mops_all", (double) ops * 1000 / elapsed);
+	result_u64("Push_CAS_fails", put_cas_fails);
+	result_u64("Pop_CAS_fails", get_cas_fails);
+
+	// The items left by the earlier runs on the queue are still there
+	expected_size += enqueues - dequeues;
+	if (queue->ops->size != NULL)
+	{
+		size_t size = rq_size(queue);
+		result_u64("size", size);
+		if (size != expected_size)
+		{
+			fprintf(stderr, "WRONG size %zu, expected %lu\n", size, expected_size);
+			expected_size = size;
+		}
+	}
+
+	if (record_latency)
+	{
+		report_latencies(tds);
+	}
+#if defined(PERF_COUNTERS)
+	report_perf_counters(ops);
+#endif
+}
+
+static void report_bfs(thread_data_t* tds)
+{
+	uint64_t min_start = tds[0].start_time, max_end = tds[0].end_time;
+	uint64_t dequeues = 0, empty_dequeues = 0;
+	for (size_t t = 0; t < num_threads; t++)
+	{
+		if (tds[t].start_time < min_start) min_start = tds[t].start_time;
+		if (tds[t].end_time > max_end) max_end = tds[t].end_time;
+		dequeues += tds[t].dequeues;
+		empty_dequeues += tds[t].empty_dequeues;
+	}
+
+	uint64_t distances = 0, visited = 0, expansions = 0, idle_time = 0;
+	for (uint64_t v = 1; v <= g->n_verticies; v++)
+	{
+		if (g->distances[v] != UINT64_MAX)
+		{
+			visited++;
+			distances += g->distances[v];
+		}
+	}
+	for (size_t t = 0; t < num_threads; t++)
+	{
+		for (uint64_t l = 0; l < bfs_levels[t].n_levels; l++)
+		{
+			expansions += bfs_levels[t].expansions[l];
+		}
+		idle_time += bfs_levels[t].idle_time;
+	}
+
+	result_double("elapsed_time", ((double) max_end - min_start) / 1000000);
+	result_double("average_distance", (double) distances / visited);
+	result_u64("vertices_visited", visited);
+	result_u64("expanded_vertices", expansions);
+	result_u64("re_expanded_vertices", expansions - visited);
+	result_u64("empty_dequeues", empty_dequeues);
+	result_double("idle_time_avg", (double) idle_time / num_threads / 1000000);
+#if defined(PERF_COUNTERS)
+	report_perf_counters(dequeues);
+#endif
+}
+
+// bfs_stats_init allocates the counters of a single search, so they are released between the runs
+static void bfs_stats_free()
+{
+	if (bfs_counters == NULL)
+	{
+		return;
+	}
+	for (size_t t = 0; t < bfs_threads; t++)
+	{
+		free(bfs_levels[t].expansions);
+	}
+	free(bfs_counters);
+	free(bfs_levels);
+}
+
+// Runs the workload once on queue with the threads of the pool, and collects its results unless
+// it is a warmup run
+void run(rq_t* queue, rq_params_t* params, thread_data_t* tds, size_t point, size_t repeat, bool warmup)
+{
+	size_t t;
+
+	stop = 0;
+	put_threshold = threshold(workload == WORKLOAD_VARIABLE ? phases[0].put_percent : put_percent);
+	barrier_init(&barrier_global, num_threads + 1);
+	barrier_init(&barrier, num_threads);
+	if (workload == WORKLOAD_BFS)
+	{
+		bfs_stats_free();
+		bfs_stats_init(num_threads);
+		for (uint64_t v = 1; v <= g->n_verticies; v++)
+		{
+			g->distances[v] = UINT64_MAX;
+		}
+		g->distances[root] = 0;
+	}
+
+	for (t = 0; t < num_threads; t++)
+	{
+		tds[t].queue = queue;
+		tds[t].role = ROLE_MIXED;
+		if (workload == WORKLOAD_PRODCON)
+		{
+			tds[t].role = t < producers ? ROLE_PRODUCER : ROLE_CONSUMER;
+		}
+		tds[t].ops = 0;
+		tds[t].enqueues = 0;
+		tds[t].failed_enqueues = 0;
+		tds[t].dequeues = 0;
+		tds[t].empty_dequeues = 0;
+		if (tds[t].hist != NULL)
+		{
+			memset(tds[t].hist, 0, LAT_TYPES * sizeof(lat_hist_t));
+		}
+	}
+
+	// Releases the pool into the run, whose threads then wait for the start like in the tests
+	barrier_cross(&pool_barrier);
+	barrier_cross(&barrier_global);
+	uint64_t start = get_time();
+	if (workload == WORKLOAD_OVER_TIME || workload == WORKLOAD_VARIABLE)
+	{
+		sample_run(tds, start);
+	}
+	else if (workload != WORKLOAD_BFS)
+	{
+		struct timespec timeout = { duration / 1000, (duration % 1000) * 1000000 };
+		nanosleep(&timeout, NULL);
+	}
+	stop = 1;
+	uint64_t elapsed = get_time() - start;
+	barrier_cross(&pool_barrier);
+	fill_queue = false;
+
+	if (warmup)
+	{
+		if (workload != WORKLOAD_BFS)
+		{
+			uint64_t enqueues = 0, dequeues = 0;
+			for (t = 0; t < num_threads; t++)
+			{
+				enqueues += tds[t].enqueues;
+				dequeues += tds[t].dequeues;
+			}
+			expected_size += enqueues - dequeues;
+		}
+		num_samples = 0;
+		return;
+	}
+
+	result_str("design", kind);
+	result_str("workload", workload_names[workload]);
+	if (sweep_arg != NULL)
+	{
+		result_u64("point", point);
+		result_u64("repeat", repeat);
+	}
+	result_u64("num_threads", num_threads);
+	result_u64("width", params->width);
+	result_u64("choices", params->choices);
+	result_u64("depth", params->depth);
+	if (workload == WORKLOAD_BFS)
+	{
+		report_bfs(tds);
+	}
+	else
+	{
+		result_u64("initial", initial);
+		if (workload == WORKLOAD_VARIABLE)
+		{
+			result_str("phases", phases_arg);
+		}
+		else if (workload != WORKLOAD_PRODCON)
+		{
+			result_u64("put_percent", put_percent);
+		}
+		if (workload == WORKLOAD_PRODCON)
+		{
+			result_u64("producers", producers);
+		}
+		report_ops(queue, tds, elapsed);
+	}
+	print_results();
+}
+
+// Runs the warmups and the repeats of one point on a new queue. The queue and the handles are
+// reused by all runs of the point, and freed afterwards.
+void run_point(rq_params_t* params, thread_data_t* tds, size_t point)
+{
+	params->num_threads = num_threads;
+	rq_t* queue = rq_create(kind, params);
+	if (queue == NULL)
+	{
+		printf("Unknown design %s, the designs are:", kind);
+		for (size_t k = 0; rq_kind(k) != NULL; k++)
+		{
+			printf(" %s", rq_kind(k));
+		}
+		printf("\n");
+		exit(1);
+	}
+
+	fill_queue = true;
+	expected_size = workload == WORKLOAD_BFS ? 0 : initial;
+	for (size_t t = 0; t < num_threads; t++)
+	{
+		tds[t].next_item = 0;
+	}
+	for (size_t w = 0; w < warmups; w++)
+	{
+		run(queue, params, tds, point, w, true);
+	}
+	for (size_t r = 0; r < repeats; r++)
+	{
+		run(queue, params, tds, point, r, false);
+	}
+
+	// The next queue may be allocated at the same address, so the threads have to register again
+	for (size_t t = 0; t < num_threads; t++)
+	{
+		if (tds[t].registered == queue)
+		{
+			rq_unregister(tds[t].handle);
+			tds[t].registered = NULL;
+			tds[t].handle = NULL;
+		}
+	}
+	rq_destroy(queue);
+}
+
+/* ################################################################### *
+ * OPTIONS
+ * ################################################################### */
+
+static workload_t parse_workload(const char* name)
+{
+	for (size_t w = 0; w < sizeof(workload_names) / sizeof(workload_names[0]); w++)
+	{
+		if (strcmp(name, workload_names[w]) == 0)
+		{
+			return (workload_t) w;
+		}
+	}
+	printf("Unknown workload %s, the workloads are uniform, prodcon, over-time, variable and bfs\n", name);
+	exit(1);
+}
+
+static format_t parse_format(const char* name)
+{
+	if (strcmp(name, "text") == 0) return FORMAT_TEXT;
+	if (strcmp(name, "json") == 0) return FORMAT_JSON;
+	if (strcmp(name, "csv") == 0) return FORMAT_CSV;
+	printf("Unknown format %s, the formats are text, json and csv\n", name);
+	exit(1);
+}
+
+// Parses the phases of variable, as put_percent:ms separated by commas
+static void parse_phases(char* arg)
+{
+	char* saveptr;
+	char* phase;
+	num_phases = 0;
+	snprintf(phases_arg, sizeof(phases_arg), "%s", arg);
+	for (phase = strtok_r(arg, ",", &saveptr); phase != NULL; phase = strtok_r(NULL, ",", &saveptr))
+	{
+		unsigned percent;
+		unsigned long ms;
+		if (num_phases == MAX_PHASES || sscanf(phase, "%u:%lu", &percent, &ms) != 2 || percent > 100 || ms == 0)
+		{
+			printf("Invalid phase %s, the phases are put_percent:ms separated by commas, at most %d\n", phase, MAX_PHASES);
+			exit(1);
+		}
+		phases[num_phases++] = (phase_t) { percent, ms };
+	}
+}
+
+static uint64_t parse_sweep_number(const char* value, const char* token)
+{
+	char* end;
+	uint64_t v = strtoull(value, &end, 10);
+	if (end == value || (*end != '\0' && *end != '.' && *end != ':'))
+	{
+		printf("Invalid sweep value %s\n", token);
+		exit(1);
+	}
+	return v;
+}
+
+static void sweep_add(sweep_axis_t* axis, uint64_t value)
+{
+	if (axis->num_values == MAX_SWEEP_VALUES)
+	{
+		printf("At most %d values can be swept for %s\n", MAX_SWEEP_VALUES, sweep_names[axis->param]);
+		exit(1);
+	}
+	axis->values[axis->num_values++] = value;
+}
+
+// Parses the grid of --sweep, as name=values separated by commas, where the values are numbers,
+// a..b for every number from a to b, a..b:s for steps of s or a..b:xf to multiply by f. The
+// values up to the next name= belong to the same parameter, e.g. threads=1..64:x2,width=8,16
+static void parse_sweep(char* arg)
+{
+	char* saveptr;
+	char* token;
+	sweep_axis_t* axis = NULL;
+	sweep_arg = strdup(arg);
+	for (token = strtok_r(arg, ",", &saveptr); token != NULL; token = strtok_r(NULL, ",", &saveptr))
+	{
+		char* value = token;
+		char* equals = strchr(token, '=');
+		if (equals != NULL)
+		{
+			*equals = '\0';
+			value = equals + 1;
+			int param;
+			for (param = 0; param < SWEEP_PARAMS && strcmp(token, sweep_names[param]) != 0; param++);
+			if (param == SWEEP_PARAMS)
+			{
+				printf("Unknown sweep parameter %s, the parameters are threads, width, choices, depth and put\n", token);
+				exit(1);
+			}
+			for (size_t a = 0; a < num_axes; a++)
+			{
+				if (axes[a].param == (sweep_param_t) param)
+				{
+					printf("The sweep parameter %s is given twice\n", token);
+					exit(1);
+				}
+			}
+			axis = &axes[num_axes++];
+			axis->param = (sweep_param_t) param;
+			axis->num_values = 0;
+		}
+		if (axis == NULL)
+		{
+			printf("The sweep has to start with a parameter, as in threads=1..8\n");
+			exit(1);
+		}
+
+		uint64_t from = parse_sweep_number(value, token);
+		char* range = strstr(value, "..");
+		if (range == NULL)
+		{
+			sweep_add(axis, from);
+			continue;
+		}
+		uint64_t to = parse_sweep_number(range + 2, token);
+		char* step = strchr(range + 2, ':');
+		bool multiply = step != NULL && step[1] == 'x';
+		uint64_t by = step == NULL ? 1 : parse_sweep_number(step + 1 + multiply, token);
+		if (from > to || by == 0 || (multiply && (by < 2 || from == 0)))
+		{
+			printf("Invalid sweep range %s\n", value);
+			exit(1);
+		}
+		for (uint64_t v = from; v <= to; v = multiply ? v * by : v + by)
+		{
+			sweep_add(axis, v);
+		}
+	}
+}
+
+static void set_sweep_param(rq_params_t* params, sweep_param_t param, uint64_t value)
+{
+	switch (param)
+	{
+		case SWEEP_THREADS: num_threads = value; break;
+		case SWEEP_WIDTH: params->width = value; break;
+		case SWEEP_CHOICES: params->choices = value; break;
+		case SWEEP_DEPTH: params->depth = value; break;
+		case SWEEP_PUT: put_percent = value; break;
+		case SWEEP_PARAMS: break;
+	}
+}
+
+// Moves to the next point of the grid, with the last parameter varying fastest, and returns
+// false after the last point
+static bool next_point(size_t* index)
+{
+	for (size_t a = num_axes; a > 0; a--)
+	{
+		if (++index[a - 1] < axes[a - 1].num_values)
+		{
+			return true;
+		}
+		index[a - 1] = 0;
+	}
+	return false;
+}
+
+// Checks the options which a point of the sweep can change
+static void check_point(size_t pool_size)
+{
+	if (num_threads == 0 || num_threads > pool_size)
+	{
+		printf("The number of threads has to be between 1 and %d\n", MAX_THREADS);
+		exit(1);
+	}
+	if (put_percent > 100)
+	{
+		printf("The percentage of enqueues has to be at most 100\n");
+		exit(1);
+	}
+	if (workload == WORKLOAD_PRODCON)
+	{
+		producers = producers_arg ? producers_arg : num_threads / 2;
+		if (producers == 0 || producers >= num_threads)
+		{
+			printf("prodcon needs at least one producer and one consumer thread\n");
+			exit(1);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	rq_params_t params;
+	rq_params_init(&params);
+	long warmups_arg = -1;
+	set_cpu(0);
+	seeds = seed_rand();
+
+	struct option long_options[] = {
+		{"help",                      no_argument,       NULL, 'h'},
+		{"design",                    required_argument, NULL, 'q'},
+		{"workload",                  required_argument, NULL, 'W'},
+		{"num-threads",               required_argument, NULL, 'n'},
+		{"duration",                  required_argument, NULL, 'd'},
+		{"initial-size",              required_argument, NULL, 'i'},
+		{"put",                       required_argument, NULL, 'p'},
+		{"producers",                 required_argument, NULL, 'x'},
+		{"interval",                  required_argument, NULL, 'T'},
+		{"phases",                    required_argument, NULL, 'V'},
+		{"width",                     required_argument, NULL, 'w'},
+		{"choices",                   required_argument, NULL, 'c'},
+		{"depth",                     required_argument, NULL, 'l'},
+		{"relaxation-bound",          required_argument, NULL, 'k'},
+		{"k-mode",                    required_argument, NULL, 'm'},
+		{"filepath",                  required_argument, NULL, 'f'},
+		{"root",                      required_argument, NULL, 'r'},
+		{"directed",                  no_argument,       NULL, 'D'},
+		{"order",                     required_argument, NULL, 'o'},
+		{"latency",                   no_argument,       NULL, 'H'},
+		{"format",                    required_argument, NULL, 'F'},
+		{"pin",                       required_argument, NULL, 'P'},
+		{"sweep",                     required_argument, NULL, 'S'},
+		{"warmups",                   required_argument, NULL, 'u'},
+		{"repeats",                   required_argument, NULL, 'R'},
+		{NULL, 0, NULL, 0}
+	};
+
+	int i, c;
+	while (1)
+	{
+		i = 0;
+		c = getopt_long(argc, argv, "hq:W:n:d:i:p:x:T:V:w:c:l:k:m:f:r:Do:HF:P:S:u:R:", long_options, &i);
+		if (c == -1)
+			break;
+		switch (c)
+		{
+			case 'h':
+				printf("relaxbench, the workloads of the tests on any librelaxed design"
+				"\n"
+				"\n"
+				"Usage:\n"
+				"  %s [options...]\n"
+				"\n"
+				"Options:\n"
+				"  -h, --help\n"
+				"        Print this message\n"
+				"  -q, --design <name>\n"
+				"        The queue to use, one of the librelaxed designs [DEFAULT=dcbo-faaaq]\n"
+				"  -W, --workload <name>\n"
+				"        uniform, prodcon, over-time, variable or bfs [DEFAULT=uniform]\n"
+				"  -n, --num-threads <int>\n"
+				"        Number of threads\n"
+				"  -d, --duration <int>\n"
+				"        Test duration in milliseconds, not used by bfs and variable\n"
+				"  -i, --initial-size <int>\n"
+				"        Number of elements to insert before the test\n"
+				"  -p, --put <int>\n"
+				"        Percentage of enqueues in uniform and over-time [DEFAULT=50]\n"
+				"  -x, --producers <int>\n"
+				"        Threads which only enqueue in prodcon, the others only dequeue [DEFAULT=half]\n"
+				"  -T, --interval <int>\n"
+				"        Milliseconds between the throughput samples of over-time and variable [DEFAULT=100]\n"
+				"  -V, --phases <put:ms,...>\n"
+				"        The phases of variable, as the percentage of enqueues and the duration of each\n"
+				"  -w, --width <int>\n"
+				"        Width (Number of sub-structures)\n"
+				"  -c, --choices <int>\n"
+				"        The number of choices in the d-CBO queues and the MultiQueue [DEFAULT=2]\n"
+				"  -l, --depth <int>\n"
+				"        Window depth in the 2D queues\n"
+				"  -k, --relaxation-bound <int>\n"
+				"        Relaxation bound in the 2D queues\n"
+				"  -m, --k-mode <int>\n"
+				"        How the 2D queues use the relaxation bound\n"
+				"  -f, --filepath <str>\n"
+				"        The filepath to the .mtx file of bfs\n"
+				"  -r, --root <int>\n"
+				"        The source vertex of bfs [DEFAULT=1]\n"
+				"  -D, --directed\n"
+				"        Parses the graph as directed [DEFAULT=false]\n"
+				"  -o, --order <str>\n"
+				"        Renumber the vertices for locality: none, bfs or rcm (reverse Cuthill-McKee) [DEFAULT=none]\n"
+				"  -H, --latency\n"
+				"        Record the latency percentiles of enqueues, dequeues and empty dequeues\n"
+				"  -F, --format <name>\n"
+				"        Print the results as text, json or csv [DEFAULT=text]\n"
+				"  -P, --pin <policy>\n"
+				"        Pin threads from the sysfs topology: compact-cores-first, scatter-sockets, smt-last or table [DEFAULT=table]\n"
+				"  -S, --sweep <param=values,...>\n"
+				"        Run every point of a grid in this process, over threads, width, choices, depth and put,\n"
+				"        with values as 4, 1..8 (step 1), 2..64:2 (step 2) or 1..256:x2 (doubling)\n"
+				"  -u, --warmups <int>\n"
+				"        Unreported runs before the measured ones [DEFAULT=1 with --sweep, otherwise 0]\n"
+				"  -R, --repeats <int>\n"
+				"        Measured runs of every point [DEFAULT=1]\n"
+				, argv[0]);
+				exit(0);
+			case 'q':
+				kind = optarg;
+				break;
+			case 'W':
+				workload = parse_workload(optarg);
+				break;
+			case 'n':
+				num_threads = atoi(optarg);
+				break;
+			case 'd':
+				duration = atoi(optarg);
+				break;
+			case 'i':
+				initial = atoi(optarg);
+				break;
+			case 'p':
+				put_percent = atoi(optarg);
+				break;
+			case 'x':
+				producers_arg = atoi(optarg);
+				break;
+			case 'T':
+				interval = atoi(optarg);
+				break;
+			case 'V':
+				parse_phases(optarg);
+				break;
+			case 'w':
+				params.width = atoi(optarg);
+				break;
+			case 'c':
+				params.choices = atoi(optarg);
+				break;
+			case 'l':
+				params.depth = atoi(optarg);
+				break;
+			case 'k':
+				params.relaxation_bound = atoi(optarg);
+				break;
+			case 'm':
+				params.k_mode = atoi(optarg);
+				break;
+			case 'f':
+				filepath = optarg;
+				break;
+			case 'r':
+				root = atol(optarg);
+				break;
+			case 'D':
+				directed = true;
+				break;
+			case 'o':
+				order = parse_graph_order(optarg);
+				break;
+			case 'H':
+				record_latency = true;
+				break;
+			case 'F':
+				format = parse_format(optarg);
+				break;
+			case 'P':
+				set_pin_policy(optarg);
+				break;
+			case 'S':
+				parse_sweep(optarg);
+				break;
+			case 'u':
+				warmups_arg = atoi(optarg);
+				break;
+			case 'R':
+				repeats = atoi(optarg);
+				break;
+			case '?':
+			default:
+				printf("Use -h or --help for help\n");
+				exit(1);
+		}
+	}
+	warmups = warmups_arg >= 0 ? (size_t) warmups_arg : sweep_arg != NULL;
+
+	// The pool has a thread for the largest point
+	size_t pool_size = num_threads;
+	size_t a, v;
+	for (a = 0; a < num_axes; a++)
+	{
+		if (axes[a].param == SWEEP_THREADS)
+		{
+			for (pool_size = 0, v = 0; v < axes[a].num_values; v++)
+			{
+				if (axes[a].values[v] > pool_size) pool_size = axes[a].values[v];
+			}
+		}
+	}
+	if (pool_size == 0 || pool_size > MAX_THREADS)
+	{
+		printf("The number of threads has to be between 1 and %d\n", MAX_THREADS);
+		exit(1);
+	}
+	if (repeats == 0)
+	{
+		printf("At least one run has to be measured\n");
+		exit(1);
+	}
+	if (interval == 0)
+	{
+		printf("The sample interval has to be at least 1 ms\n");
+		exit(1);
+	}
+	if (workload == WORKLOAD_VARIABLE)
+	{
+		if (num_phases == 0)
+		{
+			printf("variable needs its phases, given with -V\n");
+			exit(1);
+		}
+		duration = 0;
+		for (size_t p = 0; p < num_phases; p++)
+		{
+			duration += phases[p].duration;
+		}
+	}
+	if (workload == WORKLOAD_BFS)
+	{
+		if (filepath == NULL)
+		{
+			printf("bfs needs a graph, given with -f\n");
+			exit(1);
+		}
+		if (record_latency)
+		{
+			printf("The latencies are only recorded by the enqueue/dequeue workloads\n");
+			exit(1);
+		}
+	}
+
+	// SSMEM and the graph loader print their progress on stdout, which would break the JSON and
+	// CSV output, so everything but the results goes to stderr
+	fflush(stdout);
+	if ((out = fdopen(dup(STDOUT_FILENO), "w")) == NULL)
+	{
+		perror("fdopen");
+		exit(1);
+	}
+	dup2(STDERR_FILENO, STDOUT_FILENO);
+
+	if (workload == WORKLOAD_BFS)
+	{
+		g = parse_mtx_file(filepath, directed, 64, order);
+		if (root == 0 || root > g->n_verticies)
+		{
+			printf("The root %lu is not a vertex of the graph\n", root);
+			exit(1);
+		}
+		root = graph_vertex(g, root);
+	}
+	if (record_latency)
+	{
+		ticks_per_ns = lat_hist_ticks_per_ns();
+	}
+
+	pthread_t threads[pool_size];
+	thread_data_t tds[pool_size];
+	barrier_init(&pool_barrier, pool_size + 1);
+	for (size_t t = 0; t < pool_size; t++)
+	{
+		memset(&tds[t], 0, sizeof(thread_data_t));
+		tds[t].id = t;
+		if (pthread_create(&threads[t], NULL, pool_thread, tds + t))
+		{
+			perror("pthread_create");
+			exit(1);
+		}
+	}
+
+	if (sweep_arg != NULL && format == FORMAT_JSON)
+	{
+		fprintf(out, "{\n  \"sweep\": ");
+		print_json_string(sweep_arg);
+		fprintf(out, ",\n  \"warmups\": %zu,\n  \"repeats\": %zu,\n  \"runs\": [\n", warmups, repeats);
+	}
+
+	size_t index[SWEEP_PARAMS] = { 0 };
+	size_t point = 0;
+	do
+	{
+		for (a = 0; a < num_axes; a++)
+		{
+			set_sweep_param(&params, axes[a].param, axes[a].values[index[a]]);
+		}
+		check_point(pool_size);
+		if (sweep_arg != NULL)
+		{
+			fprintf(stderr, "point %zu:", point);
+			for (a = 0; a < num_axes; a++)
+			{
+				fprintf(stderr, " %s=%lu", sweep_names[axes[a].param], axes[a].values[index[a]]);
+			}
+			fprintf(stderr, "\n");
+		}
+		run_point(&params, tds, point++);
+	}
+	while (next_point(index));
+
+	if (sweep_arg != NULL && format == FORMAT_JSON)
+	{
+		fprintf(out, "\n  ]\n}\n");
+	}
+	fclose(out);
+
+	pool_exit = 1;
+	barrier_cross(&pool_barrier);
+	for (size_t t = 0; t < pool_size; t++)
+	{
+		pthread_join(threads[t], NULL);
+	}
+	return 0;
+}
@@ -0,0 +1,493 @@
+/*
+ * Single-source shortest paths on a weighted .mtx graph (see graph.h) with any design of the
+ * registry. The threads run a relaxed Dijkstra: they pop a vertex, expand it if its distance
+ * improved since it was last expanded, and push every neighbor they find a shorter path to,
+ * keyed by its distance divided by the bucket width (delta-stepping). FIFO designs ignore the
+ * key, so they run a chaotic Bellman-Ford, while the priority queues approximate Dijkstra.
+ *
+ * The search ends when every pushed vertex has been popped and expanded, as detected with the
+ * counters of bfs_stats.h. The distances are checked against a sequential Dijkstra, and the wasted
+ * work is reported as the vertices expanded more than once (re-settled) and the pops of already
+ * expanded vertices, along with the time every thread spent without items.
+ */
+
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "common.h"
+#include "utils.h"
+#include "barrier.h"
+#include "graph.h"
+#include "bfs_stats.h"
+#include "relaxed.h"
+
+char *filepath;
+char *kind = "dcbo-faaaq";
+uint64_t root = 1;
+uint64_t delta = 1;
+bool directed = false;
+graph_order_t order = GRAPH_ORDER_NONE;
+bool check = true;
+size_t num_threads = DEFAULT_NB_THREADS;
+
+graph_t *g;
+uint64_t *settled;              // The distance each vertex was last expanded with
+uint64_t *start_times;
+uint64_t *end_times;
+barrier_t barrier;
+
+typedef struct thread_data
+{
+	int id;
+	rq_t* queue;
+	uint64_t expanded;          // Vertices expanded, counting re-expansions
+	uint64_t resettled;         // Expansions of a vertex that had already been expanded with a longer distance
+	uint64_t stale;             // Pops of a vertex already expanded with its current distance
+	uint64_t relaxed;           // Edges which shortened the distance of their target
+} thread_data_t;
+
+uint64_t get_time()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+void run_sssp(rq_handle_t* handle, thread_data_t* td)
+{
+	uint64_t idle_start = 0;
+	uint64_t expanded = 0, resettled = 0, stale = 0, relaxed = 0;
+	int id = td->id;
+
+	while (1)
+	{
+		rq_val_t current = rq_dequeue(handle);
+		if (current == RQ_EMPTY)
+		{
+			// The counters of every thread are only read when out of items
+			if (idle_start == 0) idle_start = get_time();
+			if (bfs_terminated()) break;
+			continue;
+		}
+		if (idle_start != 0)
+		{
+			bfs_idle(id, get_time() - idle_start);
+			idle_start = 0;
+		}
+
+		// Only expand if no thread has expanded the vertex with this distance or a shorter one
+		uint64_t distance = g->distances[current];
+		uint64_t last = settled[current];
+		while (distance < last && !CAE(&settled[current], &last, &distance));
+		if (distance >= last)
+		{
+			stale++;
+			bfs_processed(id);
+			continue;
+		}
+		if (last != UINT64_MAX)
+		{
+			resettled++;
+		}
+		expanded++;
+
+		uint64_t *neighbors;
+		uint64_t size = get_neighbors(g, current, &neighbors);
+		uint64_t *weights = get_weights(g, current);
+		for (uint64_t i = 0; i < size; i++)
+		{
+			uint64_t current_neighbor = neighbors[i];
+			uint64_t old_distance = g->distances[current_neighbor];
+			uint64_t new_distance = distance + weights[i];
+
+			while (new_distance < old_distance)
+			{
+				if (likely(CAE(&g->distances[current_neighbor], &old_distance, &new_distance)))
+				{
+					relaxed++;
+					bfs_added(id);
+					rq_enqueue(handle, new_distance / delta, current_neighbor);
+					break;
+				}
+			}
+		}
+		bfs_processed(id);
+	}
+
+	// The search ends when the last vertex was processed, which this thread has just seen
+	end_times[id] = get_time();
+	bfs_idle(id, end_times[id] - idle_start);
+
+	td->expanded = expanded;
+	td->resettled = resettled;
+	td->stale = stale;
+	td->relaxed = relaxed;
+}
+
+void* test(void* thread)
+{
+	thread_data_t* td = (thread_data_t*) thread;
+
+	set_cpu(td->id);
+	seeds = seed_rand();
+
+	rq_handle_t* handle = rq_register(td->queue, td->id);
+	if (td->id == 0)
+	{
+		bfs_added(td->id);
+		rq_enqueue(handle, 0, root);
+	}
+	barrier_cross(&barrier);
+	start_times[td->id] = get_time();
+
+	run_sssp(handle, td);
+	return NULL;
+}
+
+/* ################################################################### *
+ * SEQUENTIAL DIJKSTRA
+ * ################################################################### */
+
+typedef struct dijkstra_item
+{
+	uint64_t distance;
+	uint64_t vertex;
+} dijkstra_item_t;
+
+static void dijkstra_push(dijkstra_item_t *heap, uint64_t *size, dijkstra_item_t item)
+{
+	uint64_t pos = (*size)++;
+	while (pos > 0 && heap[(pos - 1) / 2].distance > item.distance)
+	{
+		heap[pos] = heap[(pos - 1) / 2];
+		pos = (pos - 1) / 2;
+	}
+	heap[pos] = item;
+}
+
+static dijkstra_item_t dijkstra_pop(dijkstra_item_t *heap, uint64_t *size)
+{
+	dijkstra_item_t min = heap[0];
+	dijkstra_item_t item = heap[--(*size)];
+	uint64_t pos = 0;
+	while (2 * pos + 1 < *size)
+	{
+		uint64_t child = 2 * pos + 1;
+		if (child + 1 < *size && heap[child + 1].distance < heap[child].distance) child++;
+		if (item.distance <= heap[child].distance) break;
+		heap[pos] = heap[child];
+		pos = child;
+	}
+	heap[pos] = item;
+	return min;
+}
+
+// Exact distances from root, with a binary heap where outdated entries are skipped when popped
+uint64_t* sequential_dijkstra(graph_t *g, uint64_t root)
+{
+	uint64_t *distances = (uint64_t*) malloc(sizeof(uint64_t) * (g->n_verticies + 1));
+	// Every edge pushes at most once, plus the root
+	dijkstra_item_t *heap = (dijkstra_item_t*) malloc(sizeof(dijkstra_item_t) * (g->n_edges + 1));
+	uint64_t size = 0;
+	if (distances == NULL || heap == NULL)
+	{
+		perror("malloc at allocating the Dijkstra heap");
+		exit(1);
+	}
+	for (uint64_t i = 1; i <= g->n_verticies; i++)
+	{
+		distances[i] = UINT64_MAX;
+	}
+
+	distances[root] = 0;
+	dijkstra_push(heap, &size, (dijkstra_item_t) { 0, root });
+	while (size > 0)
+	{
+		dijkstra_item_t item = dijkstra_pop(heap, &size);
+		if (item.distance > distances[item.vertex])
+		{
+			continue;
+		}
+
+		uint64_t *neighbors;
+		uint64_t n = get_neighbors(g, item.vertex, &neighbors);
+		uint64_t *weights = get_weights(g, item.vertex);
+		for (uint64_t i = 0; i < n; i++)
+		{
+			uint64_t distance = item.distance + weights[i];
+			if (distance < distances[neighbors[i]])
+			{
+				distances[neighbors[i]] = distance;
+				dijkstra_push(heap, &size, (dijkstra_item_t) { distance, neighbors[i] });
+			}
+		}
+	}
+
+	free(heap);
+	return distances;
+}
+
+int main(int argc, char **argv)
+{
+	rq_params_t params;
+	rq_params_init(&params);
+	set_cpu(0);
+	seeds = seed_rand();
+
+	struct option long_options[] = {
+		{"help",                      no_argument,       NULL, 'h'},
+		{"design",                    required_argument, NULL, 'q'},
+		{"num-threads",               required_argument, NULL, 'n'},
+		{"width",                     required_argument, NULL, 'w'},
+		{"choices",                   required_argument, NULL, 'c'},
+		{"depth",                     required_argument, NULL, 'l'},
+		{"relaxation-bound",          required_argument, NULL, 'k'},
+		{"k-mode",                    required_argument, NULL, 'm'},
+		{"filepath",                  required_argument, NULL, 'f'},
+		{"root",                      required_argument, NULL, 'r'},
+		{"directed",                  no_argument,       NULL, 'd'},
+		{"order",                     required_argument, NULL, 'o'},
+		{"delta",                     required_argument, NULL, 'D'},
+		{"no-check",                  no_argument,       NULL, 'S'},
+		{"pin",                       required_argument, NULL, 'P'},
+		{NULL, 0, NULL, 0}
+	};
+
+	int i, c;
+	while (1)
+	{
+		i = 0;
+		c = getopt_long(argc, argv, "hq:n:w:c:l:k:m:f:r:do:D:SP:", long_options, &i);
+		if (c == -1)
+			break;
+		switch (c)
+		{
+			case 'h':
+				printf("SSSP with librelaxed"
+				"\n"
+				"\n"
+				"Usage:\n"
+				"  %s [options...]\n"
+				"\n"
+				"Options:\n"
+				"  -h, --help\n"
+				"        Print this message\n"
+				"  -q, --design <name>\n"
+				"        The queue to use, one of the librelaxed designs [DEFAULT=dcbo-faaaq]\n"
+				"  -n, --num-threads <int>\n"
+				"        Number of threads\n"
+				"  -w, --width <int>\n"
+				"        Width (Number of sub-structures)\n"
+				"  -c, --choices <int>\n"
+				"        The number of choices in the d-CBO queues and the MultiQueue [DEFAULT=2]\n"
+				"  -l, --depth <int>\n"
+				"        Window depth in the 2D queues\n"
+				"  -k, --relaxation-bound <int>\n"
+				"        Relaxation bound in the 2D queues\n"
+				"  -m, --k-mode <int>\n"
+				"        How the 2D queues use the relaxation bound\n"
+				"  -f, --filepath <str>\n"
+				"        The filepath to the .mtx file\n"
+				"  -r, --root <int>\n"
+				"        The source vertex [DEFAULT=1]\n"
+				"  -d, --directed\n"
+				"        Parses the graph as directed [DEFAULT=false]\n"
+				"  -o, --order <str>\n"
+				"        Renumber the vertices for locality: none, bfs or rcm (reverse Cuthill-McKee) [DEFAULT=none]\n"
+				"  -D, --delta <int>\n"
+				"        Distances per priority, where 1 is relaxed Dijkstra [DEFAULT=1]\n"
+				"  -S, --no-check\n"
+				"        Skip the sequential Dijkstra the distances are checked against\n"
+				"  -P, --pin <policy>\n"
+				"        Pin threads from the sysfs topology: compact-cores-first, scatter-sockets, smt-last or table [DEFAULT=table]\n"
+				, argv[0]);
+				exit(0);
+			case 'q':
+				kind = optarg;
+				break;
+			case 'n':
+				num_threads = atoi(optarg);
+				break;
+			case 'w':
+				params.width = atoi(optarg);
+				break;
+			case 'c':
+				params.choices = atoi(optarg);
+				break;
+			case 'l':
+				params.depth = atoi(optarg);
+				break;
+			case 'k':
+				params.relaxation_bound = atoi(optarg);
+				break;
+			case 'm':
+				params.k_mode = atoi(optarg);
+				break;
+			case 'f':
+				filepath = optarg;
+				break;
+			case 'r':
+				root = atol(optarg);
+				break;
+			case 'd':
+				directed = true;
+				break;
+			case 'o':
+				order = parse_graph_order(optarg);
+				break;
+			case 'D':
+				delta = atol(optarg);
+				break;
+			case 'S':
+				check = false;
+				break;
+			case 'P':
+				set_pin_policy(optarg);
+				break;
+			case '?':
+			default:
+				printf("Use -h or --help for help\n");
+				exit(1);
+		}
+	}
+	params.num_threads = num_threads;
+
+	if (filepath == NULL)
+	{
+		printf("A graph has to be given with -f\n");
+		exit(1);
+	}
+	if (delta == 0)
+	{
+		printf("The delta has to be at least 1\n");
+		exit(1);
+	}
+
+	// The distances are sums of weights, so the ids are kept at 64 bits along with them
+	g = parse_mtx_file(filepath, directed, 64, order);
+	if (root == 0 || root > g->n_verticies)
+	{
+		printf("The root %lu is not a vertex of the graph\n", root);
+		exit(1);
+	}
+	root = graph_vertex(g, root);
+
+	rq_t* queue = rq_create(kind, &params);
+	if (queue == NULL)
+	{
+		printf("Unknown design %s, the designs are:", kind);
+		for (size_t k = 0; rq_kind(k) != NULL; k++)
+		{
+			printf(" %s", rq_kind(k));
+		}
+		printf("\n");
+		exit(1);
+	}
+
+	settled = (uint64_t*) malloc(sizeof(uint64_t) * (g->n_verticies + 1));
+	start_times = (uint64_t*) calloc(num_threads, sizeof(uint64_t));
+	end_times = (uint64_t*) calloc(num_threads, sizeof(uint64_t));
+	if (settled == NULL || start_times == NULL || end_times == NULL)
+	{
+		perror("malloc");
+		exit(1);
+	}
+	for (uint64_t v = 1; v <= g->n_verticies; v++)
+	{
+		settled[v] = UINT64_MAX;
+	}
+	g->distances[root] = 0;
+
+	pthread_t threads[num_threads];
+	thread_data_t tds[num_threads];
+	barrier_init(&barrier, num_threads);
+	bfs_stats_init(num_threads);
+
+	size_t t;
+	for (t = 0; t < num_threads; t++)
+	{
+		tds[t].id = t;
+		tds[t].queue = queue;
+		if (pthread_create(&threads[t], NULL, test, tds + t))
+		{
+			perror("pthread_create");
+			exit(1);
+		}
+	}
+
+	uint64_t expanded = 0, resettled = 0, stale = 0, relaxed = 0;
+	for (t = 0; t < num_threads; t++)
+	{
+		pthread_join(threads[t], NULL);
+		expanded += tds[t].expanded;
+		resettled += tds[t].resettled;
+		stale += tds[t].stale;
+		relaxed += tds[t].relaxed;
+	}
+
+	uint64_t min_start = start_times[0];
+	uint64_t max_end = end_times[0];
+	for (t = 1; t < num_threads; t++)
+	{
+		if (start_times[t] < min_start) min_start = start_times[t];
+		if (end_times[t] > max_end) max_end = end_times[t];
+	}
+
+	uint64_t distances = 0;
+	uint64_t visited = 0;
+	for (uint64_t v = 1; v <= g->n_verticies; v++)
+	{
+		if (g->distances[v] != UINT64_MAX)
+		{
+			visited++;
+			distances += g->distances[v];
+		}
+	}
+
+	printf("Design , %s\n", kind);
+	printf("num_threads , %zu \n", num_threads);
+	printf("Width , %lu\n", params.width);
+	printf("Choices (d) , %lu\n", params.choices);
+	printf("Delta , %lu\n", delta);
+	printf("elapsed_time , %.3f \n", ((double)max_end - min_start)/1000000);
+	printf("average_distance , %.3f \n", ((double)distances/visited));
+	printf("vertices_visited , %lu \n", visited);
+	printf("total_work , %lu \n", expanded);
+	printf("resettled_vertices , %lu \n", resettled);
+	printf("stale_pops , %lu \n", stale);
+	printf("relaxations , %lu \n", relaxed);
+	printf("wasted_work_perc , %.2f \n", visited ? 100.0 * resettled / visited : 0.0);
+	uint64_t idle_time = 0;
+	for (t = 0; t < num_threads; t++)
+	{
+		printf("idle_time_thread_%zu , %.3f \n", t, (double) bfs_levels[t].idle_time / 1000000);
+		idle_time += bfs_levels[t].idle_time;
+	}
+	printf("idle_time_avg , %.3f \n", (double) idle_time / num_threads / 1000000);
+
+	if (check)
+	{
+		uint64_t dijkstra_start = get_time();
+		uint64_t *exact = sequential_dijkstra(g, root);
+		uint64_t dijkstra_end = get_time();
+		uint64_t wrong = 0;
+		for (uint64_t v = 1; v <= g->n_verticies; v++)
+		{
+			if (exact[v] != g->distances[v]) wrong++;
+		}
+		printf("dijkstra_time , %.3f \n", ((double)dijkstra_end - dijkstra_start)/1000000);
+		printf("wrong_distances , %lu \n", wrong);
+		free(exact);
+		if (wrong != 0)
+		{
+			printf("\n******** ERROR %lu distances differ from the sequential Dijkstra **********\n\n", wrong);
+			exit(1);
+		}
+	}
+
+	return 0;
+}
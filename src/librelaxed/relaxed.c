@@ -0,0 +1,154 @@
+#include <string.h>
+
+#include "common.h"
+#include "utils.h"
+#include "relaxed.h"
+
+// Thread local variables the designs expect the benchmark to define
+__thread unsigned long *seeds;
+__thread int thread_id;
+__thread unsigned long my_put_cas_fail_count;
+__thread unsigned long my_get_cas_fail_count;
+__thread unsigned long my_null_count;
+__thread unsigned long my_hop_count;
+__thread unsigned long my_slide_count;
+
+// One entry per adapter, see adapter.h
+extern const rq_ops_t rq_ops_dcbo_ms;
+extern const rq_ops_t rq_ops_dcbo_faaaq;
+extern const rq_ops_t rq_ops_dcbo_lcrq;
+extern const rq_ops_t rq_ops_dcbo_wfqueue;
+extern const rq_ops_t rq_ops_twod_queue;
+extern const rq_ops_t rq_ops_twod_queue_optimized;
+extern const rq_ops_t rq_ops_ms;
+extern const rq_ops_t rq_ops_faaaq;
+extern const rq_ops_t rq_ops_lcrq;
+extern const rq_ops_t rq_ops_wfqueue;
+extern const rq_ops_t rq_ops_multiqueue;
+
+static const rq_ops_t* const registry[] =
+{
+	&rq_ops_dcbo_ms,
+	&rq_ops_dcbo_faaaq,
+	&rq_ops_dcbo_lcrq,
+	&rq_ops_dcbo_wfqueue,
+	&rq_ops_twod_queue,
+	&rq_ops_twod_queue_optimized,
+	&rq_ops_ms,
+	&rq_ops_faaaq,
+	&rq_ops_lcrq,
+	&rq_ops_wfqueue,
+	&rq_ops_multiqueue,
+};
+
+#define REGISTRY_SIZE (sizeof(registry) / sizeof(registry[0]))
+
+// Sets up what the benchmarks otherwise set up in every thread before using a design
+static void thread_init(int id)
+{
+	if (seeds == NULL)
+	{
+		seeds = seed_rand();
+	}
+	thread_id = id;
+}
+
+void rq_params_init(rq_params_t* params)
+{
+	// Same defaults as the benchmarks
+	params->num_threads = DEFAULT_NB_THREADS;
+	params->width = 8;
+	params->choices = 2;
+	params->depth = 16;
+	params->relaxation_bound = 0;
+	params->k_mode = 0;
+}
+
+const rq_ops_t* rq_lookup(const char* kind)
+{
+	size_t i;
+	for (i = 0; i < REGISTRY_SIZE; i++)
+	{
+		if (strcmp(registry[i]->name, kind) == 0)
+		{
+			return registry[i];
+		}
+	}
+	return NULL;
+}
+
+const char* rq_kind(size_t index)
+{
+	return index < REGISTRY_SIZE ? registry[index]->name : NULL;
+}
+
+// Returns NULL if there is no design called kind
+rq_t* rq_create(const char* kind, const rq_params_t* params)
+{
+	const rq_ops_t* ops = rq_lookup(kind);
+	rq_t* queue;
+
+	if (ops == NULL)
+	{
+		return NULL;
+	}
+
+	if ((queue = (rq_t*) malloc(sizeof(rq_t))) == NULL)
+	{
+		perror("malloc at allocating rq_t");
+		exit(1);
+	}
+
+	thread_init(0);
+	queue->ops = ops;
+	queue->queue = ops->create(params);
+	return queue;
+}
+
+rq_handle_t* rq_register(rq_t* queue, int thread_id)
+{
+	rq_handle_t* handle;
+
+	if ((handle = (rq_handle_t*) memalign(CACHE_LINE_SIZE, sizeof(rq_handle_t))) == NULL)
+	{
+		perror("malloc at allocating rq_handle_t");
+		exit(1);
+	}
+
+	thread_init(thread_id);
+	handle->ops = queue->ops;
+	handle->enqueue = queue->ops->enqueue;
+	handle->dequeue = queue->ops->dequeue;
+	handle->handle = queue->ops->register_thread(queue->queue, thread_id);
+	return handle;
+}
+
+// Not linearizable, only meant to be used when no other thread is operating on the queue
+size_t rq_size(rq_t* queue)
+{
+	if (queue->ops->size == NULL)
+	{
+		return 0;
+	}
+	return queue->ops->size(queue->queue);
+}
+
+// Frees the handle of a thread, which must not be used any more
+void rq_unregister(rq_handle_t* handle)
+{
+	if (handle->ops->unregister != NULL)
+	{
+		handle->ops->unregister(handle->handle);
+	}
+	free(handle);
+}
+
+// Frees the queue once no thread operates on it, its handles have to be unregistered first
+void rq_destroy(rq_t* queue)
+{
+	if (queue->ops->destroy != NULL)
+	{
+		queue->ops->destroy(queue->queue);
+	}
+	free(queue);
+}
@@ -0,0 +1,80 @@
+#ifndef RELAXED_H
+#define RELAXED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * librelaxed: the queues of this repository behind one C API, selected at runtime by name.
+ *
+ * Every design is compiled into its own adapter, which binds the DS_* macros of the design
+ * to an rq_ops_t entry in the registry. The design code is inlined into the adapter, so an
+ * enqueue or dequeue through a handle costs one indirect call on top of the macro-bound build.
+ */
+
+typedef intptr_t rq_key_t;
+typedef intptr_t rq_val_t;
+
+// Returned by rq_dequeue when no item was found, so 0 can't be enqueued
+#define RQ_EMPTY ((rq_val_t) 0)
+
+// Creation parameters, each design only reads the ones it uses
+typedef struct rq_params
+{
+	size_t num_threads;			// Threads which will register to the queue
+	uint64_t width;				// Sub-queues of the d-CBO and 2D queues
+	uint64_t choices;			// Sub-queues sampled per operation in the d-CBO queues
+	uint64_t depth;				// Window depth of the 2D queues
+	uint64_t relaxation_bound;	// Relaxation bound of the 2D queues, see k_mode
+	uint8_t k_mode;				// How the 2D queues derive width and depth from relaxation_bound
+} rq_params_t;
+
+// One registry entry, the pointers take the design's DS_TYPE* and DS_HANDLE as void*
+typedef struct rq_ops
+{
+	const char* name;
+	void* (*create)(const rq_params_t* params);
+	void* (*register_thread)(void* queue, int thread_id);
+	int (*enqueue)(void* handle, rq_key_t key, rq_val_t val);
+	rq_val_t (*dequeue)(void* handle);
+	size_t (*size)(void* queue);	// NULL if the design can't count its items
+	void (*unregister)(void* handle);	// NULL if the design has no per-thread handle to free
+	void (*destroy)(void* queue);	// NULL if the design can't free its queue
+} rq_ops_t;
+
+typedef struct rq
+{
+	const rq_ops_t* ops;
+	void* queue;
+} rq_t;
+
+// Per-thread handle, the operations are copied in so that the hot path only loads from here
+typedef struct rq_handle
+{
+	void* handle;
+	int (*enqueue)(void* handle, rq_key_t key, rq_val_t val);
+	rq_val_t (*dequeue)(void* handle);
+	const rq_ops_t* ops;
+} rq_handle_t;
+
+/* Interfaces */
+void rq_params_init(rq_params_t* params);
+const rq_ops_t* rq_lookup(const char* kind);
+const char* rq_kind(size_t index);
+rq_t* rq_create(const char* kind, const rq_params_t* params);
+rq_handle_t* rq_register(rq_t* queue, int thread_id);
+size_t rq_size(rq_t* queue);
+void rq_unregister(rq_handle_t* handle);
+void rq_destroy(rq_t* queue);
+
+static inline int rq_enqueue(rq_handle_t* handle, rq_key_t key, rq_val_t val)
+{
+	return handle->enqueue(handle->handle, key, val);
+}
+
+static inline rq_val_t rq_dequeue(rq_handle_t* handle)
+{
+	return handle->dequeue(handle->handle);
+}
+
+#endif
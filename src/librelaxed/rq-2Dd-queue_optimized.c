@@ -0,0 +1,9 @@
+#include "2Dd-queue_optimized.c"
+#include "adapter.h"
+
+static DS_TYPE* rq_new(const rq_params_t* params)
+{
+	return DS_NEW(params->num_threads, params->width, params->depth, params->k_mode, params->relaxation_bound, 0);
+}
+
+RQ_ADAPTER(twod_queue_optimized, "2Dd-queue_optimized");
@@ -0,0 +1,10 @@
+#include "d-balanced-queue.c"
+#include "partial-ms.c"
+#include "adapter.h"
+
+static DS_TYPE* rq_new(const rq_params_t* params)
+{
+	return DS_NEW(params->width, params->choices, params->num_threads);
+}
+
+RQ_ADAPTER(dcbo_ms, "dcbo-ms");
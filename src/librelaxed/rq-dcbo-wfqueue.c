@@ -0,0 +1,13 @@
+#include "d-balanced-queue.c"
+// The wait-free sub-queues bring their own CAS and PAUSE, which differ from the ones in utils.h
+#undef CAS
+#undef PAUSE
+#include "partial-wfqueue.c"
+#include "adapter.h"
+
+static DS_TYPE* rq_new(const rq_params_t* params)
+{
+	return DS_NEW(params->width, params->choices, params->num_threads);
+}
+
+RQ_ADAPTER(dcbo_wfqueue, "dcbo-wfqueue");
@@ -0,0 +1,9 @@
+#include "faaaq.c"
+#include "adapter.h"
+
+static DS_TYPE* rq_new(const rq_params_t* params)
+{
+	return DS_NEW(0);
+}
+
+RQ_ADAPTER(faaaq, "faaaq");
@@ -0,0 +1,10 @@
+#include "queue.h"
+#include "lcrq.c"
+#include "adapter.h"
+
+static DS_TYPE* rq_new(const rq_params_t* params)
+{
+	return DS_NEW(params->width, params->choices);
+}
+
+RQ_ADAPTER(lcrq, "lcrq");
@@ -0,0 +1,9 @@
+#include "ms.c"
+#include "adapter.h"
+
+static DS_TYPE* rq_new(const rq_params_t* params)
+{
+	return DS_NEW(0);
+}
+
+RQ_ADAPTER(ms, "ms");
@@ -0,0 +1,9 @@
+#include "multiqueue.c"
+#include "adapter.h"
+
+static DS_TYPE* rq_new(const rq_params_t* params)
+{
+	return DS_NEW(params->width, params->choices, params->num_threads);
+}
+
+RQ_ADAPTER(multiqueue, "multiqueue");
@@ -0,0 +1,12 @@
+#include "wfqueue.c"
+
+// The wait-free queue can't count its items
+#define RQ_NO_SIZE
+#include "adapter.h"
+
+static DS_TYPE* rq_new(const rq_params_t* params)
+{
+	return DS_NEW(params->num_threads);
+}
+
+RQ_ADAPTER(wfqueue, "wfqueue");
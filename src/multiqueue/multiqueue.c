@@ -0,0 +1,258 @@
+#include "multiqueue.h"
+
+#ifdef RELAXATION_TIMER_ANALYSIS
+#include "relaxation_analysis_timestamps.c"
+#endif
+
+// Internal thread local insert counts for double-collect
+// Don't have in header as it would double-instantiate both here and in the test file
+// It is shared by all queues the thread registers with, so it grows to the widest of them
+__thread uint64_t *double_collect_counts;
+__thread uint32_t double_collect_size;
+// The thread's stream of random bits for sampling sub-queues
+__thread uint64_t index_seed;
+__thread ssmem_allocator_t* alloc;
+
+static inline void sift_up(pq_item_t *items, size_t pos, pq_item_t item)
+{
+    while (pos > 0)
+    {
+        size_t parent = (pos - 1) / 2;
+        if (items[parent].key <= item.key) break;
+        items[pos] = items[parent];
+        pos = parent;
+    }
+    items[pos] = item;
+}
+
+static inline void sift_down(pq_item_t *items, size_t size, pq_item_t item)
+{
+    size_t pos = 0;
+    while (2 * pos + 1 < size)
+    {
+        size_t child = 2 * pos + 1;
+        if (child + 1 < size && items[child + 1].key < items[child].key) child++;
+        if (item.key <= items[child].key) break;
+        items[pos] = items[child];
+        pos = child;
+    }
+    items[pos] = item;
+}
+
+// Both heap operations must hold the lock of the heap
+static inline void heap_push(sub_heap_t *heap, skey_t key, sval_t val)
+{
+    if (heap->size == heap->capacity)
+    {
+        heap->capacity *= 2;
+        if ((heap->items = realloc(heap->items, heap->capacity * sizeof(pq_item_t))) == NULL)
+        {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    pq_item_t item = { key, val };
+    sift_up(heap->items, heap->size, item);
+    heap->size++;
+    heap->insert_count++;
+    heap->top = heap->items[0].key;
+#ifdef RELAXATION_TIMER_ANALYSIS
+    // The stamps hold keys, as the rank error is measured in key order (RELAXATION_KEY_ORDER)
+    add_relaxed_put(key, get_timestamp());
+#endif
+}
+
+static inline sval_t heap_pop(sub_heap_t *heap)
+{
+    pq_item_t min = heap->items[0];
+    heap->size--;
+    if (heap->size > 0)
+    {
+        sift_down(heap->items, heap->size, heap->items[heap->size]);
+    }
+    heap->top = heap->size > 0 ? heap->items[0].key : EMPTY_TOP;
+#ifdef RELAXATION_TIMER_ANALYSIS
+    add_relaxed_get(min.key, get_timestamp());
+#endif
+    return min.val;
+}
+
+// Sample d sub-queues and return the one with the smallest cached top key, or width if all were empty
+static inline uint32_t delete_index(mqueue_t *set) {
+    uint32_t opt_index = set->width;
+    skey_t opt = EMPTY_TOP;
+    for(int i = 0; i < set->d; i++ )
+    {
+        uint32_t index = random_index(set);
+        sub_heap_t *heap = &set->heaps[index];
+        skey_t index_val = heap->top;
+        // A sub-queue holding only EMPTY_TOP keys is still chosen if nothing smaller was seen
+        if(heap->size > 0 && (index_val < opt || opt_index == set->width))
+        {
+            opt_index = index;
+            opt = index_val;
+        }
+    }
+    return opt_index;
+}
+
+// Inserts into a single random sub-queue, as the d-choice is only needed to find small keys
+int mq_insert(mqueue_t *set, skey_t key, sval_t val) {
+    sub_heap_t *heap = &set->heaps[random_index(set)];
+    LOCK(&heap->lock);
+    heap_push(heap, key, val);
+    UNLOCK(&heap->lock);
+    return 1;
+}
+
+sval_t mq_delete_min(mqueue_t *set) {
+    uint32_t opt_index = delete_index(set);
+    if (opt_index == set->width) return double_collect(set, random_index(set));
+
+    sub_heap_t *heap = &set->heaps[opt_index];
+    LOCK(&heap->lock);
+    // The top might have been taken since it was sampled
+    if (heap->size > 0)
+    {
+        sval_t v = heap_pop(heap);
+        UNLOCK(&heap->lock);
+        return v;
+    }
+    UNLOCK(&heap->lock);
+    return double_collect(set, opt_index + 1);
+}
+
+// Pops from the first non-empty sub-queue from start_index, or returns EMPTY once two passes have
+// seen every sub-queue empty with the same insert counts
+sval_t double_collect(mqueue_t *set, uint32_t start_index)
+{
+    uint32_t i, index;
+    uint32_t width = set->width;
+    sub_heap_t *heap;
+
+    // Loop through all from start_index, wrapping around without a modulo
+    if (start_index >= width) start_index = 0;
+retry:
+    index = start_index;
+    for (i = 0; i < width; i++, index = index + 1 == width ? 0 : index + 1)
+    {
+        heap = &set->heaps[index];
+        double_collect_counts[index] = heap->insert_count;
+        if (heap->size > 0)
+        {
+            LOCK(&heap->lock);
+            if (heap->size > 0)
+            {
+                sval_t v = heap_pop(heap);
+                UNLOCK(&heap->lock);
+                return v;
+            }
+            UNLOCK(&heap->lock);
+        }
+    }
+
+    index = start_index;
+    for (i = 0; i < width; i++, index = index + 1 == width ? 0 : index + 1)
+    {
+        if (set->heaps[index].insert_count != double_collect_counts[index])
+        {
+            start_index = index;
+            goto retry;
+        }
+    }
+    return EMPTY;
+}
+
+mqueue_t* create_multiqueue(uint32_t n_heaps, uint32_t d, int nbr_threads)
+{
+    mqueue_t *set;
+
+	// Create an allocator for the main thread, like the other designs
+    ssalloc_init();
+	#if GC == 1
+    if (alloc == NULL)
+    {
+		alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
+		assert(alloc != NULL);
+		ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, nbr_threads);
+    }
+	#endif
+
+	if ((set = (mqueue_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mqueue_t))) == NULL)
+    {
+		perror("malloc");
+		exit(1);
+    }
+	set->width = n_heaps;
+    set->d = d;
+	set->heaps = ssalloc_aligned(CACHE_LINE_SIZE, n_heaps*sizeof(sub_heap_t));
+
+	uint32_t i;
+	for(i=0; i < set->width; i++)
+	{
+        sub_heap_t *heap = &set->heaps[i];
+        INIT_LOCK(&heap->lock);
+        heap->top = EMPTY_TOP;
+        heap->size = 0;
+        heap->insert_count = 0;
+        heap->capacity = SUB_HEAP_INITIAL;
+        if ((heap->items = malloc(SUB_HEAP_INITIAL * sizeof(pq_item_t))) == NULL)
+        {
+            perror("malloc");
+            exit(1);
+        }
+	}
+
+	return set;
+}
+
+// Frees the heaps of the queue, once no thread uses it any more
+void destroy_multiqueue(mqueue_t *set)
+{
+	for (uint32_t i = 0; i < set->width; i++)
+	{
+		free(set->heaps[i].items);
+	}
+	ssfree((void*) set->heaps);
+	ssfree((void*) set);
+}
+
+size_t multiqueue_size(mqueue_t *set)
+{
+    uint64_t total = 0;
+    for(int i=0; i<set->width; i++){
+        total+=set->heaps[i].size;
+    }
+    return total;
+}
+
+uint32_t random_index(mqueue_t *set)
+{
+	return reduce_range((uint32_t) wyrand(&index_seed), set->width);
+}
+
+// Set up thread local variables for the queue
+mqueue_t* multiqueue_register(mqueue_t *set, int thread_id)
+{
+    ssalloc_init();
+	#if GC == 1
+    if (alloc == NULL)
+    {
+		alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
+		assert(alloc != NULL);
+		ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, thread_id);
+    }
+	#endif
+
+	if (double_collect_size < set->width)
+	{
+		double_collect_size = set->width;
+		double_collect_counts = realloc(double_collect_counts, double_collect_size*sizeof(uint64_t));
+		assert(double_collect_counts != NULL);
+	}
+	index_seed = wyrand_seed(thread_id);
+#ifdef RELAXATION_TIMER_ANALYSIS
+	init_relaxation_analysis_local(thread_id);
+#endif
+    return set;
+}
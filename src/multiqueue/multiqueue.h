@@ -0,0 +1,99 @@
+#ifndef MULTIQUEUE_H
+#define MULTIQUEUE_H
+
+#include <assert.h>
+#include <getopt.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <time.h>
+#include <stdint.h>
+#include "common.h"
+
+#include "lock_if.h"
+#include "ssmem.h"
+#include "utils.h"
+
+#ifdef RELAXATION_TIMER_ANALYSIS
+#include "relaxation_analysis_timestamps.h"
+#elif RELAXATION_ANALYSIS
+#error "The MultiQueue only supports RELAXATION_ANALYSIS=TIMER"
+#endif
+
+ /* ################################################################### *
+	* Definition of macros: per data structure
+* ################################################################### */
+
+#define DS_ADD(s,k,v)       mq_insert(s,k,v)
+#define DS_REMOVE(s)        mq_delete_min(s)
+#define DS_SIZE(s)          multiqueue_size(s)
+#define DS_NEW(w,d,i)       create_multiqueue(w,d,i)
+#define DS_REGISTER(q,i)    multiqueue_register(q,i)
+#define DS_DESTROY(s)       destroy_multiqueue(s)
+
+#define DS_HANDLE           mqueue_t*
+#define DS_TYPE             mqueue_t
+#define DS_NODE             pq_item_t
+
+#define EMPTY               ((sval_t)0)
+
+// Cached top key of an empty sub-queue. It is also a valid key, so emptiness is only decided by the size
+#define EMPTY_TOP           ((skey_t)INTPTR_MAX)
+
+// Items every sub-queue has room for before its heap array is first grown
+#define SUB_HEAP_INITIAL    64
+
+/* Type definitions */
+typedef struct pq_item
+{
+	skey_t key;
+	sval_t val;
+} pq_item_t;
+
+// A binary min-heap protected by a lock. The top key, size and insert count are only written
+// under the lock, but read without it when sampling.
+typedef ALIGNED(CACHE_LINE_SIZE) struct sub_heap
+{
+	ptlock_t lock;
+	volatile skey_t top;
+	volatile size_t size;
+	volatile uint64_t insert_count;
+	size_t capacity;
+	pq_item_t *items;
+} sub_heap_t;
+
+typedef ALIGNED(CACHE_LINE_SIZE) struct mqueue_file
+{
+	sub_heap_t *heaps;
+	uint32_t width;
+	uint32_t d;
+	uint8_t padding[CACHE_LINE_SIZE - sizeof(sub_heap_t*) - 2*sizeof(uint32_t)];
+} mqueue_t;
+
+/*Global variables*/
+
+
+/*Thread local variables*/
+extern __thread ssmem_allocator_t* alloc;
+extern __thread int thread_id;
+
+extern __thread unsigned long my_put_cas_fail_count;
+extern __thread unsigned long my_get_cas_fail_count;
+extern __thread unsigned long my_null_count;
+extern __thread unsigned long my_hop_count;
+extern __thread unsigned long my_slide_count;
+
+/* Interfaces */
+int mq_insert(mqueue_t *set, skey_t key, sval_t val);
+sval_t mq_delete_min(mqueue_t *set);
+mqueue_t* create_multiqueue(uint32_t n_heaps, uint32_t d, int nbr_threads);
+void destroy_multiqueue(mqueue_t *set);
+size_t multiqueue_size(mqueue_t *set);
+uint32_t random_index(mqueue_t *set);
+sval_t double_collect(mqueue_t *set, uint32_t start_index);
+mqueue_t* multiqueue_register(mqueue_t *set, int thread_id);
+
+#endif // MULTIQUEUE_H
@@ -291,7 +291,7 @@ sval_t dequeue(mqueue_t *set)
 
 uint64_t random_index(mqueue_t *set)
 {
-	return (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (set->width));
+	return reduce_range((uint32_t) my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])), set->width);
 }
 
 size_t queue_size(mqueue_t *set)
@@ -254,10 +254,12 @@ void* test(void* thread)
 	RETRY_STATS_ZERO(); //ad for latency.h
 	barrier_cross(&barrier_global);
 	RR_START_SIMPLE(); //ad for rapl_read
+	PERF_COUNTERS_START();
 	while (stop == 0)
     {
 		TEST_LOOP_ONLY_UPDATES(); //run only update tests
     }
+	PERF_COUNTERS_STOP();
 	barrier_cross(&barrier);
 	RR_STOP_SIMPLE(); //ad for rapl_read
 	if (!ID)
@@ -320,6 +322,7 @@ int main(int argc, char **argv)
     {"num-buckets",               required_argument, NULL, 'b'},
     {"print-vals",                required_argument, NULL, 'v'},
     {"vals-pf",                   required_argument, NULL, 'f'},
+    {"pin",                       required_argument, NULL, 'P'},
     {NULL, 0, NULL, 0}
   };
 
@@ -327,7 +330,7 @@ int main(int argc, char **argv)
   while(1)
     {
 		i = 0;
-		c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:k:m:w:", long_options, &i);
+		c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:k:m:w:P:", long_options, &i);
 		if(c == -1)
 			break;
 		if(c == 0 && long_options[i].flag == 0)
@@ -367,6 +370,8 @@ int main(int argc, char **argv)
 					 "        When using detailed profiling, how many values to keep track of.\n"
 					 "  -k, --Relaxation Bound <int>\n"
 					 "        Relaxation bound.\n"
+					 "  -P, --pin <policy>\n"
+					 "        Pin threads from the sysfs topology: compact-cores-first, scatter-sockets, smt-last or table [DEFAULT=table].\n"
 					 , argv[0]);
 				exit(0);
 			case 'd':
@@ -404,6 +409,9 @@ int main(int argc, char **argv)
 			case 'w':
 				// Does not do anything, but added to play nicer in tests with other relaxed data structures
 				break;
+			case 'P':
+				set_pin_policy(optarg);
+				break;
 			case '?':
 			default:
 				printf("Use -h or --help for help\n");
@@ -596,7 +604,7 @@ int main(int argc, char **argv)
 		long unsigned put_fal = (putting_count_total - putting_count_total_succ) ? putting_fal_total / (putting_count_total - putting_count_total_succ) : 0;
 		long unsigned rem_suc = removing_count_total_succ ? removing_suc_total / removing_count_total_succ : 0;
 		long unsigned rem_fal = (removing_count_total - removing_count_total_succ) ? removing_fal_total / (removing_count_total - removing_count_total_succ) : 0;
-		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, get_suc, get_fal, put_suc, put_fal, rem_suc, rem_fal);
+		printf("%-7zu %-8lu %-8lu %-8lu %-8lu %-8lu %-8lu\n", num_threads, 0LU, 0LU, put_suc, put_fal, rem_suc, rem_fal);
 	#endif
 
 	#define LLU long long unsigned int
@@ -638,6 +646,7 @@ int main(int argc, char **argv)
 	RR_PRINT_CORRECTED();
 	RETRY_STATS_PRINT(total, putting_count_total, removing_count_total, putting_count_total_succ + removing_count_total_succ);
 	LATENCY_DISTRIBUTION_PRINT();
+	PERF_COUNTERS_PRINT(putting_count_total + removing_count_total);
 
 	#ifdef RELAXATION_TIMER_ANALYSIS
 		print_relaxation_measurements(num_threads);
@@ -389,6 +389,7 @@ void queue_init(queue_t *q, int nprocs) {
     q->Ei = 1;
     q->Di = 1;
 
+    q->_tail_handle = NULL;
     q->nprocs = nprocs;
 
 #ifdef RECORD
@@ -453,12 +454,11 @@ handle_t* queue_register(queue_t *q, int id) {
     th->empty = 0;
 #endif
 
-    static handle_t *volatile _tail;
-    handle_t *tail = _tail;
+    handle_t *tail = q->_tail_handle;
 
     if (tail == NULL) {
         th->next = th;
-        if (CASra(&_tail, &tail, th)) {
+        if (CASra(&q->_tail_handle, &tail, th)) {
             th->Eh = th->next;
             th->Dh = th->next;
             return th;
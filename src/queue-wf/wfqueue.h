@@ -53,6 +53,11 @@ typedef struct CACHE_ALIGNED {
    */
   struct _node_t * volatile Hp;
 
+  /**
+   * Pointer to the last registered handle for setup.
+  */
+  struct _handle_t * volatile _tail_handle;
+
   /**
    * Number of processors.
    */
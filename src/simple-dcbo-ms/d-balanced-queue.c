@@ -3,6 +3,8 @@
 // Internal thread local count for double-collect
 // Don't have in header as it would double-instantiate both here and in the test file
 __thread uint64_t *double_collect_counts;
+// The thread's stream of random bits for sampling sub-queues
+__thread uint64_t index_seed;
 __thread ssmem_allocator_t* alloc;
 
 
@@ -59,9 +61,11 @@ sval_t double_collect(mqueue_t *set, uint32_t start_index){
     uint64_t throwaway;
 
     start:
-    // Loop through all, collecting their tail versions and then try to dequeue if not empty
-    for(uint32_t i = 0; i<set->width; i++){
-        index = (start_index + i) % set->width; // TODO: Optimize away modulo
+    // Loop through all from start_index, wrapping around, collecting their tail versions and then try
+    // to dequeue if not empty
+    if (start_index >= set->width) start_index = 0;
+    index = start_index;
+    for(uint32_t i = 0; i<set->width; i++, index = index + 1 == set->width ? 0 : index + 1){
 
         double_collect_counts[index] = PARTIAL_TAIL_VERSION(&set->queues[index]);
         sval_t v = PARTIAL_DEQUEUE(&(set->queues[index]));
@@ -69,8 +73,8 @@ sval_t double_collect(mqueue_t *set, uint32_t start_index){
     }
 
     // Return empty if all counts are the same and the queues are still empty, otherwise restart
-    for(uint32_t i = 0; i<set->width; i++){
-        index = (start_index + i) % set->width;
+    index = start_index;
+    for(uint32_t i = 0; i<set->width; i++, index = index + 1 == set->width ? 0 : index + 1){
         if (double_collect_counts[index] != PARTIAL_TAIL_VERSION(&(set->queues[index])))
         {
             start_index = index;
@@ -127,7 +131,7 @@ size_t queue_size(mqueue_t *set)
 
 uint32_t random_index(mqueue_t *set)
 {
-	return (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (set->width));
+	return reduce_range((uint32_t) wyrand(&index_seed), set->width);
 }
 
 // Set up thread local variables for the queue
@@ -144,6 +148,7 @@ mqueue_t* d_balanced_register(mqueue_t *set, int thread_id)
 	#endif
 
 	double_collect_counts = malloc(set->width*sizeof(uint64_t));
+    index_seed = wyrand_seed(thread_id);
 #ifdef RELAXATION_TIMER_ANALYSIS
 	init_relaxation_analysis_local(thread_id);
 #endif
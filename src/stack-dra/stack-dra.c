@@ -247,7 +247,7 @@ sval_t pop(mstack_t *set)
 
 uint64_t random_index(mstack_t *set)
 {
-	return (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (set->width));
+	return reduce_range((uint32_t) my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])), set->width);
 }
 
 size_t stack_size(mstack_t *set)
@@ -218,10 +218,12 @@ void* test(void* thread)
 	RETRY_STATS_ZERO(); //ad for latency.h
 	barrier_cross(&barrier_global);
 	RR_START_SIMPLE(); //ad for rapl_read
+	PERF_COUNTERS_START();
 	while (stop == 0)
     {
 		TEST_LOOP_ONLY_UPDATES(); //run only update tests
     }
+	PERF_COUNTERS_STOP();
 	barrier_cross(&barrier);
 	RR_STOP_SIMPLE(); //ad for rapl_read
 	if (!ID)
@@ -284,6 +286,7 @@ int main(int argc, char **argv)
     {"num-buckets",               required_argument, NULL, 'b'},
     {"print-vals",                required_argument, NULL, 'v'},
     {"vals-pf",                   required_argument, NULL, 'f'},
+    {"pin",                       required_argument, NULL, 'P'},
     {NULL, 0, NULL, 0}
   };
 
@@ -291,7 +294,7 @@ int main(int argc, char **argv)
   while(1)
     {
 		i = 0;
-		c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:k:m:w:", long_options, &i);
+		c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:k:m:w:P:", long_options, &i);
 		if(c == -1)
 			break;
 		if(c == 0 && long_options[i].flag == 0)
@@ -329,6 +332,8 @@ int main(int argc, char **argv)
 					 "        When using detailed profiling, how many values to print.\n"
 					 "  -f, --val-pf <int>\n"
 					 "        When using detailed profiling, how many values to keep track of.\n"
+					 "  -P, --pin <policy>\n"
+					 "        Pin threads from the sysfs topology: compact-cores-first, scatter-sockets, smt-last or table [DEFAULT=table].\n"
 					 , argv[0]);
 				exit(0);
 			case 'd':
@@ -364,6 +369,9 @@ int main(int argc, char **argv)
 			case 'w':
 				// Does not do anything, but added to play nicer in tests with other relaxed data structures
 				break;
+			case 'P':
+				set_pin_policy(optarg);
+				break;
 			case '?':
 			default:
 				printf("Use -h or --help for help\n");
@@ -613,6 +621,7 @@ int main(int argc, char **argv)
 	RR_PRINT_CORRECTED();
 	RETRY_STATS_PRINT(total, putting_count_total, removing_count_total, putting_count_total_succ + removing_count_total_succ);
 	LATENCY_DISTRIBUTION_PRINT();
+	PERF_COUNTERS_PRINT(putting_count_total + removing_count_total);
 
 	printf("Push_CAS_fails , %zu\n", push_cas_fail_count_total);
 	printf("Pop_CAS_fails , %zu\n", pop_cas_fail_count_total);